@@ -78,4 +78,10 @@ namespace BitFunnel
     typedef size_t RowIndex;
     static const size_t c_log2MaxRowIndexValue = 25;
     static const size_t c_maxRowIndexValue = (1ul << c_log2MaxRowIndexValue) - 1;
+
+    // StaticRank is a query-independent measure of a document's quality,
+    // quantized by the host so that larger values are better. It is stored
+    // in the DocTable blob registered by
+    // IDocumentDataSchema::RegisterStaticRankBlob().
+    typedef uint16_t StaticRank;
 }
@@ -0,0 +1,83 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stddef.h>                     // ptrdiff_t return value.
+
+#include "BitFunnel/AbstractRow.h"      // AbstractRow return value.
+#include "BitFunnel/BitFunnelTypes.h"   // Rank, ShardId parameters.
+#include "BitFunnel/IInterface.h"       // Base class.
+#include "BitFunnel/RowId.h"            // RowId return value.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // IPlanRows
+    //
+    // Maps the AbstractRows of a RowPlan to the physical rows of each Shard.
+    // A query is planned once in terms of AbstractRows, whose ids are shared
+    // by every Shard, and then bound to each Shard's row layout when its
+    // code is generated.
+    //
+    // Each AbstractRow has a rank which is no greater than the rank of any of
+    // the physical rows it maps to. A physical row with a higher rank is
+    // evaluated as if it had been ranked down by the difference.
+    //
+    //*************************************************************************
+    class IPlanRows : public IInterface
+    {
+    public:
+        // Returns true if no more rows can be added.
+        virtual bool IsFull() const = 0;
+
+        // Returns the number of Shards the rows are mapped to.
+        virtual ShardId GetShardCount() const = 0;
+
+        // Returns the number of AbstractRows added so far.
+        virtual unsigned GetRowCount() const = 0;
+
+        // Adds an AbstractRow with the specified rank. The physical rows for
+        // the new id must then be set for every Shard with PhysicalRow().
+        virtual AbstractRow AddRow(Rank rank) = 0;
+
+        // Returns the rank passed to AddRow() for the row with the specified
+        // id.
+        virtual Rank GetRank(unsigned id) const = 0;
+
+        // Returns the physical row in a Shard for an AbstractRow id.
+        virtual RowId const & PhysicalRow(ShardId shard, unsigned id) const = 0;
+        virtual RowId & PhysicalRow(ShardId shard, unsigned id) = 0;
+
+        // Returns the byte offset of the physical row within the slice
+        // buffers of a Shard.
+        virtual ptrdiff_t GetRowOffset(ShardId shard, unsigned id) const = 0;
+
+        // Returns the estimated fraction of bits set in the physical rows
+        // for an AbstractRow id, averaged over the Shards. Returns 1.0 when
+        // no densities are available.
+        virtual double GetDensity(unsigned id) const = 0;
+    };
+}
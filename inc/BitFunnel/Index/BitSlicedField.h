@@ -0,0 +1,75 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stdint.h>                         // uint64_t parameter.
+#include <vector>                           // std::vector member.
+
+#include "BitFunnel/Index/IFactSet.h"       // FactHandle member.
+
+
+namespace BitFunnel
+{
+    class DocumentHandle;
+
+    //*************************************************************************
+    //
+    // BitSlicedField
+    //
+    // Stores a numeric document field, e.g. a timestamp, price or quality
+    // score, in ceil(log2(maxValue + 1)) fact rows. Fact row i holds bit i of
+    // the value, so range predicates over the field become And/Or/Not
+    // expressions over these rows (see TermMatchNode::Builder::
+    // CreateRangeNode()) and run at the same speed as term matching, without
+    // consulting the DocTable.
+    //
+    // The facts must be defined in the IFactSet before it configures the
+    // TermTable. They are mutable so that a document's value can be updated.
+    //
+    //*************************************************************************
+    class BitSlicedField
+    {
+    public:
+        // Defines one fact per bit in facts, named "<name>:<bit>". The field
+        // holds values in [0, maxValue].
+        BitSlicedField(IFactSet& facts, char const * name, uint64_t maxValue);
+
+        // Returns the largest value the field accepts.
+        uint64_t GetMaxValue() const;
+
+        // Returns the number of bits, and therefore fact rows, in the field.
+        unsigned GetBitCount() const;
+
+        // Returns the fact holding bit i of the value.
+        FactHandle GetFact(unsigned bit) const;
+
+        // Sets the document's fact rows to the bits of value. Throws
+        // RecoverableError if value exceeds GetMaxValue().
+        void Assert(DocumentHandle handle, uint64_t value) const;
+
+    private:
+        const uint64_t m_maxValue;
+        std::vector<FactHandle> m_facts;
+    };
+}
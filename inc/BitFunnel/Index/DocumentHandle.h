@@ -32,6 +32,7 @@
 
 namespace BitFunnel
 {
+    class ResolvedTermCache;
     class Slice;
     class Term;
 
@@ -85,6 +86,12 @@ namespace BitFunnel
         // Returns nullptr if the blob data has not been previously allocated.
         void* GetVariableSizeBlob(VariableSizeBlobId id) const;
 
+        // Allocates the variable-sized blob registered by
+        //    IDocumentDataSchema::RegisterTermSequenceBlob().
+        //
+        // Returns nullptr if the schema has no term sequence blob.
+        void* AllocateTermSequenceBlob(size_t byteSize);
+
         // Returns a pointer to the fixed-sized blob associated with a
         // given FixedSizeBlobId. The FIxedSizeBlobId must have been previously
         // assigned by a call to
@@ -95,10 +102,28 @@ namespace BitFunnel
         // must have been previously registered in the IFactSet.
         void AssertFact(FactHandle fact, bool value);
 
+        // Sets the document's StaticRank. The schema must have a static rank
+        // blob, registered by IDocumentDataSchema::RegisterStaticRankBlob().
+        void SetStaticRank(StaticRank rank);
+
+        // Returns the document's StaticRank, or 0 if the schema has no
+        // static rank blob.
+        StaticRank GetStaticRank() const;
+
         // Adds a posting to the index, asserting that a Term is associated
         // with this document.
         void AddPosting(Term const & term);
 
+        // Same as AddPosting(term), but resolves the term's RowIds through
+        // cache, which must come from GetResolvedTermCache() on this thread.
+        // Documents with many postings should get the cache once and pass it
+        // to each call.
+        void AddPosting(Term const & term, ResolvedTermCache& cache);
+
+        // Returns the calling thread's ResolvedTermCache for the TermTable
+        // of the document's Shard.
+        ResolvedTermCache& GetResolvedTermCache() const;
+
         // Removes this document from the index. Queries initiated after
         // Expire() returns will not see this document. Queries already in
         // progress at the time Expire() is called may be able to see the
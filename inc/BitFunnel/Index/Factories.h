@@ -24,6 +24,7 @@
 
 #include <iosfwd>               // std::istream parameter.
 #include <memory>               // std::unique_ptr return type.
+#include <string>               // std::string parameter.
 
 #include "BitFunnel/Term.h"     // Term::IdfX10 parameter.
 
@@ -38,8 +39,10 @@ namespace BitFunnel
     class IIngestor;
     class IRecycler;
     class IShardDefinition;
+    class IShardDefinitionBuilder;
     class ISimpleIndex;
     class ISliceBufferAllocator;
+    class ISliceCompactor;
     class ITermTable2;
     class ITermTableCollection;
     class ITermTableBuilder;
@@ -70,10 +73,33 @@ namespace BitFunnel
                            IRecycler& recycler,
                            ITermTableCollection const & termTables,
                            IShardDefinition const & shardDefinition,
-                           ISliceBufferAllocator& sliceBufferAllocator);
+                           ISliceBufferAllocator& sliceBufferAllocator,
+                           bool generateStatistics);
+
+        // Creates an Ingestor that gathers statistics in the
+        // DocumentFrequencyTableBuilder's approximate mode, with fixed memory
+        // per thread. The DocumentFrequencyTable keeps the heavyHitterCount
+        // most frequent terms, with counts overestimated by at most
+        // statisticsErrorBound times the number of postings.
+        std::unique_ptr<IIngestor>
+            CreateIngestor(IDocumentDataSchema const & docDataSchema,
+                           IRecycler& recycler,
+                           ITermTableCollection const & termTables,
+                           IShardDefinition const & shardDefinition,
+                           ISliceBufferAllocator& sliceBufferAllocator,
+                           double statisticsErrorBound,
+                           size_t heavyHitterCount);
 
         std::unique_ptr<IRecycler> CreateRecycler();
 
+        // Adds shards to an empty shardDefinition, chosen to minimize the
+        // row memory for the documents in a DocumentLengthHistogram file.
+        std::unique_ptr<IShardDefinitionBuilder>
+            CreateShardDefinitionBuilder(std::istream& documentLengthHistogram,
+                                         ITermTable2 const & termTable,
+                                         ShardId shardCount,
+                                         IShardDefinition& shardDefinition);
+
         std::unique_ptr<ISimpleIndex> CreateSimpleIndex(char const * directory,
                                                         size_t gramSize,
                                                         bool generateTermToText);
@@ -81,16 +107,26 @@ namespace BitFunnel
         std::unique_ptr<ISliceBufferAllocator>
             CreateSliceBufferAllocator(size_t blockSize, size_t blockCount);
 
+        std::unique_ptr<ISliceCompactor>
+            CreateSliceCompactor(IIngestor& ingestor,
+                                 double maxDensity,
+                                 size_t intervalInMilliseconds);
+
         std::unique_ptr<ITermTable2> CreateTermTable();
         std::unique_ptr<ITermTable2> CreateTermTable(std::istream & input);
 
+        // Memory maps a TermTable file previously written by
+        // ITermTable2::Write().
+        std::unique_ptr<ITermTable2> CreateTermTable(std::string const & fileName);
+
         std::unique_ptr<ITermTableBuilder>
             CreateTermTableBuilder(double density,
                                    double adhocFrequency,
                                    ITermTreatment const & treatment,
                                    IDocumentFrequencyTable const & terms,
                                    IFactSet const & facts,
-                                   ITermTable2 & termTable);
+                                   ITermTable2 & termTable,
+                                   size_t threadCount);
 
         std::unique_ptr<ITermTableCollection>
             CreateTermTableCollection(ShardId shardCount);
@@ -105,5 +141,8 @@ namespace BitFunnel
 
         std::unique_ptr<ITermTreatment>
             CreateTreatmentPrivateShardRank0And3(double density, double snr);
+
+        std::unique_ptr<ITermTreatment>
+            CreateTreatmentTable(std::istream& input);
     }
 }
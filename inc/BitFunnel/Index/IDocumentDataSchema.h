@@ -69,6 +69,26 @@ namespace BitFunnel
         // data and returns its id for future use.
         virtual FixedSizeBlobId RegisterFixedSizeBlob(unsigned byteCount) = 0;
 
+        // Registers the variable size blob in which ingestion stores the
+        // sequence of term fingerprints in each of the document's streams.
+        // Queries use it to verify phrase matches. Returns the blob's id.
+        // May only be called once.
+        virtual VariableSizeBlobId RegisterTermSequenceBlob() = 0;
+
+        // Returns true and sets blob to the id of the term sequence blob if
+        // RegisterTermSequenceBlob() has been called.
+        virtual bool TryGetTermSequenceBlob(VariableSizeBlobId& blob) const = 0;
+
+        // Registers the fixed size blob that holds each document's
+        // StaticRank. Queries for the top matches by StaticRank use it to
+        // visit the best Slices first and stop early. Returns the blob's id.
+        // May only be called once.
+        virtual FixedSizeBlobId RegisterStaticRankBlob() = 0;
+
+        // Returns true and sets blob to the id of the static rank blob if
+        // RegisterStaticRankBlob() has been called.
+        virtual bool TryGetStaticRankBlob(FixedSizeBlobId& blob) const = 0;
+
         // Returns the number of variable size blobs of per document data defined
         // in the schema.
         virtual unsigned GetVariableSizeBlobCount() const = 0;
@@ -95,6 +95,11 @@ namespace BitFunnel
         // some of which may already have been deleted for other reasons.
         virtual bool Delete(DocId id) = 0;
 
+        // Moves the live documents out of sparsely populated Slices, in which
+        // fewer than maxDensity of the columns hold live documents, and
+        // releases the emptied Slices. Returns the number of Slices released.
+        virtual size_t CompactSlices(double maxDensity) = 0;
+
         // Sets or clears a fact about a document with the given DocId. The
         // FactHandle must have been previously registered in the IFactSet,
         // otherwise the function throws.
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <stddef.h>                 // size_t parameter.
+
 #include "BitFunnel/IInterface.h"   // Base class.
 
 
@@ -63,6 +65,21 @@ namespace BitFunnel
         // This thread is shut down in StopIndex().
         virtual void StartIndex(bool forStatistics) = 0;
 
+        // Makes a later StartIndex(true) gather approximate statistics, with
+        // fixed memory per ingestion thread. The Document Frequency Table
+        // keeps the heavyHitterCount most frequent terms, with counts
+        // overestimated by at most errorBound times the number of postings.
+        // Must be called before StartIndex().
+        virtual void SetApproximateStatistics(double errorBound,
+                                              size_t heavyHitterCount) = 0;
+
+        // Starts a background thread that compacts Slices whose fraction of
+        // live documents is at most maxDensity, checking every
+        // intervalInMilliseconds. Compaction is off unless this method is
+        // called after StartIndex(). The thread is shut down in StopIndex().
+        virtual void StartCompactor(double maxDensity,
+                                    size_t intervalInMilliseconds) = 0;
+
         // Performs an orderly shutdown, then tears down all of the classes
         // created by StartIndex(). Must be called before class destruction.
         virtual void StopIndex() = 0;
@@ -0,0 +1,49 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "BitFunnel/IInterface.h"   // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // Abstract class or interface for classes which periodically compact the
+    // Slices of an index in the background, re-packing the documents of
+    // sparsely populated Slices so that the rest can be recycled.
+    //
+    //*************************************************************************
+    class ISliceCompactor : public IInterface
+    {
+    public:
+        // Runs compaction passes until Shutdown() is called. The caller
+        // provides the thread.
+        virtual void Run() = 0;
+
+        // Causes Run() to return once the current compaction pass, if any,
+        // has finished.
+        virtual void Shutdown() = 0;
+    };
+}
@@ -89,6 +89,12 @@ namespace BitFunnel
         uint32_t m_start : c_log2MaxRowIndexValue;
         uint32_t m_count : RowConfiguration::Entry::c_log2MaxRowCount;
         uint32_t m_type : c_log2MaxTypeValue;
+
+        // Unused bits are always zero so that the TermTable serializes
+        // identically from one build to the next.
+        uint32_t m_unused : 32 - c_log2MaxRowIndexValue
+                               - RowConfiguration::Entry::c_log2MaxRowCount
+                               - c_log2MaxTypeValue;
     };
 
     // Require PackedRowIdSequence to be trivailly copyable to allow for binary
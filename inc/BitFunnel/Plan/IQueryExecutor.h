@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <memory>                       // std::unique_ptr return type.
+#include <stdint.h>                     // uint64_t return type.
+#include <vector>                       // std::vector return type.
+
+#include "BitFunnel/BitFunnelTypes.h"   // DocId template parameter.
+#include "BitFunnel/IEnumerator.h"      // IEnumerator return type.
+#include "BitFunnel/IInterface.h"       // Base class.
+
+
+namespace BitFunnel
+{
+    class TermMatchNode;
+
+    //*************************************************************************
+    //
+    // IQueryExecutor
+    //
+    // Matches queries against every Shard of an index. Each query is planned
+    // once and then bound to the rows of each Shard, since each Shard has its
+    // own TermTable. The plans are cached, so repeated queries skip
+    // planning. The Shards are then matched concurrently, so the latency of
+    // a query is proportional to the largest Shard rather than to the size of
+    // the index.
+    //
+    // Thread safety: all methods are thread safe.
+    //
+    //*************************************************************************
+    class IQueryExecutor : public IInterface
+    {
+    public:
+        // Starts matching query and returns a stream of the DocIds of the
+        // matching documents. Matches are available from the stream as soon
+        // as their Slice has been scanned, in no particular order. The query
+        // may be released once Execute() returns. Destroying the stream
+        // before it is exhausted cancels the remaining work.
+        virtual std::unique_ptr<IEnumerator<DocId>>
+            Execute(TermMatchNode const & query) = 0;
+
+        // Returns the DocIds of k documents matching query with the highest
+        // StaticRanks, best first. Ties between equal StaticRanks are broken
+        // arbitrarily. Each Shard visits its Slices in decreasing order of
+        // their StaticRank bounds and stops once k matches at least as good
+        // as the next bound have been found, so broad queries scan only a
+        // fraction of the index. Documents in Shards without a static rank
+        // blob have StaticRank 0. Blocks until every Shard has finished.
+        virtual std::vector<DocId>
+            FindTopMatches(TermMatchNode const & query, size_t k) = 0;
+
+        // Measures the density of every row in the index. Queries executed
+        // afterwards intersect the sparsest rows of each rank first. Queries
+        // that are already running keep the densities they started with.
+        virtual void UpdateRowDensities() = 0;
+
+        // Discards the compiled plans of previous queries. Must be called
+        // after a Shard's TermTable has been replaced. Queries that are
+        // already running keep the plans they started with.
+        virtual void InvalidatePlans() = 0;
+
+        // Return the number of Slices matched and of row quadwords read by
+        // the queries executed so far. Slices whose matches come from a cache
+        // are not counted. These show how much of the index queries scan.
+        virtual uint64_t GetSlicesMatched() const = 0;
+        virtual uint64_t GetQuadwordsRead() const = 0;
+    };
+}
@@ -0,0 +1,129 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stddef.h>                         // size_t parameter.
+#include <stdint.h>                         // uint8_t member.
+#include <vector>                           // std::vector member.
+
+#include "BitFunnel/ITermTreatment.h"       // RowConfiguration::Entry::c_maxRowCount.
+#include "BitFunnel/NonCopyable.h"          // Inherits from NonCopyable.
+#include "BitFunnel/RowId.h"                // RowId member.
+#include "BitFunnel/Term.h"                 // Term::Hash member.
+
+
+namespace BitFunnel
+{
+    class ITermTable2;
+
+    //*************************************************************************
+    //
+    // ResolvedTermCache
+    //
+    // Caches the RowIds of recently seen terms so that hot loops, like
+    // adding postings during ingestion or looking up rows while planning a
+    // query, don't have to go through the ITermTable2 and RowIdSequence for
+    // every occurrence of a term. This matters most for adhoc terms, whose
+    // RowIds are recomputed from the term's hash on each enumeration.
+    //
+    // The cache is a direct mapped array of 64 byte entries, each holding a
+    // term's key and up to c_inlineRowCount RowIds. When two terms map to the
+    // same entry, the newer one replaces the older one. Terms with more rows
+    // than fit in an entry are resolved on every call.
+    //
+    // ResolvedTermCache is not thread safe. Each thread should use its own.
+    //
+    //*************************************************************************
+    class ResolvedTermCache : public NonCopyable
+    {
+    public:
+        // A view of a term's RowIds.
+        class Rows
+        {
+        public:
+            Rows(RowId const * begin, RowId const * end)
+              : m_begin(begin),
+                m_end(end)
+            {
+            }
+
+            RowId const * begin() const
+            {
+                return m_begin;
+            }
+
+            RowId const * end() const
+            {
+                return m_end;
+            }
+
+            size_t size() const
+            {
+                return static_cast<size_t>(m_end - m_begin);
+            }
+
+        private:
+            RowId const * m_begin;
+            RowId const * m_end;
+        };
+
+        // The default cache holds 16K terms in 1MB.
+        static const size_t c_defaultLog2Capacity = 14;
+
+        // The ITermTable2 must be sealed and must outlive the cache.
+        ResolvedTermCache(ITermTable2 const & termTable,
+                          size_t log2Capacity = c_defaultLog2Capacity);
+
+        // Returns term's RowIds, resolving them from the ITermTable2 if the
+        // term is not in the cache. The returned Rows are valid until the
+        // next call to GetRows().
+        Rows GetRows(Term const & term);
+
+    private:
+        static const size_t c_inlineRowCount = 13;
+
+        struct Entry
+        {
+            Term::Hash m_hash;
+            Term::IdfX10 m_idf;
+            Term::GramSize m_gramSize;
+            uint8_t m_rowCount;
+            uint8_t m_valid;
+            RowId m_rows[c_inlineRowCount];
+        };
+
+        static_assert(sizeof(Entry) == 64,
+                      "ResolvedTermCache: Entry should fill one cache line.");
+
+        ITermTable2 const & m_termTable;
+
+        // The high order bits of the mixed hash select the entry.
+        const unsigned m_shift;
+
+        std::vector<Entry> m_entries;
+
+        // Holds the RowIds of a term with more than c_inlineRowCount rows.
+        RowId m_overflow[RowConfiguration::Entry::c_maxRowCount];
+    };
+}
@@ -31,6 +31,7 @@
 
 namespace BitFunnel
 {
+    class BitSlicedField;
     class IAllocator;
     class IObjectFormatter;
     class IObjectParser;
@@ -297,6 +298,18 @@ namespace BitFunnel
         CreateFactNode(FactHandle fact,
                        IAllocator& allocator);
 
+        // Returns a tree of Fact nodes over the bit rows of field that
+        // matches documents whose value lies in [low, high]. The bounds are
+        // inclusive and high is clamped to field.GetMaxValue(). A range that
+        // covers every value becomes the tautology (b OR NOT b) and an empty
+        // range the contradiction (b AND NOT b), which MatchTreeSimplifier
+        // folds away.
+        static TermMatchNode const *
+        CreateRangeNode(BitSlicedField const & field,
+                        uint64_t low,
+                        uint64_t high,
+                        IAllocator& allocator);
+
     private:
         IAllocator& m_allocator;
         TermMatchNode::NodeType m_targetType;
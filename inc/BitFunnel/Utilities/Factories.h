@@ -44,9 +44,21 @@ namespace BitFunnel
                 std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
                 size_t taskCount);
 
+        // Creates an ITaskDistributor that hands out the largest tasks first
+        // and balances the remaining tasks between threads by work stealing.
+        // taskSizes[i] is the estimated size of task i.
+        std::unique_ptr<ITaskDistributor>
+            CreateTaskDistributor(
+                std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
+                std::vector<size_t> const & taskSizes);
+
         std::unique_ptr<IThreadManager> CreateThreadManager(
             const std::vector<IThreadBase*>& threads);
 
         std::unique_ptr<ITokenManager> CreateTokenManager();
+
+        // Creates an epoch-based ITokenManager with slotCount per-thread
+        // epoch slots. See EpochManager for details.
+        std::unique_ptr<ITokenManager> CreateEpochManager(size_t slotCount);
     }
 }
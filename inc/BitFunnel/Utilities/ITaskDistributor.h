@@ -38,10 +38,10 @@ namespace BitFunnel
     // that derive from ITaskProcessor.
     //
     // One thread is started for each ITaskProcessor. The ITaskProcessors are
-    // assigned task ids via ITaskProcessor::ProcessTask(). Task ids are handed
-    // out starting from 0 and increasing until all ITaskProcessors are busy.
-    // Each time a thread returns from ProcessTask(), a new task id will be
-    // assigned until all tasks have been processed.
+    // assigned task ids via ITaskProcessor::ProcessTask(). Each time a thread
+    // returns from ProcessTask(), a new task id will be assigned until all
+    // tasks have been processed. Implementations may hand out task ids in any
+    // order, e.g. largest task first.
     //
     // Task coordinator only knows about task ids. The interpretation of the
     // work associated with a particular task id is up to the ITaskProcessor.
@@ -0,0 +1,71 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stddef.h>                 // size_t return value.
+#include <string>                   // std::string parameter.
+
+#include "BitFunnel/NonCopyable.h"  // Inherits from NonCopyable.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // MemoryMappedFile
+    //
+    // Maps the entire contents of a file into memory for reading. Pages are
+    // loaded by the operating system on first access, so opening even a very
+    // large file is fast, and the pages are shared with any other process
+    // that maps the same file.
+    //
+    // The mapping is read-only and remains valid for the lifetime of the
+    // MemoryMappedFile. The data is at least page aligned.
+    //
+    //*************************************************************************
+    class MemoryMappedFile : public NonCopyable
+    {
+    public:
+        // Throws RecoverableError if the file cannot be opened or mapped.
+        MemoryMappedFile(std::string const & fileName);
+
+        ~MemoryMappedFile();
+
+        // Returns a pointer to the first byte of the file, or nullptr if the
+        // file is empty.
+        char const * GetData() const;
+
+        // Returns the size of the file in bytes.
+        size_t GetSize() const;
+
+    private:
+        char const * m_data;
+        size_t m_size;
+
+#ifdef BITFUNNEL_PLATFORM_WINDOWS
+        void* m_file;
+        void* m_mapping;
+#endif
+    };
+}
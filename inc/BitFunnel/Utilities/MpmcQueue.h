@@ -0,0 +1,428 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable> // for std::condition_variable
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "BitFunnel/NonCopyable.h"
+#include "LoggerInterfaces/Logging.h"
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // MpmcQueue<T> is a bounded, multi-producer, multi-consumer queue with
+    // the same TryEnqueue()/TryDequeue()/Shutdown() contract as
+    // BlockingQueue<T>. It can be used in place of BlockingQueue<T> where
+    // the queue is on a hot path.
+    //
+    // Items are stored in a ring of cells, each with a sequence number that
+    // tells producers and consumers whether the cell is ready for them
+    // (Dmitry Vyukov's bounded MPMC queue). Enqueue and dequeue claim a cell
+    // with a single compare-exchange and take no locks.
+    //
+    // Callers that find the queue full (or empty) spin briefly and then park
+    // on a condition variable. The mutex behind the condition variable is
+    // only taken when some thread is actually parked, so a queue that never
+    // runs full or empty never makes a system call.
+    //
+    // The capacity is rounded up to a power of two, with a minimum of two.
+    // T must be default constructible and move assignable.
+    //
+    //*************************************************************************
+    template <typename T>
+    class MpmcQueue : public NonCopyable
+    {
+    public:
+        // Construct an MpmcQueue with (at least) the specified capacity.
+        MpmcQueue(unsigned capacity);
+
+        ~MpmcQueue();
+
+        // Block until all items are dequeued.
+        void Shutdown();
+
+        // Blocks the caller while the queue is full. Returns true if the item
+        // was successfully enqueued. Returns false if the queue is shutting
+        // down.
+        bool TryEnqueue(T value);
+
+        // Blocks the caller until a value is available or the queue is
+        // shutdown. Returns true if an item was successfully dequeued. Returns
+        // false if queue was shut down and is empty.
+        bool TryDequeue(T& value);
+
+    private:
+        // Non-blocking enqueue and dequeue. Return false if the queue was
+        // full or empty, respectively.
+        bool TryPush(T& value);
+        bool TryPop(T& value);
+
+        // Returns true once Shutdown() has been called and every enqueue that
+        // started before it has completed.
+        bool IsClosed() const;
+
+        static size_t RoundUpToPowerOfTwo(unsigned capacity);
+
+        //*********************************************************************
+        //
+        // WaitSet implements the spin-then-park wait used when the queue is
+        // full or empty.
+        //
+        //*********************************************************************
+        class WaitSet : public NonCopyable
+        {
+        public:
+            WaitSet();
+
+            // Returns when attempt() returns true. The attempt is retried
+            // while spinning and again whenever the thread is woken.
+            template <typename ATTEMPT>
+            void WaitUntil(ATTEMPT attempt);
+
+            // Wakes threads parked in WaitUntil(). Cheap when none are parked.
+            void NotifyOne();
+            void NotifyAll();
+
+        private:
+            static const unsigned c_spinCount = 64;
+            static const unsigned c_yieldCount = 16;
+
+            std::atomic<unsigned> m_parkedCount;
+            std::mutex m_lock;
+            std::condition_variable m_condition;
+        };
+
+        struct Cell
+        {
+            std::atomic<size_t> m_sequence;
+            T m_value;
+        };
+
+        // Producer and consumer positions are kept on separate cache lines
+        // since they are written by different sets of threads.
+        static const size_t c_cacheLineSize = 64;
+
+        const size_t m_mask;
+        std::unique_ptr<Cell[]> m_cells;
+
+        char m_padding0[c_cacheLineSize];
+        std::atomic<size_t> m_enqueuePosition;
+        char m_padding1[c_cacheLineSize - sizeof(std::atomic<size_t>)];
+        std::atomic<size_t> m_dequeuePosition;
+        char m_padding2[c_cacheLineSize - sizeof(std::atomic<size_t>)];
+
+        // Number of TryEnqueue() calls that have passed the shutdown check but
+        // not yet published their item. Consumers must not report the queue
+        // as finished until this drops to zero.
+        std::atomic<unsigned> m_enqueuesInFlight;
+        std::atomic<bool> m_shutdown;
+
+        WaitSet m_notFull;
+        WaitSet m_notEmpty;
+    };
+
+
+    //*************************************************************************
+    //
+    // Implementation of MpmcQueue<T>
+    //
+    //*************************************************************************
+    template <typename T>
+    MpmcQueue<T>::MpmcQueue(unsigned capacity)
+        : m_mask(RoundUpToPowerOfTwo(capacity) - 1),
+          m_cells(new Cell[m_mask + 1]),
+          m_enqueuePosition(0),
+          m_dequeuePosition(0),
+          m_enqueuesInFlight(0),
+          m_shutdown(false)
+    {
+        for (size_t i = 0; i <= m_mask; ++i)
+        {
+            m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+
+    template <typename T>
+    MpmcQueue<T>::~MpmcQueue()
+    {
+        LogAssertB(m_shutdown, "Queue destructed without calling shutdown.")
+        LogAssertB(m_enqueuePosition == m_dequeuePosition,
+                   "Queue destructed without finishing shutdown.")
+    }
+
+
+    template <typename T>
+    void MpmcQueue<T>::Shutdown()
+    {
+        m_shutdown = true;
+        m_notEmpty.NotifyAll();
+        m_notFull.NotifyAll();
+
+        // Consumers notify m_notFull after every dequeue, so wait there for
+        // the queue to drain.
+        m_notFull.WaitUntil([this]()
+        {
+            return IsClosed() && m_enqueuePosition == m_dequeuePosition;
+        });
+    }
+
+
+    template <typename T>
+    bool MpmcQueue<T>::TryEnqueue(T value)
+    {
+        ++m_enqueuesInFlight;
+
+        bool success = false;
+        m_notFull.WaitUntil([this, &value, &success]()
+        {
+            if (m_shutdown)
+            {
+                return true;
+            }
+            success = TryPush(value);
+            return success;
+        });
+
+        --m_enqueuesInFlight;
+
+        if (m_shutdown)
+        {
+            // Consumers and Shutdown() may be waiting for the last enqueue in
+            // flight to finish.
+            m_notEmpty.NotifyAll();
+            m_notFull.NotifyAll();
+        }
+        else if (success)
+        {
+            m_notEmpty.NotifyOne();
+        }
+
+        return success;
+    }
+
+
+    template <typename T>
+    bool MpmcQueue<T>::TryDequeue(T& value)
+    {
+        bool success = false;
+        m_notEmpty.WaitUntil([this, &value, &success]()
+        {
+            success = TryPop(value);
+            if (!success && IsClosed())
+            {
+                // An enqueue may have published its item just before
+                // leaving, so look once more before giving up.
+                success = TryPop(value);
+                return true;
+            }
+            return success;
+        });
+
+        if (success || m_shutdown)
+        {
+            // Shutdown() waits on m_notFull for the queue to drain.
+            m_notFull.NotifyAll();
+        }
+        else
+        {
+            m_notFull.NotifyOne();
+        }
+
+        return success;
+    }
+
+
+    template <typename T>
+    bool MpmcQueue<T>::TryPush(T& value)
+    {
+        Cell* cell;
+        size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &m_cells[position & m_mask];
+            const size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+            const int64_t difference =
+                static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+            if (difference == 0)
+            {
+                // The cell is free. Try to claim it.
+                if (m_enqueuePosition.compare_exchange_weak(position,
+                                                            position + 1,
+                                                            std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The cell still holds an item from the previous lap.
+                return false;
+            }
+            else
+            {
+                // Another producer claimed the cell.
+                position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->m_value = std::move(value);
+        cell->m_sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+
+    template <typename T>
+    bool MpmcQueue<T>::TryPop(T& value)
+    {
+        Cell* cell;
+        size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &m_cells[position & m_mask];
+            const size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+            const int64_t difference =
+                static_cast<int64_t>(sequence) - static_cast<int64_t>(position + 1);
+
+            if (difference == 0)
+            {
+                // The cell holds an item. Try to claim it.
+                if (m_dequeuePosition.compare_exchange_weak(position,
+                                                            position + 1,
+                                                            std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The cell has not been filled yet.
+                return false;
+            }
+            else
+            {
+                // Another consumer claimed the cell.
+                position = m_dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->m_value);
+        cell->m_sequence.store(position + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+
+    template <typename T>
+    bool MpmcQueue<T>::IsClosed() const
+    {
+        return m_shutdown && m_enqueuesInFlight == 0;
+    }
+
+
+    template <typename T>
+    size_t MpmcQueue<T>::RoundUpToPowerOfTwo(unsigned capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+
+    //*************************************************************************
+    //
+    // Implementation of MpmcQueue<T>::WaitSet
+    //
+    //*************************************************************************
+    template <typename T>
+    MpmcQueue<T>::WaitSet::WaitSet()
+        : m_parkedCount(0)
+    {
+    }
+
+
+    template <typename T>
+    template <typename ATTEMPT>
+    void MpmcQueue<T>::WaitSet::WaitUntil(ATTEMPT attempt)
+    {
+        for (unsigned i = 0; i < c_spinCount; ++i)
+        {
+            if (attempt())
+            {
+                return;
+            }
+            if (i >= c_spinCount - c_yieldCount)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // DESIGN NOTE: the parked count is incremented before the final
+        // attempt, and notifiers check the count after changing the queue.
+        // Both are sequentially consistent, so either the attempt sees the
+        // change or the notifier sees the parked thread. In the latter case
+        // the notifier takes m_lock, which cannot happen between the attempt
+        // and the wait below.
+        std::unique_lock<std::mutex> lock(m_lock);
+        ++m_parkedCount;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!attempt())
+        {
+            m_condition.wait(lock);
+        }
+        --m_parkedCount;
+    }
+
+
+    template <typename T>
+    void MpmcQueue<T>::WaitSet::NotifyOne()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_parkedCount > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_condition.notify_one();
+        }
+    }
+
+
+    template <typename T>
+    void MpmcQueue<T>::WaitSet::NotifyAll()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_parkedCount > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_condition.notify_all();
+        }
+    }
+}
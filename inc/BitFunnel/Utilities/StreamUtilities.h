@@ -62,6 +62,10 @@ namespace BitFunnel
         template <typename T>
         void ReadArray(IInputStream& stream, T* buffer, size_t itemCount);
 
+        // Read an std::vector<T> from stream.
+        template <typename T>
+        std::vector<T> ReadVector(IInputStream& stream);
+
         //
         // Wrapper methods for reading from an std::istream.
         //
@@ -166,6 +170,16 @@ namespace BitFunnel
     }
 
 
+    template <typename T>
+    std::vector<T> StreamUtilities::ReadVector(IInputStream& stream)
+    {
+        size_t count = ReadField<size_t>(stream);
+        std::vector<T> vector(count);
+        ReadArray(stream, vector.data(), count);
+        return vector;
+    }
+
+
     //
     // Implementations of templated wrapper methods for reading from an std::istream.
     //
@@ -193,10 +207,9 @@ namespace BitFunnel
     template <typename T>
     std::vector<T> StreamUtilities::ReadVector(std::istream& stream)
     {
-        size_t count = ReadField<size_t>(stream);
-        std::vector<T> vector(count);
-        ReadArray(stream, vector.data(), count);
-        return vector;
+        StandardInputStream stdStream(stream);
+
+        return ReadVector<T>(stdStream);
     }
 
 
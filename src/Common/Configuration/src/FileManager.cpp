@@ -52,6 +52,7 @@ namespace BitFunnel
           m_documentLengthHistogram(new ParameterizedFile0(intermediateDirectory,
                                                            "DocumentLengthHistogram",".csv" )),
           m_indexedIdfTable(new ParameterizedFile1(indexDirectory, "IndexedIdfTable", ".bin")),
+          m_shardDefinition(new ParameterizedFile0(indexDirectory, "ShardDefinition", ".csv")),
           m_termTable(new ParameterizedFile1(indexDirectory, "TermTable", ".bin")),
           m_termToText(new ParameterizedFile0(indexDirectory, "TermToText", ".bin"))
         //m_docTable(new ParameterizedFile1(indexDirectory, "DocTable", ".bin")),
@@ -70,6 +71,12 @@ namespace BitFunnel
     }
 
 
+    FileDescriptor0 FileManager::ShardDefinition()
+    {
+        return FileDescriptor0(*m_shardDefinition);
+    }
+
+
     FileDescriptor0 FileManager::TermToText()
     {
         return FileDescriptor0(*m_termToText);
@@ -51,7 +51,7 @@ namespace BitFunnel
         //virtual FileDescriptor0 Model() override;
         //virtual FileDescriptor0 PlanDescriptors() override;
         //virtual FileDescriptor0 PostingCounts() override;
-        //virtual FileDescriptor0 ShardDefinition() override;
+        virtual FileDescriptor0 ShardDefinition() override;
         //virtual FileDescriptor0 ShardDocCounts() override;
         //virtual FileDescriptor0 ShardedDocFreqTable() override;
         //virtual FileDescriptor0 SortRankerConfig() override;
@@ -79,6 +79,7 @@ namespace BitFunnel
         std::unique_ptr<IParameterizedFile1> m_docFreqTable;
         std::unique_ptr<IParameterizedFile0> m_documentLengthHistogram;
         std::unique_ptr<IParameterizedFile1> m_indexedIdfTable;
+        std::unique_ptr<IParameterizedFile0> m_shardDefinition;
         std::unique_ptr<IParameterizedFile1> m_termTable;
         std::unique_ptr<IParameterizedFile0> m_termToText;
     };
@@ -24,7 +24,7 @@
 #include <ostream>
 
 #include "BitFunnel/Configuration/Factories.h"
-#include "BitFunnel/Exceptions.h"
+#include "CsvTsv/Csv.h"
 #include "ShardDefinition.h"
 
 
@@ -47,14 +47,48 @@ namespace BitFunnel
     }
 
 
-    ShardDefinition::ShardDefinition(std::istream& /*input*/)
+    ShardDefinition::ShardDefinition(std::istream& input)
     {
+        CsvTsv::CsvTableParser parser(input);
+        CsvTsv::TableReader reader(parser);
+
+        CsvTsv::InputColumn<uint64_t> maxPostingCount(
+            "MaxPostings",
+            "Maximum number of postings in a document in the shard.");
+
+        reader.DefineColumn(maxPostingCount);
+        reader.ReadPrologue();
+
+        while (!reader.AtEOF())
+        {
+            reader.ReadDataRow();
+            AddShard(static_cast<size_t>(maxPostingCount));
+        }
+
+        reader.ReadEpilogue();
     }
 
 
-    void ShardDefinition::Write(std::ostream& /*output*/) const
+    void ShardDefinition::Write(std::ostream& output) const
     {
-        throw NotImplemented();
+        CsvTsv::CsvTableFormatter formatter(output);
+        CsvTsv::TableWriter writer(formatter);
+
+        CsvTsv::OutputColumn<uint64_t> maxPostingCount(
+            "MaxPostings",
+            "Maximum number of postings in a document in the shard.");
+
+        writer.DefineColumn(maxPostingCount);
+        writer.WritePrologue();
+
+        // The last shard is unbounded, so it has no entry.
+        for (auto count : m_maxPostingCounts)
+        {
+            maxPostingCount = count;
+            writer.WriteDataRow();
+        }
+
+        writer.WriteEpilogue();
     }
 
 
@@ -75,30 +75,31 @@ namespace BitFunnel
         }
 
 
-        // TEST(ShardDefinition, RoundTrip)
-        // {
-        //     ShardDefinition s1;
-        //     s1.AddShard(500);
-        //     s1.AddShard(400);
-        //     s1.AddShard(600);
-        //     s1.AddShard(450);
-
-        //     std::stringstream stream;
-        //     s1.Write(stream);
-
-        //     // Ensure the test fails if s1 isn't loaded correctly.
-        //     // Perhaps one really wants to ensure that characters were written to stream.
-        //     // Want to guard against writing nothing and the passing the test when nothing is read.
-        //     EXPECT_EQ(s1.GetShardCount(), 5u);
-
-
-        //     ShardDefinition s2(stream);
-
-        //     EXPECT_EQ(s1.GetShardCount(), s2.GetShardCount());
-        //     for (ShardId i = 0; i < s1.GetShardCount(); ++i)
-        //     {
-        //         EXPECT_EQ(s1.GetMaxPostingCount(i), s2.GetMaxPostingCount(i));
-        //     }
-        // }
+        TEST(ShardDefinition, RoundTrip)
+        {
+            ShardDefinition s1;
+            s1.AddShard(500);
+            s1.AddShard(400);
+            s1.AddShard(600);
+            s1.AddShard(450);
+
+            std::stringstream stream;
+            s1.Write(stream);
+
+            // Ensure the test fails if s1 isn't loaded correctly.
+            // Perhaps one really wants to ensure that characters were written to stream.
+            // Want to guard against writing nothing and the passing the test when nothing is read.
+            EXPECT_EQ(s1.GetShardCount(), 5u);
+
+
+            ShardDefinition s2(stream);
+
+            // The last shard is unbounded and has no max posting count.
+            EXPECT_EQ(s1.GetShardCount(), s2.GetShardCount());
+            for (ShardId i = 0; i < s1.GetShardCount() - 1; ++i)
+            {
+                EXPECT_EQ(s1.GetMaxPostingCount(i), s2.GetMaxPostingCount(i));
+            }
+        }
     }
 }
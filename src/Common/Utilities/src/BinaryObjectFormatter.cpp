@@ -0,0 +1,173 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <cstring>                          // strlen().
+
+#include "BinaryObjectFormatter.h"
+#include "BitFunnel/IPersistableObject.h"
+
+
+namespace BitFunnel
+{
+    BinaryObjectFormatter::BinaryObjectFormatter(std::ostream& output,
+                                                 TypenameConverter typenameConverter)
+        : m_output(output),
+          m_typenameConverter(typenameConverter)
+    {
+    }
+
+
+    void BinaryObjectFormatter::OpenObject(const IPersistableObject& object)
+    {
+        WriteTag(object.GetTypeName());
+    }
+
+
+    void BinaryObjectFormatter::OpenObjectField(const char* /*name*/)
+    {
+    }
+
+
+    void BinaryObjectFormatter::CloseObject()
+    {
+    }
+
+
+    void BinaryObjectFormatter::NullObject()
+    {
+        // The text format writes nothing for a null object, so the parser
+        // sees an empty type name.
+        WriteTag("");
+    }
+
+
+    void BinaryObjectFormatter::OpenList()
+    {
+    }
+
+
+    void BinaryObjectFormatter::OpenListItem()
+    {
+        m_output.put(c_itemMarker);
+    }
+
+
+    void BinaryObjectFormatter::CloseList()
+    {
+        m_output.put(c_endMarker);
+    }
+
+
+    void BinaryObjectFormatter::OpenPrimitive(const char* name)
+    {
+        WriteTag(name);
+    }
+
+
+    void BinaryObjectFormatter::OpenPrimitiveItem()
+    {
+        m_output.put(c_itemMarker);
+    }
+
+
+    void BinaryObjectFormatter::ClosePrimitive()
+    {
+        m_output.put(c_endMarker);
+    }
+
+
+    void BinaryObjectFormatter::Format(bool value)
+    {
+        m_output.put(value ? 1 : 0);
+    }
+
+
+    void BinaryObjectFormatter::Format(int value)
+    {
+        WriteSignedVarint(value);
+    }
+
+
+    void BinaryObjectFormatter::Format(unsigned value)
+    {
+        WriteVarint(value);
+    }
+
+
+    void BinaryObjectFormatter::Format(size_t value)
+    {
+        WriteVarint(value);
+    }
+
+
+    void BinaryObjectFormatter::Format(double value)
+    {
+        m_output.write(reinterpret_cast<char const *>(&value), sizeof(value));
+    }
+
+
+    void BinaryObjectFormatter::Format(const char* value)
+    {
+        WriteString(value);
+    }
+
+
+    void BinaryObjectFormatter::FormatStringLiteral(const char* value)
+    {
+        WriteString(value);
+    }
+
+
+    void BinaryObjectFormatter::WriteTag(char const * name)
+    {
+        WriteSignedVarint(m_typenameConverter(name));
+    }
+
+
+    void BinaryObjectFormatter::WriteVarint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            m_output.put(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        m_output.put(static_cast<char>(value));
+    }
+
+
+    void BinaryObjectFormatter::WriteSignedVarint(int64_t value)
+    {
+        // Zigzag encoding keeps small negative values small.
+        WriteVarint((static_cast<uint64_t>(value) << 1) ^
+                    static_cast<uint64_t>(value >> 63));
+    }
+
+
+    void BinaryObjectFormatter::WriteString(char const * value)
+    {
+        const size_t length = strlen(value);
+        WriteVarint(length);
+        m_output.write(value, length + 1);
+    }
+}
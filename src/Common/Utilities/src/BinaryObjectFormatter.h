@@ -0,0 +1,103 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <ostream>                          // std::ostream member.
+#include <stdint.h>                         // uint64_t parameter.
+
+#include "BitFunnel/IObjectFormatter.h"     // Base class.
+#include "BitFunnel/NonCopyable.h"          // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // BinaryObjectFormatter
+    //
+    // Writes IPersistableObjects in a compact binary form that can be read by
+    // BinaryObjectParser without tokenizing or copying strings. Type names
+    // are written as the tags returned by the TypenameConverter, which must
+    // be the same one the parser uses. Field names are not written, since
+    // fields are always parsed in the order they are formatted.
+    //
+    // Encoding:
+    //   type tag        zigzag varint.
+    //   list item       0x01 before each item, 0x00 after the last item.
+    //   primitive item  0x01 before each item, 0x00 after the last item.
+    //   bool            one byte.
+    //   int             zigzag varint.
+    //   unsigned        varint.
+    //   double          eight bytes, in host byte order.
+    //   string          varint length, the characters and a terminating
+    //                   zero, so the parser can return a pointer into its
+    //                   input.
+    //
+    //*************************************************************************
+    class BinaryObjectFormatter : public IObjectFormatter, NonCopyable
+    {
+    public:
+        typedef int (*TypenameConverter)(const char* name);
+
+        BinaryObjectFormatter(std::ostream& output,
+                              TypenameConverter typenameConverter);
+
+        void OpenObject(const IPersistableObject& object);
+        void OpenObjectField(char const * name);
+        void CloseObject();
+
+        void NullObject();
+
+        void OpenList();
+        void OpenListItem();
+        void CloseList();
+
+        void OpenPrimitive(char const * name);
+        void OpenPrimitiveItem();
+        void ClosePrimitive();
+
+        void Format(bool value);
+        void Format(int value);
+        void Format(unsigned value);
+        void Format(size_t value);
+        void Format(double value);
+        void Format(char const * value);
+        void FormatStringLiteral(char const * value);
+
+        // Markers written before each list or primitive item and after the
+        // last one.
+        static const char c_itemMarker = 1;
+        static const char c_endMarker = 0;
+
+    private:
+        void WriteTag(char const * name);
+        void WriteVarint(uint64_t value);
+        void WriteSignedVarint(int64_t value);
+        void WriteString(char const * value);
+
+        std::ostream& m_output;
+        TypenameConverter m_typenameConverter;
+    };
+}
@@ -0,0 +1,239 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <cstring>                          // memcpy().
+#include <limits>                           // std::numeric_limits.
+
+#include "BinaryObjectFormatter.h"
+#include "BinaryObjectParser.h"
+#include "LoggerInterfaces/Logging.h"
+
+
+namespace BitFunnel
+{
+    BinaryObjectParser::BinaryObjectParser(char const * buffer,
+                                           size_t byteCount,
+                                           IAllocator& allocator,
+                                           TypenameConverter typenameConverter)
+        : m_allocator(allocator),
+          m_typenameConverter(typenameConverter),
+          m_buffer(buffer),
+          m_byteCount(byteCount),
+          m_position(0)
+    {
+    }
+
+
+    IAllocator& BinaryObjectParser::GetAllocator() const
+    {
+        return m_allocator;
+    }
+
+
+    int BinaryObjectParser::ReadTypeTag()
+    {
+        return static_cast<int>(ReadSignedVarint());
+    }
+
+
+    void BinaryObjectParser::OpenObject()
+    {
+    }
+
+
+    void BinaryObjectParser::OpenObjectField(const char* /*name*/)
+    {
+    }
+
+
+    void BinaryObjectParser::CloseObject()
+    {
+    }
+
+
+    void BinaryObjectParser::OpenList()
+    {
+    }
+
+
+    bool BinaryObjectParser::OpenListItem()
+    {
+        return TryReadItemMarker();
+    }
+
+
+    void BinaryObjectParser::CloseList()
+    {
+        LogAssertB(ReadByte() == BinaryObjectFormatter::c_endMarker,
+                   "Expected end of list");
+    }
+
+
+    void BinaryObjectParser::OpenPrimitive(const char* name)
+    {
+        // An empty name means the caller has already read the type tag
+        // with ReadTypeTag().
+        if (name[0] != '\0')
+        {
+            LogAssertB(ReadTypeTag() == m_typenameConverter(name),
+                       "Unexpected primitive");
+        }
+    }
+
+
+    bool BinaryObjectParser::OpenPrimitiveItem()
+    {
+        return TryReadItemMarker();
+    }
+
+
+    void BinaryObjectParser::ClosePrimitive()
+    {
+        LogAssertB(ReadByte() == BinaryObjectFormatter::c_endMarker,
+                   "Expected end of primitive");
+    }
+
+
+    bool BinaryObjectParser::ParseBool()
+    {
+        const char value = ReadByte();
+        LogAssertB(value == 0 || value == 1, "Unexpected input for ParseBool");
+        return value == 1;
+    }
+
+
+    unsigned BinaryObjectParser::ParseInt()
+    {
+        const int64_t value = ReadSignedVarint();
+        LogAssertB(value >= std::numeric_limits<int>::min() &&
+                   value <= std::numeric_limits<int>::max(),
+                   "Unexpected input for ParseInt");
+        return static_cast<unsigned>(static_cast<int>(value));
+    }
+
+
+    unsigned BinaryObjectParser::ParseUInt()
+    {
+        const uint64_t value = ReadVarint();
+        LogAssertB(value <= std::numeric_limits<unsigned>::max(),
+                   "Unexpected input for ParseUInt");
+        return static_cast<unsigned>(value);
+    }
+
+
+    uint64_t BinaryObjectParser::ParseUInt64()
+    {
+        return ReadVarint();
+    }
+
+
+    double BinaryObjectParser::ParseDouble()
+    {
+        double value;
+        LogAssertB(m_byteCount - m_position >= sizeof(value),
+                   "Unexpected end of input");
+        memcpy(&value, m_buffer + m_position, sizeof(value));
+        m_position += sizeof(value);
+        return value;
+    }
+
+
+    char const * BinaryObjectParser::ParseStringLiteral()
+    {
+        size_t length;
+        return ReadString(length);
+    }
+
+
+    void BinaryObjectParser::ParseToken(std::string& token)
+    {
+        size_t length;
+        char const * text = ReadString(length);
+        token.append(text, length);
+    }
+
+
+    size_t BinaryObjectParser::GetPosition() const
+    {
+        return m_position;
+    }
+
+
+    char BinaryObjectParser::ReadByte()
+    {
+        LogAssertB(m_position < m_byteCount, "Unexpected end of input");
+        return m_buffer[m_position++];
+    }
+
+
+    bool BinaryObjectParser::TryReadItemMarker()
+    {
+        LogAssertB(m_position < m_byteCount, "Unexpected end of input");
+        if (m_buffer[m_position] == BinaryObjectFormatter::c_itemMarker)
+        {
+            ++m_position;
+            return true;
+        }
+
+        LogAssertB(m_buffer[m_position] == BinaryObjectFormatter::c_endMarker,
+                   "Expected item or end marker");
+        return false;
+    }
+
+
+    uint64_t BinaryObjectParser::ReadVarint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; ; shift += 7)
+        {
+            LogAssertB(shift < 64, "Varint too long");
+            const uint8_t byte = static_cast<uint8_t>(ReadByte());
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+    }
+
+
+    int64_t BinaryObjectParser::ReadSignedVarint()
+    {
+        const uint64_t value = ReadVarint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+
+    char const * BinaryObjectParser::ReadString(size_t& length)
+    {
+        length = static_cast<size_t>(ReadVarint());
+        LogAssertB(length < m_byteCount - m_position &&
+                   m_buffer[m_position + length] == '\0',
+                   "Malformed string");
+
+        char const * text = m_buffer + m_position;
+        m_position += length + 1;
+        return text;
+    }
+}
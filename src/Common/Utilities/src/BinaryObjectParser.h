@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <stddef.h>                         // size_t parameter.
+#include <stdint.h>                         // uint64_t return value.
+
+#include "BitFunnel/IObjectParser.h"        // Base class.
+#include "BitFunnel/NonCopyable.h"          // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // BinaryObjectParser
+    //
+    // Parses IPersistableObjects written by BinaryObjectFormatter directly
+    // from a buffer. Objects are allocated from the IAllocator as with
+    // TextObjectParser, but strings are not copied: ParseStringLiteral()
+    // returns a pointer into the buffer, so the buffer must outlive the
+    // parsed objects.
+    //
+    // Malformed input, including reading past the end of the buffer, fails
+    // a LogAssert as in TextObjectParser.
+    //
+    //*************************************************************************
+    class BinaryObjectParser : public IObjectParser, NonCopyable
+    {
+    public:
+        typedef int (*TypenameConverter)(const char* name);
+
+        BinaryObjectParser(char const * buffer,
+                           size_t byteCount,
+                           IAllocator& allocator,
+                           TypenameConverter typenameConverter);
+
+        IAllocator& GetAllocator() const;
+
+        int ReadTypeTag();
+
+        void OpenObject();
+        void OpenObjectField(const char* name);
+        void CloseObject();
+
+        void OpenList();
+        bool OpenListItem();
+        void CloseList();
+
+        void OpenPrimitive(const char* name);
+        bool OpenPrimitiveItem();
+        void ClosePrimitive();
+
+        bool ParseBool();
+        unsigned ParseInt();
+        unsigned ParseUInt();
+        uint64_t ParseUInt64();
+        double ParseDouble();
+        char const * ParseStringLiteral();
+        void ParseToken(std::string& token);
+
+        // Returns the number of bytes consumed so far.
+        size_t GetPosition() const;
+
+    private:
+        char ReadByte();
+        bool TryReadItemMarker();
+        uint64_t ReadVarint();
+        int64_t ReadSignedVarint();
+        char const * ReadString(size_t& length);
+
+        IAllocator& m_allocator;
+        TypenameConverter m_typenameConverter;
+
+        char const * const m_buffer;
+        const size_t m_byteCount;
+        size_t m_position;
+    };
+}
@@ -46,7 +46,8 @@ namespace BitFunnel
     BlockAllocator::BlockAllocator(size_t blockSize, size_t totalBlockCount)
         : m_blockSize(RoundUp(blockSize, c_byteAlignment)),
           m_totalPoolSize(m_blockSize * totalBlockCount),
-          m_pool(m_totalPoolSize, c_log2ByteAlignment)
+          m_pool(m_totalPoolSize, c_log2ByteAlignment),
+          m_nextFree(new std::atomic<uint32_t>[totalBlockCount])
     {
         // DESIGN NOTE: technically, one can create an allocator with a size = 0
         // which would simply throw on the first allocation. This would allow
@@ -56,41 +57,53 @@ namespace BitFunnel
         // re-visit it in future if needed.
         LogAssertB(m_blockSize > 0, "m_blockSize of 0.");
         LogAssertB(totalBlockCount > 0, "totalBlockCount of 0.");
-
-        char * currentBlock = static_cast<char *>(m_pool.GetBuffer());
+        LogAssertB(totalBlockCount < c_nullIndex, "totalBlockCount too large.");
 
         for (size_t block = 0; block < totalBlockCount; ++block)
         {
-            char** nextBlockPtr = reinterpret_cast<char**>(currentBlock);
-            currentBlock += m_blockSize;
-
             if (block != totalBlockCount - 1)
             {
-                *nextBlockPtr = currentBlock;
+                m_nextFree[block] = static_cast<uint32_t>(block + 1);
             }
             else
             {
-                *nextBlockPtr = nullptr;
+                m_nextFree[block] = c_nullIndex;
             }
         }
 
-        m_freeListHead = static_cast<uint64_t*>(m_pool.GetBuffer());
+        m_freeListHead = PackHead(0, 0);
     }
 
 
     uint64_t * BlockAllocator::AllocateBlock()
     {
-        std::lock_guard<std::mutex> lock(m_lock);
+        uint64_t head = m_freeListHead.load(std::memory_order_acquire);
 
-        if (m_freeListHead == nullptr)
+        for (;;)
         {
-            throw FatalError("Out of memory");
-        }
-
-        uint64_t * block = m_freeListHead;
-        m_freeListHead = reinterpret_cast<uint64_t*>(*m_freeListHead);
+            const uint32_t index = GetIndex(head);
+            if (index == c_nullIndex)
+            {
+                throw FatalError("Out of memory");
+            }
 
-        return block;
+            // If another thread pops this block between the load of head and
+            // the compare_exchange below, the tag will have changed and the
+            // (possibly stale) value of next is discarded.
+            const uint32_t next =
+                m_nextFree[index].load(std::memory_order_relaxed);
+            const uint64_t newHead = PackHead(next, GetTag(head) + 1);
+
+            if (m_freeListHead.compare_exchange_weak(head,
+                                                     newHead,
+                                                     std::memory_order_acquire,
+                                                     std::memory_order_acquire))
+            {
+                char * block = static_cast<char *>(m_pool.GetBuffer()) +
+                    index * m_blockSize;
+                return reinterpret_cast<uint64_t*>(block);
+            }
+        }
     }
 
 
@@ -111,14 +124,24 @@ namespace BitFunnel
         LogAssertB(((blockReturned - bufferStart) % m_blockSize) == 0,
                    "Block offset (relative to begining of pool not a multiple of blockSize");
 
-        // Add the block to the head of the free list
-        uint64_t** blockPtr = reinterpret_cast<uint64_t**>(block);
-
-        std::lock_guard<std::mutex> lock(m_lock);
+        const uint32_t index =
+            static_cast<uint32_t>((blockReturned - bufferStart) / m_blockSize);
 
-        *blockPtr = m_freeListHead;
+        // Push the block onto the head of the free list.
+        uint64_t head = m_freeListHead.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            m_nextFree[index].store(GetIndex(head), std::memory_order_relaxed);
+            const uint64_t newHead = PackHead(index, GetTag(head) + 1);
 
-        m_freeListHead = block;
+            if (m_freeListHead.compare_exchange_weak(head,
+                                                     newHead,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
     }
 
 
@@ -126,4 +149,22 @@ namespace BitFunnel
     {
         return m_blockSize;
     }
+
+
+    uint64_t BlockAllocator::PackHead(uint32_t index, uint32_t tag)
+    {
+        return (static_cast<uint64_t>(tag) << 32) | index;
+    }
+
+
+    uint32_t BlockAllocator::GetIndex(uint64_t head)
+    {
+        return static_cast<uint32_t>(head);
+    }
+
+
+    uint32_t BlockAllocator::GetTag(uint64_t head)
+    {
+        return static_cast<uint32_t>(head >> 32);
+    }
 }
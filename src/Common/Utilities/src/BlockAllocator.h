@@ -24,7 +24,8 @@
 #pragma once
 
 
-#include <mutex>  // For std::mutex.
+#include <atomic>                       // std::atomic embedded.
+#include <memory>                       // std::unique_ptr embedded.
 
 #include "BitFunnel/Utilities/IBlockAllocator.h"
 #include "AlignedBuffer.h"
@@ -37,10 +38,14 @@ namespace BitFunnel
     // allocates the entire pool of the requested number of blocks at
     // construction and never releases it until destruction. Internally the
     // pool is aligned to c_byteAlignment. The list of available blocks is
-    // stored as a linked list where the pointer to the next item is stored in
-    // the beginning of the block itself. If this value is nullptr, this is the
-    // last block. m_freeListHead points to the first available block, or
-    // nullptr if there are no available blocks.
+    // maintained as a lock-free stack (Treiber stack) of block indices. The
+    // index of the next free block is stored in a side array, m_nextFree,
+    // rather than in the block itself, so that a thread racing with a pop
+    // never reads memory that has already been handed out to a caller.
+    // m_freeListHead packs the index of the first available block with a
+    // tag that is incremented on every successful update, which protects
+    // against the ABA problem when a block is popped and pushed back between
+    // another thread's load and compare-exchange of the head.
     // Requesting a block when there are none available results in an exception.
     //
     // DESIGN NOTE: The main usage of this allocator is for the RowTable rows
@@ -73,13 +78,23 @@ namespace BitFunnel
         const size_t m_blockSize;
         const size_t m_totalPoolSize;
 
-        // Lock protecting operations on the pool.
-        std::mutex m_lock;
+        // Sentinel block index which marks the end of the free list.
+        static const uint32_t c_nullIndex = 0xFFFFFFFF;
+
+        static uint64_t PackHead(uint32_t index, uint32_t tag);
+        static uint32_t GetIndex(uint64_t head);
+        static uint32_t GetTag(uint64_t head);
 
         // Underlying pool of memory blocks.
         AlignedBuffer m_pool;
 
-        // A pointer to the first available block.
-        uint64_t * m_freeListHead;
+        // For each free block, the index of the next free block or
+        // c_nullIndex if it is the last one. Entries for allocated blocks
+        // are meaningless.
+        std::unique_ptr<std::atomic<uint32_t>[]> m_nextFree;
+
+        // Index of the first available block in the low 32 bits and the ABA
+        // tag in the high 32 bits.
+        std::atomic<uint64_t> m_freeListHead;
     };
 }
@@ -0,0 +1,276 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <chrono>
+#include <thread>
+
+#include "BitFunnel/Utilities/Factories.h"
+#include "EpochManager.h"
+#include "LoggerInterfaces/Logging.h"
+
+namespace BitFunnel
+{
+    std::unique_ptr<ITokenManager> Factories::CreateEpochManager(size_t slotCount)
+    {
+        return std::unique_ptr<ITokenManager>(new EpochManager(slotCount));
+    }
+
+
+    //*************************************************************************
+    //
+    // EpochManager::Slots
+    //
+    // Each slot packs the number of tokens held through it into the high
+    // c_depthBits bits and the epoch of the oldest of those tokens into the
+    // remaining low bits. Slots are padded to the size of a cache line so
+    // that threads using different slots do not contend.
+    //
+    //*************************************************************************
+    class EpochManager::Slots : NonCopyable
+    {
+    public:
+        Slots(size_t slotCount)
+          : m_slotCount(slotCount),
+            m_slots(new Slot[slotCount])
+        {
+        }
+
+        size_t GetSlotCount() const
+        {
+            return m_slotCount;
+        }
+
+        std::atomic<uint64_t>& operator[](size_t slot)
+        {
+            return m_slots[slot].m_state;
+        }
+
+        // Returns true if no slot holds a token issued before cutoffEpoch.
+        bool IsClear(uint64_t cutoffEpoch) const
+        {
+            for (size_t i = 0; i < m_slotCount; ++i)
+            {
+                const uint64_t state = m_slots[i].m_state.load();
+                if (GetDepth(state) > 0 && GetEpoch(state) < cutoffEpoch)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static const unsigned c_depthBits = 16;
+        static const unsigned c_epochBits = 64 - c_depthBits;
+        static const uint64_t c_depthOne = 1ull << c_epochBits;
+        static const uint64_t c_maxDepth = (1ull << c_depthBits) - 1;
+        static const uint64_t c_epochMask = c_depthOne - 1;
+
+        static uint64_t Pack(uint64_t depth, uint64_t epoch)
+        {
+            return (depth << c_epochBits) | (epoch & c_epochMask);
+        }
+
+        static uint64_t GetDepth(uint64_t state)
+        {
+            return state >> c_epochBits;
+        }
+
+        static uint64_t GetEpoch(uint64_t state)
+        {
+            return state & c_epochMask;
+        }
+
+    private:
+        static const size_t c_cacheLineSize = 64;
+
+        struct Slot
+        {
+            Slot()
+              : m_state(0)
+            {
+            }
+
+            std::atomic<uint64_t> m_state;
+            char m_padding[c_cacheLineSize - sizeof(std::atomic<uint64_t>)];
+        };
+
+        const size_t m_slotCount;
+        std::unique_ptr<Slot[]> m_slots;
+    };
+
+
+    //*************************************************************************
+    //
+    // EpochTracker
+    //
+    // Tracks the tokens issued before the global epoch was advanced to
+    // m_cutoffEpoch. Completion is determined by scanning the slots, so the
+    // token release path never has to notify trackers.
+    //
+    //*************************************************************************
+    class EpochTracker : public ITokenTracker, NonCopyable
+    {
+    public:
+        EpochTracker(std::shared_ptr<EpochManager::Slots> const & slots,
+                     uint64_t cutoffEpoch)
+          : m_slots(slots),
+            m_cutoffEpoch(cutoffEpoch),
+            m_isComplete(false)
+        {
+        }
+
+        virtual bool IsComplete() const override
+        {
+            if (!m_isComplete)
+            {
+                if (m_slots->IsClear(m_cutoffEpoch))
+                {
+                    m_isComplete = true;
+                }
+            }
+            return m_isComplete;
+        }
+
+        virtual void WaitForCompletion() override
+        {
+            // Spin briefly since most tokens are short lived, then back off
+            // to sleeping so that a long running query does not burn a core.
+            static const unsigned c_spinCount = 1000;
+            for (unsigned i = 0; !IsComplete(); ++i)
+            {
+                if (i < c_spinCount)
+                {
+                    std::this_thread::yield();
+                }
+                else
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        }
+
+    private:
+        std::shared_ptr<EpochManager::Slots> m_slots;
+        const uint64_t m_cutoffEpoch;
+
+        // Cached once true, since completion is permanent.
+        mutable std::atomic<bool> m_isComplete;
+    };
+
+
+    // Returns a small integer unique to the calling thread. Threads are
+    // numbered densely in the order in which they first request a token so
+    // that, with enough slots, each thread gets a slot of its own.
+    static size_t GetThreadIndex()
+    {
+        static std::atomic<size_t> s_nextThreadIndex(0);
+        thread_local size_t t_threadIndex = s_nextThreadIndex++;
+        return t_threadIndex;
+    }
+
+
+    //*************************************************************************
+    //
+    // EpochManager
+    //
+    //*************************************************************************
+    EpochManager::EpochManager(size_t slotCount)
+        : m_epoch(0),
+          m_isShuttingDown(false),
+          m_slots(new Slots(slotCount))
+    {
+        LogAssertB(slotCount > 0, "slotCount of 0.");
+    }
+
+
+    EpochManager::~EpochManager()
+    {
+        Shutdown();
+    }
+
+
+    Token EpochManager::RequestToken()
+    {
+        LogAssertB(!m_isShuttingDown, "Requested Token while shutting down");
+
+        const size_t slot = GetThreadIndex() % m_slots->GetSlotCount();
+        std::atomic<uint64_t>& state = (*m_slots)[slot];
+
+        // The first token held through a slot publishes the current epoch.
+        // Later tokens keep the epoch already published, which is never
+        // newer than the current one. The pointer protected by the token is
+        // read after this compare-exchange. If a tracker's scan missed the
+        // slot, the scan happened before the exchange, so the reader will see
+        // whatever the tracker's owner swapped in before starting it.
+        uint64_t current = state.load();
+        for (;;)
+        {
+            const uint64_t depth = Slots::GetDepth(current);
+            LogAssertB(depth < Slots::c_maxDepth, "Too many tokens on one slot.");
+
+            const uint64_t epoch =
+                (depth == 0) ? m_epoch.load() : Slots::GetEpoch(current);
+
+            if (state.compare_exchange_weak(current,
+                                            Slots::Pack(depth + 1, epoch)))
+            {
+                break;
+            }
+        }
+
+        return Token(*this, static_cast<SerialNumber>(slot));
+    }
+
+
+    const std::shared_ptr<ITokenTracker> EpochManager::StartTracker()
+    {
+        const uint64_t cutoffEpoch = ++m_epoch;
+        return std::shared_ptr<ITokenTracker>(
+            new EpochTracker(m_slots, cutoffEpoch));
+    }
+
+
+    void EpochManager::Shutdown()
+    {
+        m_isShuttingDown = true;
+
+        // Wait for existing tokens to be returned. An epoch past every epoch
+        // issued so far covers all of them.
+        EpochTracker tracker(m_slots, m_epoch.load() + 1);
+        tracker.WaitForCompletion();
+    }
+
+
+    void EpochManager::OnTokenComplete(SerialNumber serialNumber)
+    {
+        LogAssertB(serialNumber >= 0 &&
+                   static_cast<size_t>(serialNumber) < m_slots->GetSlotCount(),
+                   "Token serial number is not a slot index.");
+
+        const uint64_t previous =
+            (*m_slots)[static_cast<size_t>(serialNumber)].fetch_sub(Slots::c_depthOne);
+
+        LogAssertB(Slots::GetDepth(previous) > 0,
+                   "Token completed on slot with no tokens in flight.");
+    }
+}
@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>                   // std::atomic member.
+#include <memory>                   // std::shared_ptr member.
+
+#include "BitFunnel/Token.h"        // Inherits from ITokenManager and ITokenListener.
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // EpochManager is an implementation of ITokenManager based on epoch-based
+    // reclamation. It can be used anywhere a TokenManager is used, e.g. by
+    // the Recycler and DeferredSliceListDelete, but RequestToken() and token
+    // release only touch a per-thread epoch slot instead of the shared
+    // counters, mutex and tracker list used by TokenManager.
+    //
+    // Each thread is mapped to one of a fixed number of slots. A slot records
+    // the number of tokens held through it and the global epoch observed when
+    // the first of those tokens was issued. StartTracker() advances the global
+    // epoch and returns a tracker which completes once no slot holds tokens
+    // from an earlier epoch.
+    //
+    // The Token's SerialNumber is the index of the slot that issued it, so a
+    // Token may be moved to and released on another thread. If more threads
+    // than slots request tokens, threads share slots. This is safe, but a
+    // shared slot keeps the oldest epoch of its holders until all of them
+    // have released their tokens, which can delay trackers. The slot count
+    // should be at least the number of threads requesting tokens.
+    //
+    // This class is thread-safe.
+    //
+    //*************************************************************************
+    class EpochManager : public ITokenManager,
+                         private ITokenListener
+    {
+    public:
+        EpochManager(size_t slotCount);
+
+        ~EpochManager();
+
+        //
+        // ITokenManager API.
+        //
+        virtual Token RequestToken() override;
+        virtual const std::shared_ptr<ITokenTracker> StartTracker() override;
+        virtual void Shutdown() override;
+
+        class Slots;
+
+    private:
+        //
+        // ITokenListener API.
+        //
+        virtual void OnTokenComplete(SerialNumber serialNumber) override;
+
+        // Global epoch. Advanced by each call to StartTracker().
+        std::atomic<uint64_t> m_epoch;
+
+        // Flag indicating that EpochManager is shutting down.
+        std::atomic<bool> m_isShuttingDown;
+
+        // The slots are shared with the trackers, which may outlive the
+        // EpochManager while they sit in the Recycler's queue.
+        std::shared_ptr<Slots> m_slots;
+    };
+}
@@ -0,0 +1,178 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <sstream>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/MemoryMappedFile.h"
+
+#ifdef BITFUNNEL_PLATFORM_WINDOWS
+#include <Windows.h>        // For CreateFileMapping/MapViewOfFile.
+#else
+#include <cerrno>
+#include <cstring>          // For std::strerror.
+#include <fcntl.h>          // For open.
+#include <sys/mman.h>       // For mmap/munmap.
+#include <sys/stat.h>       // For fstat.
+#include <unistd.h>         // For close.
+#endif
+
+
+namespace BitFunnel
+{
+    static void ThrowMappingError(std::string const & fileName,
+                                  char const * operation)
+    {
+        std::stringstream message;
+        message << "MemoryMappedFile: " << operation
+                << " failed for '" << fileName << "'";
+#ifndef BITFUNNEL_PLATFORM_WINDOWS
+        message << ": " << std::strerror(errno);
+#endif
+        throw RecoverableError(message.str());
+    }
+
+
+#ifdef BITFUNNEL_PLATFORM_WINDOWS
+    MemoryMappedFile::MemoryMappedFile(std::string const & fileName)
+      : m_data(nullptr),
+        m_size(0),
+        m_file(INVALID_HANDLE_VALUE),
+        m_mapping(nullptr)
+    {
+        m_file = CreateFileA(fileName.c_str(),
+                             GENERIC_READ,
+                             FILE_SHARE_READ,
+                             nullptr,
+                             OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL,
+                             nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            ThrowMappingError(fileName, "CreateFile()");
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size))
+        {
+            CloseHandle(m_file);
+            ThrowMappingError(fileName, "GetFileSizeEx()");
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        // Windows cannot map an empty file.
+        if (m_size > 0)
+        {
+            m_mapping = CreateFileMapping(m_file,
+                                          nullptr,
+                                          PAGE_READONLY,
+                                          0,
+                                          0,
+                                          nullptr);
+            if (m_mapping == nullptr)
+            {
+                CloseHandle(m_file);
+                ThrowMappingError(fileName, "CreateFileMapping()");
+            }
+
+            m_data = static_cast<char const *>(
+                MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (m_data == nullptr)
+            {
+                CloseHandle(m_mapping);
+                CloseHandle(m_file);
+                ThrowMappingError(fileName, "MapViewOfFile()");
+            }
+        }
+    }
+
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        if (m_data != nullptr)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr)
+        {
+            CloseHandle(m_mapping);
+        }
+        CloseHandle(m_file);
+    }
+#else
+    MemoryMappedFile::MemoryMappedFile(std::string const & fileName)
+      : m_data(nullptr),
+        m_size(0)
+    {
+        const int file = open(fileName.c_str(), O_RDONLY);
+        if (file == -1)
+        {
+            ThrowMappingError(fileName, "open()");
+        }
+
+        struct stat status;
+        if (fstat(file, &status) == -1)
+        {
+            close(file);
+            ThrowMappingError(fileName, "fstat()");
+        }
+        m_size = static_cast<size_t>(status.st_size);
+
+        // mmap() rejects zero length mappings.
+        if (m_size > 0)
+        {
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+            if (data == MAP_FAILED)
+            {
+                close(file);
+                ThrowMappingError(fileName, "mmap()");
+            }
+            m_data = static_cast<char const *>(data);
+        }
+
+        // The mapping holds its own reference to the file.
+        close(file);
+    }
+
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        if (m_data != nullptr)
+        {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+    }
+#endif
+
+
+    char const * MemoryMappedFile::GetData() const
+    {
+        return m_data;
+    }
+
+
+    size_t MemoryMappedFile::GetSize() const
+    {
+        return m_size;
+    }
+}
@@ -20,6 +20,8 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+
 #include "BitFunnel/Utilities/Factories.h"
 #include "BitFunnel/Utilities/ITaskProcessor.h"
 #include "TaskDistributor.h"
@@ -37,17 +39,27 @@ namespace BitFunnel
     }
 
 
+    std::unique_ptr<ITaskDistributor>
+    Factories::CreateTaskDistributor(std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
+                                     std::vector<size_t> const & taskSizes)
+    {
+        return std::unique_ptr<ITaskDistributor>(new TaskDistributor(processors, taskSizes));
+    }
+
+
     TaskDistributor::TaskDistributor(std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
                                      size_t taskCount)
-        : m_processors(processors),
-          m_taskCount(taskCount),
-          m_nextTaskId(0)
+        : m_processors(processors)
     {
-        for (size_t i = 0 ; i < m_processors.size(); ++i)
-        {
-            m_threads.push_back(new TaskDistributorThread(*this, *m_processors[i]));
-        }
-        m_threadManager = new ThreadManager(m_threads);
+        Initialize(std::vector<size_t>(taskCount, 1));
+    }
+
+
+    TaskDistributor::TaskDistributor(std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
+                                     std::vector<size_t> const & taskSizes)
+        : m_processors(processors)
+    {
+        Initialize(taskSizes);
     }
 
 
@@ -61,24 +73,154 @@ namespace BitFunnel
     }
 
 
+    void TaskDistributor::Initialize(std::vector<size_t> const & taskSizes)
+    {
+        m_taskSizes = taskSizes;
+
+        const size_t queueCount = (std::max)(m_processors.size(), static_cast<size_t>(1));
+        for (size_t i = 0; i < queueCount; ++i)
+        {
+            m_queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+        }
+
+        // Largest tasks first. Ties keep task id order.
+        std::vector<size_t> taskIds(m_taskSizes.size());
+        for (size_t i = 0; i < taskIds.size(); ++i)
+        {
+            taskIds[i] = i;
+        }
+        std::stable_sort(taskIds.begin(),
+                         taskIds.end(),
+                         [this](size_t a, size_t b)
+                         {
+                             return m_taskSizes[a] > m_taskSizes[b];
+                         });
+
+        // Deal each task to the queue with the least work so far. Ties go to
+        // the lowest numbered queue, which makes equal sized tasks round-robin.
+        std::vector<size_t> assignedWork(queueCount, 0);
+        for (auto taskId : taskIds)
+        {
+            const size_t queue =
+                std::min_element(assignedWork.begin(), assignedWork.end()) -
+                assignedWork.begin();
+            m_queues[queue]->PushBack(taskId, m_taskSizes[taskId]);
+            assignedWork[queue] += m_taskSizes[taskId] + 1;
+        }
+
+        // Threads start running as soon as the ThreadManager is constructed,
+        // so the queues must be filled first.
+        for (size_t i = 0 ; i < m_processors.size(); ++i)
+        {
+            m_threads.push_back(new TaskDistributorThread(*this, *m_processors[i], i));
+        }
+        m_threadManager = new ThreadManager(m_threads);
+    }
+
+
     bool TaskDistributor::TryAllocateTask(size_t& taskId)
+    {
+        return TrySteal(taskId);
+    }
+
+
+    bool TaskDistributor::TryAllocateTask(size_t threadIndex, size_t& taskId)
+    {
+        return m_queues[threadIndex]->TryPopFront(m_taskSizes, taskId)
+            || TrySteal(taskId);
+    }
+
+
+    bool TaskDistributor::TrySteal(size_t& taskId)
+    {
+        // Tasks are never added after construction, so once every queue has
+        // been found empty there is no more work.
+        for (;;)
+        {
+            TaskQueue* victim = nullptr;
+            size_t victimWork = 0;
+            for (auto & queue : m_queues)
+            {
+                const size_t work = queue->GetRemainingWork();
+                if (work > victimWork)
+                {
+                    victim = queue.get();
+                    victimWork = work;
+                }
+            }
+
+            if (victim == nullptr)
+            {
+                return false;
+            }
+
+            // The victim may have been drained since its work was read. In
+            // that case pick another.
+            if (victim->TryPopBack(m_taskSizes, taskId))
+            {
+                return true;
+            }
+        }
+    }
+
+
+    void TaskDistributor::WaitForCompletion()
+    {
+        m_threadManager->WaitForThreads();
+    }
+
+
+    //*************************************************************************
+    //
+    // TaskDistributor::TaskQueue
+    //
+    //*************************************************************************
+    TaskDistributor::TaskQueue::TaskQueue()
+        : m_remainingWork(0)
+    {
+    }
+
+
+    void TaskDistributor::TaskQueue::PushBack(size_t taskId, size_t size)
     {
         std::lock_guard<std::mutex> lock(m_lock);
+        m_taskIds.push_back(taskId);
+        m_remainingWork += size + 1;
+    }
+
 
-        if (m_nextTaskId < m_taskCount)
+    bool TaskDistributor::TaskQueue::TryPopFront(std::vector<size_t> const & taskSizes,
+                                                 size_t& taskId)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_taskIds.empty())
         {
-            taskId = m_nextTaskId++;
-            return true;
+            return false;
         }
-        else
+        taskId = m_taskIds.front();
+        m_taskIds.pop_front();
+        m_remainingWork -= taskSizes[taskId] + 1;
+        return true;
+    }
+
+
+    bool TaskDistributor::TaskQueue::TryPopBack(std::vector<size_t> const & taskSizes,
+                                                size_t& taskId)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_taskIds.empty())
         {
             return false;
         }
+        taskId = m_taskIds.back();
+        m_taskIds.pop_back();
+        m_remainingWork -= taskSizes[taskId] + 1;
+        return true;
     }
 
 
-    void TaskDistributor::WaitForCompletion()
+    size_t TaskDistributor::TaskQueue::GetRemainingWork() const
     {
-        m_threadManager->WaitForThreads();
+        return m_remainingWork;
     }
 }
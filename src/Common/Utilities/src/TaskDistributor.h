@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <atomic>                                   // std::atomic member.
+#include <deque>                                    // std::deque member.
 #include <memory>                                   // For std::unique_ptr.
 #include <mutex>                                    // std::mutex member.
 #include <vector>                                   // std::vector member.
@@ -45,13 +47,23 @@ namespace BitFunnel
     // that derive from ITaskProcessor.
     //
     // One thread is started for each ITaskProcessor. The ITaskProcessors are
-    // assigned task ids via ITaskProcessor::ProcessTask(). Task ids are handed
-    // out starting from 0 and increasing until all ITaskProcessors are busy.
-    // Each time a thread returns from ProcessTask(), a new task id will be
-    // assigned until all tasks have been processed.
+    // assigned task ids via ITaskProcessor::ProcessTask(). Each time a thread
+    // returns from ProcessTask(), a new task id will be assigned until all
+    // tasks have been processed.
     //
-    // Task coordinator only knows about task ids. The interpretation of the
-    // work associated with a particular task id is up to the ITaskProcessor.
+    // Task coordinator only knows about task ids and, optionally, an estimate
+    // of the size of each task. The interpretation of the work associated
+    // with a particular task id is up to the ITaskProcessor.
+    //
+    // Tasks are handed out largest first. At construction, tasks are sorted by
+    // decreasing size and dealt to per-thread queues, each task going to the
+    // queue with the least work assigned so far. A thread takes tasks from
+    // the front of its own queue. When its queue is empty, it steals from the
+    // back of the queue with the most remaining work. The result is that big
+    // tasks start early and small tasks fill in the gaps at the end of the
+    // run, instead of one thread being left alone with a big task. When all
+    // tasks have the same size, task ids are dealt round-robin in increasing
+    // order.
     //
     //*************************************************************************
     class TaskDistributor : public ITaskDistributor, NonCopyable
@@ -61,25 +73,61 @@ namespace BitFunnel
             const std::vector<std::unique_ptr<ITaskProcessor>>& processors,
             size_t taskCount);
 
+        // Constructs a TaskDistributor for taskSizes.size() tasks where
+        // taskSizes[i] is the estimated cost (e.g. the number of bytes) of
+        // the task with id i.
+        TaskDistributor(
+            const std::vector<std::unique_ptr<ITaskProcessor>>& processors,
+            std::vector<size_t> const & taskSizes);
+
         ~TaskDistributor();
 
-        // TaskDistributorThreads call TryAllocateTask() to get their next task
-        // assignment. If there is work remaining, taskId will be set to the id
-        // of the assigned task and the method will return true. If there are
-        // no tasks remaining, the method will return false.
+        // Assigns a task to a caller that is not one of the distributor's
+        // own threads. The task is stolen from the queue with the most
+        // remaining work. If there is work remaining, taskId will be set to
+        // the id of the assigned task and the method will return true. If
+        // there are no tasks remaining, the method will return false.
         bool TryAllocateTask(size_t& taskId);
 
+        // TaskDistributorThreads call this overload to get their next task
+        // assignment, first from their own queue and then by stealing.
+        bool TryAllocateTask(size_t threadIndex, size_t& taskId);
+
         // Wait for all tasks to complete.
         void WaitForCompletion();
 
     private:
+        // Deals the tasks to the per-thread queues and starts the threads.
+        void Initialize(std::vector<size_t> const & taskSizes);
+
+        bool TrySteal(size_t& taskId);
+
+        class TaskQueue : NonCopyable
+        {
+        public:
+            TaskQueue();
+
+            void PushBack(size_t taskId, size_t size);
+            bool TryPopFront(std::vector<size_t> const & taskSizes, size_t& taskId);
+            bool TryPopBack(std::vector<size_t> const & taskSizes, size_t& taskId);
+
+            // Sum of the sizes of the tasks remaining in the queue plus one
+            // per task, so that a queue of zero-sized tasks is not mistaken
+            // for an empty queue. Read without the lock to pick a victim.
+            size_t GetRemainingWork() const;
+
+        private:
+            std::mutex m_lock;
+            std::deque<size_t> m_taskIds;
+            std::atomic<size_t> m_remainingWork;
+        };
+
         std::vector<std::unique_ptr<ITaskProcessor>> const & m_processors;
-        size_t m_taskCount;
-        size_t m_nextTaskId;
+
+        std::vector<size_t> m_taskSizes;
+        std::vector<std::unique_ptr<TaskQueue>> m_queues;
 
         std::vector<IThreadBase*> m_threads;
         ThreadManager* m_threadManager;
-
-        std::mutex m_lock;
     };
 }
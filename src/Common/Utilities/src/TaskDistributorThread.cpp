@@ -27,16 +27,19 @@
 
 namespace BitFunnel
 {
-    TaskDistributorThread::TaskDistributorThread(TaskDistributor& distributor, ITaskProcessor& processor)
+    TaskDistributorThread::TaskDistributorThread(TaskDistributor& distributor,
+                                                 ITaskProcessor& processor,
+                                                 size_t threadIndex)
         : m_distributor(distributor),
-          m_processor(processor)
+          m_processor(processor),
+          m_threadIndex(threadIndex)
     {
     }
 
     void TaskDistributorThread::EntryPoint()
     {
         size_t taskId = 0;
-        while (m_distributor.TryAllocateTask(taskId))
+        while (m_distributor.TryAllocateTask(m_threadIndex, taskId))
         {
             m_processor.ProcessTask(taskId);
         }
@@ -32,11 +32,14 @@ namespace BitFunnel
     class TaskDistributorThread : public IThreadBase
     {
     public:
-        TaskDistributorThread(TaskDistributor& distributor, ITaskProcessor& processor);
+        TaskDistributorThread(TaskDistributor& distributor,
+                              ITaskProcessor& processor,
+                              size_t threadIndex);
         void EntryPoint();
 
     private:
         TaskDistributor& m_distributor;
         ITaskProcessor& m_processor;
+        size_t m_threadIndex;
     };
 }
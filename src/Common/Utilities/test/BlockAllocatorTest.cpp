@@ -22,6 +22,8 @@
 
 
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -143,5 +145,67 @@ namespace BitFunnel
             allocator->ReleaseBlock(block + 2);
             allocator->ReleaseBlock(block + 4);
         }
+
+
+        TEST(BlockAllocator, MultipleThreads)
+        {
+            static const size_t c_blockSize = 16;
+            static const size_t c_totalBlockCount = 64;
+            static const size_t c_threadCount = 8;
+            static const size_t c_blocksPerThread = c_totalBlockCount / c_threadCount;
+            static const size_t c_iterations = 2000;
+
+            std::unique_ptr<IBlockAllocator> allocator(
+                Factories::CreateBlockAllocator(c_blockSize,
+                                                c_totalBlockCount));
+
+            // Each thread repeatedly allocates its share of the pool, stamps
+            // each block with its own id, verifies the stamps, and releases
+            // the blocks. A block handed out to two threads at once would
+            // show up as a mismatched stamp.
+            std::vector<size_t> errors(c_threadCount, 0);
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < c_threadCount; ++t)
+            {
+                threads.emplace_back([&allocator, &errors, t]()
+                {
+                    uint64_t* blocks[c_blocksPerThread];
+                    for (size_t i = 0; i < c_iterations; ++i)
+                    {
+                        for (size_t b = 0; b < c_blocksPerThread; ++b)
+                        {
+                            blocks[b] = allocator->AllocateBlock();
+                            blocks[b][0] = t;
+                            blocks[b][1] = b;
+                        }
+                        for (size_t b = 0; b < c_blocksPerThread; ++b)
+                        {
+                            if (blocks[b][0] != t || blocks[b][1] != b)
+                            {
+                                ++errors[t];
+                            }
+                            allocator->ReleaseBlock(blocks[b]);
+                        }
+                    }
+                });
+            }
+
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            for (size_t t = 0; t < c_threadCount; ++t)
+            {
+                EXPECT_EQ(0u, errors[t]);
+            }
+
+            // Every block should have made it back to the free list.
+            for (size_t b = 0; b < c_totalBlockCount; ++b)
+            {
+                allocator->AllocateBlock();
+            }
+            EXPECT_ANY_THROW(allocator->AllocateBlock());
+        }
     }
 }
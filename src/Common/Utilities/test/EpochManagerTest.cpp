@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "EpochManager.h"
+
+namespace BitFunnel
+{
+    namespace EpochManagerTest
+    {
+        TEST(EpochManager, StartTracker)
+        {
+            EpochManager epochManager(4);
+
+            // Starting a tracker when there are no tokens in flight.
+            const std::shared_ptr<ITokenTracker> noTokensTracker
+                = epochManager.StartTracker();
+
+            ASSERT_TRUE(noTokensTracker->IsComplete());
+
+            std::shared_ptr<ITokenTracker> token0Tracker;
+            {
+                const Token token0 = epochManager.RequestToken();
+                ASSERT_TRUE(noTokensTracker->IsComplete());
+
+                token0Tracker = epochManager.StartTracker();
+                ASSERT_FALSE(token0Tracker->IsComplete());
+
+                // A token requested after the tracker was started does not
+                // hold up the tracker once the older token is released.
+                {
+                    const Token token1 = epochManager.RequestToken();
+                    ASSERT_FALSE(token0Tracker->IsComplete());
+                }
+                ASSERT_FALSE(token0Tracker->IsComplete());
+            }
+
+            ASSERT_TRUE(token0Tracker->IsComplete());
+            ASSERT_TRUE(noTokensTracker->IsComplete());
+        }
+
+
+        TEST(EpochManager, TokenReleasedOnAnotherThread)
+        {
+            EpochManager epochManager(2);
+
+            std::unique_ptr<Token> token(new Token(epochManager.RequestToken()));
+            const std::shared_ptr<ITokenTracker> tracker
+                = epochManager.StartTracker();
+            ASSERT_FALSE(tracker->IsComplete());
+
+            std::thread thread([&token]()
+            {
+                token.reset();
+            });
+            thread.join();
+
+            ASSERT_TRUE(tracker->IsComplete());
+        }
+
+
+        TEST(EpochManager, TrackerOutlivesManager)
+        {
+            std::shared_ptr<ITokenTracker> tracker;
+            {
+                std::unique_ptr<ITokenManager>
+                    epochManager(Factories::CreateEpochManager(1));
+                tracker = epochManager->StartTracker();
+                epochManager->Shutdown();
+            }
+            ASSERT_TRUE(tracker->IsComplete());
+            tracker->WaitForCompletion();
+        }
+
+
+        // Many threads share a single slot while a tracker waits for tokens
+        // that were in flight when it was started.
+        TEST(EpochManager, SharedSlot)
+        {
+            static const size_t c_threadCount = 8;
+            static const size_t c_iterations = 10000;
+
+            EpochManager epochManager(1);
+
+            std::atomic<bool> stop(false);
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < c_threadCount; ++t)
+            {
+                threads.emplace_back([&]()
+                {
+                    for (size_t i = 0; i < c_iterations && !stop; ++i)
+                    {
+                        const Token token = epochManager.RequestToken();
+                    }
+                });
+            }
+
+            for (size_t i = 0; i < 100; ++i)
+            {
+                epochManager.StartTracker()->WaitForCompletion();
+            }
+            stop = true;
+
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            ASSERT_TRUE(epochManager.StartTracker()->IsComplete());
+        }
+    }
+}
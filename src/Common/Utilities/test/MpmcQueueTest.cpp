@@ -0,0 +1,193 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BitFunnel/Utilities/MpmcQueue.h"
+#include "gtest/gtest.h"
+
+
+namespace BitFunnel
+{
+    namespace MpmcQueueTest
+    {
+        TEST(MpmcQueue, FirstInFirstOut)
+        {
+            MpmcQueue<uint64_t> queue(4);
+
+            for (uint64_t i = 0; i < 4; ++i)
+            {
+                ASSERT_TRUE(queue.TryEnqueue(i));
+            }
+
+            for (uint64_t i = 0; i < 4; ++i)
+            {
+                uint64_t value;
+                ASSERT_TRUE(queue.TryDequeue(value));
+                ASSERT_EQ(i, value);
+            }
+
+            queue.Shutdown();
+
+            uint64_t value;
+            ASSERT_FALSE(queue.TryDequeue(value));
+            ASSERT_FALSE(queue.TryEnqueue(0));
+        }
+
+
+        TEST(MpmcQueue, MoveOnly)
+        {
+            MpmcQueue<std::unique_ptr<uint64_t>> queue(2);
+
+            ASSERT_TRUE(queue.TryEnqueue(std::unique_ptr<uint64_t>(new uint64_t(7))));
+
+            std::unique_ptr<uint64_t> value;
+            ASSERT_TRUE(queue.TryDequeue(value));
+            ASSERT_EQ(7u, *value);
+
+            queue.Shutdown();
+        }
+
+
+        // Producers each enqueue the values 1..itemsPerProducer while
+        // consumers dequeue until the queue is shut down. Every value must be
+        // dequeued exactly once, so the sums have to match.
+        void RunProducersAndConsumers(unsigned capacity,
+                                      unsigned producerCount,
+                                      uint64_t itemsPerProducer,
+                                      unsigned consumerCount)
+        {
+            MpmcQueue<uint64_t> queue(capacity);
+
+            std::atomic<uint64_t> consumedSum(0);
+            std::atomic<uint64_t> consumedCount(0);
+
+            std::vector<std::thread> consumers;
+            for (unsigned i = 0; i < consumerCount; ++i)
+            {
+                consumers.emplace_back([&]()
+                {
+                    uint64_t value;
+                    while (queue.TryDequeue(value))
+                    {
+                        consumedSum += value;
+                        ++consumedCount;
+                    }
+                });
+            }
+
+            std::vector<std::thread> producers;
+            for (unsigned i = 0; i < producerCount; ++i)
+            {
+                producers.emplace_back([&]()
+                {
+                    for (uint64_t value = 1; value <= itemsPerProducer; ++value)
+                    {
+                        EXPECT_TRUE(queue.TryEnqueue(value));
+                    }
+                });
+            }
+
+            for (auto & producer : producers)
+            {
+                producer.join();
+            }
+
+            queue.Shutdown();
+
+            for (auto & consumer : consumers)
+            {
+                consumer.join();
+            }
+
+            const uint64_t expectedSum =
+                producerCount * itemsPerProducer * (itemsPerProducer + 1) / 2;
+            ASSERT_EQ(producerCount * itemsPerProducer, consumedCount.load());
+            ASSERT_EQ(expectedSum, consumedSum.load());
+        }
+
+
+        TEST(MpmcQueue, ProducersAndConsumers)
+        {
+            RunProducersAndConsumers(32, 3, 10000, 3);    // Lots of readers and writers.
+            RunProducersAndConsumers(32, 10, 1000, 1);    // Many writers, one reader.
+            RunProducersAndConsumers(32, 2, 5000, 10);    // Few writers, many readers.
+            RunProducersAndConsumers(2, 4, 2000, 4);      // Queue is almost always full.
+        }
+
+
+        TEST(MpmcQueue, ShutdownWakesConsumers)
+        {
+            MpmcQueue<uint64_t> queue(8);
+
+            std::vector<std::thread> consumers;
+            for (unsigned i = 0; i < 4; ++i)
+            {
+                consumers.emplace_back([&queue]()
+                {
+                    uint64_t value;
+                    EXPECT_FALSE(queue.TryDequeue(value));
+                });
+            }
+
+            queue.Shutdown();
+
+            for (auto & consumer : consumers)
+            {
+                consumer.join();
+            }
+        }
+
+
+        TEST(MpmcQueue, ShutdownWakesProducers)
+        {
+            MpmcQueue<uint64_t> queue(2);
+            ASSERT_TRUE(queue.TryEnqueue(0));
+            ASSERT_TRUE(queue.TryEnqueue(1));
+
+            // The queue is full, so this producer blocks until shutdown.
+            std::thread producer([&queue]()
+            {
+                EXPECT_FALSE(queue.TryEnqueue(2));
+            });
+
+            // Shutdown() does not return until the queue drains.
+            std::thread shutdown([&queue]()
+            {
+                queue.Shutdown();
+            });
+
+            producer.join();
+
+            uint64_t value;
+            ASSERT_TRUE(queue.TryDequeue(value));
+            ASSERT_TRUE(queue.TryDequeue(value));
+            ASSERT_FALSE(queue.TryDequeue(value));
+
+            shutdown.join();
+        }
+    }
+}
@@ -159,5 +159,96 @@ namespace BitFunnel
         {
             out << "call count = " << m_callCount << std::endl;
         }
+
+
+        //*************************************************************************
+        //
+        // Size-aware distribution
+        //
+        //*************************************************************************
+        class RecordingTaskProcessor : public ITaskProcessor, NonCopyable
+        {
+        public:
+            RecordingTaskProcessor(std::vector<std::atomic<uint64_t>>& tasks)
+                : m_tasks(tasks)
+            {
+            }
+
+            void ProcessTask(size_t taskId)
+            {
+                ++m_tasks[taskId];
+                m_taskIds.push_back(taskId);
+            }
+
+            void Finished()
+            {
+            }
+
+            std::vector<size_t> const & GetTaskIds() const
+            {
+                return m_taskIds;
+            }
+
+        private:
+            std::vector<std::atomic<uint64_t>>& m_tasks;
+            std::vector<size_t> m_taskIds;
+        };
+
+
+        // Runs taskSizes through a TaskDistributor with threadCount threads,
+        // verifies that each task ran exactly once, and returns the order in
+        // which each thread processed its tasks.
+        static std::vector<std::vector<size_t>>
+            RunSizedTasks(size_t threadCount, std::vector<size_t> const & taskSizes)
+        {
+            std::vector<std::atomic<uint64_t>> tasks(taskSizes.size());
+            std::vector<RecordingTaskProcessor*> recorders;
+            std::vector<std::unique_ptr<ITaskProcessor>> processors;
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                recorders.push_back(new RecordingTaskProcessor(tasks));
+                processors.push_back(std::unique_ptr<ITaskProcessor>(recorders.back()));
+            }
+
+            std::unique_ptr<ITaskDistributor>
+                distributor(Factories::CreateTaskDistributor(processors, taskSizes));
+            distributor->WaitForCompletion();
+
+            for (size_t i = 0; i < taskSizes.size(); ++i)
+            {
+                EXPECT_EQ(tasks[i].load(), 1u);
+            }
+
+            std::vector<std::vector<size_t>> order;
+            for (auto recorder : recorders)
+            {
+                order.push_back(recorder->GetTaskIds());
+            }
+            return order;
+        }
+
+
+        TEST(TaskDistributor, LargestTasksFirst)
+        {
+            std::vector<size_t> taskSizes(NUM_TASKS);
+            for (size_t i = 0; i < taskSizes.size(); ++i)
+            {
+                taskSizes[i] = (i * 7919) % 1000;
+            }
+            taskSizes[37] = 100000;
+
+            // With a single thread, tasks run in order of decreasing size.
+            auto order = RunSizedTasks(1, taskSizes);
+            ASSERT_EQ(NUM_TASKS, order[0].size());
+            EXPECT_EQ(37u, order[0][0]);
+            for (size_t i = 1; i < order[0].size(); ++i)
+            {
+                EXPECT_GE(taskSizes[order[0][i - 1]], taskSizes[order[0][i]]);
+            }
+
+            // With many threads, whether tasks run in their owner's thread or
+            // are stolen, every task still runs exactly once.
+            RunSizedTasks(10, taskSizes);
+        }
     }
 }
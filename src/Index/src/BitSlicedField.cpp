@@ -0,0 +1,91 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <sstream>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/BitSlicedField.h"
+#include "BitFunnel/Index/DocumentHandle.h"
+#include "LoggerInterfaces/Logging.h"
+
+
+namespace BitFunnel
+{
+    BitSlicedField::BitSlicedField(IFactSet& facts,
+                                   char const * name,
+                                   uint64_t maxValue)
+        : m_maxValue(maxValue)
+    {
+        // A field always has at least one bit, even if it only holds zero.
+        unsigned bitCount = 1;
+        while (bitCount < 64 && (maxValue >> bitCount) != 0)
+        {
+            ++bitCount;
+        }
+
+        for (unsigned bit = 0; bit < bitCount; ++bit)
+        {
+            std::stringstream friendlyName;
+            friendlyName << name << ":" << bit;
+            m_facts.push_back(facts.DefineFact(friendlyName.str().c_str(),
+                                               true));
+        }
+    }
+
+
+    uint64_t BitSlicedField::GetMaxValue() const
+    {
+        return m_maxValue;
+    }
+
+
+    unsigned BitSlicedField::GetBitCount() const
+    {
+        return static_cast<unsigned>(m_facts.size());
+    }
+
+
+    FactHandle BitSlicedField::GetFact(unsigned bit) const
+    {
+        LogAssertB(bit < m_facts.size(), "BitSlicedField: bit out of range.");
+        return m_facts[bit];
+    }
+
+
+    void BitSlicedField::Assert(DocumentHandle handle, uint64_t value) const
+    {
+        if (value > m_maxValue)
+        {
+            std::stringstream message;
+            message << "BitSlicedField::Assert: value " << value
+                    << " exceeds maximum " << m_maxValue << ".";
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        for (unsigned bit = 0; bit < m_facts.size(); ++bit)
+        {
+            handle.AssertFact(m_facts[bit], ((value >> bit) & 1) != 0);
+        }
+    }
+}
@@ -24,6 +24,7 @@
 #include "BitFunnel/Utilities/Factories.h"
 #include "ChunkEnumerator.h"
 #include "ChunkTaskProcessor.h"
+#include "ChunkTasks.h"
 
 
 namespace BitFunnel
@@ -33,28 +34,35 @@ namespace BitFunnel
         IConfiguration const & config,
         IIngestor& ingestor,
         size_t threadCount)
+      : m_tasks(new ChunkTasks(filePaths, threadCount))
     {
-        std::vector<std::unique_ptr<ITaskProcessor>> processors;
         for (size_t i = 0; i < threadCount; ++i) {
-            processors.push_back(
+            m_processors.push_back(
                 std::unique_ptr<ITaskProcessor>(
-                    new ChunkTaskProcessor(filePaths, config, ingestor)));
+                    new ChunkTaskProcessor(*m_tasks, config, ingestor)));
         }
 
         if (threadCount > 1)
         {
-            m_distributor = Factories::CreateTaskDistributor(processors, filePaths.size());
+            m_distributor =
+                Factories::CreateTaskDistributor(m_processors,
+                                                 m_tasks->GetTaskSizes());
         }
         else
         {
             // The threadCount == 1 case is implemented to simplify debugging.
-            for (size_t i = 0; i < filePaths.size(); ++i) {
-                processors[0]->ProcessTask(i);
+            for (size_t i = 0; i < m_tasks->GetTaskCount(); ++i) {
+                m_processors[0]->ProcessTask(i);
             }
         }
     }
 
 
+    ChunkEnumerator::~ChunkEnumerator()
+    {
+    }
+
+
     void ChunkEnumerator::WaitForCompletion() const
     {
         if (m_distributor != nullptr)
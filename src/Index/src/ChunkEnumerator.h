@@ -25,6 +25,7 @@
 #include <memory>       // std::unique_ptr member.
 #include <stddef.h>     // size_t parameter.
 #include <string>       // std::string template parameter.
+#include <vector>       // std::vector member.
 
 #include "BitFunnel/NonCopyable.h"                  // Inherits from NonCopyable.
 #include "BitFunnel/Utilities/ITaskDistributor.h"   // std::unqiue_ptr template parameter.
@@ -32,12 +33,15 @@
 
 namespace BitFunnel
 {
+    class ChunkTasks;
     class IConfiguration;
     class IIngestor;
+    class ITaskProcessor;
 
-    // Fill an std::vector with filenames
+    // Divide the files into ChunkTasks, splitting large files into ranges
     // Construct a ChunkTaskProcessor for each thread
-    // Pass the above to constructor TaskDistributor()
+    // Pass the above to constructor TaskDistributor(), which starts the
+    // largest tasks first and balances the rest by work stealing
     class ChunkEnumerator : public NonCopyable
     {
     public:
@@ -46,9 +50,15 @@ namespace BitFunnel
                         IIngestor& ingestor,
                         size_t threadCount);
 
+        ~ChunkEnumerator();
+
         void WaitForCompletion() const;
 
     private:
+        // DESIGN NOTE: The tasks and processors must outlive the distributor,
+        // whose threads reference them, so they are declared first.
+        std::unique_ptr<ChunkTasks> m_tasks;
+        std::vector<std::unique_ptr<ITaskProcessor>> m_processors;
         std::unique_ptr<ITaskDistributor> m_distributor;
     };
 }
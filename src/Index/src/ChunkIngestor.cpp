@@ -22,20 +22,45 @@
 
 #include "BitFunnel/Index/IIngestor.h"
 #include "ChunkIngestor.h"
+#include "DocTableDescriptor.h"
 #include "Document.h"
+#include "Shard.h"
 
 
 namespace BitFunnel
 {
+    // Every shard has the same schema, so the first one stands for all of
+    // them.
+    static bool HasTermSequenceBlob(IIngestor const & ingestor)
+    {
+        VariableSizeBlobId blob;
+        return ingestor.GetShardCount() > 0 &&
+               ingestor.GetShard(0).GetDocTable().TryGetTermSequenceBlob(blob);
+    }
+
+
     ChunkIngestor::ChunkIngestor(
         std::vector<char> const & chunkData,
         IConfiguration const & config,
         IIngestor& ingestor)
       : m_config(config),
         m_ingestor(ingestor),
-        m_chunkData(chunkData)
+        m_storeTermSequences(HasTermSequenceBlob(ingestor))
+    {
+        ChunkReader(chunkData, *this);
+    }
+
+
+    ChunkIngestor::ChunkIngestor(
+        char const * begin,
+        char const * end,
+        IConfiguration const & config,
+        IIngestor& ingestor)
+      : m_config(config),
+        m_ingestor(ingestor),
+        m_storeTermSequences(HasTermSequenceBlob(ingestor))
     {
-        ChunkReader(m_chunkData, *this);
+        ChunkReader(begin, end, *this);
     }
 
 
@@ -46,7 +71,7 @@ namespace BitFunnel
 
     void ChunkIngestor::OnDocumentEnter(DocId id)
     {
-        m_currentDocument.reset(new Document(m_config, id));
+        m_currentDocument.reset(new Document(m_config, id, m_storeTermSequences));
     }
 
 
@@ -55,6 +55,12 @@ namespace BitFunnel
                       IConfiguration const & configuration,
                       IIngestor& ingestor);
 
+        // Ingests the whole documents in [begin, end). See ChunkReader.
+        ChunkIngestor(char const * begin,
+                      char const * end,
+                      IConfiguration const & configuration,
+                      IIngestor& ingestor);
+
         //
         // ChunkReader::IEvents methods.
         //
@@ -73,10 +79,13 @@ namespace BitFunnel
         IConfiguration const & m_config;
         IIngestor& m_ingestor;
 
+        // True if the schema has a term sequence blob. Checked once, rather
+        // than for each document.
+        const bool m_storeTermSequences;
+
         //
         // Other members
         //
-        std::vector<char> const& m_chunkData;
         std::unique_ptr<Document> m_currentDocument;
     };
 }
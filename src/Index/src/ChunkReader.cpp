@@ -51,6 +51,23 @@ namespace BitFunnel
     }
 
 
+    ChunkReader::ChunkReader(char const * begin, char const * end, IEvents& processor)
+        : m_processor(processor),
+          m_next(begin),
+          m_end(end)
+    {
+        if (m_next == m_end) {
+            throw FatalError("Attempt to read empty document range.");
+        }
+
+        m_processor.OnFileEnter();
+        while (m_next != m_end) {
+            ProcessDocument();
+        }
+        m_processor.OnFileExit();
+    }
+
+
     void ChunkReader::ProcessDocument()
     {
         char const * start = m_next;
@@ -53,8 +53,16 @@ namespace BitFunnel
             virtual void OnFileExit() = 0;
         };
 
+        // Parses an entire chunk, including the '\0' that marks the end of
+        // the chunk.
         ChunkReader(std::vector<char> const & input, IEvents& processor);
 
+        // Parses the documents in [begin, end). The range must start at the
+        // beginning of a document and end just after the end of a document.
+        // It does not include the chunk's terminating '\0'. Used to ingest
+        // a large chunk from several threads.
+        ChunkReader(char const * begin, char const * end, IEvents& processor);
+
     private:
         void ProcessDocument();
         void ProcessStream();
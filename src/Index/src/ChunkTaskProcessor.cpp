@@ -20,22 +20,17 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-#include <iostream>         // TODO: Remove this temporary header.
-#include <fstream>
-#include <sstream>
-
-#include "BitFunnel/Exceptions.h"
-#include "ChunkIngestor.h"
 #include "ChunkTaskProcessor.h"
+#include "ChunkTasks.h"
 
 
 namespace BitFunnel
 {
     ChunkTaskProcessor::ChunkTaskProcessor(
-        std::vector<std::string> const & filePaths,
+        ChunkTasks& tasks,
         IConfiguration const & config,
         IIngestor& ingestor)
-      : m_filePaths(filePaths),
+      : m_tasks(tasks),
         m_config(config),
         m_ingestor(ingestor)
     {
@@ -44,36 +39,7 @@ namespace BitFunnel
 
     void ChunkTaskProcessor::ProcessTask(size_t taskId)
     {
-        if (taskId >= m_filePaths.size())
-        {
-            std::stringstream message;
-            message << "No task corresponds to task id '" << taskId << "'";
-            throw FatalError(message.str());
-        }
-
-        // // TODO: Replace stream to cout with calls to the logger.
-        // std::cout << "ChunkTaskProcessor::ProcessTask: taskId:" << taskId
-        //           << std::endl;
-        std::cout << "ChunkTaskProcessor::ProcessTask: filePath:"
-                  << m_filePaths[taskId] << std::endl;
-
-        std::ifstream inputStream(m_filePaths[taskId], std::ios::binary);
-        if (!inputStream.is_open())
-        {
-            std::stringstream message;
-            message << "Failed to open chunk file '"
-                    << m_filePaths[taskId]
-                    << "'";
-            throw FatalError(message.str());
-        }
-
-        std::vector<char> chunkData(
-            (std::istreambuf_iterator<char>(inputStream)),
-            std::istreambuf_iterator<char>());
-
-        // NOTE: The act of constructing a ChunkIngestor causes the bytes in
-        // chunkData to be parsed into documents and ingested.
-        ChunkIngestor(chunkData, m_config, m_ingestor);
+        m_tasks.ProcessTask(taskId, m_config, m_ingestor);
     }
 
 
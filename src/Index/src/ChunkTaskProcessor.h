@@ -23,14 +23,13 @@
 #pragma once
 
 #include <stddef.h>     // size_t parameter.
-#include <string>       // std::string template parameter.
-#include <vector>       // std::vector member.
 
 #include "BitFunnel/Utilities/ITaskProcessor.h"
 
 
 namespace BitFunnel
 {
+    class ChunkTasks;
     class IConfiguration;
     class IIngestor;
 
@@ -38,7 +37,7 @@ namespace BitFunnel
     class ChunkTaskProcessor : public ITaskProcessor
     {
     public:
-        ChunkTaskProcessor(std::vector<std::string> const & filePaths,
+        ChunkTaskProcessor(ChunkTasks& tasks,
                            IConfiguration const & config,
                            IIngestor& ingestor);
 
@@ -52,7 +51,7 @@ namespace BitFunnel
         //
         // Constructor parameters.
         //
-        std::vector<std::string> const & m_filePaths;
+        ChunkTasks& m_tasks;
         IConfiguration const & m_config;
         IIngestor& m_ingestor;
     };
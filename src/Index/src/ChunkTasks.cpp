@@ -0,0 +1,301 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "BitFunnel/Exceptions.h"
+#include "ChunkIngestor.h"
+#include "ChunkReader.h"
+#include "ChunkTasks.h"
+#include "LoggerInterfaces/Logging.h"
+
+
+namespace BitFunnel
+{
+    // Files are not split into ranges smaller than this.
+    static const size_t c_minRangeSize = 4 * 1024 * 1024;
+
+    // When splitting, aim for this many ranges per thread across the corpus
+    // so that stealing has small tasks to even out the end of the run.
+    static const size_t c_rangesPerThread = 4;
+
+
+    //*************************************************************************
+    //
+    // DocumentEnds records the offset just past the end of each document in
+    // a chunk.
+    //
+    //*************************************************************************
+    class DocumentEnds : public ChunkReader::IEvents
+    {
+    public:
+        DocumentEnds(std::vector<char> const & chunk)
+          : m_offset(0)
+        {
+            ChunkReader(chunk, *this);
+        }
+
+        std::vector<size_t> const & GetEnds() const
+        {
+            return m_ends;
+        }
+
+        //
+        // ChunkReader::IEvents methods.
+        //
+        virtual void OnFileEnter() override {}
+        virtual void OnDocumentEnter(DocId /*id*/) override {}
+        virtual void OnStreamEnter(Term::StreamId /*id*/) override {}
+        virtual void OnTerm(char const * /*term*/) override {}
+        virtual void OnStreamExit() override {}
+
+        virtual void OnDocumentExit(size_t bytesRead) override
+        {
+            m_offset += bytesRead;
+            m_ends.push_back(m_offset);
+        }
+
+        virtual void OnFileExit() override {}
+
+    private:
+        size_t m_offset;
+        std::vector<size_t> m_ends;
+    };
+
+
+    //*************************************************************************
+    //
+    // ChunkTasks
+    //
+    //*************************************************************************
+    ChunkTasks::ChunkTasks(std::vector<std::string> const & filePaths,
+                           size_t threadCount)
+      : m_filePaths(filePaths)
+    {
+        size_t totalSize = 0;
+        for (auto const & filePath : m_filePaths)
+        {
+            totalSize += GetFileSize(filePath);
+        }
+
+        const size_t targetRangeSize =
+            (std::max)(c_minRangeSize,
+                       totalSize / ((std::max)(threadCount, static_cast<size_t>(1)) * c_rangesPerThread));
+
+        PlanTasks(threadCount, targetRangeSize);
+    }
+
+
+    ChunkTasks::ChunkTasks(std::vector<std::string> const & filePaths,
+                           size_t threadCount,
+                           size_t targetRangeSize)
+      : m_filePaths(filePaths)
+    {
+        PlanTasks(threadCount, targetRangeSize);
+    }
+
+
+    ChunkTasks::~ChunkTasks()
+    {
+    }
+
+
+    void ChunkTasks::PlanTasks(size_t threadCount, size_t targetRangeSize)
+    {
+        for (size_t fileIndex = 0; fileIndex < m_filePaths.size(); ++fileIndex)
+        {
+            const size_t fileSize = GetFileSize(m_filePaths[fileIndex]);
+
+            size_t rangeCount = 1;
+            if (threadCount > 1 && targetRangeSize > 0)
+            {
+                rangeCount = (std::max)((fileSize + targetRangeSize - 1) / targetRangeSize,
+                                        static_cast<size_t>(1));
+            }
+
+            if (rangeCount == 1)
+            {
+                m_tasks.push_back({ fileIndex, 0, c_notSplit });
+                m_taskSizes.push_back(fileSize);
+            }
+            else
+            {
+                const size_t splitFileIndex = m_splitFiles.size();
+                m_splitFiles.emplace_back(new SplitFile(rangeCount));
+                for (size_t range = 0; range < rangeCount; ++range)
+                {
+                    m_tasks.push_back({ fileIndex, range, splitFileIndex });
+                    m_taskSizes.push_back(fileSize / rangeCount);
+                }
+            }
+        }
+    }
+
+
+    size_t ChunkTasks::GetTaskCount() const
+    {
+        return m_tasks.size();
+    }
+
+
+    std::vector<size_t> const & ChunkTasks::GetTaskSizes() const
+    {
+        return m_taskSizes;
+    }
+
+
+    void ChunkTasks::ProcessTask(size_t taskId,
+                                 IConfiguration const & config,
+                                 IIngestor& ingestor)
+    {
+        if (taskId >= m_tasks.size())
+        {
+            std::stringstream message;
+            message << "No task corresponds to task id '" << taskId << "'";
+            throw FatalError(message.str());
+        }
+
+        Task const & task = m_tasks[taskId];
+        std::string const & filePath = m_filePaths[task.m_fileIndex];
+
+        if (task.m_splitFileIndex == c_notSplit)
+        {
+            LogB(Logging::Info,
+                 "ChunkTaskProcessor::ProcessTask",
+                 "filePath:%s",
+                 filePath.c_str());
+
+            std::vector<char> chunkData = ReadFile(filePath);
+
+            // NOTE: The act of constructing a ChunkIngestor causes the bytes in
+            // chunkData to be parsed into documents and ingested.
+            ChunkIngestor(chunkData, config, ingestor);
+        }
+        else
+        {
+            SplitFile& file = *m_splitFiles[task.m_splitFileIndex];
+
+            LogB(Logging::Info,
+                 "ChunkTaskProcessor::ProcessTask",
+                 "filePath:%s range %zu of %zu",
+                 filePath.c_str(),
+                 task.m_rangeIndex + 1,
+                 file.m_rangeCount);
+
+            // The first range of the file to run loads the data for all of
+            // them.
+            std::call_once(file.m_loaded, [&file, &filePath]()
+            {
+                file.m_data = ReadFile(filePath);
+                file.m_boundaries = SplitChunk(file.m_data, file.m_rangeCount);
+            });
+
+            const size_t begin = file.m_boundaries[task.m_rangeIndex];
+            const size_t end = file.m_boundaries[task.m_rangeIndex + 1];
+            if (begin != end)
+            {
+                char const * data = &file.m_data[0];
+                ChunkIngestor(data + begin, data + end, config, ingestor);
+            }
+
+            if (--file.m_remainingRanges == 0)
+            {
+                std::vector<char>().swap(file.m_data);
+            }
+        }
+    }
+
+
+    std::vector<size_t> ChunkTasks::SplitChunk(std::vector<char> const & chunk,
+                                               size_t rangeCount)
+    {
+        DocumentEnds documents(chunk);
+        std::vector<size_t> const & ends = documents.GetEnds();
+
+        const size_t chunkEnd = ends.empty() ? 0 : ends.back();
+
+        std::vector<size_t> boundaries;
+        boundaries.push_back(0);
+        for (size_t range = 1; range < rangeCount; ++range)
+        {
+            // End the range at the document boundary closest to its share
+            // of the chunk.
+            const size_t target = chunkEnd * range / rangeCount;
+            auto it = std::lower_bound(ends.begin(), ends.end(), target);
+            size_t boundary = (it == ends.end()) ? chunkEnd : *it;
+            if (it != ends.begin() && target - *(it - 1) < boundary - target)
+            {
+                boundary = *(it - 1);
+            }
+            boundaries.push_back((std::max)(boundary, boundaries.back()));
+        }
+        boundaries.push_back(chunkEnd);
+
+        return boundaries;
+    }
+
+
+    size_t ChunkTasks::GetFileSize(std::string const & filePath)
+    {
+        // Files that cannot be opened are treated as empty here. The error
+        // is reported when the task runs.
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            return 0;
+        }
+        return static_cast<size_t>(file.tellg());
+    }
+
+
+    std::vector<char> ChunkTasks::ReadFile(std::string const & filePath)
+    {
+        std::ifstream inputStream(filePath, std::ios::binary);
+        if (!inputStream.is_open())
+        {
+            std::stringstream message;
+            message << "Failed to open chunk file '"
+                    << filePath
+                    << "'";
+            throw FatalError(message.str());
+        }
+
+        return std::vector<char>(
+            (std::istreambuf_iterator<char>(inputStream)),
+            std::istreambuf_iterator<char>());
+    }
+
+
+    //*************************************************************************
+    //
+    // ChunkTasks::SplitFile
+    //
+    //*************************************************************************
+    ChunkTasks::SplitFile::SplitFile(size_t rangeCount)
+      : m_rangeCount(rangeCount),
+        m_remainingRanges(rangeCount)
+    {
+    }
+}
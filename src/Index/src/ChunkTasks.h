@@ -0,0 +1,130 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>       // std::atomic member.
+#include <memory>       // std::unique_ptr member.
+#include <mutex>        // std::once_flag member.
+#include <stddef.h>     // size_t parameter.
+#include <string>       // std::string template parameter.
+#include <vector>       // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"  // Inherits from NonCopyable.
+
+
+namespace BitFunnel
+{
+    class IConfiguration;
+    class IIngestor;
+
+    //*************************************************************************
+    //
+    // ChunkTasks divides the ingestion of a list of chunk files into tasks
+    // for the TaskDistributor.
+    //
+    // Each file is one task, except for files that are large relative to the
+    // whole corpus. Those are split into several tasks, each covering a
+    // range of whole documents, so that several threads can ingest a big
+    // file at the same time. The first task for a split file to run reads
+    // the file and finds the range boundaries. The other tasks for the file
+    // reuse that data, and the last one to finish releases it.
+    //
+    // GetTaskSizes() estimates each task's size in bytes so that the
+    // TaskDistributor can start the largest tasks first.
+    //
+    // ProcessTask() is thread safe.
+    //
+    //*************************************************************************
+    class ChunkTasks : public NonCopyable
+    {
+    public:
+        // Plans tasks for threadCount threads. Files are only split when
+        // threadCount > 1.
+        ChunkTasks(std::vector<std::string> const & filePaths,
+                   size_t threadCount);
+
+        // Plans tasks so that no task covers much more than targetRangeSize
+        // bytes, unless a single document is larger than that.
+        ChunkTasks(std::vector<std::string> const & filePaths,
+                   size_t threadCount,
+                   size_t targetRangeSize);
+
+        ~ChunkTasks();
+
+        size_t GetTaskCount() const;
+
+        // Returns the estimated size in bytes of each task, indexed by task id.
+        std::vector<size_t> const & GetTaskSizes() const;
+
+        // Ingests the documents belonging to taskId.
+        void ProcessTask(size_t taskId,
+                         IConfiguration const & config,
+                         IIngestor& ingestor);
+
+        // Returns rangeCount + 1 offsets into chunk that divide its documents
+        // into rangeCount ranges of roughly equal size. The first offset is
+        // 0 and the last is the offset of the chunk's terminating '\0'.
+        // Ranges may be empty if the chunk has fewer documents than ranges.
+        static std::vector<size_t> SplitChunk(std::vector<char> const & chunk,
+                                              size_t rangeCount);
+
+        // Returns the contents of a chunk file. Throws FatalError if the file
+        // cannot be opened.
+        static std::vector<char> ReadFile(std::string const & filePath);
+
+    private:
+        void PlanTasks(size_t threadCount, size_t targetRangeSize);
+
+        static size_t GetFileSize(std::string const & filePath);
+
+        // Chunk data shared by the tasks of a split file.
+        class SplitFile : public NonCopyable
+        {
+        public:
+            SplitFile(size_t rangeCount);
+
+            const size_t m_rangeCount;
+            std::once_flag m_loaded;
+            std::vector<char> m_data;
+            std::vector<size_t> m_boundaries;
+            std::atomic<size_t> m_remainingRanges;
+        };
+
+        struct Task
+        {
+            size_t m_fileIndex;
+            size_t m_rangeIndex;
+
+            // Index into m_splitFiles, or c_notSplit.
+            size_t m_splitFileIndex;
+        };
+
+        static const size_t c_notSplit = static_cast<size_t>(-1);
+
+        std::vector<std::string> const & m_filePaths;
+        std::vector<Task> m_tasks;
+        std::vector<size_t> m_taskSizes;
+        std::vector<std::unique_ptr<SplitFile>> m_splitFiles;
+    };
+}
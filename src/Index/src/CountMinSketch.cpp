@@ -0,0 +1,149 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <math.h>
+
+#include "BitFunnel/Exceptions.h"
+#include "CountMinSketch.h"
+
+
+namespace BitFunnel
+{
+    // Mixes the bits of x so that nearby keys map to unrelated counters.
+    // This is the finalizer from SplitMix64.
+    static uint64_t Mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+
+    CountMinSketch::CountMinSketch(double errorBound,
+                                   double failureProbability)
+      : m_width(1),
+        m_depth(1),
+        m_totalCount(0)
+    {
+        if (!(errorBound > 0.0 && errorBound < 1.0) ||
+            !(failureProbability > 0.0 && failureProbability < 1.0))
+        {
+            RecoverableError error("CountMinSketch: parameters must be in (0, 1).");
+            throw error;
+        }
+
+        const double width = ceil(exp(1.0) / errorBound);
+        while (m_width < width)
+        {
+            m_width <<= 1;
+        }
+
+        m_depth = std::max(static_cast<size_t>(ceil(log(1.0 / failureProbability))),
+                           static_cast<size_t>(1));
+
+        m_counters.resize(m_width * m_depth, 0);
+    }
+
+
+    void CountMinSketch::Increment(uint64_t key)
+    {
+        ++m_totalCount;
+        for (size_t row = 0; row < m_depth; ++row)
+        {
+            ++m_counters[row * m_width + GetIndex(row, key)];
+        }
+    }
+
+
+    uint64_t CountMinSketch::Estimate(uint64_t key) const
+    {
+        uint32_t estimate = m_counters[GetIndex(0, key)];
+        for (size_t row = 1; row < m_depth; ++row)
+        {
+            estimate = std::min(estimate,
+                                m_counters[row * m_width + GetIndex(row, key)]);
+        }
+        return estimate;
+    }
+
+
+    void CountMinSketch::Merge(CountMinSketch const & other)
+    {
+        if (m_width != other.m_width || m_depth != other.m_depth)
+        {
+            RecoverableError error("CountMinSketch::Merge: dimensions differ.");
+            throw error;
+        }
+
+        m_totalCount += other.m_totalCount;
+        for (size_t i = 0; i < m_counters.size(); ++i)
+        {
+            m_counters[i] += other.m_counters[i];
+        }
+    }
+
+
+    double CountMinSketch::EstimateDistinctCount() const
+    {
+        const size_t empty =
+            static_cast<size_t>(std::count(m_counters.begin(),
+                                           m_counters.begin() + m_width,
+                                           0u));
+
+        // Once every counter is in use, linear counting saturates. Report the
+        // largest value it can resolve.
+        const double width = static_cast<double>(m_width);
+        return width * log(width / std::max(empty, static_cast<size_t>(1)));
+    }
+
+
+    size_t CountMinSketch::GetWidth() const
+    {
+        return m_width;
+    }
+
+
+    size_t CountMinSketch::GetDepth() const
+    {
+        return m_depth;
+    }
+
+
+    uint64_t CountMinSketch::GetTotalCount() const
+    {
+        return m_totalCount;
+    }
+
+
+    size_t CountMinSketch::GetIndex(size_t row, uint64_t key) const
+    {
+        // Each row uses a different seed. Width is a power of two.
+        return static_cast<size_t>(Mix(key + 0x9e3779b97f4a7c15ull * (row + 1)))
+               & (m_width - 1);
+    }
+}
@@ -0,0 +1,88 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stdint.h>     // uint32_t, uint64_t members.
+#include <vector>       // std::vector member.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // CountMinSketch
+    //
+    // A fixed size approximate counter for a stream of 64-bit keys. The
+    // sketch has depth rows of width counters. Each key increments one
+    // counter in every row, and the estimate for a key is the minimum of its
+    // counters, so estimates never fall below the true count.
+    //
+    // With width = e / errorBound and depth = ln(1 / failureProbability),
+    // an estimate exceeds the true count by more than errorBound * the total
+    // number of increments with probability at most failureProbability.
+    // Width is rounded up to a power of two.
+    //
+    // Sketches with the same dimensions use the same hash functions, so they
+    // can be built independently, for example one per thread, and then
+    // combined with Merge().
+    //
+    // Thread safety: none.
+    //
+    //*************************************************************************
+    class CountMinSketch
+    {
+    public:
+        CountMinSketch(double errorBound, double failureProbability);
+
+        void Increment(uint64_t key);
+
+        // Returns an upper bound on the number of times key was incremented.
+        uint64_t Estimate(uint64_t key) const;
+
+        // Adds the counts from other into this sketch. Throws if other has
+        // different dimensions.
+        void Merge(CountMinSketch const & other);
+
+        // Returns an estimate of the number of distinct keys, computed by
+        // linear counting over the empty counters in the first row.
+        double EstimateDistinctCount() const;
+
+        size_t GetWidth() const;
+        size_t GetDepth() const;
+
+        // Returns the total number of calls to Increment(), including those
+        // merged from other sketches.
+        uint64_t GetTotalCount() const;
+
+    private:
+        size_t GetIndex(size_t row, uint64_t key) const;
+
+        size_t m_width;
+        size_t m_depth;
+        uint64_t m_totalCount;
+
+        // Counters are stored row by row.
+        std::vector<uint32_t> m_counters;
+    };
+}
@@ -118,6 +118,9 @@ namespace BitFunnel
           m_fixedSizeBlobOffsets(CreateFixedSizeBlobOffsets(schema)),
           m_bytesPerItem(GetItemByteCount(schema))
     {
+        m_hasTermSequenceBlob = schema.TryGetTermSequenceBlob(m_termSequenceBlob);
+        m_hasStaticRankBlob = schema.TryGetStaticRankBlob(m_staticRankBlob);
+
         // Make sure offset of the DocTable is properly aligned.
         // LogAssertB((bufferOffset % c_docTableByteAlignment) == 0,
         //           "DocTableDescriptor bufferOffset not aligned.");
@@ -129,6 +132,10 @@ namespace BitFunnel
           m_capacity(other.m_capacity),
           m_variableSizeBlobCount(other.m_variableSizeBlobCount),
           m_fixedSizeBlobOffsets(other.m_fixedSizeBlobOffsets),
+          m_hasTermSequenceBlob(other.m_hasTermSequenceBlob),
+          m_termSequenceBlob(other.m_termSequenceBlob),
+          m_hasStaticRankBlob(other.m_hasStaticRankBlob),
+          m_staticRankBlob(other.m_staticRankBlob),
           m_bytesPerItem(other.m_bytesPerItem)
 
     {
@@ -224,6 +231,50 @@ namespace BitFunnel
     }
 
 
+    bool DocTableDescriptor::TryGetTermSequenceBlob(VariableSizeBlobId& blob) const
+    {
+        blob = m_termSequenceBlob;
+        return m_hasTermSequenceBlob;
+    }
+
+
+    bool DocTableDescriptor::HasStaticRank() const
+    {
+        return m_hasStaticRankBlob;
+    }
+
+
+    StaticRank DocTableDescriptor::GetStaticRank(void* sliceBuffer,
+                                                 DocIndex index) const
+    {
+        StaticRank rank = 0;
+        if (m_hasStaticRankBlob)
+        {
+            // Fixed size blobs are packed, so the value may be unaligned.
+            memcpy(&rank,
+                   GetFixedSizeBlob(sliceBuffer, index, m_staticRankBlob),
+                   sizeof(rank));
+        }
+        return rank;
+    }
+
+
+    void DocTableDescriptor::SetStaticRank(void* sliceBuffer,
+                                           DocIndex index,
+                                           StaticRank rank) const
+    {
+        if (!m_hasStaticRankBlob)
+        {
+            RecoverableError error("DocTableDescriptor::SetStaticRank: schema has no static rank blob.");
+            throw error;
+        }
+
+        memcpy(GetFixedSizeBlob(sliceBuffer, index, m_staticRankBlob),
+               &rank,
+               sizeof(rank));
+    }
+
+
     DocId DocTableDescriptor::GetDocId(void* sliceBuffer, DocIndex index) const
     {
         void* item = GetItem(sliceBuffer, index);
@@ -240,6 +291,30 @@ namespace BitFunnel
     }
 
 
+    void DocTableDescriptor::CopyItem(void* fromBuffer,
+                                      DocIndex fromIndex,
+                                      void* toBuffer,
+                                      DocIndex toIndex) const
+    {
+        memcpy(GetItem(toBuffer, toIndex),
+               GetItem(fromBuffer, fromIndex),
+               m_bytesPerItem);
+
+        for (unsigned blob = 0; blob < m_variableSizeBlobCount; ++blob)
+        {
+            VariableSizeBlob& blobData =
+                GetVariableBlobRef(toBuffer, toIndex, blob);
+
+            if (blobData.m_data != nullptr)
+            {
+                void* data = malloc(blobData.m_size);
+                memcpy(data, blobData.m_data, blobData.m_size);
+                blobData.m_data = data;
+            }
+        }
+    }
+
+
     void* DocTableDescriptor::AllocateVariableSizeBlob(void* sliceBuffer,
                                                        DocIndex index,
                                                        VariableSizeBlobId blob,
@@ -125,12 +125,38 @@ namespace BitFunnel
                                DocIndex index,
                                FixedSizeBlobId blob) const;
 
+        // Returns true and sets blob to the id of the variable sized blob
+        // that holds the document's term sequences, if the schema has one.
+        bool TryGetTermSequenceBlob(VariableSizeBlobId& blob) const;
+
+        // Returns true if the schema has a static rank blob.
+        bool HasStaticRank() const;
+
+        // Returns the document's StaticRank, or 0 if the schema has no
+        // static rank blob.
+        StaticRank GetStaticRank(void* sliceBuffer, DocIndex index) const;
+
+        // Stores the document's StaticRank. Throws if the schema has no
+        // static rank blob.
+        void SetStaticRank(void* sliceBuffer,
+                           DocIndex index,
+                           StaticRank rank) const;
+
         // Returns the document's unique identifier.
         DocId GetDocId(void* sliceBuffer, DocIndex index) const;
 
         // Stores the document's unique identifier.
         void SetDocId(void* sliceBuffer, DocIndex index, DocId id) const;
 
+        // Copies the item at fromIndex in fromBuffer to toIndex in toBuffer.
+        // The variable sized blobs are duplicated, so both items remain
+        // valid until their buffers are cleaned up. The item at toIndex
+        // must not have any variable sized blobs allocated.
+        void CopyItem(void* fromBuffer,
+                      DocIndex fromIndex,
+                      void* toBuffer,
+                      DocIndex toIndex) const;
+
         //
         // NaviteJIT methods.
         //
@@ -203,6 +229,10 @@ namespace BitFunnel
         // self-contained and more performant.
         unsigned m_variableSizeBlobCount;
         std::vector<unsigned> m_fixedSizeBlobOffsets;
+        bool m_hasTermSequenceBlob;
+        VariableSizeBlobId m_termSequenceBlob;
+        bool m_hasStaticRankBlob;
+        FixedSizeBlobId m_staticRankBlob;
 
         // The number of bytes per single entry in the DocTable. Consists of
         // bytes required to store pointers to variable size blobs and fixed
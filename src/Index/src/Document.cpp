@@ -26,16 +26,20 @@
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/DocumentHandle.h"
 #include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/ResolvedTermCache.h"
 #include "Document.h"
 #include "LoggerInterfaces/Logging.h"
 
 
 namespace BitFunnel
 {
-    Document::Document(IConfiguration const & configuration, DocId id)
+    Document::Document(IConfiguration const & configuration,
+                       DocId id,
+                       bool storeTermSequence)
         : m_configuration(configuration),
           m_docId(id),
           m_maxGramSize(configuration.GetMaxGramSize()),
+          m_storeTermSequence(storeTermSequence),
           m_sourceByteSize(0),
           m_streamIsOpen(false)
     {
@@ -48,6 +52,12 @@ namespace BitFunnel
     }
 
 
+    bool Document::Contains(Term const & term) const
+    {
+        return m_postings.find(term) != m_postings.end();
+    }
+
+
     size_t Document::GetPostingCount() const
     {
         return m_postings.size();
@@ -62,9 +72,21 @@ namespace BitFunnel
 
     void Document::Ingest(DocumentHandle handle) const
     {
+        // Looking up the thread's cache once, rather than per posting.
+        ResolvedTermCache& cache = handle.GetResolvedTermCache();
         for (auto const & posting : m_postings)
         {
-            handle.AddPosting(posting);
+            handle.AddPosting(posting, cache);
+        }
+
+        if (m_storeTermSequence)
+        {
+            const size_t byteCount = m_termSequence.GetByteCount();
+            void* termSequence = handle.AllocateTermSequenceBlob(byteCount);
+            if (termSequence != nullptr)
+            {
+                m_termSequence.Write(termSequence);
+            }
         }
     }
 
@@ -80,6 +102,10 @@ namespace BitFunnel
             m_streamIsOpen = true;
 
             m_currentStreamId = id;
+            if (m_storeTermSequence)
+            {
+                m_termSequence.OpenStream(id);
+            }
 
             // Reset ring buffer just in case.
             m_ringBuffer.Reset();
@@ -99,9 +125,12 @@ namespace BitFunnel
             // TODO: Make it compute the unique posting count.
 
             // TODO: should we use the dfThreshold parameter instead of the fixed value?
-            new(m_ringBuffer.PushBack()) Term(termText,
-                                              m_currentStreamId,
-                                              m_configuration);
+            Term term(termText, m_currentStreamId, m_configuration);
+            new(m_ringBuffer.PushBack()) Term(term);
+            if (m_storeTermSequence)
+            {
+                m_termSequence.AddTerm(term);
+            }
 
             if (m_ringBuffer.GetCount() == m_maxGramSize)
             {
@@ -28,6 +28,7 @@
 #include "BitFunnel/Index/IDocument.h"      // Inherits from IDocument.
 #include "BitFunnel/Utilities/RingBuffer.h" // RingBuffer member.
 #include "BitFunnel/Term.h"                 // Term template parameter.
+#include "TermSequence.h"                   // TermSequence member.
 
 
 namespace BitFunnel
@@ -38,11 +39,20 @@ namespace BitFunnel
     class Document : public IDocument
     {
     public:
-        Document(IConfiguration const & config, DocId id);
+        // The term sequence is only recorded when storeTermSequence is
+        // true, which should be the case when the schema has a term
+        // sequence blob.
+        Document(IConfiguration const & config,
+                 DocId id,
+                 bool storeTermSequence = false);
 
         // TODO: Should GetDocId() be part of IDocument?
         DocId GetDocId() const;
 
+        // Returns true if the document has a posting for term. Only valid
+        // after CloseDocument().
+        bool Contains(Term const & term) const;
+
         //
         // IDocument methods
         //
@@ -99,6 +109,8 @@ namespace BitFunnel
         // Maximum size of ngrams that will be indexed.
         const size_t m_maxGramSize;
 
+        const bool m_storeTermSequence;
+
 
         //
         // Other members.
@@ -125,5 +137,9 @@ namespace BitFunnel
 
         // TODO: Replace unordered_set with alloc free version.
         std::unordered_set<Term, Term::Hasher> m_postings;
+
+        // Term fingerprints in stream order, stored in the DocTable when
+        // m_storeTermSequence is true.
+        TermSequence m_termSequence;
     };
 }
@@ -23,6 +23,7 @@
 
 #include <memory>
 
+#include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
 #include "DocumentDataSchema.h"
 
@@ -37,7 +38,11 @@ namespace BitFunnel
     // static const size_t s_bytesPerDocId = sizeof(DocId);
 
     DocumentDataSchema::DocumentDataSchema()
-        : m_variableSizeBlobCount(0)
+        : m_variableSizeBlobCount(0),
+          m_hasTermSequenceBlob(false),
+          m_termSequenceBlob(0),
+          m_hasStaticRankBlob(false),
+          m_staticRankBlob(0)
     {
     }
 
@@ -58,6 +63,46 @@ namespace BitFunnel
     }
 
 
+    VariableSizeBlobId DocumentDataSchema::RegisterTermSequenceBlob()
+    {
+        if (m_hasTermSequenceBlob)
+        {
+            throw FatalError("Term sequence blob has already been registered");
+        }
+
+        m_termSequenceBlob = RegisterVariableSizeBlob();
+        m_hasTermSequenceBlob = true;
+        return m_termSequenceBlob;
+    }
+
+
+    bool DocumentDataSchema::TryGetTermSequenceBlob(VariableSizeBlobId& blob) const
+    {
+        blob = m_termSequenceBlob;
+        return m_hasTermSequenceBlob;
+    }
+
+
+    FixedSizeBlobId DocumentDataSchema::RegisterStaticRankBlob()
+    {
+        if (m_hasStaticRankBlob)
+        {
+            throw FatalError("Static rank blob has already been registered");
+        }
+
+        m_staticRankBlob = RegisterFixedSizeBlob(sizeof(StaticRank));
+        m_hasStaticRankBlob = true;
+        return m_staticRankBlob;
+    }
+
+
+    bool DocumentDataSchema::TryGetStaticRankBlob(FixedSizeBlobId& blob) const
+    {
+        blob = m_staticRankBlob;
+        return m_hasStaticRankBlob;
+    }
+
+
     unsigned DocumentDataSchema::GetVariableSizeBlobCount() const
     {
         return m_variableSizeBlobCount;
@@ -49,6 +49,14 @@ namespace BitFunnel
         //
         virtual VariableSizeBlobId RegisterVariableSizeBlob() override;
         virtual FixedSizeBlobId RegisterFixedSizeBlob(unsigned byteCount) override;
+
+        virtual VariableSizeBlobId RegisterTermSequenceBlob() override;
+
+        virtual bool TryGetTermSequenceBlob(VariableSizeBlobId& blob) const override;
+
+        virtual FixedSizeBlobId RegisterStaticRankBlob() override;
+
+        virtual bool TryGetStaticRankBlob(FixedSizeBlobId& blob) const override;
         virtual unsigned GetVariableSizeBlobCount() const override;
         virtual std::vector<unsigned> const & GetFixedSizeBlobSizes() const override;
 
@@ -57,6 +65,14 @@ namespace BitFunnel
         // The number of variable sized blobs.
         unsigned m_variableSizeBlobCount;
 
+        // Id of the term sequence blob, if one has been registered.
+        bool m_hasTermSequenceBlob;
+        VariableSizeBlobId m_termSequenceBlob;
+
+        // Id of the static rank blob, if one has been registered.
+        bool m_hasStaticRankBlob;
+        FixedSizeBlobId m_staticRankBlob;
+
         // Sizes of the fixed-size per document data added by different
         // constituants of the document ingestion. FixedSizeBlobId acts as an
         // index into this array.
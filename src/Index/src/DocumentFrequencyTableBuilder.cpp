@@ -25,43 +25,354 @@
 #include <utility>
 #include <vector>
 
+#include "BitFunnel/Exceptions.h"
+#include "CountMinSketch.h"
 #include "DocumentFrequencyTable.h"
 #include "DocumentFrequencyTableBuilder.h"
+#include "HeavyHitters.h"
 #include "IndexedIdfTable.h"
 
 
 namespace BitFunnel
 {
+    //*************************************************************************
+    //
+    // DocumentFrequencyTableBuilder::ThreadCounts
+    //
+    // Term counts gathered by a single thread. In exact mode, the counts are
+    // moved out by MergeExactCounts(). In approximate mode they are kept and
+    // combined each time statistics are written.
+    //
+    //*************************************************************************
+    class DocumentFrequencyTableBuilder::ThreadCounts
+    {
+    public:
+        // Probability that a count exceeds the error bound.
+        static constexpr double c_failureProbability = 0.01;
+
+        // Exact mode.
+        ThreadCounts()
+          : m_currentDocument(0)
+        {
+        }
+
+        // Approximate mode.
+        ThreadCounts(double errorBound, size_t heavyHitterCount)
+          : m_currentDocument(0),
+            m_sketch(new CountMinSketch(errorBound, c_failureProbability)),
+            m_heavyHitters(new HeavyHitters(heavyHitterCount))
+        {
+        }
+
+        void OnDocumentEnter(size_t document)
+        {
+            m_currentDocument = document;
+        }
+
+        void OnTerm(Term term)
+        {
+            if (m_sketch.get() != nullptr)
+            {
+                m_sketch->Increment(term.GetRawHash());
+                m_heavyHitters->Increment(term);
+            }
+            else
+            {
+                auto it = m_terms.find(term);
+                if (it == m_terms.end())
+                {
+                    TermRecord record;
+                    record.m_count = 1;
+                    record.m_firstDocument = m_currentDocument;
+                    m_terms.insert(std::make_pair(term, record));
+                }
+                else
+                {
+                    ++it->second.m_count;
+                }
+            }
+        }
+
+        TermRecords & GetTerms()
+        {
+            return m_terms;
+        }
+
+        CountMinSketch const & GetSketch() const
+        {
+            return *m_sketch;
+        }
+
+        HeavyHitters const & GetHeavyHitters() const
+        {
+            return *m_heavyHitters;
+        }
+
+    private:
+        size_t m_currentDocument;
+
+        TermRecords m_terms;
+
+        std::unique_ptr<CountMinSketch> m_sketch;
+        std::unique_ptr<HeavyHitters> m_heavyHitters;
+    };
+
+
+    //*************************************************************************
+    //
+    // DocumentFrequencyTableBuilder
+    //
+    //*************************************************************************
+    std::atomic<uint64_t> DocumentFrequencyTableBuilder::s_nextInstanceId(0);
+
+
+    DocumentFrequencyTableBuilder::DocumentFrequencyTableBuilder()
+      : m_isApproximate(false),
+        m_errorBound(0.0),
+        m_heavyHitterCount(0),
+        m_documentCount(0),
+        m_instanceId(s_nextInstanceId++)
+    {
+    }
+
+
+    DocumentFrequencyTableBuilder::DocumentFrequencyTableBuilder(
+        double errorBound,
+        size_t heavyHitterCount)
+      : m_isApproximate(true),
+        m_errorBound(errorBound),
+        m_heavyHitterCount(heavyHitterCount),
+        m_documentCount(0),
+        m_instanceId(s_nextInstanceId++)
+    {
+        if (!(errorBound > 0.0 && errorBound < 1.0) || heavyHitterCount == 0)
+        {
+            RecoverableError error("DocumentFrequencyTableBuilder: invalid approximation parameters.");
+            throw error;
+        }
+    }
+
+
+    DocumentFrequencyTableBuilder::~DocumentFrequencyTableBuilder()
+    {
+    }
+
+
     void DocumentFrequencyTableBuilder::OnDocumentEnter()
     {
-        m_cumulativeTermCounts.push_back(m_termCounts.size());
+        GetThreadCounts().OnDocumentEnter(m_documentCount++);
     }
 
 
     void DocumentFrequencyTableBuilder::OnTerm(Term t)
     {
-        ++m_termCounts[t];
+        GetThreadCounts().OnTerm(t);
     }
 
 
-    // Write out sorted truncated list, sorted by count (TODO: frequency).
-    void DocumentFrequencyTableBuilder::WriteFrequencies(std::ostream& output,
-                                                         double truncateBelowFrequency,
-                                                         TermToText const * termToText) const
+    DocumentFrequencyTableBuilder::ThreadCounts &
+        DocumentFrequencyTableBuilder::GetThreadCounts()
     {
-        DocumentFrequencyTable table;
+        struct Entry
+        {
+            uint64_t m_instanceId;
+            ThreadCounts* m_counts;
+        };
+
+        // Builders are rarely destroyed, so entries for destroyed builders
+        // are simply never matched again.
+        thread_local std::vector<Entry> t_counts;
+
+        for (auto const & entry : t_counts)
+        {
+            if (entry.m_instanceId == m_instanceId)
+            {
+                return *entry.m_counts;
+            }
+        }
+
+        std::unique_ptr<ThreadCounts>
+            counts(m_isApproximate ?
+                   new ThreadCounts(m_errorBound, m_heavyHitterCount) :
+                   new ThreadCounts());
+        ThreadCounts* result = counts.get();
+        {
+            std::lock_guard<std::mutex> lock(m_threadCountsLock);
+            m_threadCounts.push_back(std::move(counts));
+        }
+
+        Entry entry;
+        entry.m_instanceId = m_instanceId;
+        entry.m_counts = result;
+        t_counts.push_back(entry);
+
+        return *result;
+    }
+
+
+    std::vector<std::pair<Term, double>>
+        DocumentFrequencyTableBuilder::GetFrequencies(
+            double truncateBelowFrequency) const
+    {
+        if (m_isApproximate)
+        {
+            return GetApproximateFrequencies(truncateBelowFrequency);
+        }
+
+        MergeExactCounts();
+
+        std::vector<std::pair<Term, double>> frequencies;
 
         // For each term count record, compute the document frequency then
         // add to entries if frequency is above threshold.
         for (auto const & entry : m_termCounts)
         {
-            double frequency = static_cast<double>(entry.second) / m_cumulativeTermCounts.size();
+            double frequency = static_cast<double>(entry.second.m_count) / m_documentCount;
+            if (frequency >= truncateBelowFrequency)
+            {
+                frequencies.push_back(std::make_pair(entry.first, frequency));
+            }
+        }
+
+        return frequencies;
+    }
+
+
+    void DocumentFrequencyTableBuilder::MergeExactCounts() const
+    {
+        std::lock_guard<std::mutex> lock(m_threadCountsLock);
+
+        for (auto const & counts : m_threadCounts)
+        {
+            TermRecords & terms = counts->GetTerms();
+            if (m_termCounts.empty())
+            {
+                m_termCounts.swap(terms);
+                continue;
+            }
+
+            for (auto const & entry : terms)
+            {
+                auto it = m_termCounts.find(entry.first);
+                if (it == m_termCounts.end())
+                {
+                    m_termCounts.insert(entry);
+                }
+                else
+                {
+                    it->second.m_count += entry.second.m_count;
+                    it->second.m_firstDocument =
+                        std::min(it->second.m_firstDocument,
+                                 entry.second.m_firstDocument);
+                }
+            }
+            terms.clear();
+        }
+    }
+
+
+    // Must only be called when m_threadCounts is not empty.
+    CountMinSketch DocumentFrequencyTableBuilder::GetMergedSketch() const
+    {
+        // Count-min sketches with the same dimensions add exactly.
+        CountMinSketch sketch(m_threadCounts[0]->GetSketch());
+        for (size_t i = 1; i < m_threadCounts.size(); ++i)
+        {
+            sketch.Merge(m_threadCounts[i]->GetSketch());
+        }
+        return sketch;
+    }
+
+
+    std::vector<std::pair<Term, double>>
+        DocumentFrequencyTableBuilder::GetApproximateFrequencies(
+            double truncateBelowFrequency) const
+    {
+        std::vector<std::pair<Term, double>> frequencies;
+        if (m_threadCounts.empty())
+        {
+            return frequencies;
+        }
+
+        CountMinSketch sketch(GetMergedSketch());
+
+        // Any term in the overall top heavyHitterCount is monitored by at
+        // least one thread. For each candidate, sum the per-thread upper
+        // bounds. A thread that doesn't monitor the term contributes its
+        // minimum count. Then use the tighter of that sum and the sketch.
+        std::unordered_map<Term, uint64_t, Term::Hasher> candidates;
+        for (auto const & counts : m_threadCounts)
+        {
+            for (auto const & entry : counts->GetHeavyHitters())
+            {
+                candidates.insert(std::make_pair(entry.GetTerm(), 0));
+            }
+        }
+
+        std::vector<std::pair<Term, uint64_t>> estimates;
+        estimates.reserve(candidates.size());
+        for (auto const & candidate : candidates)
+        {
+            const Term term = candidate.first;
+
+            uint64_t bound = 0;
+            for (auto const & counts : m_threadCounts)
+            {
+                uint64_t count;
+                if (!counts->GetHeavyHitters().TryGetCount(term, count))
+                {
+                    count = counts->GetHeavyHitters().GetMinCount();
+                }
+                bound += count;
+            }
+
+            estimates.push_back(
+                std::make_pair(term,
+                               std::min(bound, sketch.Estimate(term.GetRawHash()))));
+        }
+
+        // Keep the heavyHitterCount largest estimates.
+        if (estimates.size() > m_heavyHitterCount)
+        {
+            std::nth_element(estimates.begin(),
+                             estimates.begin() + m_heavyHitterCount,
+                             estimates.end(),
+                             [](std::pair<Term, uint64_t> const & a,
+                                std::pair<Term, uint64_t> const & b)
+                             {
+                                 return a.second > b.second;
+                             });
+            estimates.erase(estimates.begin() + m_heavyHitterCount,
+                            estimates.end());
+        }
+
+        const double documentCount = static_cast<double>(m_documentCount);
+        for (auto const & estimate : estimates)
+        {
+            double frequency =
+                std::min(static_cast<double>(estimate.second) / documentCount, 1.0);
             if (frequency >= truncateBelowFrequency)
             {
-                table.AddEntry(DocumentFrequencyTable::Entry(entry.first, frequency));
+                frequencies.push_back(std::make_pair(estimate.first, frequency));
             }
         }
 
+        return frequencies;
+    }
+
+
+    // Write out sorted truncated list, sorted by count (TODO: frequency).
+    void DocumentFrequencyTableBuilder::WriteFrequencies(std::ostream& output,
+                                                         double truncateBelowFrequency,
+                                                         TermToText const * termToText) const
+    {
+        DocumentFrequencyTable table;
+
+        for (auto const & entry : GetFrequencies(truncateBelowFrequency))
+        {
+            table.AddEntry(DocumentFrequencyTable::Entry(entry.first, entry.second));
+        }
+
         table.Write(output, termToText);
     }
 
@@ -73,19 +384,13 @@ namespace BitFunnel
         typedef std::pair<Term::Hash, Term::IdfX10> Entry;
         std::vector<Entry> entries;
 
-        // For each term count record, compute the document frequency then
-        // add to entries if frequency is above threshold.
-        for (auto const & entry : m_termCounts)
+        for (auto const & entry : GetFrequencies(truncateBelowFrequency))
         {
-            double frequency = static_cast<double>(entry.second) / m_cumulativeTermCounts.size();
-            if (frequency >= truncateBelowFrequency)
-            {
-                const Term::Hash hash = entry.first.GetRawHash();
-                const Term::IdfX10 idf = 
-                    Term::ComputeIdfX10(frequency, Term::c_maxIdfX10Value);
+            const Term::Hash hash = entry.first.GetRawHash();
+            const Term::IdfX10 idf =
+                Term::ComputeIdfX10(entry.second, Term::c_maxIdfX10Value);
 
-                entries.push_back(std::make_pair(hash, idf));
-            }
+            entries.push_back(std::make_pair(hash, idf));
         }
 
         IndexedIdfTable::WriteHeader(output, entries.size());
@@ -98,9 +403,37 @@ namespace BitFunnel
 
     void DocumentFrequencyTableBuilder::WriteCumulativeTermCounts(std::ostream& output) const
     {
-        for (size_t i = 0; i < m_cumulativeTermCounts.size(); ++i)
+        if (m_isApproximate)
+        {
+            // The growth curve isn't tracked. Write a single entry with the
+            // estimated number of unique terms.
+            if (!m_threadCounts.empty())
+            {
+                output << m_documentCount << ","
+                       << static_cast<size_t>(GetMergedSketch().EstimateDistinctCount())
+                       << std::endl;
+            }
+            return;
+        }
+
+        MergeExactCounts();
+
+        // Entry i is the number of unique terms in the documents before
+        // document i.
+        std::vector<size_t> newTermCounts(m_documentCount, 0);
+        for (auto const & entry : m_termCounts)
+        {
+            if (entry.second.m_firstDocument < newTermCounts.size())
+            {
+                ++newTermCounts[entry.second.m_firstDocument];
+            }
+        }
+
+        size_t uniqueTermCount = 0;
+        for (size_t i = 0; i < newTermCounts.size(); ++i)
         {
-            output << i << "," << m_cumulativeTermCounts[i] << std::endl;
+            output << i << "," << uniqueTermCount << std::endl;
+            uniqueTermCount += newTermCounts[i];
         }
     }
 }
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>           // std::atomic member.
 #include <iosfwd>           // std::ostream parameter.
+#include <memory>           // std::unique_ptr member.
+#include <mutex>            // std::mutex member.
+#include <stdint.h>         // uint64_t member.
 #include <unordered_map>    // std::unordered_map member.
+#include <utility>          // std::pair return value.
 #include <vector>           // std::vector member.
 
 #include "BitFunnel/Term.h" // Term and Term::Hasher template parameters.
@@ -9,6 +14,7 @@
 
 namespace BitFunnel
 {
+    class CountMinSketch;
     class TermToText;
 
     //*************************************************************************
@@ -31,13 +37,44 @@ namespace BitFunnel
     //
     // OnDocumentEnter() should be called once for each document. Then OnTerm()
     // is called once for each unique term in the document. OnDocumentEnter()
-    // should not be called again until all terms in the current document have
-    // been recorded via calls to OnTerm().
+    // should not be called again on the same thread until all terms in the
+    // current document have been recorded via calls to OnTerm().
+    //
+    // Each thread that calls OnDocumentEnter() or OnTerm() records its terms
+    // in its own ThreadCounts, so ingestion threads never contend. The
+    // ThreadCounts are merged when the statistics are written. In exact mode,
+    // each term remembers the first document in which it appeared, which is
+    // enough to rebuild the Cumulative Term Count table after the merge.
+    //
+    // APPROXIMATE MODE. The exact map grows with the vocabulary, which is
+    // unbounded on large corpora. In approximate mode, each thread records
+    // terms in a CountMinSketch and HeavyHitters set instead, so memory is
+    // fixed at roughly
+    //     threads * (20 * e / errorBound + 64 * heavyHitterCount)
+    // bytes. The Document Frequency Table then holds the heavyHitterCount
+    // terms with the highest estimated counts. Each count is overestimated by
+    // at most errorBound times the total number of OnTerm() calls, with
+    // probability 0.99. A term is guaranteed to be a candidate if its count
+    // exceeds the total number of OnTerm() calls divided by
+    // heavyHitterCount. The Cumulative Term Count table only has a single
+    // entry, with an estimate of the number of unique terms.
+    //
+    // Thread safety: OnDocumentEnter() and OnTerm() may be called
+    // concurrently, but not concurrently with the Write methods.
     //
     //*************************************************************************
     class DocumentFrequencyTableBuilder
     {
     public:
+        // Constructs a builder that counts terms exactly.
+        DocumentFrequencyTableBuilder();
+
+        // Constructs a builder in approximate mode.
+        DocumentFrequencyTableBuilder(double errorBound,
+                                      size_t heavyHitterCount);
+
+        ~DocumentFrequencyTableBuilder();
+
         void OnDocumentEnter();
         void OnTerm(Term t);
 
@@ -70,7 +107,52 @@ namespace BitFunnel
         void WriteCumulativeTermCounts(std::ostream& output) const;
 
     private:
-        std::vector<size_t> m_cumulativeTermCounts;
-        std::unordered_map<Term, size_t, Term::Hasher> m_termCounts;
+        class ThreadCounts;
+
+        // Returns the ThreadCounts for the calling thread, creating it on
+        // first use.
+        ThreadCounts & GetThreadCounts();
+
+        // Returns (Term, frequency) pairs for terms with frequency at least
+        // truncateBelowFrequency.
+        std::vector<std::pair<Term, double>>
+            GetFrequencies(double truncateBelowFrequency) const;
+
+        std::vector<std::pair<Term, double>>
+            GetApproximateFrequencies(double truncateBelowFrequency) const;
+
+        // Folds the exact per-thread counts into m_termCounts.
+        void MergeExactCounts() const;
+
+        // Returns the sum of the per-thread sketches.
+        CountMinSketch GetMergedSketch() const;
+
+        class TermRecord
+        {
+        public:
+            size_t m_count;
+
+            // Index of the first document, in OnDocumentEnter() order, that
+            // contained the term.
+            size_t m_firstDocument;
+        };
+
+        typedef std::unordered_map<Term, TermRecord, Term::Hasher> TermRecords;
+
+        // Exact counts merged from all threads.
+        mutable TermRecords m_termCounts;
+
+        const bool m_isApproximate;
+        const double m_errorBound;
+        const size_t m_heavyHitterCount;
+
+        std::atomic<size_t> m_documentCount;
+
+        // Identifies this builder in the per-thread lookup.
+        const uint64_t m_instanceId;
+        static std::atomic<uint64_t> s_nextInstanceId;
+
+        mutable std::mutex m_threadCountsLock;
+        std::vector<std::unique_ptr<ThreadCounts>> m_threadCounts;
     };
 }
@@ -53,6 +53,18 @@ namespace BitFunnel
     }
 
 
+    void* DocumentHandle::AllocateTermSequenceBlob(size_t byteSize)
+    {
+        VariableSizeBlobId id;
+        if (!m_slice->GetDocTable().TryGetTermSequenceBlob(id))
+        {
+            return nullptr;
+        }
+
+        return AllocateVariableSizeBlob(id, byteSize);
+    }
+
+
     void* DocumentHandle::GetVariableSizeBlob(VariableSizeBlobId id) const
     {
         return m_slice->GetDocTable().
@@ -77,9 +89,34 @@ namespace BitFunnel
     }
 
 
+    void DocumentHandle::SetStaticRank(StaticRank rank)
+    {
+        m_slice->SetStaticRank(rank, m_index);
+    }
+
+
+    StaticRank DocumentHandle::GetStaticRank() const
+    {
+        return m_slice->GetDocTable().GetStaticRank(m_slice->GetSliceBuffer(),
+                                                    m_index);
+    }
+
+
     void DocumentHandle::AddPosting(Term const & term)
     {
-        m_slice->AddPosting(term, m_index);
+        m_slice->AddPosting(term, m_index, m_slice->GetResolvedTermCache());
+    }
+
+
+    void DocumentHandle::AddPosting(Term const & term, ResolvedTermCache& cache)
+    {
+        m_slice->AddPosting(term, m_index, cache);
+    }
+
+
+    ResolvedTermCache& DocumentHandle::GetResolvedTermCache() const
+    {
+        return m_slice->GetResolvedTermCache();
     }
 
 
@@ -141,6 +178,12 @@ namespace BitFunnel
     }
 
 
+    DocumentHandleInternal::DocumentHandleInternal(Slice* slice, DocIndex index)
+        : DocumentHandle(slice, index)
+    {
+    }
+
+
     DocumentHandleInternal::DocumentHandleInternal(DocumentHandle const & handle)
         : DocumentHandle(handle)
     {
@@ -168,8 +211,5 @@ namespace BitFunnel
         rowTable.SetBit(m_slice->GetSliceBuffer(),
                         documentActiveRowId.GetIndex(),
                         m_index);
-
-        // TODO: add back statistics.
-        // m_slice->GetShard().TemporaryRecordDocument();
     }
 }
@@ -56,6 +56,10 @@ namespace BitFunnel
         // Constructs a handle from slice and offset (index) in the slice.
         DocumentHandleInternal(Slice* slice, DocIndex index, DocId id);
 
+        // Constructs a handle to a document already in the slice, leaving
+        // its DocTable entry unchanged.
+        DocumentHandleInternal(Slice* slice, DocIndex index);
+
         // Copy constructor to convert from DocumentHandle. Required by
         // IIndex::Add which converts the output of IIndex::AllocateDocument
         // from DocumentHandle to DocumentHandleInternal.
@@ -27,25 +27,74 @@
 
 namespace BitFunnel
 {
-    DocumentLengthHistogram::DocumentLengthHistogram()
+    std::atomic<uint64_t> DocumentLengthHistogram::s_nextInstanceId(0);
+
+
+    DocumentLengthHistogram::ThreadHistogram::ThreadHistogram()
         : m_totalCount(0)
     {
     }
 
 
-    void DocumentLengthHistogram::AddDocument(size_t postingCount)
+    DocumentLengthHistogram::DocumentLengthHistogram()
+        : m_instanceId(s_nextInstanceId++)
     {
+    }
+
+
+    DocumentLengthHistogram::DocumentLengthHistogram(std::istream& input)
+        : m_instanceId(s_nextInstanceId++)
+    {
+        CsvTsv::CsvTableParser parser(input);
+        CsvTsv::TableReader reader(parser);
+
+        CsvTsv::InputColumn<uint64_t> postingCount(
+            "Postings",
+            "Total postings in a document.");
+        CsvTsv::InputColumn<uint64_t> numDocs(
+            "Count",
+            "Number of documents that have a given posting count.");
+
+        reader.DefineColumn(postingCount);
+        reader.DefineColumn(numDocs);
+        reader.ReadPrologue();
+
+        // The histogram is loaded into the calling thread's histogram.
+        ThreadHistogram& histogram = GetThreadHistogram();
+        const std::lock_guard<std::mutex> lock(histogram.m_lock);
+
+        while (!reader.AtEOF())
         {
-            const std::lock_guard<std::mutex> lock(m_lock);
-            ++m_hist[postingCount];
+            reader.ReadDataRow();
+            histogram.m_hist[postingCount] += numDocs;
+            histogram.m_totalCount += postingCount * numDocs;
         }
-        m_totalCount += postingCount;
+
+        reader.ReadEpilogue();
+    }
+
+
+    void DocumentLengthHistogram::AddDocument(size_t postingCount)
+    {
+        ThreadHistogram& histogram = GetThreadHistogram();
+
+        const std::lock_guard<std::mutex> lock(histogram.m_lock);
+        ++histogram.m_hist[postingCount];
+        histogram.m_totalCount += postingCount;
     }
 
 
     size_t DocumentLengthHistogram::GetPostingCount() const
     {
-        return m_totalCount;
+        const std::lock_guard<std::mutex> lock(m_lock);
+
+        size_t totalCount = 0;
+        for (auto const & histogram : m_threadHistograms)
+        {
+            const std::lock_guard<std::mutex> threadLock(histogram->m_lock);
+            totalCount += histogram->m_totalCount;
+        }
+        return totalCount;
     }
 
 
@@ -53,15 +102,71 @@ namespace BitFunnel
     {
         const std::lock_guard<std::mutex> lock(m_lock);
 
-        const auto kvPair = m_hist.find(postingCount);
-        if (kvPair != m_hist.end())
+        size_t count = 0;
+        for (auto const & histogram : m_threadHistograms)
+        {
+            const std::lock_guard<std::mutex> threadLock(histogram->m_lock);
+            const auto kvPair = histogram->m_hist.find(postingCount);
+            if (kvPair != histogram->m_hist.end())
+            {
+                count += kvPair->second;
+            }
+        }
+        return count;
+    }
+
+
+    DocumentLengthHistogram::ThreadHistogram&
+        DocumentLengthHistogram::GetThreadHistogram()
+    {
+        struct Entry
+        {
+            uint64_t m_instanceId;
+            ThreadHistogram* m_histogram;
+        };
+
+        // Histograms are rarely destroyed, so entries for destroyed
+        // histograms are simply never matched again.
+        thread_local std::vector<Entry> t_histograms;
+
+        for (auto const & entry : t_histograms)
         {
-            return kvPair->second;
+            if (entry.m_instanceId == m_instanceId)
+            {
+                return *entry.m_histogram;
+            }
         }
-        else
+
+        std::unique_ptr<ThreadHistogram> histogram(new ThreadHistogram());
+        ThreadHistogram* result = histogram.get();
+        {
+            const std::lock_guard<std::mutex> lock(m_lock);
+            m_threadHistograms.push_back(std::move(histogram));
+        }
+
+        Entry entry;
+        entry.m_instanceId = m_instanceId;
+        entry.m_histogram = result;
+        t_histograms.push_back(entry);
+
+        return *result;
+    }
+
+
+    std::map<size_t, size_t> DocumentLengthHistogram::GetMergedHistogram() const
+    {
+        const std::lock_guard<std::mutex> lock(m_lock);
+
+        std::map<size_t, size_t> merged;
+        for (auto const & histogram : m_threadHistograms)
         {
-            return 0;
+            const std::lock_guard<std::mutex> threadLock(histogram->m_lock);
+            for (auto const & kvPair : histogram->m_hist)
+            {
+                merged[kvPair.first] += kvPair.second;
+            }
         }
+        return merged;
     }
 
 
@@ -84,7 +189,7 @@ namespace BitFunnel
         writer.DefineColumn(numDocs);
         writer.WritePrologue();
 
-        for (const auto & kvPairs : m_hist)
+        for (const auto & kvPairs : GetMergedHistogram())
         {
             postingCount = kvPairs.first;
             numDocs = kvPairs.second;
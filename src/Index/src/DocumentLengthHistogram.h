@@ -25,7 +25,10 @@
 #include <atomic>   // std::atomic member
 #include <iosfwd>   // std::ostream parameter
 #include <map>      // std::map member
+#include <memory>   // std::unique_ptr member
 #include <mutex>    // std::mutex member
+#include <stdint.h> // uint64_t member
+#include <vector>   // std::vector member
 
 #include "BitFunnel/NonCopyable.h"
 
@@ -44,22 +47,47 @@ namespace BitFunnel
         DocumentLengthHistogram(std::istream& input);
         DocumentLengthHistogram();
 
-        // AddDocument is thread safe with multiple writers.
+        // AddDocument is thread safe with multiple writers. Each thread
+        // records documents in its own histogram, so writers only take an
+        // uncontended lock. The per-thread histograms are combined by the
+        // readers below.
         void AddDocument(size_t postingCount);
 
         size_t GetPostingCount() const;
 
-        // AddDocument is thread safe with multiple readers and writers.
+        // GetValue is thread safe with multiple readers and writers.
         size_t GetValue(size_t postingCount) const;
 
+        // Returns the number of documents for each posting count, summed
+        // over all threads.
+        std::map<size_t, size_t> GetMergedHistogram() const;
+
         // Persists the contents of the histogram to a stream, not thread-safe
         void Write(std::ostream& output) const;
 
 
     private:
-        std::map<size_t, size_t> m_hist;
+        class ThreadHistogram
+        {
+        public:
+            ThreadHistogram();
+
+            // Guards the members below against readers on other threads.
+            std::mutex m_lock;
+            std::map<size_t, size_t> m_hist;
+            size_t m_totalCount;
+        };
+
+        // Returns the histogram for the calling thread, creating it on first
+        // use.
+        ThreadHistogram& GetThreadHistogram();
+
+        // Identifies this histogram in the per-thread lookup.
+        const uint64_t m_instanceId;
+        static std::atomic<uint64_t> s_nextInstanceId;
+
+        // Guards m_threadHistograms.
         mutable std::mutex m_lock;
-
-        std::atomic<size_t> m_totalCount;
+        std::vector<std::unique_ptr<ThreadHistogram>> m_threadHistograms;
     };
 }
@@ -1,7 +1,9 @@
 #include <sstream>
 
 #include "BitFunnel/Exceptions.h"
+#include "DocTableDescriptor.h"
 #include "DocumentMap.h"
+#include "Slice.h"
 
 
 namespace BitFunnel
@@ -62,4 +64,42 @@ namespace BitFunnel
 
         return found;
     }
+
+
+    void DocumentMap::DeleteSlice(Slice& slice)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        DocTableDescriptor const & docTable = slice.GetDocTable();
+        void* sliceBuffer = slice.GetSliceBuffer();
+
+        for (DocIndex index = 0; index < slice.GetCapacity(); ++index)
+        {
+            // Unallocated columns of a sealed Slice hold arbitrary DocIds,
+            // so only remove entries that point back at this column.
+            auto it = m_docIdToDocHandle.find(docTable.GetDocId(sliceBuffer,
+                                                                index));
+            if (it != m_docIdToDocHandle.end() &&
+                it->second.GetSlice() == &slice &&
+                it->second.GetIndex() == index)
+            {
+                m_docIdToDocHandle.erase(it);
+            }
+        }
+    }
+
+
+    void DocumentMap::Relocate(DocumentHandleInternal const & from,
+                               DocumentHandleInternal const & to)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto it = m_docIdToDocHandle.find(to.GetDocId());
+        if (it != m_docIdToDocHandle.end() &&
+            it->second.GetSlice() == from.GetSlice() &&
+            it->second.GetIndex() == from.GetIndex())
+        {
+            it->second = to;
+        }
+    }
 }
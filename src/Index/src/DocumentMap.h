@@ -10,6 +10,8 @@
 
 namespace BitFunnel
 {
+    class Slice;
+
     class DocumentMap : NonCopyable
     {
     public:
@@ -34,6 +36,15 @@ namespace BitFunnel
         // Returns true otherwise.
         bool Delete(DocId id);
 
+        // Deletes the entries for all documents in the given Slice. Entries
+        // for the same DocIds that refer to other Slices are left alone.
+        void DeleteSlice(Slice& slice);
+
+        // Points the entry for the document at from to its new location. The
+        // entry is left alone if it no longer refers to from.
+        void Relocate(DocumentHandleInternal const & from,
+                      DocumentHandleInternal const & to);
+
     private:
         // Lock protecting operations on m_docIdToHandle.
         // Made mutable to allow using it from const functions.
@@ -117,7 +117,14 @@ namespace BitFunnel
 
     FactSetBase::FactInfo const & FactSetBase::GetFactInfoByHandle(FactHandle handle) const
     {
-        const size_t factIndex = handle;
+        // User defined handles start after the system terms.
+        if (handle < ITermTable2::SystemTerm::Count)
+        {
+            throw RecoverableError("FactSetBase: not a user defined fact.");
+        }
+
+        const size_t factIndex =
+            static_cast<size_t>(handle - ITermTable2::SystemTerm::Count);
         return m_facts.at(factIndex);
     }
 }
@@ -0,0 +1,506 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>                            // std::binary_search().
+#include <memory>                               // std::unique_ptr.
+#include <ostream>
+
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "BitFunnel/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
+#include "ChunkReader.h"
+#include "ChunkTasks.h"
+#include "DocTableDescriptor.h"
+#include "Document.h"
+#include "FalsePositiveAnalyzer.h"
+#include "RowTableDescriptor.h"
+#include "Shard.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // FalsePositiveAnalyzer::GroundTruthBuilder
+    //
+    // Builds a Document for each document in a chunk and records which of
+    // the query terms it contains.
+    //
+    //*************************************************************************
+    class FalsePositiveAnalyzer::GroundTruthBuilder : public ChunkReader::IEvents
+    {
+    public:
+        GroundTruthBuilder(IConfiguration const & config,
+                           std::vector<Term> const & terms)
+          : m_config(config),
+            m_terms(terms)
+        {
+        }
+
+        virtual void OnFileEnter() override
+        {
+        }
+
+        virtual void OnDocumentEnter(DocId id) override
+        {
+            m_document.reset(new Document(m_config, id));
+        }
+
+        virtual void OnStreamEnter(Term::StreamId id) override
+        {
+            m_document->OpenStream(id);
+        }
+
+        virtual void OnTerm(char const * term) override
+        {
+            m_document->AddTerm(term);
+        }
+
+        virtual void OnStreamExit() override
+        {
+            m_document->CloseStream();
+        }
+
+        virtual void OnDocumentExit(size_t bytesRead) override
+        {
+            m_document->CloseDocument(bytesRead);
+
+            std::vector<size_t> terms;
+            for (size_t i = 0; i < m_terms.size(); ++i)
+            {
+                if (m_document->Contains(m_terms[i]))
+                {
+                    terms.push_back(i);
+                }
+            }
+
+            if (!terms.empty())
+            {
+                m_documents.push_back(
+                    std::make_pair(m_document->GetDocId(), std::move(terms)));
+            }
+
+            m_document.reset(nullptr);
+        }
+
+        virtual void OnFileExit() override
+        {
+        }
+
+        std::vector<std::pair<DocId, std::vector<size_t>>>& GetDocuments()
+        {
+            return m_documents;
+        }
+
+    private:
+        IConfiguration const & m_config;
+        std::vector<Term> const & m_terms;
+        std::unique_ptr<Document> m_document;
+        std::vector<std::pair<DocId, std::vector<size_t>>> m_documents;
+    };
+
+
+    //*************************************************************************
+    //
+    // FalsePositiveAnalyzer::ChunkProcessor
+    //
+    // Each task is one chunk file.
+    //
+    //*************************************************************************
+    class FalsePositiveAnalyzer::ChunkProcessor : public ITaskProcessor
+    {
+    public:
+        ChunkProcessor(FalsePositiveAnalyzer& analyzer,
+                       std::vector<std::string> const & filePaths,
+                       IConfiguration const & config)
+          : m_analyzer(analyzer),
+            m_filePaths(filePaths),
+            m_config(config)
+        {
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            m_analyzer.AddChunk(ChunkTasks::ReadFile(m_filePaths[taskId]),
+                                m_config);
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        FalsePositiveAnalyzer& m_analyzer;
+        std::vector<std::string> const & m_filePaths;
+        IConfiguration const & m_config;
+    };
+
+
+    //*************************************************************************
+    //
+    // FalsePositiveAnalyzer::SliceProcessor
+    //
+    // Each task is one slice. Counts are accumulated per thread and merged
+    // after all slices have been processed.
+    //
+    //*************************************************************************
+    class FalsePositiveAnalyzer::SliceProcessor : public ITaskProcessor
+    {
+    public:
+        struct ShardInfo
+        {
+            Shard const * m_shard;
+            RowId m_documentActiveRow;
+            // Rows for all terms of each query.
+            std::vector<std::vector<RowId>> m_queryRows;
+        };
+
+        struct SliceTask
+        {
+            size_t m_shardIndex;
+            void* m_sliceBuffer;
+        };
+
+        SliceProcessor(FalsePositiveAnalyzer const & analyzer,
+                       std::vector<ShardInfo> const & shards,
+                       std::vector<SliceTask> const & tasks)
+          : m_analyzer(analyzer),
+            m_shards(shards),
+            m_tasks(tasks),
+            m_counts(analyzer.m_queries.size(), Counts{0, 0, 0})
+        {
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            SliceTask const & task = m_tasks[taskId];
+            ShardInfo const & info = m_shards[task.m_shardIndex];
+            Shard const & shard = *info.m_shard;
+            void* sliceBuffer = task.m_sliceBuffer;
+
+            RowTableDescriptor const & rank0 = shard.GetRowTable(0);
+            const DocIndex capacity = shard.GetSliceCapacity();
+            const std::vector<size_t> noTerms;
+
+            for (DocIndex index = 0; index < capacity; ++index)
+            {
+                if (rank0.GetBit(sliceBuffer,
+                                 info.m_documentActiveRow.GetIndex(),
+                                 index) == 0)
+                {
+                    continue;
+                }
+
+                const DocId id = shard.GetDocTable().GetDocId(sliceBuffer, index);
+                auto it = m_analyzer.m_documents.find(id);
+                std::vector<size_t> const & terms =
+                    (it == m_analyzer.m_documents.end()) ? noTerms : it->second;
+
+                for (size_t q = 0; q < m_counts.size(); ++q)
+                {
+                    bool exact = true;
+                    for (auto term : m_analyzer.m_queries[q])
+                    {
+                        if (!std::binary_search(terms.begin(), terms.end(), term))
+                        {
+                            exact = false;
+                            break;
+                        }
+                    }
+
+                    bool bits = true;
+                    for (auto row : info.m_queryRows[q])
+                    {
+                        if (shard.GetRowTable(row.GetRank()).GetBit(sliceBuffer,
+                                                                    row.GetIndex(),
+                                                                    index) == 0)
+                        {
+                            bits = false;
+                            break;
+                        }
+                    }
+
+                    Counts& counts = m_counts[q];
+                    if (exact)
+                    {
+                        ++counts.m_matches;
+                        if (!bits)
+                        {
+                            ++counts.m_falseNegatives;
+                        }
+                    }
+                    else if (bits)
+                    {
+                        ++counts.m_falsePositives;
+                    }
+                }
+            }
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+        std::vector<Counts> const & GetCounts() const
+        {
+            return m_counts;
+        }
+
+    private:
+        FalsePositiveAnalyzer const & m_analyzer;
+        std::vector<ShardInfo> const & m_shards;
+        std::vector<SliceTask> const & m_tasks;
+        std::vector<Counts> m_counts;
+    };
+
+
+    //*************************************************************************
+    //
+    // FalsePositiveAnalyzer
+    //
+    //*************************************************************************
+    FalsePositiveAnalyzer::FalsePositiveAnalyzer(
+        std::vector<std::vector<Term>> const & queries)
+      : m_counts(queries.size(), Counts{0, 0, 0})
+    {
+        std::unordered_map<Term, size_t, Term::Hasher> termIndexes;
+        for (auto const & query : queries)
+        {
+            std::vector<size_t> indexes;
+            for (auto const & term : query)
+            {
+                auto it = termIndexes.find(term);
+                if (it == termIndexes.end())
+                {
+                    it = termIndexes.insert(
+                        std::make_pair(term, m_terms.size())).first;
+                    m_terms.push_back(term);
+                }
+                indexes.push_back(it->second);
+            }
+            m_queries.push_back(indexes);
+        }
+    }
+
+
+    void FalsePositiveAnalyzer::AddChunkFiles(
+        std::vector<std::string> const & filePaths,
+        IConfiguration const & config,
+        size_t threadCount)
+    {
+        threadCount = std::max(static_cast<size_t>(1), threadCount);
+        std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            processors.push_back(
+                std::unique_ptr<ITaskProcessor>(
+                    new ChunkProcessor(*this, filePaths, config)));
+        }
+
+        if (threadCount > 1 && filePaths.size() > 0)
+        {
+            auto distributor =
+                Factories::CreateTaskDistributor(processors, filePaths.size());
+            distributor->WaitForCompletion();
+        }
+        else
+        {
+            for (size_t i = 0; i < filePaths.size(); ++i)
+            {
+                processors[0]->ProcessTask(i);
+            }
+        }
+    }
+
+
+    void FalsePositiveAnalyzer::AddChunk(std::vector<char> const & chunk,
+                                         IConfiguration const & config)
+    {
+        GroundTruthBuilder builder(config, m_terms);
+        ChunkReader(chunk, builder);
+
+        std::lock_guard<std::mutex> lock(m_documentsLock);
+        for (auto & document : builder.GetDocuments())
+        {
+            m_documents[document.first] = std::move(document.second);
+        }
+    }
+
+
+    void FalsePositiveAnalyzer::Analyze(IIngestor& ingestor,
+                                        size_t threadCount)
+    {
+        // The token keeps the slice buffers alive while they are scanned.
+        const Token token = ingestor.GetTokenManager().RequestToken();
+
+        std::vector<SliceProcessor::ShardInfo> shards;
+        std::vector<SliceProcessor::SliceTask> tasks;
+        for (size_t s = 0; s < ingestor.GetShardCount(); ++s)
+        {
+            Shard const & shard = ingestor.GetShard(s);
+            ITermTable2 const & termTable = shard.GetTermTable();
+
+            SliceProcessor::ShardInfo info;
+            info.m_shard = &shard;
+            RowIdSequence documentActive(termTable.GetDocumentActiveTerm(),
+                                         termTable);
+            info.m_documentActiveRow = *documentActive.begin();
+
+            for (auto const & query : m_queries)
+            {
+                std::vector<RowId> rows;
+                for (auto term : query)
+                {
+                    RowIdSequence termRows(m_terms[term], termTable);
+                    for (auto row : termRows)
+                    {
+                        rows.push_back(row);
+                    }
+                }
+                info.m_queryRows.push_back(rows);
+            }
+            shards.push_back(info);
+
+            for (auto sliceBuffer : shard.GetSliceBuffers())
+            {
+                tasks.push_back(SliceProcessor::SliceTask{s, sliceBuffer});
+            }
+        }
+
+        threadCount = std::max(static_cast<size_t>(1), threadCount);
+        std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            processors.push_back(
+                std::unique_ptr<ITaskProcessor>(
+                    new SliceProcessor(*this, shards, tasks)));
+        }
+
+        if (threadCount > 1 && tasks.size() > 0)
+        {
+            auto distributor =
+                Factories::CreateTaskDistributor(processors, tasks.size());
+            distributor->WaitForCompletion();
+        }
+        else
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                processors[0]->ProcessTask(i);
+            }
+        }
+
+        m_counts.assign(m_queries.size(), Counts{0, 0, 0});
+        for (auto const & p : processors)
+        {
+            auto const & counts =
+                static_cast<SliceProcessor const &>(*p).GetCounts();
+            for (size_t q = 0; q < m_counts.size(); ++q)
+            {
+                m_counts[q].m_matches += counts[q].m_matches;
+                m_counts[q].m_falsePositives += counts[q].m_falsePositives;
+                m_counts[q].m_falseNegatives += counts[q].m_falseNegatives;
+            }
+        }
+    }
+
+
+    size_t FalsePositiveAnalyzer::GetQueryCount() const
+    {
+        return m_queries.size();
+    }
+
+
+    size_t FalsePositiveAnalyzer::GetMatchCount(size_t query) const
+    {
+        return m_counts.at(query).m_matches;
+    }
+
+
+    size_t FalsePositiveAnalyzer::GetFalsePositiveCount(size_t query) const
+    {
+        return m_counts.at(query).m_falsePositives;
+    }
+
+
+    size_t FalsePositiveAnalyzer::GetFalseNegativeCount(size_t query) const
+    {
+        return m_counts.at(query).m_falseNegatives;
+    }
+
+
+    double FalsePositiveAnalyzer::GetFalsePositiveRate() const
+    {
+        size_t matches = 0;
+        size_t falsePositives = 0;
+        for (auto const & counts : m_counts)
+        {
+            matches += counts.m_matches - counts.m_falseNegatives;
+            falsePositives += counts.m_falsePositives;
+        }
+
+        const size_t total = matches + falsePositives;
+        return (total == 0) ? 0.0 : static_cast<double>(falsePositives) / total;
+    }
+
+
+    void FalsePositiveAnalyzer::Write(std::ostream& output) const
+    {
+        output << "query,terms,matches,falsePositives,falseNegatives"
+               << std::endl;
+        for (size_t q = 0; q < m_counts.size(); ++q)
+        {
+            output << q << ","
+                   << m_queries[q].size() << ","
+                   << m_counts[q].m_matches << ","
+                   << m_counts[q].m_falsePositives << ","
+                   << m_counts[q].m_falseNegatives << std::endl;
+        }
+    }
+
+
+    void FalsePositiveAnalyzer::Print(std::ostream& output) const
+    {
+        size_t matches = 0;
+        size_t falsePositives = 0;
+        size_t falseNegatives = 0;
+        for (auto const & counts : m_counts)
+        {
+            matches += counts.m_matches;
+            falsePositives += counts.m_falsePositives;
+            falseNegatives += counts.m_falseNegatives;
+        }
+
+        output << "False positives" << std::endl;
+        output << "  Queries: " << m_counts.size() << std::endl;
+        output << "  Matches: " << matches << std::endl;
+        output << "  False positives: " << falsePositives << std::endl;
+        output << "  False negatives: " << falseNegatives << std::endl;
+        output << "  False positive rate: " << GetFalsePositiveRate()
+               << std::endl;
+    }
+}
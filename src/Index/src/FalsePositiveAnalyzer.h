@@ -0,0 +1,130 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <mutex>                        // std::mutex member.
+#include <stddef.h>                     // size_t parameter.
+#include <string>                       // std::string template parameter.
+#include <unordered_map>                // std::unordered_map member.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"   // DocId template parameter.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+#include "BitFunnel/Term.h"             // Term template parameter.
+
+
+namespace BitFunnel
+{
+    class IConfiguration;
+    class IIngestor;
+
+    //*************************************************************************
+    //
+    // FalsePositiveAnalyzer
+    //
+    // Compares the documents matched by the bit-sliced index against the
+    // exact matches for a sample of conjunctive queries.
+    //
+    // The exact matches come from re-reading the chunk files that were
+    // ingested. For each document, only the query terms it contains are
+    // kept, so memory use is proportional to the number of postings for
+    // query terms rather than to the size of the corpus.
+    //
+    // Analyze() then visits every active document in every slice of the
+    // index. A document is a bit-sliced match when all of the rows for all of
+    // the query's terms have its bit set. The slices are divided between
+    // threads.
+    //
+    //*************************************************************************
+    class FalsePositiveAnalyzer : public NonCopyable
+    {
+    public:
+        // Each query is the conjunction of its terms.
+        FalsePositiveAnalyzer(std::vector<std::vector<Term>> const & queries);
+
+        // Records which query terms each document in the chunk files
+        // contains. Files are divided between threadCount threads.
+        void AddChunkFiles(std::vector<std::string> const & filePaths,
+                           IConfiguration const & config,
+                           size_t threadCount);
+
+        // Records which query terms each document in chunk contains. Thread
+        // safe.
+        void AddChunk(std::vector<char> const & chunk,
+                      IConfiguration const & config);
+
+        // Matches every query against every active document in the index.
+        void Analyze(IIngestor& ingestor, size_t threadCount);
+
+        size_t GetQueryCount() const;
+
+        // Number of documents in the index that contain every term of the
+        // query.
+        size_t GetMatchCount(size_t query) const;
+
+        // Number of documents matched by the bit-sliced index that don't
+        // contain every term of the query.
+        size_t GetFalsePositiveCount(size_t query) const;
+
+        // Number of documents containing every term of the query that the
+        // bit-sliced index failed to match. Anything other than 0 is a bug.
+        size_t GetFalseNegativeCount(size_t query) const;
+
+        // Fraction of bit-sliced matches, over all queries, that are false
+        // positives.
+        double GetFalsePositiveRate() const;
+
+        // Writes the counts for each query as CSV.
+        void Write(std::ostream& output) const;
+
+        // Prints totals over all queries.
+        void Print(std::ostream& output) const;
+
+    private:
+        class ChunkProcessor;
+        class GroundTruthBuilder;
+        class SliceProcessor;
+
+        struct Counts
+        {
+            size_t m_matches;
+            size_t m_falsePositives;
+            size_t m_falseNegatives;
+        };
+
+        // Distinct query terms.
+        std::vector<Term> m_terms;
+
+        // Indexes into m_terms for each query.
+        std::vector<std::vector<size_t>> m_queries;
+
+        // Sorted indexes into m_terms for the query terms in each document.
+        // Documents without query terms are omitted.
+        std::mutex m_documentsLock;
+        std::unordered_map<DocId, std::vector<size_t>> m_documents;
+
+        std::vector<Counts> m_counts;
+    };
+}
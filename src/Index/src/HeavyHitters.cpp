@@ -0,0 +1,160 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include "BitFunnel/Exceptions.h"
+#include "HeavyHitters.h"
+
+
+namespace BitFunnel
+{
+    HeavyHitters::HeavyHitters(size_t capacity)
+      : m_capacity(capacity)
+    {
+        if (capacity == 0)
+        {
+            RecoverableError error("HeavyHitters: capacity must be positive.");
+            throw error;
+        }
+
+        m_heap.reserve(capacity);
+        m_positions.reserve(capacity);
+    }
+
+
+    void HeavyHitters::Increment(Term term)
+    {
+        auto it = m_positions.find(term);
+        if (it != m_positions.end())
+        {
+            ++m_heap[it->second].m_count;
+            SiftDown(it->second);
+        }
+        else if (m_heap.size() < m_capacity)
+        {
+            m_heap.push_back(Entry(term, 1));
+            m_positions.insert(std::make_pair(term, m_heap.size() - 1));
+            SiftUp(m_heap.size() - 1);
+        }
+        else
+        {
+            // Replace the term with the smallest count.
+            m_positions.erase(m_heap[0].m_term);
+            m_heap[0].m_term = term;
+            ++m_heap[0].m_count;
+            m_positions.insert(std::make_pair(term, 0));
+            SiftDown(0);
+        }
+    }
+
+
+    bool HeavyHitters::TryGetCount(Term term, uint64_t & count) const
+    {
+        auto it = m_positions.find(term);
+        if (it == m_positions.end())
+        {
+            return false;
+        }
+
+        count = m_heap[it->second].m_count;
+        return true;
+    }
+
+
+    uint64_t HeavyHitters::GetMinCount() const
+    {
+        return m_heap.size() < m_capacity ? 0 : m_heap[0].m_count;
+    }
+
+
+    size_t HeavyHitters::size() const
+    {
+        return m_heap.size();
+    }
+
+
+    std::vector<HeavyHitters::Entry>::const_iterator HeavyHitters::begin() const
+    {
+        return m_heap.begin();
+    }
+
+
+    std::vector<HeavyHitters::Entry>::const_iterator HeavyHitters::end() const
+    {
+        return m_heap.end();
+    }
+
+
+    void HeavyHitters::SiftDown(size_t position)
+    {
+        for (;;)
+        {
+            size_t smallest = position;
+            const size_t left = 2 * position + 1;
+            const size_t right = left + 1;
+
+            if (left < m_heap.size() &&
+                m_heap[left].m_count < m_heap[smallest].m_count)
+            {
+                smallest = left;
+            }
+            if (right < m_heap.size() &&
+                m_heap[right].m_count < m_heap[smallest].m_count)
+            {
+                smallest = right;
+            }
+
+            if (smallest == position)
+            {
+                break;
+            }
+
+            Swap(position, smallest);
+            position = smallest;
+        }
+    }
+
+
+    void HeavyHitters::SiftUp(size_t position)
+    {
+        while (position > 0)
+        {
+            const size_t parent = (position - 1) / 2;
+            if (m_heap[parent].m_count <= m_heap[position].m_count)
+            {
+                break;
+            }
+
+            Swap(position, parent);
+            position = parent;
+        }
+    }
+
+
+    void HeavyHitters::Swap(size_t a, size_t b)
+    {
+        std::swap(m_heap[a], m_heap[b]);
+        m_positions.find(m_heap[a].m_term)->second = a;
+        m_positions.find(m_heap[b].m_term)->second = b;
+    }
+}
@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stdint.h>             // uint64_t member.
+#include <unordered_map>        // std::unordered_map member.
+#include <vector>               // std::vector member.
+
+#include "BitFunnel/Term.h"     // Term member.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // HeavyHitters
+    //
+    // Tracks the most frequent Terms in a stream using the Space-Saving
+    // algorithm of Metwally, Agrawal, and El Abbadi. At most capacity Terms
+    // are monitored. When an unmonitored Term arrives and the set is full,
+    // it replaces the monitored Term with the smallest count and inherits
+    // that count plus one.
+    //
+    // The count for a monitored Term is an upper bound on its true count and
+    // overestimates it by at most GetMinCount(). Every Term whose true count
+    // exceeds GetMinCount() is guaranteed to be monitored.
+    //
+    // The monitored Terms are kept in a binary min-heap on count, with a hash
+    // table from Term to heap position.
+    //
+    // Thread safety: none.
+    //
+    //*************************************************************************
+    class HeavyHitters
+    {
+    public:
+        HeavyHitters(size_t capacity);
+
+        void Increment(Term term);
+
+        // Returns true if term is monitored. If so, sets count to its
+        // estimated count.
+        bool TryGetCount(Term term, uint64_t & count) const;
+
+        // Returns the smallest monitored count if the set is full, otherwise
+        // zero. This bounds the count of any Term that is not monitored.
+        uint64_t GetMinCount() const;
+
+        size_t size() const;
+
+        class Entry
+        {
+        public:
+            Entry(Term term, uint64_t count)
+              : m_term(term),
+                m_count(count)
+            {
+            }
+
+            Term GetTerm() const
+            {
+                return m_term;
+            }
+
+            uint64_t GetCount() const
+            {
+                return m_count;
+            }
+
+        private:
+            friend class HeavyHitters;
+
+            Term m_term;
+            uint64_t m_count;
+        };
+
+        // Iterates over the monitored Terms in no particular order.
+        std::vector<Entry>::const_iterator begin() const;
+        std::vector<Entry>::const_iterator end() const;
+
+    private:
+        // Restore the heap property after the count at position increased
+        // or a new entry was added at position.
+        void SiftDown(size_t position);
+        void SiftUp(size_t position);
+
+        void Swap(size_t a, size_t b);
+
+        size_t m_capacity;
+        std::vector<Entry> m_heap;
+        std::unordered_map<Term, size_t, Term::Hasher> m_positions;
+    };
+}
@@ -31,7 +31,9 @@ namespace BitFunnel
     size_t GetMinimumBlockSize(IDocumentDataSchema const & schema,
                                ITermTable2 const & termTable)
     {
-        static const DocIndex capacity = 
+        // The capacity depends on the TermTable, so it must not be cached
+        // across calls.
+        const DocIndex capacity =
             Row::DocumentsInRank0Row(1, termTable.GetMaxRankUsed());
 
         return Shard::InitializeDescriptors(nullptr,
@@ -4,6 +4,8 @@
 
 namespace BitFunnel
 {
+    class DocumentFrequencyTableBuilder;
+    class ResolvedTermCache;
     class Slice;
 
     class ISliceOwner : public IInterface
@@ -11,5 +13,15 @@ namespace BitFunnel
     public:
         virtual void RecycleSlice(Slice& slice) = 0;
         virtual void ReleaseSliceBuffer(void* sliceBuffer) = 0;
+
+        // Returns the calling thread's cache of RowIds for terms in the
+        // owner's TermTable.
+        virtual ResolvedTermCache& GetResolvedTermCache() = 0;
+
+        // Returns the builder that records term statistics for documents
+        // added to the owner's slices, or nullptr if statistics are not
+        // being gathered.
+        virtual DocumentFrequencyTableBuilder*
+            GetDocumentFrequencyTableBuilder() = 0;
     };
 }
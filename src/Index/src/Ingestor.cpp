@@ -22,6 +22,7 @@
 
 #include <iostream>     // TODO: Remove this temporary header.
 #include <memory>
+#include <sstream>
 
 #include "BitFunnel/Configuration/IShardDefinition.h"
 #include "BitFunnel/Exceptions.h"
@@ -46,13 +47,37 @@ namespace BitFunnel
                               IRecycler& recycler,
                               ITermTableCollection const & termTables,
                               IShardDefinition const & shardDefinition,
-                              ISliceBufferAllocator& sliceBufferAllocator)
+                              ISliceBufferAllocator& sliceBufferAllocator,
+                              bool generateStatistics)
     {
         return std::unique_ptr<IIngestor>(new Ingestor(docDataSchema,
                                                        recycler,
                                                        termTables,
                                                        shardDefinition,
-                                                       sliceBufferAllocator));
+                                                       sliceBufferAllocator,
+                                                       generateStatistics,
+                                                       0.0,
+                                                       0));
+    }
+
+
+    std::unique_ptr<IIngestor>
+    Factories::CreateIngestor(IDocumentDataSchema const & docDataSchema,
+                              IRecycler& recycler,
+                              ITermTableCollection const & termTables,
+                              IShardDefinition const & shardDefinition,
+                              ISliceBufferAllocator& sliceBufferAllocator,
+                              double statisticsErrorBound,
+                              size_t heavyHitterCount)
+    {
+        return std::unique_ptr<IIngestor>(new Ingestor(docDataSchema,
+                                                       recycler,
+                                                       termTables,
+                                                       shardDefinition,
+                                                       sliceBufferAllocator,
+                                                       true,
+                                                       statisticsErrorBound,
+                                                       heavyHitterCount));
     }
 
 
@@ -60,7 +85,10 @@ namespace BitFunnel
                        IRecycler& recycler,
                        ITermTableCollection const & termTables,
                        IShardDefinition const & shardDefinition,
-                       ISliceBufferAllocator& sliceBufferAllocator)
+                       ISliceBufferAllocator& sliceBufferAllocator,
+                       bool generateStatistics,
+                       double statisticsErrorBound,
+                       size_t heavyHitterCount)
         : m_recycler(recycler),
           m_shardDefinition(shardDefinition),
           m_documentCount(0),   // TODO: This member is now redundant (with m_documentMap).
@@ -79,7 +107,10 @@ namespace BitFunnel
                               termTables.GetTermTable(shardId),
                               docDataSchema,
                               m_sliceBufferAllocator,
-                              m_sliceBufferAllocator.GetSliceBufferSize())));
+                              m_sliceBufferAllocator.GetSliceBufferSize(),
+                              generateStatistics,
+                              statisticsErrorBound,
+                              heavyHitterCount)));
         }
     }
 
@@ -200,24 +231,30 @@ namespace BitFunnel
         ShardId shardId = m_shardDefinition.GetShard(document.GetPostingCount());
         DocumentHandleInternal handle = m_shards[shardId]->AllocateDocument(id);
 
+        // Statistics attribute the postings that follow to this document.
+        m_shards[shardId]->TemporaryRecordDocument();
         document.Ingest(handle);
 
 
         // TODO: REVIEW: Why are Activate() and CommitDocument() separate operations?
         handle.Activate();
-        handle.GetSlice()->CommitDocument();
-
-        // TODO: schedule for backup if Slice is full.
-        // Consider if Slice::CommitDocument itself may schedule a backup when full.
 
+        // The document is committed after its DocumentMap entry exists.
+        // CompactSlices() only moves documents out of fully committed
+        // Slices, so it always finds the entry to update.
         try
         {
             m_documentMap->Add(handle);
+            handle.GetSlice()->CommitDocument();
+
+            // TODO: schedule for backup if Slice is full.
+            // Consider if Slice::CommitDocument itself may schedule a backup when full.
         }
         catch (...)
         {
             try
             {
+                handle.GetSlice()->CommitDocument();
                 handle.Expire();
             }
             catch (...)
@@ -286,6 +323,23 @@ namespace BitFunnel
     }
 
 
+    size_t Ingestor::CompactSlices(double maxDensity)
+    {
+        // Group removal and document expiration must not touch the Slices
+        // being compacted.
+        std::lock_guard<std::mutex> groupLock(m_groupLock);
+        std::lock_guard<std::mutex> deleteLock(m_deleteDocumentLock);
+
+        size_t releasedCount = 0;
+        for (auto & shard : m_shards)
+        {
+            releasedCount += shard->CompactSlices(maxDensity, *m_documentMap);
+        }
+
+        return releasedCount;
+    }
+
+
     void Ingestor::AssertFact(DocId /*id*/, FactHandle /*fact*/, bool /*value*/)
     {
         throw NotImplemented();
@@ -334,20 +388,71 @@ namespace BitFunnel
     }
 
 
-    void Ingestor::OpenGroup(GroupId /*groupId*/)
+    void Ingestor::OpenGroup(GroupId groupId)
     {
-        throw NotImplemented();
+        std::lock_guard<std::mutex> lock(m_groupLock);
+
+        if (!m_groupIds.insert(groupId).second)
+        {
+            std::stringstream message;
+            message << "Ingestor::OpenGroup(): GroupId " << groupId
+                    << " has already been used.";
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        for (auto & shard : m_shards)
+        {
+            shard->OpenGroup(groupId);
+        }
     }
 
 
     void Ingestor::CloseGroup()
     {
-        throw NotImplemented();
+        std::lock_guard<std::mutex> lock(m_groupLock);
+
+        for (auto & shard : m_shards)
+        {
+            shard->CloseGroup();
+        }
     }
 
 
-    void Ingestor::ExpireGroup(GroupId /*groupId*/)
+    void Ingestor::ExpireGroup(GroupId groupId)
     {
-        throw NotImplemented();
+        std::lock_guard<std::mutex> lock(m_groupLock);
+
+        if (m_groupIds.find(groupId) == m_groupIds.end())
+        {
+            std::stringstream message;
+            message << "Ingestor::ExpireGroup(): GroupId " << groupId
+                    << " not found.";
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        // Prevents Delete() from expiring documents in the group's Slices
+        // while they are being expired wholesale.
+        std::lock_guard<std::mutex> deleteLock(m_deleteDocumentLock);
+
+        for (auto & shard : m_shards)
+        {
+            for (auto slice : shard->RemoveGroup(groupId))
+            {
+                const bool isSliceExpired = slice->ExpireAll();
+
+                m_documentMap->DeleteSlice(*slice);
+
+                if (isSliceExpired)
+                {
+                    Slice::DecrementRefCount(slice);
+                }
+
+                // Release the group's reference. The last reference
+                // schedules the Slice for recycling.
+                Slice::DecrementRefCount(slice);
+            }
+        }
     }
 }
@@ -26,6 +26,7 @@
 #include <memory>                           // std::unique_ptr embedded.
 #include <mutex>                            // std::mutex member.
 #include <stddef.h>                         // size_t template parameter.
+#include <unordered_set>                    // std::unordered_set member.
 #include <vector>                           // std::vector embedded.
 
 #include "BitFunnel/BitFunnelTypes.h"       // DocId parameter.
@@ -56,7 +57,10 @@ namespace BitFunnel
                  IRecycler& recycle,
                  ITermTableCollection const & termTables,
                  IShardDefinition const & shardDefinition,
-                 ISliceBufferAllocator& sliceBufferAllocator);
+                 ISliceBufferAllocator& sliceBufferAllocator,
+                 bool generateStatistics,
+                 double statisticsErrorBound,
+                 size_t heavyHitterCount);
 
         virtual ~Ingestor();
 
@@ -94,6 +98,13 @@ namespace BitFunnel
         // some of which may already have been deleted for other reasons.
         virtual bool Delete(DocId id) override;
 
+        // Re-packs the live documents of Slices in which fewer than
+        // maxDensity of the columns hold live documents into fewer Slices,
+        // releasing the rest. Queries already in progress continue to use the
+        // old Slices, which are recycled once their tokens are returned.
+        // Returns the number of Slices released. Thread safe.
+        virtual size_t CompactSlices(double maxDensity) override;
+
         // Sets or clears a fact about a document with the given DocId. The
         // FactHandle must have been previously registered in the IFactSet,
         // otherwise the function throws.
@@ -141,12 +152,20 @@ namespace BitFunnel
         //    - All future addition operations are done in this new group.
         //    - The previous group is closed. A closed group cannot be reopened or
         //      modified.
+        // Each group gets Slices of its own in every Shard, so the partially
+        // filled active Slices are sealed when a group is opened or closed.
+        // Throws if groupId has been opened before.
         virtual void OpenGroup(GroupId groupId) override;
 
         // Closes the current group, if any.
         virtual void CloseGroup() override;
 
-        // Expires the group with the given id.
+        // Expires the group with the given id, closing it first if it is
+        // open. The cost is proportional to the number of Slices in the group:
+        // each Slice's document active row is cleared at once and the Slice is
+        // handed to the IRecycler. Calls to Add() for documents in the group
+        // must have returned. Throws if groupId was never opened. Expiring a
+        // group a second time has no effect.
         virtual void ExpireGroup(GroupId groupId) override;
 
     private:
@@ -172,6 +191,11 @@ namespace BitFunnel
         // Lock protecting concurrent DeleteDocument operations.
         std::mutex m_deleteDocumentLock;
 
+        // Lock serializing group operations, and every GroupId passed to
+        // OpenGroup(). GroupIds may not be reused, even after expiration.
+        std::mutex m_groupLock;
+        std::unordered_set<GroupId> m_groupIds;
+
 
         DocumentLengthHistogram m_histogram;
 
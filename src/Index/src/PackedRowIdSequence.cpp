@@ -35,7 +35,8 @@ namespace BitFunnel
     PackedRowIdSequence::PackedRowIdSequence()
       : m_start(0ul),
         m_count(0ul),
-        m_type(static_cast<uint32_t>(Type::Adhoc))
+        m_type(static_cast<uint32_t>(Type::Adhoc)),
+        m_unused(0ul)
     {
     }
 
@@ -45,7 +46,8 @@ namespace BitFunnel
                                              Type type)
       : m_start(static_cast<uint32_t>(start)),
         m_count(static_cast<uint32_t>(end - start)),
-        m_type(static_cast<uint32_t>(type))
+        m_type(static_cast<uint32_t>(type)),
+        m_unused(0ul)
     {
         if (start > c_maxRowIndexValue ||
             end > c_maxRowIndexValue ||
@@ -55,7 +55,8 @@ namespace BitFunnel
     //    allocator and deleting the resources it held.
     //
     // Uses token system to determine when the consumers of the resource have
-    // exited.
+    // exited. Any ITokenManager may be supplied, e.g. the TokenManager or the
+    // epoch-based EpochManager.
     //
     // TODO: Consider moving to Shard.cpp, as it is the only consumer of the class.
     class DeferredSliceListDelete : public IRecyclable
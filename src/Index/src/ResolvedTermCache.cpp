@@ -0,0 +1,87 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/ResolvedTermCache.h"
+#include "BitFunnel/RowIdSequence.h"
+
+
+namespace BitFunnel
+{
+    ResolvedTermCache::ResolvedTermCache(ITermTable2 const & termTable,
+                                         size_t log2Capacity)
+      : m_termTable(termTable),
+        m_shift(static_cast<unsigned>(64 - log2Capacity))
+    {
+        if (log2Capacity == 0 || log2Capacity > 32)
+        {
+            throw RecoverableError("ResolvedTermCache: log2Capacity out of range.");
+        }
+
+        m_entries.resize(1ull << log2Capacity, Entry());
+    }
+
+
+    ResolvedTermCache::Rows ResolvedTermCache::GetRows(Term const & term)
+    {
+        const Term::Hash hash = term.GetRawHash();
+        const Term::IdfX10 idf = term.GetIdfMax();
+        const Term::GramSize gramSize = term.GetGramSize();
+
+        // The ITermTable2 selects rows by raw hash, and for adhoc terms by
+        // IdfX10 and GramSize, so all three form the key.
+        Entry& entry = m_entries[(hash * 0x9E3779B97F4A7C15ull) >> m_shift];
+        if (entry.m_valid
+            && entry.m_hash == hash
+            && entry.m_idf == idf
+            && entry.m_gramSize == gramSize)
+        {
+            return Rows(entry.m_rows, entry.m_rows + entry.m_rowCount);
+        }
+
+        RowIdSequence rows(term, m_termTable);
+        size_t count = 0;
+        for (auto row : rows)
+        {
+            m_overflow[count++] = row;
+        }
+
+        if (count > c_inlineRowCount)
+        {
+            return Rows(m_overflow, m_overflow + count);
+        }
+
+        entry.m_hash = hash;
+        entry.m_idf = idf;
+        entry.m_gramSize = gramSize;
+        entry.m_rowCount = static_cast<uint8_t>(count);
+        entry.m_valid = 1;
+        for (size_t i = 0; i < count; ++i)
+        {
+            entry.m_rows[i] = m_overflow[i];
+        }
+
+        return Rows(entry.m_rows, entry.m_rows + count);
+    }
+}
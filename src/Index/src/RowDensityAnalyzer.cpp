@@ -0,0 +1,297 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>                            // std::min().
+#include <bitset>                               // std::bitset::count().
+#include <memory>                               // std::unique_ptr.
+#include <ostream>
+
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/Row.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "BitFunnel/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
+#include "RowDensityAnalyzer.h"
+#include "RowTableDescriptor.h"
+#include "Shard.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // RowDensityAnalyzer::Processor
+    //
+    // Counts bits for the slices assigned to one thread. Each task is one
+    // slice buffer.
+    //
+    //*************************************************************************
+    class RowDensityAnalyzer::Processor : public ITaskProcessor
+    {
+    public:
+        Processor(Shard const & shard,
+                  std::vector<void*> const & sliceBuffers,
+                  std::vector<size_t> const & rowCounts,
+                  RowId documentActiveRow)
+          : m_shard(shard),
+            m_sliceBuffers(sliceBuffers),
+            m_rowCounts(rowCounts),
+            m_documentActiveRow(documentActiveRow),
+            m_columnCounts(rowCounts.size(), 0)
+        {
+            for (auto rowCount : rowCounts)
+            {
+                m_bitCounts.push_back(std::vector<uint64_t>(rowCount, 0));
+            }
+        }
+
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            char const * sliceBuffer =
+                static_cast<char const *>(m_sliceBuffers[taskId]);
+            const DocIndex capacity = m_shard.GetSliceCapacity();
+
+            // Mask of columns holding active documents at rank 0.
+            const size_t rank0Words = Row::BytesInRow(capacity, 0) / sizeof(uint64_t);
+            uint64_t const * active =
+                RowData(sliceBuffer,
+                        m_shard.GetRowTable(0),
+                        m_documentActiveRow.GetIndex());
+
+            for (Rank rank = 0; rank < m_rowCounts.size(); ++rank)
+            {
+                if (m_rowCounts[rank] == 0)
+                {
+                    continue;
+                }
+
+                // A rank r column is active if any of the 2^r rank 0 columns
+                // folded into it is active. Rank 0 word i maps to rank r word
+                // i >> r.
+                const size_t words =
+                    std::min(Row::BytesInRow(capacity, rank) / sizeof(uint64_t),
+                             (rank0Words + (static_cast<size_t>(1) << rank) - 1) >> rank);
+                m_mask.assign(words, 0);
+                for (size_t i = 0; i < rank0Words && (i >> rank) < words; ++i)
+                {
+                    m_mask[i >> rank] |= active[i];
+                }
+
+                for (auto word : m_mask)
+                {
+                    m_columnCounts[rank] += std::bitset<64>(word).count();
+                }
+
+                RowTableDescriptor const & rowTable = m_shard.GetRowTable(rank);
+                auto & counts = m_bitCounts[rank];
+                for (RowIndex row = 0; row < counts.size(); ++row)
+                {
+                    uint64_t const * data = RowData(sliceBuffer, rowTable, row);
+                    uint64_t count = 0;
+                    for (size_t i = 0; i < words; ++i)
+                    {
+                        count += std::bitset<64>(data[i] & m_mask[i]).count();
+                    }
+                    counts[row] += count;
+                }
+            }
+        }
+
+
+        virtual void Finished() override
+        {
+        }
+
+
+        std::vector<std::vector<uint64_t>> const & GetBitCounts() const
+        {
+            return m_bitCounts;
+        }
+
+
+        std::vector<uint64_t> const & GetColumnCounts() const
+        {
+            return m_columnCounts;
+        }
+
+    private:
+        static uint64_t const * RowData(char const * sliceBuffer,
+                                        RowTableDescriptor const & rowTable,
+                                        RowIndex row)
+        {
+            return reinterpret_cast<uint64_t const *>(
+                sliceBuffer + rowTable.GetRowOffset(row));
+        }
+
+        Shard const & m_shard;
+        std::vector<void*> const & m_sliceBuffers;
+        std::vector<size_t> const & m_rowCounts;
+        const RowId m_documentActiveRow;
+
+        std::vector<std::vector<uint64_t>> m_bitCounts;
+        std::vector<uint64_t> m_columnCounts;
+
+        // Active column mask for the current rank. Reused between tasks.
+        std::vector<uint64_t> m_mask;
+    };
+
+
+    //*************************************************************************
+    //
+    // RowDensityAnalyzer
+    //
+    //*************************************************************************
+    RowDensityAnalyzer::RowDensityAnalyzer(Shard const & shard,
+                                           ITokenManager& tokenManager,
+                                           size_t threadCount)
+    {
+        ITermTable2 const & termTable = shard.GetTermTable();
+
+        std::vector<size_t> rowCounts;
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            rowCounts.push_back(termTable.GetTotalRowCount(rank));
+        }
+
+        RowIdSequence documentActive(termTable.GetDocumentActiveTerm(),
+                                     termTable);
+        const RowId documentActiveRow = *documentActive.begin();
+
+        // The token keeps the slice buffers alive while they are scanned.
+        const Token token = tokenManager.RequestToken();
+        const std::vector<void*> sliceBuffers = shard.GetSliceBuffers();
+
+        threadCount = std::max(static_cast<size_t>(1), threadCount);
+        std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            processors.push_back(
+                std::unique_ptr<ITaskProcessor>(
+                    new Processor(shard,
+                                  sliceBuffers,
+                                  rowCounts,
+                                  documentActiveRow)));
+        }
+
+        if (threadCount > 1 && sliceBuffers.size() > 0)
+        {
+            auto distributor =
+                Factories::CreateTaskDistributor(processors,
+                                                 sliceBuffers.size());
+            distributor->WaitForCompletion();
+        }
+        else
+        {
+            // The threadCount == 1 case is implemented to simplify debugging.
+            for (size_t i = 0; i < sliceBuffers.size(); ++i)
+            {
+                processors[0]->ProcessTask(i);
+            }
+        }
+
+        // Merge the per-thread counts.
+        m_columnCounts.resize(rowCounts.size(), 0);
+        for (auto rowCount : rowCounts)
+        {
+            m_bitCounts.push_back(std::vector<uint64_t>(rowCount, 0));
+        }
+
+        for (auto const & p : processors)
+        {
+            Processor const & processor = static_cast<Processor const &>(*p);
+            for (Rank rank = 0; rank < rowCounts.size(); ++rank)
+            {
+                m_columnCounts[rank] += processor.GetColumnCounts()[rank];
+                for (size_t row = 0; row < rowCounts[rank]; ++row)
+                {
+                    m_bitCounts[rank][row] +=
+                        processor.GetBitCounts()[rank][row];
+                }
+            }
+        }
+    }
+
+
+    std::vector<double> RowDensityAnalyzer::GetDensities(Rank rank) const
+    {
+        auto const & counts = m_bitCounts.at(rank);
+        std::vector<double> densities(counts.size(), 0.0);
+        if (m_columnCounts[rank] > 0)
+        {
+            for (size_t row = 0; row < counts.size(); ++row)
+            {
+                densities[row] =
+                    static_cast<double>(counts[row]) / m_columnCounts[rank];
+            }
+        }
+        return densities;
+    }
+
+
+    void RowDensityAnalyzer::Write(std::ostream& output) const
+    {
+        output << "rank,row,density" << std::endl;
+        for (Rank rank = 0; rank < m_bitCounts.size(); ++rank)
+        {
+            auto densities = GetDensities(rank);
+            for (size_t row = 0; row < densities.size(); ++row)
+            {
+                output << rank << "," << row << "," << densities[row]
+                       << std::endl;
+            }
+        }
+    }
+
+
+    void RowDensityAnalyzer::Print(std::ostream& output) const
+    {
+        output << "Row densities" << std::endl;
+        for (Rank rank = 0; rank < m_bitCounts.size(); ++rank)
+        {
+            auto densities = GetDensities(rank);
+            if (densities.empty())
+            {
+                continue;
+            }
+
+            double sum = 0.0;
+            double min = densities[0];
+            double max = densities[0];
+            for (auto density : densities)
+            {
+                sum += density;
+                min = std::min(min, density);
+                max = std::max(max, density);
+            }
+
+            output << "  Rank " << rank << ": "
+                   << densities.size() << " rows, "
+                   << "density min " << min
+                   << ", mean " << sum / densities.size()
+                   << ", max " << max << std::endl;
+        }
+    }
+}
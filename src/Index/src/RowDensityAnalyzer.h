@@ -0,0 +1,81 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <stddef.h>                     // size_t parameter.
+#include <stdint.h>                     // uint64_t template parameter.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"   // Rank parameter.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class ITokenManager;
+    class Shard;
+
+    //*************************************************************************
+    //
+    // RowDensityAnalyzer
+    //
+    // Measures the fraction of bits set in each row of a Shard, over all of
+    // its slices. Only columns that hold at least one active document are
+    // counted, so partially filled slices don't dilute the densities. The
+    // slices are divided between threadCount threads.
+    //
+    // The constructor holds a Token from the ITokenManager while it reads
+    // the slice buffers.
+    //
+    //*************************************************************************
+    class RowDensityAnalyzer : public NonCopyable
+    {
+    public:
+        RowDensityAnalyzer(Shard const & shard,
+                           ITokenManager& tokenManager,
+                           size_t threadCount);
+
+        // Returns the density of each row at rank, indexed by RowIndex.
+        // Rows in a shard without active documents have density 0.
+        std::vector<double> GetDensities(Rank rank) const;
+
+        // Writes the density of every row as CSV with columns rank, row and
+        // density.
+        void Write(std::ostream& output) const;
+
+        // Prints the row count and the minimum, mean and maximum density of
+        // each rank.
+        void Print(std::ostream& output) const;
+
+    private:
+        class Processor;
+
+        // Number of bits set in each row, indexed by rank, then RowIndex.
+        std::vector<std::vector<uint64_t>> m_bitCounts;
+
+        // Number of columns with active documents, indexed by rank.
+        std::vector<uint64_t> m_columnCounts;
+    };
+}
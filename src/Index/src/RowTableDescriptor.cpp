@@ -22,6 +22,9 @@
 
 
 #include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>     // _InterlockedOr64().
+#endif
 
 #include "BitFunnel/ITermTable2.h"
 #include "BitFunnel/Row.h"
@@ -40,7 +43,8 @@ namespace BitFunnel
           m_rowCount(rowCount),
           m_rank(rank),
           m_bufferOffset(rowTableBufferOffset),
-          m_bytesPerRow(Row::BytesInRow(capacity, rank))
+          m_bytesPerRow(Row::BytesInRow(capacity, rank)),
+          m_summaryQuadwordCount(GetSummaryQuadwordCount(m_bytesPerRow))
     {
         // Make sure capacity is properly rounded already.
         // TODO: fix.
@@ -57,7 +61,8 @@ namespace BitFunnel
           m_rowCount(other.m_rowCount),
           m_rank(other.m_rank),
           m_bufferOffset(other.m_bufferOffset),
-          m_bytesPerRow(other.m_bytesPerRow)
+          m_bytesPerRow(other.m_bytesPerRow),
+          m_summaryQuadwordCount(other.m_summaryQuadwordCount)
     {
     }
 
@@ -92,6 +97,9 @@ namespace BitFunnel
             // Fill up the match-all row with all ones.
             uint64_t * rowData = GetRowData(sliceBuffer, row.GetIndex());
             memset(rowData, 0xFF, m_bytesPerRow);
+
+            uint64_t * summary = GetSummaryData(sliceBuffer, row.GetIndex());
+            memset(summary, 0xFF, m_summaryQuadwordCount * sizeof(uint64_t));
         }
     }
 
@@ -128,6 +136,24 @@ namespace BitFunnel
         uint64_t bitMask = 1ull << bitPos;
         uint64_t newVal = *(row + offset) | bitMask;
         *(row + offset) = newVal;
+
+        // Each summary quadword covers 512 quadwords of the row, so threads
+        // ingesting different documents often update the same one. A lost
+        // update would hide the block from matching, so the OR is atomic. It
+        // is skipped when the bit is already set, which is the common case.
+        const size_t block = offset / c_quadwordsPerSummaryBit;
+        uint64_t* const summary =
+            GetSummaryData(sliceBuffer, rowIndex) + (block >> 6);
+        const uint64_t summaryBit = 1ull << (block & 0x3F);
+        if ((*summary & summaryBit) == 0)
+        {
+#ifdef _MSC_VER
+            _InterlockedOr64(reinterpret_cast<__int64 volatile *>(summary),
+                             static_cast<__int64>(summaryBit));
+#else
+            __atomic_fetch_or(summary, summaryBit, __ATOMIC_RELAXED);
+#endif
+        }
     }
 
 
@@ -148,6 +174,28 @@ namespace BitFunnel
     }
 
 
+    void RowTableDescriptor::ClearRow(void* sliceBuffer, RowIndex rowIndex) const
+    {
+        memset(GetRowData(sliceBuffer, rowIndex), 0, m_bytesPerRow);
+        memset(GetSummaryData(sliceBuffer, rowIndex),
+               0,
+               m_summaryQuadwordCount * sizeof(uint64_t));
+    }
+
+
+    uint64_t const * RowTableDescriptor::GetSummary(void* sliceBuffer,
+                                                    RowIndex rowIndex) const
+    {
+        return GetSummaryData(sliceBuffer, rowIndex);
+    }
+
+
+    size_t RowTableDescriptor::GetSummaryQuadwordCount() const
+    {
+        return m_summaryQuadwordCount;
+    }
+
+
     ptrdiff_t RowTableDescriptor::GetRowOffset(RowIndex rowIndex) const
     {
         return m_bufferOffset + rowIndex * m_bytesPerRow;
@@ -164,7 +212,10 @@ namespace BitFunnel
         // LogAssertB(capacity == Row::DocumentsInRank0Row(capacity),
         //            "capacity not evenly rounded.");
 
-        return static_cast<unsigned>(Row::BytesInRow(capacity, rank) * rowCount);
+        const size_t bytesPerRow = Row::BytesInRow(capacity, rank);
+        const size_t summaryBytes =
+            GetSummaryQuadwordCount(bytesPerRow) * sizeof(uint64_t);
+        return static_cast<unsigned>((bytesPerRow + summaryBytes) * rowCount);
     }
 
 
@@ -176,6 +227,25 @@ namespace BitFunnel
     }
 
 
+    uint64_t* RowTableDescriptor::GetSummaryData(void* sliceBuffer,
+                                                 RowIndex rowIndex) const
+    {
+        // The summaries follow the last row.
+        uint64_t* summaries = GetRowData(sliceBuffer, m_rowCount);
+        return summaries + rowIndex * m_summaryQuadwordCount;
+    }
+
+
+    /* static */
+    size_t RowTableDescriptor::GetSummaryQuadwordCount(size_t bytesPerRow)
+    {
+        const size_t quadwords = bytesPerRow / sizeof(uint64_t);
+        const size_t blocks =
+            (quadwords + c_quadwordsPerSummaryBit - 1) / c_quadwordsPerSummaryBit;
+        return (blocks + 63) / 64;
+    }
+
+
     size_t RowTableDescriptor::QwordPositionFromDocIndex(DocIndex docIndex) const
     {
         LogAssertB(docIndex < m_capacity, "docIndex out of range");
@@ -42,6 +42,14 @@ namespace BitFunnel
     // and is able to perform bit operations over that data.
     // See Slice.h for more info about the layout of the data buffer.
     //
+    // The rows are followed by a summary bitmap for each row, with one bit
+    // per block of c_quadwordsPerSummaryBit quadwords of the row. SetBit()
+    // atomically sets the block's summary bit, so a clear summary bit
+    // guarantees that the block is all zeros. Summary bits are not cleared
+    // by ClearBit(), so a set summary bit only means that the block may have
+    // bits. A matcher can AND the summaries of the rows that every match
+    // requires and skip the blocks where the result is zero.
+    //
     // All methods except Initialize are thread safe. Initialize method is not
     // thread-safe with respect to calling *Bit methods at the same time.
     //
@@ -49,6 +57,10 @@ namespace BitFunnel
     class RowTableDescriptor
     {
     public:
+        // Number of row quadwords, i.e. 512 bits, covered by each bit of a
+        // row's summary.
+        static const size_t c_quadwordsPerSummaryBit = 8;
+
         // Constructs a RowTableDescriptor with given dimensions.
         // rowTableBufferOffset represents the offset where this RowTable's
         // data starts within a larger slice buffer which is passed to other
@@ -83,6 +95,18 @@ namespace BitFunnel
         // Clears a bit in the given row and column.
         void ClearBit(void* sliceBuffer, RowIndex rowIndex, DocIndex docIndex) const;
 
+        // Clears all of the bits in the given row, along with its summary.
+        void ClearRow(void* sliceBuffer, RowIndex rowIndex) const;
+
+        // Returns the summary bitmap of the given row. Bit b of the summary
+        // is set if any bit may be set in quadwords
+        // [b * c_quadwordsPerSummaryBit, (b + 1) * c_quadwordsPerSummaryBit)
+        // of the row.
+        uint64_t const * GetSummary(void* sliceBuffer, RowIndex rowIndex) const;
+
+        // Returns the number of quadwords in each row's summary.
+        size_t GetSummaryQuadwordCount() const;
+
         // Returns the offset of a row with the given index, relative to the
         // start of the sliceBuffer.
         ptrdiff_t GetRowOffset(RowIndex rowIndex) const;
@@ -107,6 +131,14 @@ namespace BitFunnel
         // RowIndex.
         uint64_t* GetRowData(void* sliceBuffer, RowIndex rowIndex) const;
 
+        // Helper method to seek to the summary for the row with the given
+        // RowIndex.
+        uint64_t* GetSummaryData(void* sliceBuffer, RowIndex rowIndex) const;
+
+        // Returns the number of quadwords in the summary of a row with
+        // bytesPerRow bytes.
+        static size_t GetSummaryQuadwordCount(size_t bytesPerRow);
+
         // Returns the QWORD number for the given DocIndex.
         size_t QwordPositionFromDocIndex(DocIndex docIndex) const;
 
@@ -123,5 +155,8 @@ namespace BitFunnel
 
         // Cached value of the number of bytes per single row.
         const size_t m_bytesPerRow;
+
+        // Cached value of the number of quadwords in each row's summary.
+        const size_t m_summaryQuadwordCount;
     };
 }
@@ -21,40 +21,79 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
+#include <map>
+#include <utility>
+
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/IRecycler.h"
 #include "BitFunnel/Index/ISliceBufferAllocator.h"
 #include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/ResolvedTermCache.h"
 #include "BitFunnel/Row.h"
 #include "BitFunnel/RowIdSequence.h"
 #include "BitFunnel/Term.h"
 #include "BitFunnel/Token.h"
 #include "IRecyclable.h"
 #include "LoggerInterfaces/Logging.h"
+#include "DocumentMap.h"
 #include "Recycler.h"
 #include "Shard.h"
 
 
 namespace BitFunnel
 {
+    std::atomic<uint64_t> Shard::s_nextInstanceId(0);
+
+
+    static DocumentFrequencyTableBuilder*
+        CreateDocumentFrequencyTableBuilder(bool generateStatistics,
+                                            double errorBound,
+                                            size_t heavyHitterCount)
+    {
+        if (!generateStatistics)
+        {
+            return nullptr;
+        }
+        else if (heavyHitterCount == 0)
+        {
+            return new DocumentFrequencyTableBuilder();
+        }
+        else
+        {
+            return new DocumentFrequencyTableBuilder(errorBound,
+                                                     heavyHitterCount);
+        }
+    }
+
+
     Shard::Shard(IRecycler& recycler,
                  ITokenManager& tokenManager,
                  ITermTable2 const & termTable,
                  IDocumentDataSchema const & docDataSchema,
                  ISliceBufferAllocator& sliceBufferAllocator,
-                 size_t sliceBufferSize)
-        : m_recycler(recycler),
+                 size_t sliceBufferSize,
+                 bool generateStatistics,
+                 double statisticsErrorBound,
+                 size_t heavyHitterCount)
+        : m_instanceId(s_nextInstanceId++),
+          m_recycler(recycler),
           m_tokenManager(tokenManager),
           m_termTable(termTable),
           m_sliceBufferAllocator(sliceBufferAllocator),
           m_activeSlice(nullptr),
+          m_isGroupOpen(false),
+          m_openGroup(0),
           m_sliceBuffers(new std::vector<void*>()),
           m_sliceCapacity(GetCapacityForByteSize(sliceBufferSize,
                                                  docDataSchema,
                                                  termTable)),
           m_sliceBufferSize(sliceBufferSize),
           // TODO: will need one global, not one per shard.
-          m_docFrequencyTableBuilder(new DocumentFrequencyTableBuilder())
+          m_docFrequencyTableBuilder(
+              CreateDocumentFrequencyTableBuilder(generateStatistics,
+                                                  statisticsErrorBound,
+                                                  heavyHitterCount))
     {
         const size_t bufferSize =
             InitializeDescriptors(this,
@@ -111,6 +150,12 @@ namespace BitFunnel
         m_sliceBuffers = newSlices;
         m_activeSlice = newSlice;
 
+        if (m_isGroupOpen)
+        {
+            Slice::IncrementRefCount(newSlice);
+            m_groupSlices[m_openGroup].push_back(newSlice);
+        }
+
         // TODO: think if this can be done outside of the lock.
         std::unique_ptr<IRecyclable>
             recyclableSliceList(new DeferredSliceListDelete(nullptr,
@@ -121,6 +166,352 @@ namespace BitFunnel
     }
 
 
+    // Must be called with m_slicesLock held.
+    Slice* Shard::SealActiveSlice()
+    {
+        Slice* slice = m_activeSlice;
+        m_activeSlice = nullptr;
+
+        if (slice != nullptr && slice->Seal())
+        {
+            return slice;
+        }
+        return nullptr;
+    }
+
+
+    void Shard::OpenGroup(GroupId groupId)
+    {
+        Slice* expiredSlice = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+            expiredSlice = SealActiveSlice();
+            m_isGroupOpen = true;
+            m_openGroup = groupId;
+        }
+
+        // RecycleSlice() takes m_slicesLock.
+        if (expiredSlice != nullptr)
+        {
+            Slice::DecrementRefCount(expiredSlice);
+        }
+    }
+
+
+    void Shard::CloseGroup()
+    {
+        Slice* expiredSlice = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+            if (m_isGroupOpen)
+            {
+                expiredSlice = SealActiveSlice();
+                m_isGroupOpen = false;
+            }
+        }
+
+        if (expiredSlice != nullptr)
+        {
+            Slice::DecrementRefCount(expiredSlice);
+        }
+    }
+
+
+    std::vector<Slice*> Shard::RemoveGroup(GroupId groupId)
+    {
+        Slice* expiredSlice = nullptr;
+        std::vector<Slice*> slices;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+            if (m_isGroupOpen && m_openGroup == groupId)
+            {
+                expiredSlice = SealActiveSlice();
+                m_isGroupOpen = false;
+            }
+
+            auto it = m_groupSlices.find(groupId);
+            if (it != m_groupSlices.end())
+            {
+                slices.swap(it->second);
+                m_groupSlices.erase(it);
+            }
+        }
+
+        // The group still holds a reference, so this can't recycle a Slice
+        // that is being returned.
+        if (expiredSlice != nullptr)
+        {
+            Slice::DecrementRefCount(expiredSlice);
+        }
+
+        return slices;
+    }
+
+
+    size_t Shard::CompactSlices(double maxDensity, DocumentMap& documentMap)
+    {
+        // Sparse Slices, pooled by the group that owns them. Groups are
+        // identified by their Slice lists, with nullptr for ungrouped Slices.
+        std::map<std::vector<Slice*>*, std::vector<Slice*>> pools;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+
+            std::unordered_map<Slice*, std::vector<Slice*>*> sliceGroups;
+            for (auto & group : m_groupSlices)
+            {
+                for (auto slice : group.second)
+                {
+                    sliceGroups[slice] = &group.second;
+                }
+            }
+
+            const ptrdiff_t slicePtrOffset = GetSlicePtrOffset();
+            for (auto buffer : *m_sliceBuffers)
+            {
+                Slice* slice = Slice::GetSliceFromBuffer(buffer, slicePtrOffset);
+
+                DocIndex liveCount;
+                if (slice != m_activeSlice &&
+                    slice->TryGetLiveCount(liveCount) &&
+                    liveCount < maxDensity * m_sliceCapacity)
+                {
+                    auto group = sliceGroups.find(slice);
+                    pools[group == sliceGroups.end() ? nullptr : group->second].
+                        push_back(slice);
+                }
+            }
+        }
+
+        // Copy the live documents without holding m_slicesLock, so that
+        // ingestion into the active Slice continues. The sources can no
+        // longer change: they are full and the caller holds off expiration.
+        struct GroupReplacement
+        {
+            std::vector<Slice*>* m_group;
+            size_t m_begin;
+            size_t m_end;
+        };
+
+        std::vector<Slice*> sources;
+        std::vector<Slice*> replacements;
+        std::vector<std::pair<DocumentHandleInternal, DocumentHandleInternal>> moves;
+        std::vector<Slice*> expiredReplacements;
+        std::vector<GroupReplacement> groupReplacements;
+
+        for (auto & pool : pools)
+        {
+            size_t liveCount = 0;
+            for (auto slice : pool.second)
+            {
+                DocIndex count = 0;
+                slice->TryGetLiveCount(count);
+                liveCount += count;
+            }
+
+            const size_t newSliceCount =
+                (liveCount + m_sliceCapacity - 1) / m_sliceCapacity;
+            if (newSliceCount >= pool.second.size())
+            {
+                continue;
+            }
+
+            GroupReplacement replacement;
+            replacement.m_group = pool.first;
+            replacement.m_begin = replacements.size();
+
+            size_t next = 0;
+            DocIndex position = 0;
+            for (size_t i = 0; i < newSliceCount; ++i)
+            {
+                replacements.push_back(
+                    CreateCompactedSlice(pool.second,
+                                         next,
+                                         position,
+                                         moves,
+                                         expiredReplacements));
+            }
+            sources.insert(sources.end(), pool.second.begin(), pool.second.end());
+
+            replacement.m_end = replacements.size();
+            if (replacement.m_group != nullptr)
+            {
+                groupReplacements.push_back(replacement);
+            }
+        }
+
+        if (sources.empty())
+        {
+            return 0;
+        }
+
+        std::vector<void*>* oldSlices = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+
+            std::vector<void*>* const newSlices = new std::vector<void*>();
+            for (auto buffer : *m_sliceBuffers)
+            {
+                auto isSource = [buffer](Slice* slice)
+                {
+                    return slice->GetSliceBuffer() == buffer;
+                };
+                if (std::none_of(sources.begin(), sources.end(), isSource))
+                {
+                    newSlices->push_back(buffer);
+                }
+            }
+            for (auto slice : replacements)
+            {
+                newSlices->push_back(slice->GetSliceBuffer());
+            }
+
+            oldSlices = m_sliceBuffers.load();
+            m_sliceBuffers = newSlices;
+
+            // Each group trades its references on the sources for references
+            // on its new Slices.
+            for (auto const & replacement : groupReplacements)
+            {
+                std::vector<Slice*>& group = *replacement.m_group;
+                auto isSource = [&sources](Slice* slice)
+                {
+                    return std::find(sources.begin(),
+                                     sources.end(),
+                                     slice) != sources.end();
+                };
+                group.erase(std::remove_if(group.begin(), group.end(), isSource),
+                            group.end());
+
+                for (size_t i = replacement.m_begin; i < replacement.m_end; ++i)
+                {
+                    Slice::IncrementRefCount(replacements[i]);
+                    group.push_back(replacements[i]);
+                }
+            }
+        }
+
+        for (auto const & move : moves)
+        {
+            documentMap.Relocate(move.first, move.second);
+        }
+
+        // Queries that started before the exchange may still be scanning the
+        // old list and the sources, so both wait for their tokens to drain.
+        std::unique_ptr<IRecyclable>
+            recyclableSliceList(new DeferredSliceListDelete(nullptr,
+                                                            oldSlices,
+                                                            m_tokenManager));
+        m_recycler.ScheduleRecyling(recyclableSliceList);
+
+        for (auto slice : sources)
+        {
+            std::unique_ptr<IRecyclable>
+                recyclableSlice(new DeferredSliceListDelete(slice,
+                                                            nullptr,
+                                                            m_tokenManager));
+            m_recycler.ScheduleRecyling(recyclableSlice);
+        }
+
+        // RecycleSlice() takes m_slicesLock.
+        for (auto slice : expiredReplacements)
+        {
+            Slice::DecrementRefCount(slice);
+        }
+
+        return sources.size() - replacements.size();
+    }
+
+
+    Slice* Shard::CreateCompactedSlice(
+        std::vector<Slice*> const & sources,
+        size_t& next,
+        DocIndex& position,
+        std::vector<std::pair<DocumentHandleInternal,
+                              DocumentHandleInternal>>& moves,
+        std::vector<Slice*>& expired)
+    {
+        Slice* slice = new Slice(*this,
+                                 m_termTable,
+                                 *m_docTable,
+                                 m_rowTables,
+                                 m_sliceBufferSize,
+                                 GetSliceCapacity(),
+                                 AllocateSliceBuffer());
+
+        // Columns to copy from columnSource, which are copied together
+        // whenever the source changes.
+        Slice* columnSource = nullptr;
+        std::vector<std::pair<DocIndex, DocIndex>> columns;
+
+        bool isExpired = false;
+        DocIndex index;
+        while (next < sources.size() && slice->TryAllocateDocument(index))
+        {
+            // Find the next live document. The allocated column is given
+            // back below if there isn't one.
+            Slice* source = sources[next];
+            while (next < sources.size() && !source->IsActive(position))
+            {
+                if (++position == m_sliceCapacity)
+                {
+                    position = 0;
+                    if (++next < sources.size())
+                    {
+                        source = sources[next];
+                    }
+                }
+            }
+
+            if (next == sources.size())
+            {
+                slice->CommitDocument();
+                isExpired = slice->ExpireDocument();
+                break;
+            }
+
+            if (source != columnSource)
+            {
+                if (columnSource != nullptr)
+                {
+                    columnSource->CopyDocuments(columns, *slice);
+                    columns.clear();
+                }
+                columnSource = source;
+            }
+            columns.push_back(std::make_pair(position, index));
+
+            // The Slice is not visible to queries until it is added to
+            // m_sliceBuffers, so the document can be committed before its
+            // column is copied.
+            slice->CommitDocument();
+
+            const DocId id = m_docTable->GetDocId(source->GetSliceBuffer(),
+                                                  position);
+            moves.push_back(
+                std::make_pair(DocumentHandleInternal(source, position),
+                               DocumentHandleInternal(slice, index, id)));
+
+            if (++position == m_sliceCapacity)
+            {
+                position = 0;
+                ++next;
+            }
+        }
+
+        if (columnSource != nullptr)
+        {
+            columnSource->CopyDocuments(columns, *slice);
+        }
+
+        if (slice->Seal() || isExpired)
+        {
+            expired.push_back(slice);
+        }
+
+        return slice;
+    }
+
+
     /* static */
     DocIndex Shard::GetCapacityForByteSize(size_t bufferSizeInBytes,
                                            IDocumentDataSchema const & schema,
@@ -182,12 +573,58 @@ namespace BitFunnel
     }
 
 
+    ptrdiff_t Shard::GetSlicePtrOffset() const
+    {
+        // A pointer to a Slice is placed in the end of the slice buffer.
+        return m_sliceBufferSize - sizeof(void*);
+    }
+
+
     ITermTable2 const & Shard::GetTermTable() const
     {
         return m_termTable;
     }
 
 
+    ResolvedTermCache& Shard::GetResolvedTermCache()
+    {
+        struct CacheEntry
+        {
+            uint64_t m_instanceId;
+            std::unique_ptr<ResolvedTermCache> m_cache;
+        };
+
+        // Most recently used cache last. Caches of destroyed shards are
+        // never matched again and eventually age out.
+        thread_local std::vector<CacheEntry> t_caches;
+
+        auto it = std::find_if(t_caches.begin(),
+                               t_caches.end(),
+                               [this](CacheEntry const & entry)
+                               {
+                                   return entry.m_instanceId == m_instanceId;
+                               });
+
+        if (it == t_caches.end())
+        {
+            if (t_caches.size() == c_maxTermCachesPerThread)
+            {
+                t_caches.erase(t_caches.begin());
+            }
+            CacheEntry entry;
+            entry.m_instanceId = m_instanceId;
+            entry.m_cache.reset(new ResolvedTermCache(m_termTable));
+            t_caches.push_back(std::move(entry));
+        }
+        else if (it + 1 != t_caches.end())
+        {
+            std::rotate(it, it + 1, t_caches.end());
+        }
+
+        return *t_caches.back().m_cache;
+    }
+
+
     size_t Shard::GetUsedCapacityInBytes() const
     {
         // TODO: does this really need to be locked?
@@ -297,15 +734,27 @@ namespace BitFunnel
     }
 
 
+    DocumentFrequencyTableBuilder* Shard::GetDocumentFrequencyTableBuilder()
+    {
+        return m_docFrequencyTableBuilder.get();
+    }
+
+
     void Shard::TemporaryRecordDocument()
     {
-        m_docFrequencyTableBuilder->OnDocumentEnter();
+        if (m_docFrequencyTableBuilder.get() != nullptr)
+        {
+            m_docFrequencyTableBuilder->OnDocumentEnter();
+        }
     }
 
 
     void Shard::TemporaryWriteDocumentFrequencyTable(std::ostream& out,
                                                      TermToText const * termToText) const
     {
+        LogAssertB(m_docFrequencyTableBuilder.get() != nullptr,
+                   "Shard is not generating statistics.");
+
         // TODO: 0.0 is the truncation frequency, which shouldn't be fixed at 0.
         m_docFrequencyTableBuilder->WriteFrequencies(out, 0.0, termToText); 
     }
@@ -313,6 +762,9 @@ namespace BitFunnel
 
     void Shard::TemporaryWriteIndexedIdfTable(std::ostream& out) const
     {
+        LogAssertB(m_docFrequencyTableBuilder.get() != nullptr,
+                   "Shard is not generating statistics.");
+
         // TODO: 0.0 is the truncation frequency, which shouldn't be fixed at 0.
         m_docFrequencyTableBuilder->WriteIndexedIdfTable(out, 0.0);
     }
@@ -320,6 +772,9 @@ namespace BitFunnel
 
     void Shard::TemporaryWriteCumulativeTermCounts(std::ostream& out) const
     {
+        LogAssertB(m_docFrequencyTableBuilder.get() != nullptr,
+                   "Shard is not generating statistics.");
+
         m_docFrequencyTableBuilder->WriteCumulativeTermCounts(out);
     }
 }
@@ -23,11 +23,14 @@
 #pragma once
 
 
+#include <atomic>                               // std::atomic member.
 #include <memory>                               // std::unique_ptr member.
 #include <mutex>                                // std::mutex member.
 #include <ostream>                              // TODO: Remove this temporary include.
+#include <unordered_map>                        // std::unordered_map member.
 #include <vector>
 
+#include "BitFunnel/Index/IIngestor.h"      // GroupId parameter.
 #include "BitFunnel/NonCopyable.h"          // Base class.
 #include "BitFunnel/Term.h"
 #include "ISliceOwner.h"
@@ -44,7 +47,9 @@ namespace BitFunnel
     class ISliceBufferAllocator;
     class ITermTable2;
     class ITokenManager;
+    class DocumentMap;
     class IRecycler;
+    class ResolvedTermCache;
     class Slice;
     class Term;     // TODO: Remove this temporary declaration.
     class TermToText;
@@ -68,12 +73,20 @@ namespace BitFunnel
         // Constructs an empty Shard with no slices. sliceBufferSize must be
         // sufficient to hold the minimum capacity Slice. The minimum capacity
         // is determined by a value returned by Row::DocumentsInRank0Row(1).
+        // When generateStatistics is true, the Shard records document
+        // frequencies and cumulative term counts for the Temporary*
+        // methods below. They are counted exactly when heavyHitterCount is
+        // 0, and otherwise with the DocumentFrequencyTableBuilder's
+        // approximate mode.
         Shard(IRecycler& recycler,
               ITokenManager& tokenManager,
               ITermTable2 const & termTable,
               IDocumentDataSchema const & docDataSchema,
               ISliceBufferAllocator& sliceBufferAllocator,
-              size_t sliceBufferSize);
+              size_t sliceBufferSize,
+              bool generateStatistics,
+              double statisticsErrorBound = 0.0,
+              size_t heavyHitterCount = 0);
 
         virtual ~Shard();
 
@@ -103,6 +116,10 @@ namespace BitFunnel
         // Returns the offset of the row in the slice buffer in a shard.
         virtual ptrdiff_t GetRowOffset(RowId rowId) const;
 
+        // Returns the offset in each slice buffer of the pointer to the
+        // Slice that owns the buffer. See Slice::GetSliceFromBuffer().
+        ptrdiff_t GetSlicePtrOffset() const;
+
         //
         // Shard exclusive members.
         //
@@ -124,6 +141,33 @@ namespace BitFunnel
         //   return DocumentHandleInternal(m_activeSlice, docIndex);
         DocumentHandleInternal AllocateDocument(DocId id);
 
+        // Group management. Documents allocated while a group is open are
+        // placed in Slices that belong to that group alone. Opening or
+        // closing a group seals the active Slice, so the next allocation
+        // starts a new one. The group holds a reference on each of its
+        // Slices until it is removed.
+        void OpenGroup(GroupId groupId);
+        void CloseGroup();
+
+        // Closes the group if it is open and returns its Slices. Returns an
+        // empty vector if the Shard has no Slices for the group. The caller
+        // takes over the group's reference on each Slice.
+        std::vector<Slice*> RemoveGroup(GroupId groupId);
+
+        // Re-packs the live documents of sparse Slices into fewer, new
+        // Slices. A Slice is sparse when fewer than maxDensity of its
+        // columns hold live documents. Only Slices that have been fully
+        // allocated and committed are considered, and Slices are only
+        // combined with others from the same group. The new Slices are
+        // swapped into the slice buffer list in a single exchange, the
+        // entries in documentMap are pointed at the new locations and the
+        // old Slices are handed to the IRecycler. Returns the number of
+        // Slices released.
+        //
+        // Not thread safe with respect to document expiration or group
+        // removal. The caller must prevent both while this runs.
+        size_t CompactSlices(double maxDensity, DocumentMap& documentMap);
+
         // Loads a Slice from a previously serialized state and adds it to the
         // list of Slices. As part of deserialization, LoadSlice loads
         // RowTable/DocTable descriptors from the stream and verifies that it is
@@ -149,6 +193,13 @@ namespace BitFunnel
         // Returns term table associated with this shard.
         ITermTable2 const & GetTermTable() const;
 
+        // Returns the calling thread's ResolvedTermCache for this shard's
+        // term table. Each thread keeps caches for up to
+        // c_maxTermCachesPerThread shards, creating them on first use.
+        virtual ResolvedTermCache& GetResolvedTermCache() override;
+        virtual DocumentFrequencyTableBuilder*
+            GetDocumentFrequencyTableBuilder() override;
+
         // Descriptor for RowTables and DocTable.
         DocTableDescriptor const & GetDocTable() const;
         RowTableDescriptor const & GetRowTable(Rank) const;
@@ -203,6 +254,34 @@ namespace BitFunnel
         //   swap newSlices and m_sliceBuffers, schedule newSlices for recycling.
         void CreateNewActiveSlice();
 
+        // Seals the active Slice and clears m_activeSlice. Returns the Slice
+        // if sealing made it fully expired, in which case the caller must
+        // decrement its reference count after releasing m_slicesLock.
+        // Otherwise returns nullptr. Must be called with m_slicesLock held.
+        Slice* SealActiveSlice();
+
+        // Returns a new Slice holding copies of the live documents in
+        // sources, starting at sources[next]. Advances next and position
+        // past the copied documents and appends a (from, to) pair to moves
+        // for each of them. Does not add the Slice to m_sliceBuffers. If
+        // sealing leaves the Slice fully expired, it is also appended to
+        // expired, and the caller must decrement its reference count once it
+        // is in m_sliceBuffers.
+        Slice* CreateCompactedSlice(
+            std::vector<Slice*> const & sources,
+            size_t& next,
+            DocIndex& position,
+            std::vector<std::pair<DocumentHandleInternal,
+                                  DocumentHandleInternal>>& moves,
+            std::vector<Slice*>& expired);
+
+        static const size_t c_maxTermCachesPerThread = 16;
+
+        // Identifies this Shard in the per-thread ResolvedTermCaches. Unlike
+        // the Shard's address, it is never reused by a later Shard.
+        const uint64_t m_instanceId;
+        static std::atomic<uint64_t> s_nextInstanceId;
+
         // Constructor parameters.
 
         IRecycler& m_recycler;
@@ -226,6 +305,12 @@ namespace BitFunnel
         // allocate a new Slice via CreateNewActiveSlice().
         Slice* m_activeSlice;
 
+        // The currently open group, if any, and the Slices of each group
+        // that has not been removed. Protected by m_slicesLock.
+        bool m_isGroupOpen;
+        GroupId m_openGroup;
+        std::unordered_map<GroupId, std::vector<Slice*>> m_groupSlices;
+
         // Vector of pointers to slice buffers.
         //
         // DESIGN NOTE: We store a pointer to an std::vector here instead of
@@ -282,7 +367,7 @@ namespace BitFunnel
         std::unique_ptr<DocTableDescriptor> m_docTable;
         std::vector<RowTableDescriptor> m_rowTables;
 
-        std::mutex m_temporaryFrequencyTableMutex;
+        // Null unless the Shard was constructed with generateStatistics.
         std::unique_ptr<DocumentFrequencyTableBuilder> m_docFrequencyTableBuilder;
     };
 }
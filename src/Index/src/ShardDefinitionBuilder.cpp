@@ -0,0 +1,199 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <istream>
+#include <limits>
+#include <ostream>
+
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/ITermTable2.h"
+#include "DocumentLengthHistogram.h"
+#include "LoggerInterfaces/Logging.h"
+#include "ShardDefinitionBuilder.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IShardDefinitionBuilder>
+        Factories::CreateShardDefinitionBuilder(
+            std::istream& documentLengthHistogram,
+            ITermTable2 const & termTable,
+            ShardId shardCount,
+            IShardDefinition& shardDefinition)
+    {
+        DocumentLengthHistogram histogram(documentLengthHistogram);
+        return std::unique_ptr<IShardDefinitionBuilder>(
+            new ShardDefinitionBuilder(histogram,
+                                       termTable,
+                                       shardCount,
+                                       shardDefinition));
+    }
+
+
+    ShardDefinitionBuilder::ShardDefinitionBuilder(
+        DocumentLengthHistogram const & histogram,
+        ITermTable2 const & termTable,
+        ShardId shardCount,
+        IShardDefinition& shardDefinition)
+      : m_documentCount(0),
+        m_maxPostingCount(0)
+    {
+        LogAssertB(shardCount > 0, "ShardDefinitionBuilder: shardCount must be positive.");
+        LogAssertB(shardDefinition.GetShardCount() == 1,
+                   "ShardDefinitionBuilder: shardDefinition must be empty.");
+
+        // Distinct posting counts in increasing order, with the number of
+        // documents up to and including each one.
+        std::vector<size_t> postingCounts;
+        std::vector<size_t> cumulativeCounts(1, 0);
+        size_t totalPostings = 0;
+        for (auto const & entry : histogram.GetMergedHistogram())
+        {
+            if (entry.second > 0)
+            {
+                postingCounts.push_back(entry.first);
+                cumulativeCounts.push_back(cumulativeCounts.back() + entry.second);
+                totalPostings += entry.first * entry.second;
+            }
+        }
+
+        if (postingCounts.empty())
+        {
+            RecoverableError error("ShardDefinitionBuilder: DocumentLengthHistogram has no documents.");
+            throw error;
+        }
+
+        m_documentCount = cumulativeCounts.back();
+        m_maxPostingCount = postingCounts.back();
+
+        // Calibrate the cost model so that a shard sized for the average
+        // document matches the TermTable.
+        const double c_bitsPerByte = 8.0;
+        m_fixedBytesPerDocument = ITermTable2::SystemTerm::Count / c_bitsPerByte;
+
+        double bytesPerDocument = 0;
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            bytesPerDocument += termTable.GetBytesPerDocument(rank);
+        }
+
+        double meanPostingCount =
+            static_cast<double>(totalPostings) / m_documentCount;
+        if (meanPostingCount < 1.0)
+        {
+            meanPostingCount = 1.0;
+        }
+
+        m_bytesPerPosting = (bytesPerDocument > m_fixedBytesPerDocument) ?
+            (bytesPerDocument - m_fixedBytesPerDocument) / meanPostingCount : 0.0;
+
+        // minBytes[s][i] is the smallest total for the first i posting
+        // counts split into s shards. start[s][i] is the index of the first
+        // posting count in the last of those shards.
+        const size_t n = postingCounts.size();
+        const size_t shards = (shardCount < n) ? shardCount : n;
+        const double c_infinity = std::numeric_limits<double>::infinity();
+
+        std::vector<std::vector<double>>
+            minBytes(shards + 1, std::vector<double>(n + 1, c_infinity));
+        std::vector<std::vector<size_t>>
+            start(shards + 1, std::vector<size_t>(n + 1, 0));
+        minBytes[0][0] = 0;
+
+        for (size_t s = 1; s <= shards; ++s)
+        {
+            for (size_t i = s; i <= n; ++i)
+            {
+                const double bytes = GetBytesPerDocument(postingCounts[i - 1]);
+                for (size_t j = s - 1; j < i; ++j)
+                {
+                    const double total = minBytes[s - 1][j] +
+                        bytes * (cumulativeCounts[i] - cumulativeCounts[j]);
+                    if (total < minBytes[s][i])
+                    {
+                        minBytes[s][i] = total;
+                        start[s][i] = j;
+                    }
+                }
+            }
+        }
+
+        m_shards.resize(shards);
+        size_t end = n;
+        for (size_t s = shards; s > 0; --s)
+        {
+            const size_t first = start[s][end];
+            m_shards[s - 1].m_maxPostingCount = postingCounts[end - 1];
+            m_shards[s - 1].m_documentCount =
+                cumulativeCounts[end] - cumulativeCounts[first];
+            end = first;
+        }
+
+        // The last shard is unbounded, so it is not added.
+        for (size_t s = 0; s + 1 < m_shards.size(); ++s)
+        {
+            shardDefinition.AddShard(m_shards[s].m_maxPostingCount);
+        }
+    }
+
+
+    double ShardDefinitionBuilder::GetBytesPerDocument(size_t maxPostingCount) const
+    {
+        return m_fixedBytesPerDocument + m_bytesPerPosting * maxPostingCount;
+    }
+
+
+    void ShardDefinitionBuilder::Print(std::ostream& output) const
+    {
+        output << "ShardDefinitionBuilder" << std::endl;
+        output << "  Documents: " << m_documentCount << std::endl;
+        output << "  Bytes per posting: " << m_bytesPerPosting << std::endl;
+        output << std::endl;
+
+        double totalBytes = 0;
+        for (size_t s = 0; s < m_shards.size(); ++s)
+        {
+            const double bytesPerDocument =
+                GetBytesPerDocument(m_shards[s].m_maxPostingCount);
+            totalBytes += bytesPerDocument * m_shards[s].m_documentCount;
+
+            output << "  Shard " << s << std::endl;
+            output << "    Max postings: " << m_shards[s].m_maxPostingCount
+                   << std::endl;
+            output << "    Documents: " << m_shards[s].m_documentCount
+                   << std::endl;
+            output << "    Bytes per document: " << bytesPerDocument
+                   << std::endl;
+        }
+
+        const double unshardedBytes =
+            GetBytesPerDocument(m_maxPostingCount) * m_documentCount;
+
+        output << std::endl;
+        output << "  Total bytes: " << totalBytes << std::endl;
+        output << "  Total bytes with one shard: " << unshardedBytes << std::endl;
+        output << std::endl;
+    }
+}
@@ -0,0 +1,87 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <iosfwd>                                       // std::ostream parameter.
+#include <vector>                                       // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"                   // ShardId parameter.
+#include "BitFunnel/Index/IShardDefinitionBuilder.h"    // Base class.
+
+
+namespace BitFunnel
+{
+    class DocumentLengthHistogram;
+    class IShardDefinition;
+    class ITermTable2;
+
+    //*************************************************************************
+    //
+    // ShardDefinitionBuilder
+    //
+    // Adds shards to an empty IShardDefinition so that the row memory for
+    // the documents in a DocumentLengthHistogram is minimized.
+    //
+    // Every document in a shard uses the same number of bits per row, and
+    // the rows must accommodate the longest documents in the shard at the
+    // target density. The builder therefore models the bytes per document
+    // in a shard as a fixed cost for the system rows plus a cost that grows
+    // linearly with the shard's maximum posting count. The linear term is
+    // calibrated from an ITermTable2 built for the corpus as a whole, which
+    // reflects the average document.
+    //
+    // The boundaries are chosen by dynamic programming over the distinct
+    // posting counts in the histogram. The cost is O(S * N^2) for S shards
+    // and N distinct posting counts.
+    //
+    //*************************************************************************
+    class ShardDefinitionBuilder : public IShardDefinitionBuilder
+    {
+    public:
+        ShardDefinitionBuilder(DocumentLengthHistogram const & histogram,
+                               ITermTable2 const & termTable,
+                               ShardId shardCount,
+                               IShardDefinition& shardDefinition);
+
+        virtual void Print(std::ostream& output) const override;
+
+    private:
+        // Returns the estimated bytes of row data for each document in a
+        // shard whose longest document has maxPostingCount postings.
+        double GetBytesPerDocument(size_t maxPostingCount) const;
+
+        double m_fixedBytesPerDocument;
+        double m_bytesPerPosting;
+
+        struct Shard
+        {
+            size_t m_maxPostingCount;
+            size_t m_documentCount;
+        };
+
+        std::vector<Shard> m_shards;
+        size_t m_documentCount;
+        size_t m_maxPostingCount;
+    };
+}
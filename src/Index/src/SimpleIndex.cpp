@@ -23,6 +23,7 @@
 #include <iostream>
 
 #include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Index/Helpers.h"
 #include "BitFunnel/Index/IRecycler.h"
@@ -50,7 +51,9 @@ namespace BitFunnel
         // What if TaskFactory calls back before SimpleIndex is fully initialized?
         : m_directory(directory),
           m_gramSize(static_cast<Term::GramSize>(gramSize)),
-          m_generateTermToText(generateTermToText)
+          m_generateTermToText(generateTermToText),
+          m_statisticsErrorBound(0.0),
+          m_heavyHitterCount(0)
     {
     }
 
@@ -132,18 +135,74 @@ namespace BitFunnel
         m_sliceAllocator = Factories::CreateSliceBufferAllocator(blockSize,
                                                                  initialBlockCount);
 
-        m_ingestor = Factories::CreateIngestor(*m_schema,
-                                               *m_recycler,
-                                               *m_termTables,
-                                               *m_shardDefinition,
-                                               *m_sliceAllocator);
+        if (forStatistics && m_heavyHitterCount > 0)
+        {
+            m_ingestor = Factories::CreateIngestor(*m_schema,
+                                                   *m_recycler,
+                                                   *m_termTables,
+                                                   *m_shardDefinition,
+                                                   *m_sliceAllocator,
+                                                   m_statisticsErrorBound,
+                                                   m_heavyHitterCount);
+        }
+        else
+        {
+            m_ingestor = Factories::CreateIngestor(*m_schema,
+                                                   *m_recycler,
+                                                   *m_termTables,
+                                                   *m_shardDefinition,
+                                                   *m_sliceAllocator,
+                                                   forStatistics);
+        }
+    }
+
+
+    void SimpleIndex::SetApproximateStatistics(double errorBound,
+                                               size_t heavyHitterCount)
+    {
+        if (m_ingestor != nullptr)
+        {
+            throw FatalError("SimpleIndex: SetApproximateStatistics() called after StartIndex().");
+        }
+
+        m_statisticsErrorBound = errorBound;
+        m_heavyHitterCount = heavyHitterCount;
+    }
+
+
+    void SimpleIndex::StartCompactor(double maxDensity,
+                                     size_t intervalInMilliseconds)
+    {
+        if (m_ingestor == nullptr)
+        {
+            throw FatalError("SimpleIndex: StartCompactor() called before StartIndex().");
+        }
+        if (m_compactor != nullptr)
+        {
+            throw FatalError("SimpleIndex: compactor already started.");
+        }
+
+        m_compactor = Factories::CreateSliceCompactor(*m_ingestor,
+                                                      maxDensity,
+                                                      intervalInMilliseconds);
+        m_compactorThread = std::thread(CompactorThreadEntryPoint, this);
     }
 
 
     void SimpleIndex::StopIndex()
     {
-        m_recycler->Shutdown();
-        m_recyclerThread.join();
+        // The compactor hands Slices to the recycler, so it stops first.
+        if (m_compactorThread.joinable())
+        {
+            m_compactor->Shutdown();
+            m_compactorThread.join();
+        }
+
+        if (m_recyclerThread.joinable())
+        {
+            m_recycler->Shutdown();
+            m_recyclerThread.join();
+        }
     }
 
 
@@ -185,4 +244,11 @@ namespace BitFunnel
         SimpleIndex* index = reinterpret_cast<SimpleIndex*>(data);
         index->m_recycler->Run();
     }
+
+
+    void SimpleIndex::CompactorThreadEntryPoint(void * data)
+    {
+        SimpleIndex* index = reinterpret_cast<SimpleIndex*>(data);
+        index->m_compactor->Run();
+    }
 }
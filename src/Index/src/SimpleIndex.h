@@ -34,6 +34,7 @@
 #include "BitFunnel/Index/IRecycler.h"              // Parameterizes std::unique_ptr.
 #include "BitFunnel/Index/ITermTableCollection.h"   // Parameterizes std::unique_ptr.
 #include "BitFunnel/Index/ISliceBufferAllocator.h"  // Parameterizes std::unique_ptr.
+#include "BitFunnel/Index/ISliceCompactor.h"        // Parameterizes std::unique_ptr.
 #include "BitFunnel/Index/ISimpleIndex.h"           // Parameterizes std::unique_ptr.
 #include "BitFunnel/ITermTable2.h"                  // Parameterizes std::unique_ptr.
 #include "BitFunnel/NonCopyable.h"                  // Base class.
@@ -52,6 +53,10 @@ namespace BitFunnel
         virtual ~SimpleIndex();
 
         virtual void StartIndex(bool forStatistics) override;
+        virtual void SetApproximateStatistics(double errorBound,
+                                              size_t heavyHitterCount) override;
+        virtual void StartCompactor(double maxDensity,
+                                    size_t intervalInMilliseconds) override;
         virtual void StopIndex() override;
 
         virtual IConfiguration const & GetConfiguration() const override;
@@ -63,6 +68,7 @@ namespace BitFunnel
 
     private:
         static void RecyclerThreadEntryPoint(void * data);
+        static void CompactorThreadEntryPoint(void * data);
 
         //
         // Constructor parameters.
@@ -72,6 +78,11 @@ namespace BitFunnel
         Term::GramSize m_gramSize;
         bool m_generateTermToText;
 
+        // Set by SetApproximateStatistics(). Statistics are exact when
+        // m_heavyHitterCount is 0.
+        double m_statisticsErrorBound;
+        size_t m_heavyHitterCount;
+
 
         //
         // Members initialized by StartIndex().
@@ -91,5 +102,12 @@ namespace BitFunnel
         std::unique_ptr<IShardDefinition> m_shardDefinition;
 
         std::unique_ptr<IIngestor> m_ingestor;
+
+        //
+        // Members initialized by StartCompactor().
+        //
+
+        std::unique_ptr<ISliceCompactor> m_compactor;
+        std::thread m_compactorThread;
     };
 }
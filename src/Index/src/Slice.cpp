@@ -21,9 +21,11 @@
 // THE SOFTWARE.
 
 #include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/ResolvedTermCache.h"
 #include "BitFunnel/RowId.h"
 #include "BitFunnel/RowIdSequence.h"
 #include "DocTableDescriptor.h"
+#include "DocumentFrequencyTableBuilder.h"
 #include "ISliceOwner.h"
 #include "LoggerInterfaces/Logging.h"
 #include "RowTableDescriptor.h"
@@ -32,6 +34,9 @@
 
 namespace BitFunnel
 {
+    std::atomic<uint64_t> Slice::s_nextGeneration(0);
+
+
     // TODO: where should this function live?
     // Extracts a RowId used to mark documents as active/soft-deleted.
     static RowId RowIdForDeletedDocument(ITermTable2 const & termTable)
@@ -77,6 +82,8 @@ namespace BitFunnel
           m_temporaryNextDocIndex(0U),
           m_capacity(sliceCapacity),
           m_refCount(1),
+          m_generation(++s_nextGeneration),
+          m_maxStaticRank(0),
           m_buffer(sliceBuffer),
           m_unallocatedCount(sliceCapacity),
           m_commitPendingCount(0),
@@ -130,20 +137,24 @@ namespace BitFunnel
     }
 
 
-    void Slice::AddPosting(Term const & term, DocIndex index)
+    void Slice::AddPosting(Term const & term,
+                           DocIndex index,
+                           ResolvedTermCache& cache)
     {
         void* sliceBuffer = GetSliceBuffer();
 
-        // TODO: enable statistics collection.
-        // if (m_docFrequencyTableBuilder.get() != nullptr)
-        // {
-        //     std::lock_guard<std::mutex> lock(m_temporaryFrequencyTableMutex);
-        //     m_docFrequencyTableBuilder->OnTerm(term);
-        // }
-
-        RowIdSequence rows(term, m_termTable);
+        // The builder keeps per-thread counts, so concurrent ingestion
+        // threads don't contend here.
+        DocumentFrequencyTableBuilder* statistics =
+            m_owner.GetDocumentFrequencyTableBuilder();
+        if (statistics != nullptr)
+        {
+            statistics->OnTerm(term);
+        }
 
-        for (auto const row : rows)
+        // Resolving through the thread's cache avoids a TermTable lookup
+        // and, for adhoc terms, rehashing for each RowId of each posting.
+        for (auto const row : cache.GetRows(term))
         {
             m_rowTables[row.GetRank()].SetBit(sliceBuffer,
                                               row.GetIndex(),
@@ -152,6 +163,12 @@ namespace BitFunnel
     }
 
 
+    ResolvedTermCache& Slice::GetResolvedTermCache() const
+    {
+        return m_owner.GetResolvedTermCache();
+    }
+
+
     void Slice::AssertFact(FactHandle fact, bool value, DocIndex index)
     {
         void* sliceBuffer = GetSliceBuffer();
@@ -191,6 +208,31 @@ namespace BitFunnel
                               row.GetIndex(),
                               index);
         }
+
+        AdvanceGeneration();
+    }
+
+
+    void Slice::SetStaticRank(StaticRank rank, DocIndex index)
+    {
+        m_docTable.SetStaticRank(m_buffer, index, rank);
+        RaiseMaxStaticRank(rank);
+    }
+
+
+    StaticRank Slice::GetMaxStaticRank() const
+    {
+        return m_maxStaticRank;
+    }
+
+
+    void Slice::RaiseMaxStaticRank(StaticRank rank)
+    {
+        StaticRank current = m_maxStaticRank;
+        while (current < rank &&
+               !m_maxStaticRank.compare_exchange_weak(current, rank))
+        {
+        }
     }
 
 
@@ -201,6 +243,7 @@ namespace BitFunnel
                    "CommitDocument with m_commitPendingCount == 0");
 
         --m_commitPendingCount;
+        AdvanceGeneration();
 
         return (m_unallocatedCount + m_commitPendingCount) == 0;
     }
@@ -228,11 +271,124 @@ namespace BitFunnel
                    "Slice expired more documents than committed.");
 
         m_expiredCount++;
+        AdvanceGeneration();
+
+        return m_expiredCount == m_capacity;
+    }
+
+
+    bool Slice::Seal()
+    {
+        std::lock_guard<std::mutex> lock(m_docIndexLock);
+
+        if (m_unallocatedCount == 0)
+        {
+            return false;
+        }
+
+        m_expiredCount += m_unallocatedCount;
+        m_unallocatedCount = 0;
 
         return m_expiredCount == m_capacity;
     }
 
 
+    bool Slice::ExpireAll()
+    {
+        std::lock_guard<std::mutex> lock(m_docIndexLock);
+
+        LogAssertB(m_unallocatedCount == 0 && m_commitPendingCount == 0,
+                   "Slice::ExpireAll on a Slice with documents in progress.");
+
+        if (m_expiredCount == m_capacity)
+        {
+            return false;
+        }
+
+        m_rowTables[m_documentActiveRowId.GetRank()].
+            ClearRow(m_buffer, m_documentActiveRowId.GetIndex());
+        m_expiredCount = m_capacity;
+        AdvanceGeneration();
+
+        return true;
+    }
+
+
+    uint64_t Slice::GetGeneration() const
+    {
+        return m_generation;
+    }
+
+
+    void Slice::AdvanceGeneration()
+    {
+        m_generation = ++s_nextGeneration;
+    }
+
+
+    DocIndex Slice::GetCapacity() const
+    {
+        return m_capacity;
+    }
+
+
+    bool Slice::TryGetLiveCount(DocIndex& liveCount) const
+    {
+        std::lock_guard<std::mutex> lock(m_docIndexLock);
+
+        if (m_unallocatedCount != 0 || m_commitPendingCount != 0)
+        {
+            return false;
+        }
+
+        liveCount = m_capacity - m_expiredCount;
+        return true;
+    }
+
+
+    bool Slice::IsActive(DocIndex index) const
+    {
+        return m_rowTables[m_documentActiveRowId.GetRank()].
+            GetBit(m_buffer, m_documentActiveRowId.GetIndex(), index) != 0;
+    }
+
+
+    void Slice::CopyDocuments(
+        std::vector<std::pair<DocIndex, DocIndex>> const & columns,
+        Slice& destination) const
+    {
+        for (auto const & column : columns)
+        {
+            m_docTable.CopyItem(m_buffer,
+                                column.first,
+                                destination.m_buffer,
+                                column.second);
+            destination.RaiseMaxStaticRank(
+                m_docTable.GetStaticRank(m_buffer, column.first));
+        }
+
+        // Working one row at a time keeps each row's quadwords in cache
+        // while all of the columns are copied.
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            RowTableDescriptor const & rowTable = m_rowTables[rank];
+            const RowIndex rowCount = m_termTable.GetTotalRowCount(rank);
+            for (RowIndex row = 0; row < rowCount; ++row)
+            {
+                for (auto const & column : columns)
+                {
+                    if (rowTable.GetBit(m_buffer, row, column.first) != 0)
+                    {
+                        rowTable.SetBit(destination.m_buffer,
+                                        row,
+                                        column.second);
+                    }
+                }
+            }
+        }
+    }
+
+
     DocTableDescriptor const & Slice::GetDocTable() const
     {
         return m_docTable;
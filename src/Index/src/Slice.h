@@ -26,6 +26,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 #include "BitFunnel/BitFunnelTypes.h"  // For DocIndex, Rank.
@@ -39,6 +40,7 @@ namespace BitFunnel
 {
     class DocTableDescriptor;
     class ITermTable2;
+    class ResolvedTermCache;
     class RowTableDescriptor;
     class Term;
 
@@ -152,9 +154,33 @@ namespace BitFunnel
         // back to its allocator and destroys the Slice.
         virtual ~Slice();
 
-        void AddPosting(Term const & term, DocIndex index);
+        // Sets the bits of the term's rows for the document at index. The
+        // RowIds are resolved through cache, which must be the calling
+        // thread's cache from GetResolvedTermCache().
+        void AddPosting(Term const & term,
+                        DocIndex index,
+                        ResolvedTermCache& cache);
+
+        // Returns the calling thread's ResolvedTermCache for the owner's
+        // TermTable. The lookup is not free, so callers adding many postings
+        // should get the cache once.
+        ResolvedTermCache& GetResolvedTermCache() const;
         void AssertFact(FactHandle fact, bool value, DocIndex index);
 
+        // Stores the document's StaticRank in the DocTable and raises the
+        // Slice's bound if needed. Throws if the schema has no static rank
+        // blob.
+        //
+        // Thread safe.
+        void SetStaticRank(StaticRank rank, DocIndex index);
+
+        // Returns an upper bound on the StaticRank of the Slice's documents.
+        // The bound never decreases, so it stays valid as documents are
+        // expired.
+        //
+        // Thread safe.
+        StaticRank GetMaxStaticRank() const;
+
         // Returns the slice buffer associated with this Slice. Slice buffer
         // is allocated by the Slice using ISliceBufferAllocator from its
         // parent Shard.
@@ -223,6 +249,49 @@ namespace BitFunnel
         //   return m_expiredCount == m_capacity.
         bool ExpireDocument();
 
+        // Stops further allocations from the Slice by treating its
+        // unallocated DocIndexes as expired. Used to keep the documents of
+        // different groups in different Slices. Returns true if this call
+        // made the Slice fully expired, in which case the caller is
+        // responsible of decrementing the reference count on the Slice.
+        //
+        // Thread safe.
+        bool Seal();
+
+        // Hides all documents in a sealed Slice from future matching
+        // operations by clearing its document active row. All documents in
+        // the Slice must have been committed. Returns true if this call made
+        // the Slice fully expired, in which case the caller is responsible of
+        // decrementing the reference count on the Slice.
+        //
+        // Thread safe.
+        bool ExpireAll();
+
+        // Returns the number of documents the Slice can hold.
+        DocIndex GetCapacity() const;
+
+        // Returns true if every column of the Slice has been allocated and
+        // committed, setting liveCount to the number of documents that have
+        // not been expired. Returns false while documents may still be
+        // added to the Slice.
+        //
+        // Thread safe.
+        bool TryGetLiveCount(DocIndex& liveCount) const;
+
+        // Returns true if the document at index is serving, i.e. its bit in
+        // the document active row is set.
+        bool IsActive(DocIndex index) const;
+
+        // Copies the documents at the first DocIndex of each column pair,
+        // including their DocTable entries and row bits, to the second
+        // DocIndex in another Slice of the same Shard. The rows are copied
+        // one at a time, over all of the columns. A rank > 0 bit is shared
+        // by several columns, so the destination gets the source's folded
+        // bit and each document matches everything it matched before.
+        void CopyDocuments(
+            std::vector<std::pair<DocIndex, DocIndex>> const & columns,
+            Slice& destination) const;
+
         // Returns true if the Slice is fully expired, meaning that all of its
         // documents are expired. In this case the Slice can be removed from
         // the index.
@@ -230,6 +299,15 @@ namespace BitFunnel
         // Slices are scheduled for recycling. Think if this is needed at all.
         bool IsExpired() const;
 
+        // Returns a value that changes whenever the bits of the Slice's
+        // committed documents may have changed, i.e. when a document is
+        // committed or expired, or a fact is asserted. Values are unique
+        // across all Slices, so a result computed from a Slice may be cached
+        // under its generation and reused while the generation is unchanged.
+        //
+        // Thread safe.
+        uint64_t GetGeneration() const;
+
         // Extracts Slice information from the buffer where its data is stored.
         // Slice places a pointer to itself at the offset which is controlled
         // by Shard.
@@ -256,6 +334,15 @@ namespace BitFunnel
         // Returns a reference to the Slice pointer which is placed inside a sliceBuffer.
         static Slice*& GetSlicePointer(void* sliceBuffer, ptrdiff_t slicePtrOffset);
 
+        // Called after the bits of committed documents have changed.
+        void AdvanceGeneration();
+
+        // Raises m_maxStaticRank to at least rank.
+        void RaiseMaxStaticRank(StaticRank rank);
+
+        // Source of the values returned by GetGeneration().
+        static std::atomic<uint64_t> s_nextGeneration;
+
         // Owner of the slice. In production, this is expected to be a Shard,
         // but it can be anything that has a method that which allows us to call
         // RecycleSlice.
@@ -292,6 +379,12 @@ namespace BitFunnel
         // for recycling.
         std::atomic<uint32_t> m_refCount;
 
+        // See GetGeneration().
+        std::atomic<uint64_t> m_generation;
+
+        // See GetMaxStaticRank().
+        std::atomic<StaticRank> m_maxStaticRank;
+
         // WARNING: The persistence format depends on the order in which the
         // following members are declared. If the order is changed, it is
         // neccesary to update the corresponding code in the Write() method.
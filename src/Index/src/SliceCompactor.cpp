@@ -0,0 +1,82 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "SliceCompactor.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<ISliceCompactor>
+        Factories::CreateSliceCompactor(IIngestor& ingestor,
+                                        double maxDensity,
+                                        size_t intervalInMilliseconds)
+    {
+        return std::unique_ptr<ISliceCompactor>(
+            new SliceCompactor(ingestor, maxDensity, intervalInMilliseconds));
+    }
+
+
+    SliceCompactor::SliceCompactor(IIngestor& ingestor,
+                                   double maxDensity,
+                                   size_t intervalInMilliseconds)
+      : m_ingestor(ingestor),
+        m_maxDensity(maxDensity),
+        m_interval(intervalInMilliseconds),
+        m_shutdown(false)
+    {
+    }
+
+
+    void SliceCompactor::Run()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;)
+        {
+            m_shutdownCondition.wait_for(lock,
+                                         m_interval,
+                                         [this] () { return m_shutdown; });
+            if (m_shutdown)
+            {
+                break;
+            }
+
+            // Shutdown() shouldn't wait for a compaction pass to take the
+            // lock.
+            lock.unlock();
+            m_ingestor.CompactSlices(m_maxDensity);
+            lock.lock();
+        }
+    }
+
+
+    void SliceCompactor::Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_shutdown = true;
+        }
+        m_shutdownCondition.notify_all();
+    }
+}
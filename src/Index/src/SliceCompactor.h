@@ -0,0 +1,70 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <chrono>                           // std::chrono::milliseconds member.
+#include <condition_variable>               // std::condition_variable member.
+#include <mutex>                            // std::mutex member.
+
+#include "BitFunnel/Index/ISliceCompactor.h"    // Base class.
+#include "BitFunnel/NonCopyable.h"              // Base class.
+
+
+namespace BitFunnel
+{
+    class IIngestor;
+
+    //*************************************************************************
+    //
+    // SliceCompactor
+    //
+    // Calls IIngestor::CompactSlices() at a fixed interval. Slices in which
+    // fewer than maxDensity of the columns hold live documents are re-packed
+    // and the Slices they leave empty are handed to the IRecycler.
+    //
+    //*************************************************************************
+    class SliceCompactor : public ISliceCompactor, NonCopyable
+    {
+    public:
+        SliceCompactor(IIngestor& ingestor,
+                       double maxDensity,
+                       size_t intervalInMilliseconds);
+
+        //
+        // ISliceCompactor API.
+        //
+        virtual void Run() override;
+        virtual void Shutdown() override;
+
+    private:
+        IIngestor& m_ingestor;
+        const double m_maxDensity;
+        const std::chrono::milliseconds m_interval;
+
+        // Guards m_shutdown and wakes Run() early on shutdown.
+        std::mutex m_lock;
+        std::condition_variable m_shutdownCondition;
+        bool m_shutdown;
+    };
+}
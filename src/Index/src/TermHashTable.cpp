@@ -0,0 +1,214 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>                            // std::sort.
+#include <cstring>                              // std::memcpy.
+#include <istream>
+#include <ostream>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/StreamUtilities.h"
+#include "TermHashTable.h"
+
+
+namespace BitFunnel
+{
+    TermHashTable::TermHashTable(
+        std::unordered_map<Term::Hash, PackedRowIdSequence> const & terms)
+    {
+        // Keep the table at most half full.
+        size_t capacity = 2;
+        while (capacity < 2 * terms.size())
+        {
+            capacity *= 2;
+        }
+
+        m_ownedEntries.resize(capacity, Entry());
+        SetCapacity(capacity);
+        m_size = terms.size();
+
+        // Insert in hash order so that the placement of colliding entries,
+        // and therefore the serialized table, is deterministic.
+        std::vector<Term::Hash> hashes;
+        hashes.reserve(terms.size());
+        for (auto const & term : terms)
+        {
+            hashes.push_back(term.first);
+        }
+        std::sort(hashes.begin(), hashes.end());
+
+        for (auto hash : hashes)
+        {
+            size_t slot = GetSlot(hash);
+            while (m_ownedEntries[slot].m_occupied)
+            {
+                slot = (slot + 1) & (m_capacity - 1);
+            }
+
+            Entry& entry = m_ownedEntries[slot];
+            entry.m_hash = hash;
+            entry.m_rows = terms.find(hash)->second;
+            entry.m_occupied = 1;
+        }
+    }
+
+
+    TermHashTable::TermHashTable(std::istream& input)
+    {
+        const Header header = StreamUtilities::ReadField<Header>(input);
+        if (header.m_capacity == 0
+            || (header.m_capacity & (header.m_capacity - 1)) != 0
+            || header.m_size >= header.m_capacity)
+        {
+            throw FatalError("TermHashTable: invalid header.");
+        }
+
+        m_ownedEntries.resize(header.m_capacity);
+        StreamUtilities::ReadArray(input,
+                                   m_ownedEntries.data(),
+                                   m_ownedEntries.size());
+
+        SetCapacity(header.m_capacity);
+        m_size = header.m_size;
+    }
+
+
+    TermHashTable::TermHashTable(char const * buffer, size_t byteCount)
+    {
+        if (byteCount < sizeof(Header)
+            || reinterpret_cast<size_t>(buffer) % alignof(Entry) != 0)
+        {
+            throw FatalError("TermHashTable: invalid buffer.");
+        }
+
+        Header header;
+        std::memcpy(&header, buffer, sizeof(Header));
+        if (header.m_capacity == 0
+            || (header.m_capacity & (header.m_capacity - 1)) != 0
+            || header.m_size >= header.m_capacity
+            || header.m_capacity > (byteCount - sizeof(Header)) / sizeof(Entry))
+        {
+            throw FatalError("TermHashTable: invalid header.");
+        }
+
+        m_entries = reinterpret_cast<Entry const *>(buffer + sizeof(Header));
+        SetCapacity(header.m_capacity);
+        m_size = header.m_size;
+    }
+
+
+    void TermHashTable::Write(std::ostream& output) const
+    {
+        Header header;
+        header.m_capacity = m_capacity;
+        header.m_size = m_size;
+
+        StreamUtilities::WriteField(output, header);
+        StreamUtilities::WriteArray(output, m_entries, m_capacity);
+    }
+
+
+    size_t TermHashTable::GetSerializedSize() const
+    {
+        return sizeof(Header) + m_capacity * sizeof(Entry);
+    }
+
+
+    bool TermHashTable::TryGetRows(Term::Hash hash,
+                                   PackedRowIdSequence& rows) const
+    {
+        // The table always has an empty slot, so the probe terminates.
+        size_t slot = GetSlot(hash);
+        for (;;)
+        {
+            Entry const & entry = m_entries[slot];
+            if (!entry.m_occupied)
+            {
+                return false;
+            }
+            if (entry.m_hash == hash)
+            {
+                rows = entry.m_rows;
+                return true;
+            }
+            slot = (slot + 1) & (m_capacity - 1);
+        }
+    }
+
+
+    size_t TermHashTable::size() const
+    {
+        return m_size;
+    }
+
+
+    bool TermHashTable::operator==(TermHashTable const & other) const
+    {
+        if (m_capacity != other.m_capacity || m_size != other.m_size)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < m_capacity; ++i)
+        {
+            Entry const & a = m_entries[i];
+            Entry const & b = other.m_entries[i];
+            if (a.m_occupied != b.m_occupied)
+            {
+                return false;
+            }
+            if (a.m_occupied && (a.m_hash != b.m_hash || !(a.m_rows == b.m_rows)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    size_t TermHashTable::GetSlot(Term::Hash hash) const
+    {
+        // Term hashes of system terms and facts are small consecutive
+        // integers, so mix all of the bits into the slot with Fibonacci
+        // hashing.
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> m_shift);
+    }
+
+
+    void TermHashTable::SetCapacity(size_t capacity)
+    {
+        if (!m_ownedEntries.empty())
+        {
+            m_entries = m_ownedEntries.data();
+        }
+        m_capacity = capacity;
+
+        unsigned log2Capacity = 0;
+        while ((1ull << log2Capacity) < capacity)
+        {
+            ++log2Capacity;
+        }
+        m_shift = 64 - log2Capacity;
+    }
+}
@@ -0,0 +1,120 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <iosfwd>                           // std::istream/std::ostream parameters.
+#include <stddef.h>                         // size_t members.
+#include <stdint.h>                         // uint32_t member.
+#include <type_traits>                      // std::is_trivially_copyable.
+#include <unordered_map>                    // std::unordered_map parameter.
+#include <vector>                           // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"          // Inherits from NonCopyable.
+#include "BitFunnel/PackedRowIdSequence.h"  // PackedRowIdSequence member.
+#include "BitFunnel/Term.h"                 // Term::Hash member.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // TermHashTable
+    //
+    // Read-only map from Term::Hash to PackedRowIdSequence used by a sealed
+    // TermTable. Entries are stored in a flat, power-of-two sized array and
+    // collisions are resolved by linear probing. Each entry is 16 bytes and
+    // the table is at most half full, so a lookup usually touches a single
+    // cache line.
+    //
+    // The serialized form is the array itself, preceded by its capacity and
+    // entry count. A TermHashTable can either own a copy of the array or
+    // reference one in place, e.g. inside a MemoryMappedFile.
+    //
+    //*************************************************************************
+    class TermHashTable : public NonCopyable
+    {
+    public:
+        // Builds a table containing the entries of terms. The layout of the
+        // table depends only on the set of entries, not on the iteration
+        // order of terms.
+        TermHashTable(
+            std::unordered_map<Term::Hash, PackedRowIdSequence> const & terms);
+
+        // Reads a table previously serialized with Write().
+        TermHashTable(std::istream& input);
+
+        // Constructs a table that references serialized data in place. The
+        // buffer must be 8-byte aligned and must outlive the TermHashTable.
+        // Throws FatalError if the first byteCount bytes of the buffer do not
+        // hold a valid table.
+        TermHashTable(char const * buffer, size_t byteCount);
+
+        void Write(std::ostream& output) const;
+
+        // Returns the number of bytes written by Write().
+        size_t GetSerializedSize() const;
+
+        // Returns true and sets rows if hash is in the table.
+        bool TryGetRows(Term::Hash hash, PackedRowIdSequence& rows) const;
+
+        size_t size() const;
+
+        bool operator==(TermHashTable const & other) const;
+
+    private:
+        struct Entry
+        {
+            Term::Hash m_hash;
+            PackedRowIdSequence m_rows;
+            uint32_t m_occupied;
+        };
+
+        static_assert(std::is_trivially_copyable<Entry>::value,
+                      "TermHashTable: Entry must be trivially copyable.");
+        static_assert(sizeof(Entry) == 16,
+                      "TermHashTable: Entry should be 16 bytes.");
+
+        struct Header
+        {
+            uint64_t m_capacity;
+            uint64_t m_size;
+        };
+
+        size_t GetSlot(Term::Hash hash) const;
+
+        void SetCapacity(size_t capacity);
+
+        std::vector<Entry> m_ownedEntries;
+
+        // Points to m_ownedEntries or into a caller supplied buffer.
+        Entry const * m_entries;
+
+        size_t m_capacity;
+        size_t m_size;
+
+        // log2(m_capacity) high order bits of the mixed hash select the
+        // initial slot.
+        unsigned m_shift;
+    };
+}
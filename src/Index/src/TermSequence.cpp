@@ -0,0 +1,172 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cstring>                          // memcmp(), memcpy().
+
+#include "LoggerInterfaces/Logging.h"
+#include "TermSequence.h"
+
+
+namespace BitFunnel
+{
+    TermSequence::TermSequence()
+    {
+    }
+
+
+    void TermSequence::OpenStream(Term::StreamId stream)
+    {
+        m_headers.push_back(stream);
+        m_headers.push_back(0);
+    }
+
+
+    void TermSequence::AddTerm(Term const & term)
+    {
+        LogAssertB(!m_headers.empty(), "TermSequence: no open stream.");
+
+        m_fingerprints.push_back(GetFingerprint(term.GetRawHash()));
+        ++m_headers.back();
+    }
+
+
+    size_t TermSequence::GetByteCount() const
+    {
+        return sizeof(uint32_t) +
+               m_headers.size() * sizeof(uint32_t) +
+               m_fingerprints.size() * sizeof(uint16_t);
+    }
+
+
+    void TermSequence::Write(void* buffer) const
+    {
+        char* output = reinterpret_cast<char*>(buffer);
+
+        const uint32_t streamCount = static_cast<uint32_t>(m_headers.size() / 2);
+        memcpy(output, &streamCount, sizeof(streamCount));
+        output += sizeof(streamCount);
+
+        if (!m_headers.empty())
+        {
+            memcpy(output, m_headers.data(), m_headers.size() * sizeof(uint32_t));
+            output += m_headers.size() * sizeof(uint32_t);
+        }
+
+        if (!m_fingerprints.empty())
+        {
+            memcpy(output,
+                   m_fingerprints.data(),
+                   m_fingerprints.size() * sizeof(uint16_t));
+        }
+    }
+
+
+    uint16_t TermSequence::GetFingerprint(Term::Hash rawHash)
+    {
+        // Fold every bit of the hash into the fingerprint.
+        return static_cast<uint16_t>(rawHash ^
+                                     (rawHash >> 16) ^
+                                     (rawHash >> 32) ^
+                                     (rawHash >> 48));
+    }
+
+
+    bool TermSequence::ContainsPhrase(void const * buffer,
+                                      Term::StreamId stream,
+                                      uint16_t const * phrase,
+                                      size_t length)
+    {
+        char const * input = reinterpret_cast<char const *>(buffer);
+
+        uint32_t streamCount;
+        memcpy(&streamCount, input, sizeof(streamCount));
+        uint32_t const * headers =
+            reinterpret_cast<uint32_t const *>(input + sizeof(streamCount));
+        uint16_t const * fingerprints =
+            reinterpret_cast<uint16_t const *>(headers + 2 * streamCount);
+
+        for (uint32_t i = 0; i < streamCount; ++i)
+        {
+            const uint32_t count = headers[2 * i + 1];
+            if (headers[2 * i] == stream &&
+                ContainsPhrase(fingerprints, count, phrase, length))
+            {
+                return true;
+            }
+            fingerprints += count;
+        }
+
+        return false;
+    }
+
+
+    bool TermSequence::ContainsPhrase(uint16_t const * fingerprints,
+                                      size_t count,
+                                      uint16_t const * phrase,
+                                      size_t length)
+    {
+        if (length == 0 || length > count)
+        {
+            return length == 0;
+        }
+
+        // Positions where the phrase could start.
+        const size_t starts = count - length + 1;
+        const size_t phraseBytes = length * sizeof(uint16_t);
+
+        // Compare the first term of the phrase with four fingerprints at a
+        // time. A lane of x is zero where the fingerprint matches, and the
+        // expression below is non-zero if and only if some lane is zero.
+        const uint64_t c_lowBits = 0x0001000100010001ull;
+        const uint64_t c_highBits = 0x8000800080008000ull;
+        const uint64_t first = phrase[0] * c_lowBits;
+
+        size_t start = 0;
+        for (; start + 4 <= starts; start += 4)
+        {
+            uint64_t block;
+            memcpy(&block, fingerprints + start, sizeof(block));
+            const uint64_t x = block ^ first;
+            if (((x - c_lowBits) & ~x & c_highBits) != 0)
+            {
+                for (size_t i = start; i < start + 4; ++i)
+                {
+                    if (memcmp(fingerprints + i, phrase, phraseBytes) == 0)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        for (; start < starts; ++start)
+        {
+            if (memcmp(fingerprints + start, phrase, phraseBytes) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
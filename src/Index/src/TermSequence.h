@@ -0,0 +1,92 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stddef.h>                 // size_t parameter.
+#include <stdint.h>                 // uint16_t, uint32_t members.
+#include <vector>                   // std::vector member.
+
+#include "BitFunnel/Term.h"         // Term::StreamId parameter.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // TermSequence
+    //
+    // Records the sequence of terms in each stream of a document as 16-bit
+    // fingerprints of the terms' hashes, in the layout stored in the
+    // DocTable's term sequence blob:
+    //
+    //   uint32_t streamCount
+    //   streamCount x { uint32_t streamId, uint32_t termCount }
+    //   the fingerprints of each stream, in order, as uint16_t.
+    //
+    // A stream that is opened more than once gets a sequence for each time.
+    //
+    // The fingerprints let a query confirm that the terms of a phrase are
+    // adjacent and in order, which the n-gram rows alone cannot. Two terms
+    // share a fingerprint with probability 1/65536.
+    //
+    //*************************************************************************
+    class TermSequence
+    {
+    public:
+        TermSequence();
+
+        // Starts a new sequence of terms in the stream.
+        void OpenStream(Term::StreamId stream);
+
+        // Appends a term to the sequence opened by the last OpenStream().
+        void AddTerm(Term const & term);
+
+        // Returns the number of bytes written by Write().
+        size_t GetByteCount() const;
+
+        // Writes the sequences to buffer, which must hold GetByteCount()
+        // bytes.
+        void Write(void* buffer) const;
+
+        static uint16_t GetFingerprint(Term::Hash rawHash);
+
+        // Returns true if buffer, which was written by Write(), has a
+        // sequence in the stream that contains the fingerprints of the
+        // phrase's terms at consecutive positions.
+        static bool ContainsPhrase(void const * buffer,
+                                   Term::StreamId stream,
+                                   uint16_t const * phrase,
+                                   size_t length);
+
+    private:
+        static bool ContainsPhrase(uint16_t const * fingerprints,
+                                   size_t count,
+                                   uint16_t const * phrase,
+                                   size_t length);
+
+        // Pairs of stream id and term count, one per sequence.
+        std::vector<uint32_t> m_headers;
+        std::vector<uint16_t> m_fingerprints;
+    };
+}
@@ -21,12 +21,15 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
+#include <cstring>
 #include <math.h>
 #include <sstream>
 
 #include "BitFunnel/BitFunnelTypes.h"
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Utilities/IInputStream.h"
 #include "BitFunnel/Utilities/StreamUtilities.h"
 #include "TermTable.h"
 
@@ -51,6 +54,66 @@ namespace BitFunnel
     }
 
 
+    std::unique_ptr<ITermTable2>
+        Factories::CreateTermTable(std::string const & fileName)
+    {
+        return std::unique_ptr<ITermTable2>(new TermTable(fileName));
+    }
+
+
+    //*************************************************************************
+    //
+    // MemoryInputStream
+    //
+    // IInputStream over a block of memory. Used to parse memory mapped
+    // TermTables without copying the large arrays.
+    //
+    //*************************************************************************
+    class MemoryInputStream : public IInputStream
+    {
+    public:
+        MemoryInputStream(char const * data, size_t byteCount)
+          : m_next(data),
+            m_end(data + byteCount)
+        {
+        }
+
+        virtual size_t Read(char* destination, size_t byteCount) override
+        {
+            const size_t bytesRead = (std::min)(byteCount, GetRemaining());
+            if (bytesRead > 0)
+            {
+                std::memcpy(destination, m_next, bytesRead);
+                m_next += bytesRead;
+            }
+            return bytesRead;
+        }
+
+        char const * GetPosition() const
+        {
+            return m_next;
+        }
+
+        size_t GetRemaining() const
+        {
+            return static_cast<size_t>(m_end - m_next);
+        }
+
+        void Skip(size_t byteCount)
+        {
+            if (byteCount > GetRemaining())
+            {
+                throw FatalError("MemoryInputStream: attempt to skip past end of data.");
+            }
+            m_next += byteCount;
+        }
+
+    private:
+        char const * m_next;
+        char const * m_end;
+    };
+
+
     //*************************************************************************
     //
     // TermTable
@@ -58,6 +121,8 @@ namespace BitFunnel
     //*************************************************************************
     TermTable::TermTable()
       : m_sealed(false),
+        m_rows(nullptr),
+        m_rowCount(0),
         m_explicitRowCounts(c_maxRankValue + 1, 0),
         m_adhocRowCounts(c_maxRankValue + 1, 0),
         m_sharedRowCounts(c_maxRankValue + 1, 0),
@@ -88,19 +153,15 @@ namespace BitFunnel
       : m_sealed(true),
         m_start(0)
     {
-        size_t count = StreamUtilities::ReadField<size_t>(input);
-        for (size_t i = 0; i < count; ++i)
-        {
-            const Term::Hash hash = StreamUtilities::ReadField<Term::Hash>(input);
-            const PackedRowIdSequence rows = StreamUtilities::ReadField<PackedRowIdSequence>(input);
+        m_explicitTerms.reset(new TermHashTable(input));
 
-            m_termHashToRows.insert(std::make_pair(hash, rows));
-        }
+        m_rowIds = StreamUtilities::ReadVector<RowId>(input);
+        m_rows = m_rowIds.data();
+        m_rowCount = m_rowIds.size();
 
         m_ranksInUse = StreamUtilities::ReadField<RanksInUse>(input);
         m_maxRankInUse = StreamUtilities::ReadField<Rank>(input);
         m_adhocRows = StreamUtilities::ReadField<AdhocRecipes>(input);
-        m_rowIds = StreamUtilities::ReadVector<RowId>(input);
         m_explicitRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
         m_adhocRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
         m_sharedRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
@@ -110,22 +171,50 @@ namespace BitFunnel
     }
 
 
-    void TermTable::Write(std::ostream& output) const
+    TermTable::TermTable(std::string const & fileName)
+      : m_sealed(true),
+        m_start(0),
+        m_file(new MemoryMappedFile(fileName))
     {
-        StreamUtilities::WriteField<size_t>(output, m_termHashToRows.size());
-        for (auto entry : m_termHashToRows)
+        // The layout must match Write(). The TermHashTable comes first so
+        // that it is 8-byte aligned in the page aligned mapping. The RowIds
+        // follow an 8-byte count, which keeps them 4-byte aligned.
+        MemoryInputStream input(m_file->GetData(), m_file->GetSize());
+
+        m_explicitTerms.reset(
+            new TermHashTable(input.GetPosition(), input.GetRemaining()));
+        input.Skip(m_explicitTerms->GetSerializedSize());
+
+        m_rowCount = StreamUtilities::ReadField<size_t>(input);
+        m_rows = reinterpret_cast<RowId const *>(input.GetPosition());
+        if (m_rowCount > input.GetRemaining() / sizeof(RowId))
         {
-            const Term::Hash hash = entry.first;
-            const PackedRowIdSequence rows = entry.second;
-
-            StreamUtilities::WriteField<Term::Hash>(output, hash);
-            StreamUtilities::WriteField<PackedRowIdSequence>(output, rows);
+            throw FatalError("TermTable: RowIds extend past end of file.");
         }
+        input.Skip(m_rowCount * sizeof(RowId));
+
+        m_ranksInUse = StreamUtilities::ReadField<RanksInUse>(input);
+        m_maxRankInUse = StreamUtilities::ReadField<Rank>(input);
+        m_adhocRows = StreamUtilities::ReadField<AdhocRecipes>(input);
+        m_explicitRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
+        m_adhocRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
+        m_sharedRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
+        m_factRowCount = StreamUtilities::ReadField<RowIndex>(input);
+    }
+
+
+    void TermTable::Write(std::ostream& output) const
+    {
+        ThrowIfSealed(false);
+
+        m_explicitTerms->Write(output);
+
+        StreamUtilities::WriteField<size_t>(output, m_rowCount);
+        StreamUtilities::WriteArray(output, m_rows, m_rowCount);
 
         StreamUtilities::WriteField<RanksInUse>(output, m_ranksInUse);
         StreamUtilities::WriteField<Rank>(output, m_maxRankInUse);
         StreamUtilities::WriteField<AdhocRecipes>(output, m_adhocRows);
-        StreamUtilities::WriteVector(output, m_rowIds);
         StreamUtilities::WriteVector(output, m_explicitRowCounts);
         StreamUtilities::WriteVector(output, m_adhocRowCounts);
         StreamUtilities::WriteVector(output, m_sharedRowCounts);
@@ -244,6 +333,12 @@ namespace BitFunnel
                 m_rowIds[r] = RowId(rowId, m_adhocRowCounts[rowId.GetRank()]);
             }
         }
+
+        m_rows = m_rowIds.data();
+        m_rowCount = m_rowIds.size();
+
+        m_explicitTerms.reset(new TermHashTable(m_termHashToRows));
+        std::unordered_map<Term::Hash, PackedRowIdSequence>().swap(m_termHashToRows);
     }
 
 
@@ -278,6 +373,8 @@ namespace BitFunnel
 
     PackedRowIdSequence TermTable::GetRows(const Term& term) const
     {
+        ThrowIfSealed(false);
+
         const Term::Hash hash = term.GetRawHash();
 
         if (hash < m_factRowCount)
@@ -286,10 +383,10 @@ namespace BitFunnel
         }
         else
         {
-            auto it = m_termHashToRows.find(term.GetRawHash());
-            if (it != m_termHashToRows.end())
+            PackedRowIdSequence rows;
+            if (m_explicitTerms->TryGetRows(hash, rows))
             {
-                return (*it).second;
+                return rows;
             }
             else
             {
@@ -322,13 +419,13 @@ namespace BitFunnel
 
     RowId TermTable::GetRowIdExplicit(size_t index) const
     {
-        if (index >= m_rowIds.size())
+        if (index >= m_rowCount)
         {
             RecoverableError error("TermTable::GetRowIdExplicit: index out of range.");
             throw error;
         }
 
-        return m_rowIds[index];
+        return m_rows[index];
     }
 
 
@@ -350,13 +447,13 @@ namespace BitFunnel
                                    size_t index,
                                    size_t variant) const
     {
-        if (index >= m_rowIds.size())
+        if (index >= m_rowCount)
         {
             RecoverableError error("TermTable::GetRowIdAdhoc: index out of range.");
             throw error;
         }
 
-        const RowId rowId = m_rowIds[index];
+        const RowId rowId = m_rows[index];
 
         const ShardId shard = rowId.GetShard();
         const Rank rank = rowId.GetRank();
@@ -395,7 +492,7 @@ namespace BitFunnel
         // TODO: investigate if we should split RowId to shard + 
         // shard-independent structure and keep m_shard in the TermTable.
         // TFS 15153.
-        const RowId anyRow = m_rowIds[0];
+        const RowId anyRow = m_rows[0];
 
         // Soft-deleted document row is the first one after all regular
         // rows. The caller specifies rowOffset = 0 in this case. The rationale
@@ -414,8 +511,11 @@ namespace BitFunnel
         equals = equals && (m_ranksInUse == other.m_ranksInUse);
         equals = equals && (m_maxRankInUse == other.m_maxRankInUse);
         equals = equals && (m_termHashToRows == other.m_termHashToRows);
+        equals = equals && ((m_explicitTerms == nullptr) == (other.m_explicitTerms == nullptr));
+        equals = equals && (m_explicitTerms == nullptr || *m_explicitTerms == *other.m_explicitTerms);
         equals = equals && (m_adhocRows == other.m_adhocRows);
-        equals = equals && (m_rowIds == other.m_rowIds);
+        equals = equals && (m_rowCount == other.m_rowCount);
+        equals = equals && std::equal(m_rows, m_rows + m_rowCount, other.m_rows);
         equals = equals && (m_explicitRowCounts == other.m_explicitRowCounts);
         equals = equals && (m_adhocRowCounts == other.m_adhocRowCounts);
         equals = equals && (m_sharedRowCounts == other.m_sharedRowCounts);
@@ -24,11 +24,15 @@
 
 #include <unordered_map>            // std::unordered_map member.
 #include <array>                    // std::array member.
+#include <memory>                   // std::unique_ptr member.
+#include <string>                   // std::string parameter.
 #include <vector>                   // std::vector member.
 
 #include "BitFunnel/ITermTable2.h"   // Base class.
 #include "BitFunnel/RowId.h"        // RowId template parameter.
 #include "BitFunnel/Term.h"         // Term::Hash parameter.
+#include "BitFunnel/Utilities/MemoryMappedFile.h"   // std::unique_ptr template parameter.
+#include "TermHashTable.h"          // std::unique_ptr template parameter.
 
 
 namespace BitFunnel
@@ -42,7 +46,14 @@ namespace BitFunnel
         // Write() method.
         TermTable(std::istream& input);
 
-        // Writes the contents of the ITermTable2 to a stream.
+        // Constructs a TermTable that reads data previously serialized via
+        // the Write() method directly from a memory mapped file. Explicit
+        // terms and RowIds are not copied, so loading time does not depend
+        // on the size of the TermTable.
+        TermTable(std::string const & fileName);
+
+        // Writes the contents of the ITermTable2 to a stream. The TermTable
+        // must be sealed.
         virtual void Write(std::ostream& output) const override;
 
         // Instructs the TermTable to start recording RowIds added by AddRowId.
@@ -73,7 +84,8 @@ namespace BitFunnel
 
         // Completes the TermTable build process by converting relative
         // RowIndex values to absolute RowIndex values. This can only be done
-        // after the row counts are set via a call to SetRowCounts().
+        // after the row counts are set via a call to SetRowCounts(). Also
+        // moves the explicit terms into a read-only TermHashTable.
         virtual void Seal() override;
 
         //
@@ -98,7 +110,7 @@ namespace BitFunnel
         virtual double GetBytesPerDocument(Rank rank) const override;
 
         // Returns a PackedRowIdSequence structure associated with the
-        // specified term. The PackedRowIdSequence structure contains
+        // specified term. The TermTable must be sealed. The PackedRowIdSequence structure contains
         // information about the term's rows. PackedRowIdSequence is used
         // by RowIdSequence to implement RowId enumeration for regular, adhoc
         // and fact terms.
@@ -144,13 +156,17 @@ namespace BitFunnel
         RanksInUse m_ranksInUse{};
         Rank m_maxRankInUse;
 
-        // TODO: Is the term table big enough that we would benefit from
-        // a more compact class than std::pair<RowIndex, RowIndex>>? Would this
-        // even lead to a benefit if we didn't replace std::unordered_map with
-        // a better hash table? Should measure actual memory use for this data
-        // structure.
+        // Explicit terms added during the build. Seal() moves these into
+        // m_explicitTerms.
         std::unordered_map<Term::Hash, PackedRowIdSequence> m_termHashToRows;
 
+        // Set for memory mapped TermTables. Must be declared before the
+        // members that reference its data.
+        std::unique_ptr<MemoryMappedFile> m_file;
+
+        // Explicit terms of a sealed TermTable.
+        std::unique_ptr<TermHashTable> m_explicitTerms;
+
         typedef
             std::array<
                 std::array<PackedRowIdSequence,
@@ -165,8 +181,13 @@ namespace BitFunnel
 
         AdhocRecipes m_adhocRows;
 
+        // RowIds added during the build, or read from a stream.
         std::vector<RowId> m_rowIds;
 
+        // RowIds of a sealed TermTable. Points to m_rowIds or into m_file.
+        RowId const * m_rows;
+        size_t m_rowCount;
+
         std::vector<RowIndex> m_explicitRowCounts;
         std::vector<RowIndex> m_adhocRowCounts;
         std::vector<RowIndex> m_sharedRowCounts;
@@ -31,8 +31,12 @@
 #include "BitFunnel/Index/IFactSet.h"
 #include "BitFunnel/ITermTable2.h"
 #include "BitFunnel/ITermTreatment.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
 #include "BitFunnel/Utilities/Stopwatch.h"
 #include "DocumentFrequencyTable.h"
+#include "LoggerInterfaces/Logging.h"
 #include "TermTableBuilder.h"
 
 
@@ -49,7 +53,8 @@ namespace BitFunnel
                                           ITermTreatment const & treatment,
                                           IDocumentFrequencyTable const & terms,
                                           IFactSet const & facts,
-                                          ITermTable2 & termTable)
+                                          ITermTable2 & termTable,
+                                          size_t threadCount)
     {
         return
             std::unique_ptr<ITermTableBuilder>(new TermTableBuilder(density,
@@ -57,10 +62,104 @@ namespace BitFunnel
                                                                     treatment,
                                                                     terms,
                                                                     facts,
-                                                                    termTable));
+                                                                    termTable,
+                                                                    threadCount));
     }
 
 
+    //*************************************************************************
+    //
+    // TermTableBuilder::TreatmentProcessor
+    //
+    // Evaluates the ITermTreatment for a block of consecutive terms.
+    //
+    //*************************************************************************
+    class TermTableBuilder::TreatmentProcessor : public ITaskProcessor
+    {
+    public:
+        static const size_t c_termsPerTask = 4096;
+
+        TreatmentProcessor(ITermTreatment const & treatment,
+                           IDocumentFrequencyTable const & terms,
+                           std::vector<RowConfiguration> & configurations)
+          : m_treatment(treatment),
+            m_terms(terms),
+            m_configurations(configurations)
+        {
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            size_t start = taskId * c_termsPerTask;
+            size_t end = std::min(start + c_termsPerTask, m_terms.size());
+            for (size_t i = start; i < end; ++i)
+            {
+                m_configurations[i] =
+                    m_treatment.GetTreatment(m_terms[i].GetTerm());
+            }
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        ITermTreatment const & m_treatment;
+        IDocumentFrequencyTable const & m_terms;
+        std::vector<RowConfiguration> & m_configurations;
+    };
+
+
+    //*************************************************************************
+    //
+    // TermTableBuilder::RankProcessor
+    //
+    // Runs the RowAssigner for a single rank over every term, in the order
+    // the terms appear in the IDocumentFrequencyTable.
+    //
+    //*************************************************************************
+    class TermTableBuilder::RankProcessor : public ITaskProcessor
+    {
+    public:
+        RankProcessor(IDocumentFrequencyTable const & terms,
+                      std::vector<RowConfiguration> const & configurations,
+                      std::vector<std::unique_ptr<RowAssigner>> const & assigners)
+          : m_terms(terms),
+            m_configurations(configurations),
+            m_assigners(assigners)
+        {
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            Rank rank = static_cast<Rank>(taskId);
+            RowAssigner & assigner = *m_assigners[rank];
+
+            for (size_t i = 0; i < m_configurations.size(); ++i)
+            {
+                for (auto rcEntry : m_configurations[i])
+                {
+                    if (rcEntry.GetRank() == rank)
+                    {
+                        assigner.Assign(m_terms[i].GetFrequency(),
+                                        rcEntry.GetRowCount(),
+                                        rcEntry.IsPrivate());
+                    }
+                }
+            }
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        IDocumentFrequencyTable const & m_terms;
+        std::vector<RowConfiguration> const & m_configurations;
+        std::vector<std::unique_ptr<RowAssigner>> const & m_assigners;
+    };
+
+
     //*************************************************************************
     //
     // TermTableBuilder
@@ -71,7 +170,8 @@ namespace BitFunnel
                                        ITermTreatment const & treatment,
                                        IDocumentFrequencyTable const & terms,
                                        IFactSet const & facts,
-                                       ITermTable2 & termTable)
+                                       ITermTable2 & termTable,
+                                       size_t threadCount)
         : m_termTable(termTable),
           m_buildTime(0.0)
     {
@@ -89,35 +189,61 @@ namespace BitFunnel
         }
 
 
-        // For each entry in the document frequency table.
-        // (note that the entries are sorted in order of decreasing frequency).
-        for (auto dfEntry : terms)
+        if (threadCount == 0)
         {
-            // TODO: Consider handling disposed terms here.
+            threadCount = 1;
+        }
 
-            //std::cout << "Term: ";
-            //dfEntry.GetTerm().Print(std::cout);
-            //std::cout << "; frequency = " << dfEntry.GetFrequency() << std::endl;
+        // Evaluate the treatment for each entry in the document frequency
+        // table (note that the entries are sorted in order of decreasing
+        // frequency).
+        // TODO: Consider handling disposed terms here.
+        std::vector<RowConfiguration> configurations(terms.size());
+        {
+            std::vector<std::unique_ptr<ITaskProcessor>> processors;
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                processors.push_back(
+                    std::unique_ptr<ITaskProcessor>(
+                        new TreatmentProcessor(treatment,
+                                               terms,
+                                               configurations)));
+            }
 
-            m_termTable.OpenTerm();
+            size_t taskCount =
+                (terms.size() + TreatmentProcessor::c_termsPerTask - 1) /
+                TreatmentProcessor::c_termsPerTask;
+            ProcessTasks(processors, taskCount);
+        }
 
-            // Get the term's RowConfiguration.
-            auto configuration = treatment.GetTreatment(dfEntry.GetTerm());
+        // Assign the rows for each rank. Each RowAssigner sees the terms in
+        // the same order as a serial build would.
+        {
+            std::vector<std::unique_ptr<ITaskProcessor>> processors;
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                processors.push_back(
+                    std::unique_ptr<ITaskProcessor>(
+                        new RankProcessor(terms,
+                                          configurations,
+                                          m_rowAssigners)));
+            }
 
-            //std::cout << "  Configuration: ";
-            //configuration.Write(std::cout);
-            //std::cout << std::endl;
+            ProcessTasks(processors, m_rowAssigners.size());
+        }
+
+        // Merge the assigned rows into the TermTable in term order.
+        for (size_t i = 0; i < configurations.size(); ++i)
+        {
+            m_termTable.OpenTerm();
 
             // For each rank entry in the RowConfiguration.
-            for (auto rcEntry : configuration)
+            for (auto rcEntry : configurations[i])
             {
-                // Assign the appropriate rows.
-                m_rowAssigners[rcEntry.GetRank()]->Assign(dfEntry.GetFrequency(),
-                                                          rcEntry.GetRowCount(),
-                                                          rcEntry.IsPrivate());
+                m_rowAssigners[rcEntry.GetRank()]->AddRowIds();
             }
 
-            m_termTable.CloseTerm(dfEntry.GetTerm().GetRawHash());
+            m_termTable.CloseTerm(terms[i].GetTerm().GetRawHash());
         }
 
         // TODO: make entries for facts.
@@ -200,6 +326,26 @@ namespace BitFunnel
     }
 
 
+    void TermTableBuilder::ProcessTasks(
+        std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
+        size_t taskCount)
+    {
+        if (processors.size() > 1 && taskCount > 1)
+        {
+            auto distributor =
+                Factories::CreateTaskDistributor(processors, taskCount);
+            distributor->WaitForCompletion();
+        }
+        else
+        {
+            for (size_t i = 0; i < taskCount; ++i)
+            {
+                processors[0]->ProcessTask(i);
+            }
+        }
+    }
+
+
     // TODO: Come up with a more principled solution.
     // When building a TermTable based on a small IDocumentFrequencyTable,
     // the builder may run into a situation where it encounters no adhoc
@@ -242,6 +388,9 @@ namespace BitFunnel
           m_termTable(termTable),
           m_adhocTotal(0),
           m_currentRow(0),
+          m_bins(adhocFrequency, density),
+          m_nextRow(0),
+          m_nextAssignment(0),
           m_explicitTermCount(0),
           m_adhocTermCount(0),
           m_privateTermCount(0),
@@ -275,9 +424,9 @@ namespace BitFunnel
             ++m_privateTermCount;
             ++m_privateRowCount;
 
-            // Just reserve the RowIndex and then add the appropriate RowID to
-            // the TermTableBuilder.
-            m_termTable.AddRowId(RowId(0, m_rank, m_currentRow++));
+            // Just reserve the RowIndex.
+            m_rows.push_back(m_currentRow++);
+            m_rowCounts.push_back(1);
         }
         else if (f < m_adhocFrequency)
         {
@@ -288,6 +437,8 @@ namespace BitFunnel
             // Update m_adhocTotal with this term's contribution to the total
             // number of bits.
             m_adhocTotal += frequency * count;
+
+            m_rowCounts.push_back(0);
         }
         else
         {
@@ -298,51 +449,56 @@ namespace BitFunnel
             // Use the Best Fit Descreasing bin packing algorithm.
             // See https://www.cs.ucsb.edu/~suri/cs130b/BinPacking.txt.
 
-            // currentBins holds bins assigned for this term.
-            std::vector<Bin> currentBins;
+            // m_currentBins holds bins assigned for this term.
+            m_currentBins.clear();
 
             for (RowIndex i = 0; i < count; ++i)
             {
                 // Look for an existing bin with enough space.
-                auto it = m_bins.lower_bound(Bin(f));
-                if (it == m_bins.end())
+                Bin bin(0.0);
+                if (m_bins.TryRemoveBestFit(f, bin))
                 {
-                    // No existing bin has enough space. Start a new bin.
-                    currentBins.push_back(Bin(m_density, f, m_currentRow++));
-                }
-                else
-                {
-                    // Found a bin with enough space.
-                    Bin bin = *it;
-
-                    // Remove this bin from m_bins since we will be updating
-                    // its space.
-                    m_bins.erase(it);
-
-                    // Reserve space in this bin for term.
+                    // Found a bin with enough space. Reserve space in this
+                    // bin for term.
                     bin.Reserve(f);
 
                     // Add to bins associated with this term.
                     // DESIGN NOTE: we can't immediately reinsert bin into
                     // m_bins because we must ensure that all bins for this
                     // term are unique. If we reinserted bin at this point,
-                    // the call to m_bins.lower_bound() might return it on
-                    // a future iteration.
-                    currentBins.push_back(bin);
+                    // the call to TryRemoveBestFit() might return it on a
+                    // future iteration.
+                    m_currentBins.push_back(bin);
+                }
+                else
+                {
+                    // No existing bin has enough space. Start a new bin.
+                    m_currentBins.push_back(Bin(m_density, f, m_currentRow++));
                 }
             }
 
-            // All of the bins for this term have been identified.
-
-            // Now add the appropriate RowIds to the TermTable.
-            for (auto b : currentBins)
+            // All of the bins for this term have been identified. Record
+            // their rows and reinsert the bins into m_bins.
+            for (auto const & bin : m_currentBins)
             {
-                // TODO: figure out ShardId value here.
-                m_termTable.AddRowId(RowId(0, m_rank, b.GetIndex()));
+                m_rows.push_back(bin.GetIndex());
+                m_bins.Insert(bin);
             }
+            m_rowCounts.push_back(static_cast<uint8_t>(count));
+        }
+    }
+
 
-            // Reinsert the bins into m_bins.
-            m_bins.insert(currentBins.begin(), currentBins.end());
+    void TermTableBuilder::RowAssigner::AddRowIds()
+    {
+        LogAssertB(m_nextAssignment < m_rowCounts.size(),
+                   "RowAssigner::AddRowIds: no more assignments.");
+
+        size_t count = m_rowCounts[m_nextAssignment++];
+        for (size_t i = 0; i < count; ++i)
+        {
+            // TODO: figure out ShardId value here.
+            m_termTable.AddRowId(RowId(0, m_rank, m_rows[m_nextRow++]));
         }
     }
 
@@ -402,10 +558,7 @@ namespace BitFunnel
             output << std::endl;
 
             Accumulator a;
-            for (auto bin : m_bins)
-            {
-                a.Record(bin.GetFrequency(m_density));
-            }
+            m_bins.Record(m_density, a);
 
             output << std::endl;
 
@@ -418,4 +571,140 @@ namespace BitFunnel
 
         output << std::endl;
     }
+
+
+    //*************************************************************************
+    //
+    // TermTableBuilder::RowAssigner::Bins
+    //
+    //*************************************************************************
+    TermTableBuilder::RowAssigner::Bins::Bins(double minSpace, double maxSpace)
+      : m_minSpace(std::max(minSpace, 0.0)),
+        m_scale(maxSpace > m_minSpace ?
+                c_bucketCount / (maxSpace - m_minSpace) :
+                0.0),
+        m_buckets(c_bucketCount),
+        m_nonEmpty((c_bucketCount + 63) / 64, 0ull),
+        m_size(0)
+    {
+    }
+
+
+    bool TermTableBuilder::RowAssigner::Bins::TryRemoveBestFit(double space,
+                                                               Bin & bin)
+    {
+        // Bins in lower buckets have at most space available and bins in
+        // higher buckets have more, so only this bucket needs a search.
+        size_t bucket = GetBucket(space);
+        auto & candidates = m_buckets[bucket];
+        auto it = std::lower_bound(
+            candidates.begin(),
+            candidates.end(),
+            space,
+            [](Bin const & b, double s) { return b.GetAvailableSpace() < s; });
+
+        if (it == candidates.end())
+        {
+            bucket = FindNonEmpty(bucket + 1);
+            if (bucket == c_bucketCount)
+            {
+                return false;
+            }
+            it = m_buckets[bucket].begin();
+        }
+
+        auto & bins = m_buckets[bucket];
+        bin = *it;
+        bins.erase(it);
+        if (bins.empty())
+        {
+            m_nonEmpty[bucket / 64] &= ~(1ull << (bucket % 64));
+        }
+        --m_size;
+
+        return true;
+    }
+
+
+    void TermTableBuilder::RowAssigner::Bins::Insert(Bin const & bin)
+    {
+        ++m_size;
+
+        if (bin.GetAvailableSpace() < m_minSpace)
+        {
+            m_retired.push_back(bin);
+        }
+        else
+        {
+            size_t bucket = GetBucket(bin.GetAvailableSpace());
+            auto & bins = m_buckets[bucket];
+            bins.insert(std::upper_bound(bins.begin(), bins.end(), bin), bin);
+            m_nonEmpty[bucket / 64] |= 1ull << (bucket % 64);
+        }
+    }
+
+
+    size_t TermTableBuilder::RowAssigner::Bins::size() const
+    {
+        return m_size;
+    }
+
+
+    void TermTableBuilder::RowAssigner::Bins::Record(
+        double density,
+        Accumulator & accumulator) const
+    {
+        for (auto const & bins : m_buckets)
+        {
+            for (auto const & bin : bins)
+            {
+                accumulator.Record(bin.GetFrequency(density));
+            }
+        }
+
+        for (auto const & bin : m_retired)
+        {
+            accumulator.Record(bin.GetFrequency(density));
+        }
+    }
+
+
+    size_t TermTableBuilder::RowAssigner::Bins::GetBucket(double space) const
+    {
+        double x = (space - m_minSpace) * m_scale;
+        if (!(x > 0.0))
+        {
+            return 0;
+        }
+        else if (x >= c_bucketCount - 1)
+        {
+            return c_bucketCount - 1;
+        }
+        return static_cast<size_t>(x);
+    }
+
+
+    size_t TermTableBuilder::RowAssigner::Bins::FindNonEmpty(size_t bucket) const
+    {
+        while (bucket < c_bucketCount)
+        {
+            uint64_t word = m_nonEmpty[bucket / 64] >> (bucket % 64);
+            if (word == 0)
+            {
+                // Skip to the start of the next word.
+                bucket = (bucket / 64 + 1) * 64;
+            }
+            else
+            {
+                while ((word & 1) == 0)
+                {
+                    word >>= 1;
+                    ++bucket;
+                }
+                return bucket;
+            }
+        }
+
+        return c_bucketCount;
+    }
 }
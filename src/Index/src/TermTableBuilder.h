@@ -26,7 +26,7 @@
 #include <iterator>                             // typedef uses std::back_inserter_iterator.
 #include <map>                                  // std::map member.
 #include <memory>                               // std::unique_ptr member.
-#include <set>                                  // std::set member.
+#include <stdint.h>                             // uint8_t, uint64_t members.
 #include <vector>                               // std::vector member.
 
 #include "BitFunnel/BitFunnelTypes.h"           // Rank parameter.
@@ -41,8 +41,26 @@ namespace BitFunnel
     class DocumentFrequencyTable;   // TODO: IDocumentFrequencyTable
     class IFactSet;
     class ITermTreatment;
+    class ITaskProcessor;
     class ITermTable2;
 
+    //*************************************************************************
+    //
+    // TermTableBuilder
+    //
+    // Configures an ITermTable2 from an IDocumentFrequencyTable and an
+    // ITermTreatment.
+    //
+    // The build runs in three phases. First, the ITermTreatment is evaluated
+    // for every term, with the terms partitioned into blocks that are spread
+    // across threadCount threads. Second, each rank's RowAssigner walks the
+    // terms in frequency order and assigns rows for that rank. Since the
+    // RowAssigners are independent of each other, the ranks are processed in
+    // parallel. Finally, the RowIds are merged into the TermTable in term
+    // order. Because each RowAssigner still sees the terms in the original
+    // order, the resulting TermTable is identical for any threadCount.
+    //
+    //*************************************************************************
     class TermTableBuilder : public ITermTableBuilder
     {
     public:
@@ -51,7 +69,8 @@ namespace BitFunnel
                          ITermTreatment const & treatment,
                          IDocumentFrequencyTable const & terms,
                          IFactSet const & facts,
-                         ITermTable2 & termTable);
+                         ITermTable2 & termTable,
+                         size_t threadCount);
 
         virtual void Print(std::ostream& output) const override;
 
@@ -83,6 +102,15 @@ namespace BitFunnel
         class RowAssigner;
         std::vector <std::unique_ptr<RowAssigner>> m_rowAssigners;
 
+        class TreatmentProcessor;
+        class RankProcessor;
+
+        // Runs taskCount tasks on the processors, using a TaskDistributor
+        // when there is more than one processor.
+        static void ProcessTasks(
+            std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
+            size_t taskCount);
+
         double m_buildTime;
 
 
@@ -119,35 +147,21 @@ namespace BitFunnel
                         double adhocFrequency,
                         ITermTable2 & termTable);
 
+            // Assigns rows at this rank for a term with the specified
+            // frequency. The RowIds are buffered until AddRowIds() is
+            // called.
             void Assign(double frequency, RowIndex count, bool isPrivate);
 
+            // Adds the RowIds assigned by the next Assign() call, in the order
+            // the calls were made, to the TermTable.
+            void AddRowIds();
+
             RowIndex GetExplicitRowCount() const;
             RowIndex GetAdhocRowCount() const;
 
             void Print(std::ostream& output) const;
 
         private:
-            // Constructor parameters.
-            Rank m_rank;
-            double m_density;
-            double m_adhocFrequency;
-            ITermTable2 & m_termTable;
-
-            // Sum of frequencies of all adhoc terms. Used to compute the
-            // number of adhoc rows.
-            double m_adhocTotal;
-
-            RowIndex m_currentRow;
-
-            class Bin;
-            std::set<Bin> m_bins;
-
-            size_t m_explicitTermCount;
-            size_t m_adhocTermCount;
-            size_t m_privateTermCount;
-            size_t m_privateRowCount;
-
-
             class Bin
             {
             public:
@@ -158,7 +172,8 @@ namespace BitFunnel
                 }
 
                 Bin(double frequency)
-                    : m_availableSpace(frequency)
+                    : m_availableSpace(frequency),
+                      m_index(0)
                 {
                 }
 
@@ -199,6 +214,90 @@ namespace BitFunnel
                 double m_availableSpace;
                 RowIndex m_index;
             };
+
+
+            //*****************************************************************
+            //
+            // Bins
+            //
+            // Holds the shared explicit rows for Best Fit bin packing. Bins
+            // are bucketed by available space, and each bucket is a short
+            // vector sorted by (available space, index). A bitmap of
+            // non-empty buckets lets a lookup skip directly to the next
+            // candidate. The best fit is the same bin that lower_bound()
+            // would return from a std::set<Bin>.
+            //
+            // Bins with less than minSpace available can never receive
+            // another term, so they are retired to an unsorted vector and
+            // never searched again.
+            //
+            //*****************************************************************
+            class Bins
+            {
+            public:
+                Bins(double minSpace, double maxSpace);
+
+                // Removes the bin with the least available space that is at
+                // least space, breaking ties by lowest index. Returns false
+                // if no bin has enough space.
+                bool TryRemoveBestFit(double space, Bin & bin);
+
+                void Insert(Bin const & bin);
+
+                // Returns the total number of bins, including retired bins.
+                size_t size() const;
+
+                // Records the frequency of each bin in the accumulator.
+                void Record(double density, Accumulator & accumulator) const;
+
+            private:
+                size_t GetBucket(double space) const;
+
+                // Returns the first non-empty bucket at or after bucket, or
+                // c_bucketCount if there is none.
+                size_t FindNonEmpty(size_t bucket) const;
+
+                static const size_t c_bucketCount = 1024;
+
+                double m_minSpace;
+                double m_scale;
+
+                std::vector<std::vector<Bin>> m_buckets;
+                std::vector<uint64_t> m_nonEmpty;
+                std::vector<Bin> m_retired;
+                size_t m_size;
+            };
+
+
+            // Constructor parameters.
+            Rank m_rank;
+            double m_density;
+            double m_adhocFrequency;
+            ITermTable2 & m_termTable;
+
+            // Sum of frequencies of all adhoc terms. Used to compute the
+            // number of adhoc rows.
+            double m_adhocTotal;
+
+            RowIndex m_currentRow;
+
+            Bins m_bins;
+
+            // Bins assigned to the current term. Kept as a member to avoid
+            // an allocation for each term.
+            std::vector<Bin> m_currentBins;
+
+            // RowIndexes from all Assign() calls, and the number of rows
+            // from each call, waiting to be added by AddRowIds().
+            std::vector<RowIndex> m_rows;
+            std::vector<uint8_t> m_rowCounts;
+            size_t m_nextRow;
+            size_t m_nextAssignment;
+
+            size_t m_explicitTermCount;
+            size_t m_adhocTermCount;
+            size_t m_privateTermCount;
+            size_t m_privateRowCount;
         };
     };
 }
@@ -20,8 +20,6 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-#include <istream>
-
 #include "BitFunnel/IFileManager.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/ITermTable2.h"
@@ -66,9 +64,11 @@ namespace BitFunnel
     {
         for (ShardId shard = 0; shard < shardCount; ++shard)
         {
-            auto input = fileManager.TermTable(0).OpenForRead();
+            // Map the file rather than reading it so that large TermTables
+            // load without parsing.
             m_termTables.emplace_back(
-                std::unique_ptr<ITermTable2>(new TermTable(*input)));
+                std::unique_ptr<ITermTable2>(
+                    new TermTable(fileManager.TermTable(0).GetName())));
         }
     }
 
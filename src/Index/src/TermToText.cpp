@@ -91,6 +91,8 @@ namespace BitFunnel
 
     void TermToText::AddTerm(Term::Hash hash, std::string const & text)
     {
+        std::lock_guard<std::mutex> lock(m_lock);
+
         auto it = m_termToText.find(hash);
         if (it == m_termToText.end())
         {
@@ -24,6 +24,7 @@
 
 #include <iosfwd>                           // std::istream parameter.
 #include <memory>                           // std::unique_ptr
+#include <mutex>                            // std::mutex member.
 #include <string>                           // std::string template parameter.
 #include <unordered_map>                    // std::unordered_map embedded.
 
@@ -61,7 +62,9 @@ namespace BitFunnel
 
         // Adds a (Term::Hash, std::string) mapping. Note that only the first
         // mapping for a particular Term::Hash will be recorded. Subsequent
-        // additions for the same Term::Hash will be ignored.
+        // additions for the same Term::Hash will be ignored. AddTerm() is
+        // thread safe with other calls to AddTerm(), but not with Write() or
+        // Lookup().
         void AddTerm(Term::Hash hash, std::string const & text);
 
         // Returns the text for a particular Term::Hash, if that hash is in the
@@ -73,6 +76,9 @@ namespace BitFunnel
         // Implemented as a member because Lookup() returns a const reference.
         const std::string m_emptyString;
 
+        // Serializes AddTerm() for multi-threaded ingestion.
+        std::mutex m_lock;
+
         // Term::Hash ==> std::string map.
         std::unordered_map<Term::Hash, std::string> m_termToText;
     };
@@ -0,0 +1,383 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>                            // std::min().
+#include <math.h>                               // pow().
+#include <ostream>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/IDocumentFrequencyTable.h"
+#include "TermTreatmentTuner.h"
+
+
+namespace BitFunnel
+{
+    TermTreatmentTuner::TermTreatmentTuner(double density,
+                                           double maxFalsePositiveRate)
+      : m_density(density),
+        m_maxFalsePositiveRate(maxFalsePositiveRate),
+        m_termCounts(c_bucketCount, 0),
+        m_queryTermCounts(c_bucketCount, 0),
+        m_queryCount(0),
+        m_candidates(c_bucketCount)
+    {
+        if (!(density > 0.0 && density < 1.0))
+        {
+            RecoverableError
+                error("TermTreatmentTuner: density must be in (0, 1).");
+            throw error;
+        }
+
+        if (!(maxFalsePositiveRate > 0.0))
+        {
+            RecoverableError
+                error("TermTreatmentTuner: maxFalsePositiveRate must be positive.");
+            throw error;
+        }
+
+        for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+        {
+            EnumerateCandidates(idf, m_candidates[idf]);
+        }
+    }
+
+
+    void TermTreatmentTuner::AddTerm(Term::IdfX10 idf)
+    {
+        auto local = Term::c_maxIdfX10Value;
+        ++m_termCounts[std::min(idf, local)];
+    }
+
+
+    void TermTreatmentTuner::AddTerms(IDocumentFrequencyTable const & terms)
+    {
+        for (auto const & entry : terms)
+        {
+            AddTerm(entry.GetTerm().GetIdfSum());
+        }
+    }
+
+
+    void TermTreatmentTuner::AddQuery(std::vector<Term::IdfX10> const & terms)
+    {
+        auto local = Term::c_maxIdfX10Value;
+        for (auto idf : terms)
+        {
+            ++m_queryTermCounts[std::min(idf, local)];
+        }
+        ++m_queryCount;
+    }
+
+
+    std::vector<RowConfiguration>
+        TermTreatmentTuner::Tune(double bytesPerDocument) const
+    {
+        const double budget = bytesPerDocument * 8.0;
+
+        // Without any memory pressure, each bucket gets its cheapest
+        // configuration.
+        std::vector<RowConfiguration> best;
+        if (Select(0.0, best) <= budget)
+        {
+            return best;
+        }
+
+        // Bisect on log10(lambda). The upper end of the range is large enough
+        // that memory dominates every bucket that holds terms.
+        double lo = -30.0;
+        double hi = 30.0;
+        if (Select(pow(10.0, hi), best) > budget)
+        {
+            RecoverableError
+                error("TermTreatmentTuner: memory budget is too small.");
+            throw error;
+        }
+
+        std::vector<RowConfiguration> configurations;
+        for (unsigned i = 0; i < 100; ++i)
+        {
+            const double mid = (lo + hi) / 2.0;
+            if (Select(pow(10.0, mid), configurations) <= budget)
+            {
+                hi = mid;
+                best.swap(configurations);
+            }
+            else
+            {
+                lo = mid;
+            }
+        }
+
+        return best;
+    }
+
+
+    double TermTreatmentTuner::QuadwordsPerQuery(
+        std::vector<RowConfiguration> const & configurations) const
+    {
+        if (m_queryCount == 0)
+        {
+            return 0.0;
+        }
+
+        double quadwords = 0.0;
+        for (size_t idf = 0; idf < c_bucketCount; ++idf)
+        {
+            quadwords +=
+                m_queryTermCounts[idf] * QuadwordsPerTerm(configurations[idf]);
+        }
+        return quadwords / m_queryCount;
+    }
+
+
+    double TermTreatmentTuner::BytesPerDocument(
+        std::vector<RowConfiguration> const & configurations) const
+    {
+        double bits = 0.0;
+        for (size_t idf = 0; idf < c_bucketCount; ++idf)
+        {
+            bits += m_termCounts[idf] *
+                BitsPerTerm(static_cast<Term::IdfX10>(idf),
+                            configurations[idf]);
+        }
+        return bits / 8.0;
+    }
+
+
+    double TermTreatmentTuner::FalsePositiveRate(
+        Term::IdfX10 idf,
+        RowConfiguration configuration) const
+    {
+        const double frequency = Term::IdfX10ToFrequency(idf);
+
+        double noise = 1.0;
+        for (auto entry : configuration)
+        {
+            const Rank rank = entry.GetRank();
+            const double f = Term::FrequencyAtRank(frequency, rank);
+            if (entry.IsPrivate() || f >= m_density)
+            {
+                // The TermTableBuilder allocates a single private row, no
+                // matter how many rows were requested.
+                noise *= (rank == 0) ? 0.0 : f;
+            }
+            else
+            {
+                const double p = (rank == 0) ? m_density - f : m_density;
+                noise *= pow(p, entry.GetRowCount());
+            }
+        }
+
+        return noise / frequency;
+    }
+
+
+    void TermTreatmentTuner::Print(
+        std::ostream& output,
+        std::vector<RowConfiguration> const & configurations) const
+    {
+        output << "TermTreatmentTuner" << std::endl;
+        output << "  Density: " << m_density << std::endl;
+        output << "  Max false positive rate: "
+               << m_maxFalsePositiveRate << std::endl;
+        output << "  Queries: " << m_queryCount << std::endl;
+        output << "  Quadwords per query: "
+               << QuadwordsPerQuery(configurations) << std::endl;
+        output << "  Bytes per document: "
+               << BytesPerDocument(configurations) << std::endl;
+        output << std::endl;
+
+        output << "idf, terms, queryTerms, falsePositiveRate, configuration"
+               << std::endl;
+        for (size_t idf = 0; idf < c_bucketCount; ++idf)
+        {
+            output << idf / 10.0 << ", "
+                   << m_termCounts[idf] << ", "
+                   << m_queryTermCounts[idf] << ", "
+                   << FalsePositiveRate(static_cast<Term::IdfX10>(idf),
+                                        configurations[idf]) << ", ";
+            configurations[idf].Write(output);
+            output << std::endl;
+        }
+    }
+
+
+    void TermTreatmentTuner::EnumerateCandidates(
+        Term::IdfX10 idf,
+        std::vector<Candidate>& candidates) const
+    {
+        const double frequency = Term::IdfX10ToFrequency(idf);
+        const double maxNoise = m_maxFalsePositiveRate * frequency;
+
+        std::vector<RowConfiguration> configurations;
+
+        if (frequency >= m_density)
+        {
+            // This term is so common that it must be assigned a private row.
+            // A private rank 0 row is exact, so no other rows are needed.
+            RowConfiguration configuration;
+            configuration.push_front(RowConfiguration::Entry(0, 1, true));
+            configurations.push_back(configuration);
+        }
+        else
+        {
+            for (RowIndex k0 = 1; k0 <= RowConfiguration::Entry::c_maxRowCount; ++k0)
+            {
+                RowConfiguration rank0;
+                rank0.push_front(RowConfiguration::Entry(0, k0, false));
+                configurations.push_back(rank0);
+
+                for (Rank rank = 1; rank <= c_maxRankValue; ++rank)
+                {
+                    const double f = Term::FrequencyAtRank(frequency, rank);
+                    if (f >= m_density)
+                    {
+                        RowConfiguration configuration = rank0;
+                        configuration.push_front(
+                            RowConfiguration::Entry(rank, 1, true));
+                        configurations.push_back(configuration);
+                    }
+                    else
+                    {
+                        for (RowIndex k = 1; k <= RowConfiguration::Entry::c_maxRowCount; ++k)
+                        {
+                            RowConfiguration configuration = rank0;
+                            configuration.push_front(
+                                RowConfiguration::Entry(rank, k, false));
+                            configurations.push_back(configuration);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Keep the configurations that meet the false positive cap. If there
+        // are none, fall back to the one with the lowest false positive rate.
+        RowConfiguration quietest;
+        double quietestNoise = 2.0;
+        for (auto configuration : configurations)
+        {
+            const double noise =
+                FalsePositiveRate(idf, configuration) * frequency;
+            if (noise <= maxNoise)
+            {
+                candidates.push_back({configuration,
+                                      QuadwordsPerTerm(configuration),
+                                      BitsPerTerm(idf, configuration)});
+            }
+            else if (noise < quietestNoise)
+            {
+                quietest = configuration;
+                quietestNoise = noise;
+            }
+        }
+
+        if (candidates.empty())
+        {
+            candidates.push_back({quietest,
+                                  QuadwordsPerTerm(quietest),
+                                  BitsPerTerm(idf, quietest)});
+        }
+    }
+
+
+    double TermTreatmentTuner::Select(
+        double lambda,
+        std::vector<RowConfiguration>& configurations) const
+    {
+        configurations.clear();
+
+        double bits = 0.0;
+        for (size_t idf = 0; idf < c_bucketCount; ++idf)
+        {
+            const double queryWeight =
+                static_cast<double>(m_queryTermCounts[idf]);
+            const double memoryWeight =
+                lambda * static_cast<double>(m_termCounts[idf]);
+
+            // Ties, including buckets that appear in neither the terms nor
+            // the queries, go to the configuration using the least memory,
+            // then to the one scanning the fewest quadwords.
+            Candidate const * best = nullptr;
+            double bestCost = 0.0;
+            for (auto const & candidate : m_candidates[idf])
+            {
+                const double cost = queryWeight * candidate.m_quadwords +
+                                    memoryWeight * candidate.m_bits;
+                if (best == nullptr ||
+                    cost < bestCost ||
+                    (cost == bestCost &&
+                     (candidate.m_bits < best->m_bits ||
+                      (candidate.m_bits == best->m_bits &&
+                       candidate.m_quadwords < best->m_quadwords))))
+                {
+                    best = &candidate;
+                    bestCost = cost;
+                }
+            }
+
+            configurations.push_back(best->m_configuration);
+            bits += m_termCounts[idf] * best->m_bits;
+        }
+
+        return bits;
+    }
+
+
+    double TermTreatmentTuner::QuadwordsPerTerm(
+        RowConfiguration configuration) const
+    {
+        double quadwords = 0.0;
+        for (auto entry : configuration)
+        {
+            const double rows = entry.IsPrivate() ? 1.0 : entry.GetRowCount();
+            quadwords += rows / (1ull << entry.GetRank());
+        }
+        return quadwords;
+    }
+
+
+    double TermTreatmentTuner::BitsPerTerm(
+        Term::IdfX10 idf,
+        RowConfiguration configuration) const
+    {
+        const double frequency = Term::IdfX10ToFrequency(idf);
+
+        double bits = 0.0;
+        for (auto entry : configuration)
+        {
+            const Rank rank = entry.GetRank();
+            const double f = Term::FrequencyAtRank(frequency, rank);
+            const double rowBits = 1.0 / (1ull << rank);
+            if (entry.IsPrivate() || f >= m_density)
+            {
+                bits += rowBits;
+            }
+            else
+            {
+                bits += entry.GetRowCount() * rowBits * f / m_density;
+            }
+        }
+        return bits;
+    }
+}
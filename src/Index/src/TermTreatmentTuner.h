@@ -0,0 +1,141 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/ITermTreatment.h"   // RowConfiguration return value.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+#include "BitFunnel/Term.h"             // Term::IdfX10 parameter.
+
+
+namespace BitFunnel
+{
+    class IDocumentFrequencyTable;
+
+    //*************************************************************************
+    //
+    // TermTreatmentTuner
+    //
+    // Searches for the RowConfiguration of each IdfX10 bucket that minimizes
+    // the expected number of quadwords scanned per query, subject to a cap on
+    // the false positive rate of every bucket and a budget on the number of
+    // bytes of row storage per document.
+    //
+    // The cost model mirrors the decisions made by the TermTableBuilder:
+    //   A term whose frequency at rank r meets or exceeds the target density
+    //   gets a single private row at that rank. Otherwise it gets k shared
+    //   rows, each filled to the target density.
+    //   A row at rank r costs 2^-r quadwords per rank 0 quadword scanned.
+    //   A private row at rank r costs 2^-r bits per document. A shared row
+    //   costs the term's share of those bits, namely f_r / density.
+    //   The probability that a document without the term passes a row is
+    //   0 for a private rank 0 row, f_r for a private rank r row, and the
+    //   row's density (less the term's own contribution at rank 0) for a
+    //   shared row. Rows are assumed independent.
+    //
+    // Each configuration consists of rank 0 rows, optionally followed by rows
+    // at a single higher rank. When no configuration meets the false positive
+    // cap, the bucket falls back to the one with the lowest false positive
+    // rate. The memory budget is met by searching for the Lagrange multiplier
+    // that trades query cost against memory.
+    //
+    //*************************************************************************
+    class TermTreatmentTuner : public NonCopyable
+    {
+    public:
+        // maxFalsePositiveRate is the largest acceptable ratio of false
+        // positives to true matches for a single term.
+        TermTreatmentTuner(double density, double maxFalsePositiveRate);
+
+        // Records one term in the bucket for the specified IdfX10 value.
+        void AddTerm(Term::IdfX10 idf);
+
+        // Records every term in a DocumentFrequencyTable.
+        void AddTerms(IDocumentFrequencyTable const & terms);
+
+        // Records one query from the query log, given the IdfX10 values of
+        // its terms.
+        void AddQuery(std::vector<Term::IdfX10> const & terms);
+
+        // Returns one RowConfiguration for each IdfX10 value in
+        // [0..Term::c_maxIdfX10Value] that minimizes QuadwordsPerQuery()
+        // without exceeding bytesPerDocument. Throws RecoverableError if no
+        // set of configurations meeting the false positive cap fits in the
+        // budget.
+        std::vector<RowConfiguration> Tune(double bytesPerDocument) const;
+
+        // Expected quadwords scanned per query, for each rank 0 quadword in
+        // the index.
+        double QuadwordsPerQuery(
+            std::vector<RowConfiguration> const & configurations) const;
+
+        // Expected bytes of row storage per document.
+        double BytesPerDocument(
+            std::vector<RowConfiguration> const & configurations) const;
+
+        // Expected ratio of false positives to true matches for a single
+        // term with the specified IdfX10 value.
+        double FalsePositiveRate(Term::IdfX10 idf,
+                                 RowConfiguration configuration) const;
+
+        void Print(std::ostream& output,
+                   std::vector<RowConfiguration> const & configurations) const;
+
+    private:
+        struct Candidate
+        {
+            RowConfiguration m_configuration;
+            double m_quadwords;
+            double m_bits;
+        };
+
+        void EnumerateCandidates(Term::IdfX10 idf,
+                                 std::vector<Candidate>& candidates) const;
+
+        // Picks the candidate in each bucket that minimizes
+        //   queryWeight * quadwords + lambda * termCount * bits
+        // and returns the total bits per document.
+        double Select(double lambda,
+                      std::vector<RowConfiguration>& configurations) const;
+
+        double QuadwordsPerTerm(RowConfiguration configuration) const;
+        double BitsPerTerm(Term::IdfX10 idf,
+                           RowConfiguration configuration) const;
+
+        static const size_t c_bucketCount = Term::c_maxIdfX10Value + 1ull;
+
+        const double m_density;
+        const double m_maxFalsePositiveRate;
+
+        std::vector<size_t> m_termCounts;
+        std::vector<size_t> m_queryTermCounts;
+        size_t m_queryCount;
+
+        // Candidate configurations meeting the false positive cap, indexed by
+        // IdfX10 value.
+        std::vector<std::vector<Candidate>> m_candidates;
+    };
+}
@@ -24,8 +24,10 @@
 #include <iostream>             // TODO: Remove this temporary include.
 #include <math.h>
 
+#include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Term.h"
+#include "CsvTsv/Csv.h"
 #include "TermTreatments.h"
 
 
@@ -62,6 +64,13 @@ namespace BitFunnel
     }
 
 
+    std::unique_ptr<ITermTreatment>
+        Factories::CreateTreatmentTable(std::istream& input)
+    {
+        return std::unique_ptr<ITermTreatment>(new TreatmentTable(input));
+    }
+
+
 
     //*************************************************************************
     //
@@ -216,4 +225,146 @@ namespace BitFunnel
         Term::IdfX10 idf = std::min(term.GetIdfSum(), local);
         return m_configurations[idf];
     }
+
+
+    //*************************************************************************
+    //
+    // TreatmentTable
+    //
+    // Each IdfX10 value gets the RowConfiguration found in the table.
+    //
+    //*************************************************************************
+    TreatmentTable::TreatmentTable(std::vector<RowConfiguration> const & configurations)
+      : m_configurations(configurations)
+    {
+        if (m_configurations.size() != Term::c_maxIdfX10Value + 1ull)
+        {
+            RecoverableError
+                error("TreatmentTable: expected one configuration per IdfX10 value.");
+            throw error;
+        }
+    }
+
+
+    TreatmentTable::TreatmentTable(std::istream& input)
+    {
+        CsvTsv::CsvTableParser parser(input);
+        CsvTsv::TableReader reader(parser);
+
+        // NOTE: Cannot use InputColumn<Term::IdfX10> or InputColumn<Rank>
+        // because InputColumn does not implement a specialization for char.
+        CsvTsv::InputColumn<unsigned> idf(
+            "idf",
+            "Term's IdfX10 value.");
+
+        CsvTsv::InputColumn<unsigned> rank(
+            "rank",
+            "Rank of the rows.");
+
+        CsvTsv::InputColumn<unsigned> rowCount(
+            "rowCount",
+            "Number of rows at this rank.");
+
+        CsvTsv::InputColumn<unsigned> isPrivate(
+            "private",
+            "1 if the rows are private, 0 if they are shared.");
+
+        reader.DefineColumn(idf);
+        reader.DefineColumn(rank);
+        reader.DefineColumn(rowCount);
+        reader.DefineColumn(isPrivate);
+
+        reader.ReadPrologue();
+
+        // Entries are listed in iteration order. Gather them for each IdfX10
+        // value so that they can be pushed onto RowConfigurations in reverse.
+        std::vector<std::vector<RowConfiguration::Entry>>
+            entries(Term::c_maxIdfX10Value + 1ull);
+
+        while (!reader.AtEOF())
+        {
+            reader.ReadDataRow();
+
+            if (idf > Term::c_maxIdfX10Value)
+            {
+                RecoverableError error("TreatmentTable: idf out of range.");
+                throw error;
+            }
+
+            entries[idf].push_back(
+                RowConfiguration::Entry(rank, rowCount, isPrivate != 0));
+        }
+
+        reader.ReadEpilogue();
+
+        for (auto const & list : entries)
+        {
+            if (list.empty())
+            {
+                RecoverableError
+                    error("TreatmentTable: missing configuration for IdfX10 value.");
+                throw error;
+            }
+
+            RowConfiguration configuration;
+            for (auto it = list.rbegin(); it != list.rend(); ++it)
+            {
+                configuration.push_front(*it);
+            }
+            m_configurations.push_back(configuration);
+        }
+    }
+
+
+    void TreatmentTable::Write(std::ostream& output) const
+    {
+        CsvTsv::CsvTableFormatter formatter(output);
+        CsvTsv::TableWriter writer(formatter);
+
+        CsvTsv::OutputColumn<unsigned> idf(
+            "idf",
+            "Term's IdfX10 value.");
+
+        CsvTsv::OutputColumn<unsigned> rank(
+            "rank",
+            "Rank of the rows.");
+
+        CsvTsv::OutputColumn<unsigned> rowCount(
+            "rowCount",
+            "Number of rows at this rank.");
+
+        CsvTsv::OutputColumn<unsigned> isPrivate(
+            "private",
+            "1 if the rows are private, 0 if they are shared.");
+
+        writer.DefineColumn(idf);
+        writer.DefineColumn(rank);
+        writer.DefineColumn(rowCount);
+        writer.DefineColumn(isPrivate);
+
+        writer.WritePrologue();
+
+        for (unsigned i = 0; i < m_configurations.size(); ++i)
+        {
+            for (auto entry : m_configurations[i])
+            {
+                idf = i;
+                rank = static_cast<unsigned>(entry.GetRank());
+                rowCount = static_cast<unsigned>(entry.GetRowCount());
+                isPrivate = entry.IsPrivate() ? 1 : 0;
+                writer.WriteDataRow();
+            }
+        }
+
+        writer.WriteEpilogue();
+    }
+
+
+    RowConfiguration TreatmentTable::GetTreatment(Term term) const
+    {
+        // DESIGN NOTE: see TreatmentPrivateSharedRank0::GetTreatment().
+        auto local = Term::c_maxIdfX10Value;
+        Term::IdfX10 idf = std::min(term.GetIdfSum(), local);
+        return m_configurations[idf];
+    }
 }
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <iosfwd>                       // std::istream parameter.
 #include <vector>                       // std::vector member.
 
 #include "BitFunnel/ITermTreatment.h"   // Base class.
@@ -105,4 +106,38 @@ namespace BitFunnel
     private:
         std::vector<RowConfiguration> m_configurations;
     };
+
+
+    //*************************************************************************
+    //
+    // TreatmentTable
+    //
+    // Data-driven term treatment that holds an explicit RowConfiguration for
+    // each IdfX10 value in [0..Term::c_maxIdfX10Value]. The table is usually
+    // produced by the TermTreatmentTuner tool and persisted as a CSV file
+    // with one line per (idf, rank, rowCount, private) entry.
+    //
+    //*************************************************************************
+    class TreatmentTable : public ITermTreatment
+    {
+    public:
+        // Constructs a TreatmentTable from a vector with exactly
+        // Term::c_maxIdfX10Value + 1 configurations, indexed by IdfX10.
+        TreatmentTable(std::vector<RowConfiguration> const & configurations);
+
+        // Constructs a TreatmentTable from a stream previously produced by
+        // Write(). Every IdfX10 value must have at least one entry.
+        TreatmentTable(std::istream& input);
+
+        void Write(std::ostream& output) const;
+
+        //
+        // ITermTreatment methods.
+        //
+
+        virtual RowConfiguration GetTreatment(Term term) const override;
+
+    private:
+        std::vector<RowConfiguration> m_configurations;
+    };
 }
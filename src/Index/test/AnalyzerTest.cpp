@@ -0,0 +1,220 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <memory>
+#include <vector>
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IDocumentDataSchema.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/ITermTreatment.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "BitFunnel/Term.h"
+#include "FactSetBase.h"
+#include "FalsePositiveAnalyzer.h"
+#include "gtest/gtest.h"
+#include "RowDensityAnalyzer.h"
+#include "Shard.h"
+#include "SyntheticCorpus.h"
+#include "TestIngestor.h"
+
+
+namespace BitFunnel
+{
+    namespace AnalyzerTest
+    {
+        static const size_t c_documentCount = 1000;
+
+
+        // Ingests the documents from CreateSyntheticChunk() and runs the
+        // analyzers over them.
+        class TestIndex
+        {
+        public:
+            TestIndex(std::unique_ptr<ITermTableCollection> termTables)
+              : m_index(std::move(termTables),
+                        Factories::CreateDocumentDataSchema(),
+                        Factories::CreateShardDefinition(),
+                        16),
+                m_chunk(CreateSyntheticChunk(0, c_documentCount, false))
+            {
+                m_index.Ingest(m_chunk);
+            }
+
+            Term MakeTerm(char const * text) const
+            {
+                return Term(text, 0, m_index.GetConfiguration());
+            }
+
+            std::unique_ptr<FalsePositiveAnalyzer>
+                Analyze(std::vector<std::vector<char const *>> const & queries,
+                        size_t threadCount)
+            {
+                std::vector<std::vector<Term>> terms;
+                for (auto const & query : queries)
+                {
+                    terms.push_back(std::vector<Term>());
+                    for (auto text : query)
+                    {
+                        terms.back().push_back(MakeTerm(text));
+                    }
+                }
+
+                std::unique_ptr<FalsePositiveAnalyzer>
+                    analyzer(new FalsePositiveAnalyzer(terms));
+                analyzer->AddChunk(m_chunk, m_index.GetConfiguration());
+                analyzer->Analyze(m_index.GetIngestor(), threadCount);
+                return analyzer;
+            }
+
+            IIngestor& GetIngestor() const
+            {
+                return m_index.GetIngestor();
+            }
+
+        private:
+            TestIngestor m_index;
+            std::vector<char> m_chunk;
+        };
+
+
+        // "all", "even" and "third" each get a private rank 0 row.
+        static std::unique_ptr<ITermTableCollection> CreatePrivateRowTermTables()
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            FactSetBase facts;
+            return CreateSyntheticTermTables(*treatment, facts, 1);
+        }
+
+
+        TEST(RowDensityAnalyzer, SystemRows)
+        {
+            TestIndex index(Factories::CreateTermTableCollection(1));
+            Shard const & shard = index.GetIngestor().GetShard(0);
+
+            RowDensityAnalyzer analyzer(shard,
+                                        index.GetIngestor().GetTokenManager(),
+                                        1);
+
+            // The empty TermTable only has the DocumentActive, MatchAll and
+            // MatchNone rows.
+            auto densities = analyzer.GetDensities(0);
+            ASSERT_EQ(densities.size(), 3u);
+            EXPECT_EQ(densities[0], 1.0);
+            EXPECT_EQ(densities[1], 1.0);
+            EXPECT_EQ(densities[2], 0.0);
+
+            for (Rank rank = 1; rank <= c_maxRankValue; ++rank)
+            {
+                EXPECT_TRUE(analyzer.GetDensities(rank).empty());
+            }
+        }
+
+
+        TEST(RowDensityAnalyzer, PrivateRows)
+        {
+            TestIndex index(CreatePrivateRowTermTables());
+            Shard const & shard = index.GetIngestor().GetShard(0);
+            ITermTable2 const & termTable = shard.GetTermTable();
+
+            RowDensityAnalyzer analyzer(shard,
+                                        index.GetIngestor().GetTokenManager(),
+                                        4);
+            auto densities = analyzer.GetDensities(0);
+
+            auto check = [&](char const * text, double expected)
+            {
+                RowIdSequence rows(index.MakeTerm(text), termTable);
+                auto it = rows.begin();
+                ASSERT_TRUE(it != rows.end());
+                EXPECT_EQ((*it).GetRank(), 0u);
+                EXPECT_DOUBLE_EQ(densities[(*it).GetIndex()], expected);
+            };
+
+            check("all", 1.0);
+            check("even", 0.5);
+            check("third", 334.0 / c_documentCount);
+
+            // The multi-threaded counts match the single threaded ones.
+            RowDensityAnalyzer serial(shard,
+                                      index.GetIngestor().GetTokenManager(),
+                                      1);
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                EXPECT_EQ(analyzer.GetDensities(rank),
+                          serial.GetDensities(rank));
+            }
+        }
+
+
+        TEST(FalsePositiveAnalyzer, NoRows)
+        {
+            // Terms that are not in the empty TermTable are adhoc terms with
+            // no rows, so every query matches every document.
+            TestIndex index(Factories::CreateTermTableCollection(1));
+            auto analyzer = index.Analyze({ { "all" },
+                                            { "even" },
+                                            { "even", "third" } },
+                                          4);
+
+            ASSERT_EQ(analyzer->GetQueryCount(), 3u);
+            EXPECT_EQ(analyzer->GetMatchCount(0), 1000u);
+            EXPECT_EQ(analyzer->GetMatchCount(1), 500u);
+            EXPECT_EQ(analyzer->GetMatchCount(2), 167u);
+
+            EXPECT_EQ(analyzer->GetFalsePositiveCount(0), 0u);
+            EXPECT_EQ(analyzer->GetFalsePositiveCount(1), 500u);
+            EXPECT_EQ(analyzer->GetFalsePositiveCount(2), 833u);
+
+            for (size_t q = 0; q < analyzer->GetQueryCount(); ++q)
+            {
+                EXPECT_EQ(analyzer->GetFalseNegativeCount(q), 0u);
+            }
+
+            EXPECT_DOUBLE_EQ(analyzer->GetFalsePositiveRate(),
+                             (500.0 + 833.0) / 3000.0);
+        }
+
+
+        TEST(FalsePositiveAnalyzer, PrivateRows)
+        {
+            // Private rank 0 rows are exact.
+            TestIndex index(CreatePrivateRowTermTables());
+            auto analyzer = index.Analyze({ { "even" },
+                                            { "even", "third" } },
+                                          1);
+
+            EXPECT_EQ(analyzer->GetMatchCount(0), 500u);
+            EXPECT_EQ(analyzer->GetMatchCount(1), 167u);
+            EXPECT_EQ(analyzer->GetFalsePositiveCount(0), 0u);
+            EXPECT_EQ(analyzer->GetFalsePositiveCount(1), 0u);
+            EXPECT_EQ(analyzer->GetFalseNegativeCount(0), 0u);
+            EXPECT_EQ(analyzer->GetFalseNegativeCount(1), 0u);
+            EXPECT_EQ(analyzer->GetFalsePositiveRate(), 0.0);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/BitSlicedField.h"
+#include "FactSetBase.h"
+
+
+namespace BitFunnel
+{
+    namespace BitSlicedFieldTest
+    {
+        TEST(BitSlicedField, BitCount)
+        {
+            struct Expected
+            {
+                uint64_t m_maxValue;
+                unsigned m_bitCount;
+            };
+            const Expected cases[] = {
+                { 0, 1 },
+                { 1, 1 },
+                { 2, 2 },
+                { 3, 2 },
+                { 4, 3 },
+                { 99, 7 },
+                { 127, 7 },
+                { 128, 8 },
+                { ~static_cast<uint64_t>(0), 64 }
+            };
+
+            for (auto const & c : cases)
+            {
+                FactSetBase facts;
+                BitSlicedField field(facts, "field", c.m_maxValue);
+                EXPECT_EQ(field.GetMaxValue(), c.m_maxValue);
+                EXPECT_EQ(field.GetBitCount(), c.m_bitCount);
+                EXPECT_EQ(facts.GetCount(), c.m_bitCount);
+            }
+        }
+
+
+        TEST(BitSlicedField, Facts)
+        {
+            FactSetBase facts;
+            FactHandle other = facts.DefineFact("other", false);
+            BitSlicedField price(facts, "price", 1000);
+            ASSERT_EQ(price.GetBitCount(), 10u);
+
+            // Each bit gets its own mutable fact, after the facts already
+            // defined.
+            for (unsigned bit = 0; bit < price.GetBitCount(); ++bit)
+            {
+                FactHandle fact = price.GetFact(bit);
+                EXPECT_EQ(fact, other + 1 + bit);
+                EXPECT_TRUE(facts.IsMutable(fact));
+                EXPECT_EQ(std::string(facts.GetFriendlyName(fact)),
+                          "price:" + std::to_string(bit));
+            }
+
+            // Fact names are unique, so a field can only be defined once.
+            EXPECT_THROW(BitSlicedField(facts, "price", 10), RecoverableError);
+        }
+    }
+}
@@ -25,6 +25,7 @@
 #include <stddef.h>
 #include <vector>
 
+#include "ChunkTasks.h"
 #include "gtest/gtest.h"
 #include "Mocks/ChunkEventTracer.h"
 
@@ -203,5 +204,67 @@ namespace BitFunnel
                 EXPECT_EQ(trace.str(), tracer.Trace());
             });
         }
+
+
+        // Split a chunk into document-aligned ranges and parse one of them.
+        TEST(ChunkReader, DocumentRange)
+        {
+            std::vector<char> const chunk = ToCharVector(
+                // First document
+                "00000000000000f0\0"
+                "20\0Dogs\0\0"
+                "\0"
+
+                // Second document
+                "00000000000000f1\0"
+                "20\0Cat\0Facts\0\0"
+                "\0"
+
+                // Third document
+                "00000000000000f2\0"
+                "20\0More\0Cat\0Facts\0\0"
+                "\0"
+
+                // End of corpus
+                "\0");
+
+            std::vector<size_t> const boundaries =
+                ChunkTasks::SplitChunk(chunk, 3);
+            ASSERT_EQ(4u, boundaries.size());
+            EXPECT_EQ(0u, boundaries[0]);
+            EXPECT_EQ(chunk.size() - 1, boundaries[3]);
+
+            // Each range holds exactly one document.
+            for (size_t i = 0; i < 3; ++i)
+            {
+                EXPECT_LT(boundaries[i], boundaries[i + 1]);
+            }
+
+            Mocks::ChunkEventTracer tracer(&chunk[0] + boundaries[1],
+                                           &chunk[0] + boundaries[2]);
+
+            std::stringstream trace;
+            trace
+                << "OnFileEnter" << std::endl
+                << "OnDocumentEnter;DocId: 241" << std::endl
+                << "OnStreamEnter;streamId: 32" << std::endl
+                << "OnTerm;term: 'Cat'" << std::endl
+                << "OnTerm;term: 'Facts'" << std::endl
+                << "OnStreamExit" << std::endl
+                << "OnDocumentExit" << std::endl
+                << "OnFileExit" << std::endl;
+
+            EXPECT_EQ(trace.str(), tracer.Trace());
+
+            // Asking for more ranges than there are documents yields empty
+            // ranges rather than splitting a document.
+            std::vector<size_t> const sparse = ChunkTasks::SplitChunk(chunk, 8);
+            ASSERT_EQ(9u, sparse.size());
+            EXPECT_EQ(chunk.size() - 1, sparse.back());
+            for (size_t i = 0; i + 1 < sparse.size(); ++i)
+            {
+                EXPECT_LE(sparse[i], sparse[i + 1]);
+            }
+        }
     }
 }
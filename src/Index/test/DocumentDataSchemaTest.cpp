@@ -25,6 +25,7 @@
 
 #include "gtest/gtest.h"
 
+#include "BitFunnel/BitFunnelTypes.h"
 #include "BitFunnel/Index/IDocumentDataSchema.h"
 #include "DocumentDataSchema.h"
 
@@ -67,5 +68,44 @@ namespace BitFunnel
             /* const VariableSizeBlobId variableBlob1 = */ schema.RegisterVariableSizeBlob();
             EXPECT_EQ(schema.GetVariableSizeBlobCount(), 2u);
         }
+
+
+        TEST(DocumentDataSchema, TermSequenceBlob)
+        {
+            DocumentDataSchema schema;
+            VariableSizeBlobId blob;
+            EXPECT_FALSE(schema.TryGetTermSequenceBlob(blob));
+
+            schema.RegisterVariableSizeBlob();
+            const VariableSizeBlobId termSequenceBlob =
+                schema.RegisterTermSequenceBlob();
+            EXPECT_EQ(termSequenceBlob, 1u);
+            EXPECT_EQ(schema.GetVariableSizeBlobCount(), 2u);
+
+            ASSERT_TRUE(schema.TryGetTermSequenceBlob(blob));
+            EXPECT_EQ(blob, termSequenceBlob);
+
+            EXPECT_ANY_THROW(schema.RegisterTermSequenceBlob());
+        }
+
+
+        TEST(DocumentDataSchema, StaticRankBlob)
+        {
+            DocumentDataSchema schema;
+            FixedSizeBlobId blob;
+            EXPECT_FALSE(schema.TryGetStaticRankBlob(blob));
+
+            schema.RegisterFixedSizeBlob(3);
+            const FixedSizeBlobId staticRankBlob =
+                schema.RegisterStaticRankBlob();
+            EXPECT_EQ(staticRankBlob, 1u);
+            ASSERT_EQ(schema.GetFixedSizeBlobSizes().size(), 2u);
+            EXPECT_EQ(schema.GetFixedSizeBlobSizes()[1], sizeof(StaticRank));
+
+            ASSERT_TRUE(schema.TryGetStaticRankBlob(blob));
+            EXPECT_EQ(blob, staticRankBlob);
+
+            EXPECT_ANY_THROW(schema.RegisterStaticRankBlob());
+        }
     }
 }
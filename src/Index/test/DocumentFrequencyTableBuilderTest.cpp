@@ -0,0 +1,254 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "CountMinSketch.h"
+#include "DocumentFrequencyTable.h"
+#include "DocumentFrequencyTableBuilder.h"
+#include "HeavyHitters.h"
+
+
+namespace BitFunnel
+{
+    namespace DocumentFrequencyTableBuilderTest
+    {
+        static const size_t c_documentCount = 2000;
+        static const size_t c_vocabularySize = 2000;
+        static const Term::Hash c_firstHash = 1000ull;
+
+
+        static Term MakeTerm(size_t index)
+        {
+            return Term(c_firstHash + index, 0, 0, 1);
+        }
+
+
+        // Returns the term indexes in a document. Term t appears with
+        // probability 0.5 / (t + 1), giving a Zipf-like corpus.
+        static std::vector<size_t> GetDocument(size_t document)
+        {
+            std::mt19937 generator(static_cast<unsigned>(document));
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+            std::vector<size_t> terms;
+            for (size_t t = 0; t < c_vocabularySize; ++t)
+            {
+                if (uniform(generator) < 0.5 / (t + 1))
+                {
+                    terms.push_back(t);
+                }
+            }
+            return terms;
+        }
+
+
+        TEST(CountMinSketch, Basic)
+        {
+            const double errorBound = 0.01;
+            CountMinSketch a(errorBound, 0.01);
+            CountMinSketch b(errorBound, 0.01);
+
+            EXPECT_GE(a.GetWidth(), 272u);
+            EXPECT_EQ(a.GetDepth(), 5u);
+
+            std::unordered_map<uint64_t, uint64_t> counts;
+            for (uint64_t i = 0; i < 10000; ++i)
+            {
+                uint64_t key = i % 97 + (i % 3) * 1000;
+                ++counts[key];
+                ((i % 2 == 0) ? a : b).Increment(key);
+            }
+
+            a.Merge(b);
+            EXPECT_EQ(a.GetTotalCount(), 10000u);
+
+            for (auto const & entry : counts)
+            {
+                uint64_t estimate = a.Estimate(entry.first);
+                EXPECT_GE(estimate, entry.second);
+                EXPECT_LE(estimate, entry.second + errorBound * 10000);
+            }
+
+            // Linear counting is accurate while most counters are empty.
+            EXPECT_NEAR(a.EstimateDistinctCount(),
+                        static_cast<double>(counts.size()),
+                        0.1 * counts.size());
+
+            CountMinSketch c(0.1, 0.01);
+            EXPECT_ANY_THROW(a.Merge(c));
+            EXPECT_ANY_THROW(CountMinSketch(0.0, 0.01));
+        }
+
+
+        TEST(HeavyHitters, SpaceSaving)
+        {
+            const size_t capacity = 50;
+            HeavyHitters heavyHitters(capacity);
+            std::unordered_map<size_t, uint64_t> counts;
+
+            for (size_t d = 0; d < c_documentCount; ++d)
+            {
+                for (auto t : GetDocument(d))
+                {
+                    ++counts[t];
+                    heavyHitters.Increment(MakeTerm(t));
+                }
+            }
+
+            EXPECT_EQ(heavyHitters.size(), capacity);
+
+            uint64_t minCount = heavyHitters.GetMinCount();
+            for (auto const & entry : heavyHitters)
+            {
+                EXPECT_GE(minCount, 1u);
+                EXPECT_GE(entry.GetCount(), minCount);
+            }
+
+            // Every monitored count bounds the true count from above, within
+            // the minimum count. Every term more frequent than the minimum
+            // is monitored.
+            for (auto const & entry : counts)
+            {
+                uint64_t count;
+                if (heavyHitters.TryGetCount(MakeTerm(entry.first), count))
+                {
+                    EXPECT_GE(count, entry.second);
+                    EXPECT_LE(count, entry.second + minCount);
+                }
+                else
+                {
+                    EXPECT_LE(entry.second, minCount);
+                }
+            }
+        }
+
+
+        // Compares an approximate build on several threads with an exact
+        // build over the same corpus.
+        TEST(DocumentFrequencyTableBuilder, ApproximateMatchesExact)
+        {
+            const double errorBound = 0.001;
+            const size_t heavyHitterCount = 100;
+            const size_t threadCount = 4;
+
+            DocumentFrequencyTableBuilder exact;
+            DocumentFrequencyTableBuilder approximate(errorBound,
+                                                      heavyHitterCount);
+
+            size_t postingCount = 0;
+            std::unordered_map<Term::Hash, double> expected;
+            for (size_t d = 0; d < c_documentCount; ++d)
+            {
+                exact.OnDocumentEnter();
+                for (auto t : GetDocument(d))
+                {
+                    exact.OnTerm(MakeTerm(t));
+                    expected[MakeTerm(t).GetRawHash()] += 1.0 / c_documentCount;
+                    ++postingCount;
+                }
+            }
+
+            // Each thread takes every threadCount'th document.
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                threads.push_back(std::thread([&approximate, i, threadCount]()
+                {
+                    for (size_t d = i; d < c_documentCount; d += threadCount)
+                    {
+                        approximate.OnDocumentEnter();
+                        for (auto t : GetDocument(d))
+                        {
+                            approximate.OnTerm(MakeTerm(t));
+                        }
+                    }
+                }));
+            }
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            std::stringstream exactStream;
+            exact.WriteFrequencies(exactStream, 0.0, nullptr);
+            DocumentFrequencyTable exactTable(exactStream);
+
+            std::stringstream approximateStream;
+            approximate.WriteFrequencies(approximateStream, 0.0, nullptr);
+            DocumentFrequencyTable approximateTable(approximateStream);
+
+            EXPECT_EQ(approximateTable.size(), heavyHitterCount);
+
+            // Frequencies are never underestimated, and are overestimated by
+            // at most the error bound.
+            const double maxError = errorBound * postingCount / c_documentCount;
+            for (auto const & entry : approximateTable)
+            {
+                double frequency = expected[entry.GetTerm().GetRawHash()];
+                EXPECT_GE(entry.GetFrequency() + 1e-9, frequency);
+                EXPECT_LE(entry.GetFrequency(), frequency + maxError + 1e-9);
+            }
+
+            // Terms are guaranteed to be found if some thread must have
+            // monitored them, and if no overestimated term outside the true
+            // top heavyHitterCount can displace them.
+            std::unordered_set<Term::Hash> found;
+            for (auto const & entry : approximateTable)
+            {
+                found.insert(entry.GetTerm().GetRawHash());
+            }
+            const double threshold =
+                std::max(exactTable[heavyHitterCount].GetFrequency() + maxError,
+                         static_cast<double>(postingCount) /
+                         heavyHitterCount / c_documentCount);
+            for (auto const & entry : exactTable)
+            {
+                if (entry.GetFrequency() > threshold)
+                {
+                    EXPECT_EQ(found.count(entry.GetTerm().GetRawHash()), 1u);
+                }
+            }
+
+            std::stringstream counts;
+            approximate.WriteCumulativeTermCounts(counts);
+            size_t documents;
+            char comma;
+            size_t terms;
+            counts >> documents >> comma >> terms;
+            EXPECT_EQ(documents, c_documentCount);
+            EXPECT_NEAR(static_cast<double>(terms),
+                        static_cast<double>(expected.size()),
+                        0.1 * expected.size());
+        }
+    }
+}
@@ -21,6 +21,10 @@
 // THE SOFTWARE.
 
 
+#include <sstream>
+#include <thread>
+#include <vector>
+
 #include "DocumentLengthHistogram.h"
 #include "gtest/gtest.h"
 
@@ -60,6 +64,54 @@ namespace BitFunnel
             ASSERT_EQ("Postings,Count\n0,1\n3,2\n5,1\n", stream.str());
         }
 
+        //*********************************************************************
+        TEST(DocumentLengthHistogram, MultipleWriters)
+        {
+            DocumentLengthHistogram testHistogram;
+
+            // Thread i adds documents with posting counts 0..c_lengths-1,
+            // (i + 1) times each.
+            const size_t c_threadCount = 4;
+            const size_t c_lengths = 100;
+
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < c_threadCount; ++i)
+            {
+                threads.emplace_back([&testHistogram, i, c_lengths]()
+                {
+                    for (size_t repeat = 0; repeat <= i; ++repeat)
+                    {
+                        for (size_t length = 0; length < c_lengths; ++length)
+                        {
+                            testHistogram.AddDocument(length);
+                        }
+                    }
+                });
+            }
+
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            // Each length was added 1 + 2 + ... + c_threadCount times.
+            const size_t expectedCount = c_threadCount * (c_threadCount + 1) / 2;
+            std::stringstream expected;
+            expected << "Postings,Count\n";
+            for (size_t length = 0; length < c_lengths; ++length)
+            {
+                ASSERT_EQ(testHistogram.GetValue(length), expectedCount);
+                expected << length << "," << expectedCount << "\n";
+            }
+            ASSERT_EQ(testHistogram.GetValue(c_lengths), 0u);
+            ASSERT_EQ(testHistogram.GetPostingCount(),
+                      expectedCount * c_lengths * (c_lengths - 1) / 2);
+
+            std::stringstream stream;
+            testHistogram.Write(stream);
+            ASSERT_EQ(expected.str(), stream.str());
+        }
+
         // TODO: Implement and test file read/write.
     }
 }
@@ -20,12 +20,347 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IDocumentDataSchema.h"
+#include "BitFunnel/Index/IDocumentFrequencyTable.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "BitFunnel/Term.h"
+#include "ChunkIngestor.h"
 #include "gtest/gtest.h"
+#include "Shard.h"
+#include "SyntheticCorpus.h"
+#include "TestIngestor.h"
 
 
 namespace BitFunnel
 {
-    TEST(Ingestor, Placeholder)
+    namespace IngestorTest
     {
+        static const size_t c_chunkCount = 4;
+        static const size_t c_documentsPerChunk = 250;
+
+        static const double c_errorBound = 0.001;
+
+        // Chunk c holds documents [c * c_documentsPerChunk,
+        // (c + 1) * c_documentsPerChunk), each with a unique term.
+        static std::vector<char> CreateChunk(size_t chunk)
+        {
+            return CreateSyntheticChunk(chunk * c_documentsPerChunk,
+                                        c_documentsPerChunk,
+                                        true);
+        }
+
+
+        // An Ingestor with a single shard and an empty TermTable. When
+        // heavyHitterCount is not 0, the statistics are approximate.
+        class TestEnvironment : public TestIngestor
+        {
+        public:
+            TestEnvironment(bool generateStatistics,
+                            size_t heavyHitterCount = 0)
+              : TestIngestor(Factories::CreateTermTableCollection(1),
+                             Factories::CreateDocumentDataSchema(),
+                             Factories::CreateShardDefinition(),
+                             64,
+                             generateStatistics,
+                             c_errorBound,
+                             heavyHitterCount)
+            {
+            }
+        };
+
+
+        TEST(Ingestor, Placeholder)
+        {
+        }
+
+
+        // Ingests chunks concurrently while gathering statistics and checks
+        // that the per-thread counts are combined when they are written.
+        TEST(Ingestor, MultiThreadedStatistics)
+        {
+            TestEnvironment environment(true);
+            IConfiguration const & configuration =
+                environment.GetConfiguration();
+            IIngestor& ingestor = environment.GetIngestor();
+
+            std::vector<std::vector<char>> chunks;
+            for (size_t chunk = 0; chunk < c_chunkCount; ++chunk)
+            {
+                chunks.push_back(CreateChunk(chunk));
+            }
+
+            std::vector<std::thread> threads;
+            for (auto const & chunk : chunks)
+            {
+                threads.emplace_back([&chunk, &configuration, &ingestor] ()
+                {
+                    ChunkIngestor(chunk, configuration, ingestor);
+                });
+            }
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            const size_t documentCount = c_chunkCount * c_documentsPerChunk;
+            Shard& shard = ingestor.GetShard(0);
+
+            std::stringstream frequencyStream;
+            shard.TemporaryWriteDocumentFrequencyTable(frequencyStream, nullptr);
+            auto frequencies =
+                Factories::CreateDocumentFrequencyTable(frequencyStream);
+
+            // "all", "even", "third" and one unique term per document.
+            ASSERT_EQ(frequencies->size(), documentCount + 3);
+
+            auto frequency = [&](char const * text)
+            {
+                Term term(text, 0, configuration);
+                for (auto const & entry : *frequencies)
+                {
+                    if (entry.GetTerm().GetRawHash() == term.GetRawHash())
+                    {
+                        return entry.GetFrequency();
+                    }
+                }
+                return 0.0;
+            };
+
+            EXPECT_DOUBLE_EQ(frequency("all"), 1.0);
+            EXPECT_DOUBLE_EQ(frequency("even"), 0.5);
+            EXPECT_DOUBLE_EQ(frequency("third"),
+                             ((documentCount + 2) / 3) /
+                             static_cast<double>(documentCount));
+            EXPECT_DOUBLE_EQ(frequency("unique17"),
+                             1.0 / static_cast<double>(documentCount));
+
+            // Line i holds the number of unique terms seen before the i-th
+            // document. Document order depends on thread scheduling, but
+            // every document adds its own unique term.
+            std::stringstream countStream;
+            shard.TemporaryWriteCumulativeTermCounts(countStream);
+
+            std::string line;
+            size_t lineCount = 0;
+            size_t previous = 0;
+            while (std::getline(countStream, line))
+            {
+                size_t document = 0;
+                size_t uniqueTerms = 0;
+                char comma = 0;
+                std::stringstream fields(line);
+                fields >> document >> comma >> uniqueTerms;
+
+                ASSERT_EQ(document, lineCount);
+                if (lineCount > 0)
+                {
+                    ASSERT_GT(uniqueTerms, previous);
+                }
+                else
+                {
+                    ASSERT_EQ(uniqueTerms, 0u);
+                }
+                previous = uniqueTerms;
+                ++lineCount;
+            }
+            ASSERT_EQ(lineCount, documentCount);
+            ASSERT_GE(previous, documentCount - 1);
+            ASSERT_LE(previous, documentCount + 2);
+        }
+
+
+        // In approximate mode, the DocumentFrequencyTable only keeps the
+        // heavy hitters, with counts that are never underestimated.
+        TEST(Ingestor, ApproximateStatistics)
+        {
+            const size_t heavyHitterCount = 8;
+            TestEnvironment environment(true, heavyHitterCount);
+            IConfiguration const & configuration =
+                environment.GetConfiguration();
+            IIngestor& ingestor = environment.GetIngestor();
+
+            size_t postingCount = 0;
+            for (size_t chunk = 0; chunk < c_chunkCount; ++chunk)
+            {
+                ChunkIngestor(CreateChunk(chunk), configuration, ingestor);
+            }
+            const size_t documentCount = c_chunkCount * c_documentsPerChunk;
+            for (size_t i = 0; i < documentCount; ++i)
+            {
+                postingCount += 2 + (i % 2 == 0) + (i % 3 == 0);
+            }
+
+            std::stringstream frequencyStream;
+            ingestor.GetShard(0).
+                TemporaryWriteDocumentFrequencyTable(frequencyStream, nullptr);
+            auto frequencies =
+                Factories::CreateDocumentFrequencyTable(frequencyStream);
+            ASSERT_LE(frequencies->size(), heavyHitterCount);
+
+            const double slack = c_errorBound *
+                                 postingCount / documentCount;
+            auto expectFrequency = [&](char const * text, double expected)
+            {
+                Term term(text, 0, configuration);
+                for (auto const & entry : *frequencies)
+                {
+                    if (entry.GetTerm().GetRawHash() == term.GetRawHash())
+                    {
+                        EXPECT_GE(entry.GetFrequency(), expected);
+                        EXPECT_LE(entry.GetFrequency(), expected + slack);
+                        return;
+                    }
+                }
+                ADD_FAILURE() << "Missing heavy hitter " << text;
+            };
+
+            expectFrequency("all", 1.0);
+            expectFrequency("even", 0.5);
+            expectFrequency("third",
+                            ((documentCount + 2) / 3) /
+                            static_cast<double>(documentCount));
+        }
+
+
+        // Ingests one chunk into each of two groups, then expires them.
+        TEST(Ingestor, ExpireGroup)
+        {
+            TestEnvironment environment(false);
+            IIngestor& ingestor = environment.GetIngestor();
+            Shard& shard = ingestor.GetShard(0);
+
+            ingestor.OpenGroup(1);
+            ChunkIngestor(CreateChunk(0), environment.GetConfiguration(), ingestor);
+            ingestor.OpenGroup(2);
+            ChunkIngestor(CreateChunk(1), environment.GetConfiguration(), ingestor);
+            ingestor.CloseGroup();
+
+            // Opening the second group started a new Slice, so the groups
+            // don't share Slices.
+            const size_t capacity = shard.GetSliceCapacity();
+            const size_t slicesPerGroup =
+                (c_documentsPerChunk + capacity - 1) / capacity;
+            ASSERT_EQ(shard.GetSliceBuffers().size(), 2 * slicesPerGroup);
+
+            EXPECT_THROW(ingestor.OpenGroup(1), RecoverableError);
+            EXPECT_THROW(ingestor.ExpireGroup(3), RecoverableError);
+
+            ingestor.ExpireGroup(1);
+            EXPECT_EQ(shard.GetSliceBuffers().size(), slicesPerGroup);
+
+            for (DocId id = 0; id < 2 * c_documentsPerChunk; ++id)
+            {
+                EXPECT_EQ(ingestor.Contains(id), id >= c_documentsPerChunk);
+            }
+            EXPECT_FALSE(ingestor.Delete(0));
+
+            // Documents deleted individually are not expired again.
+            EXPECT_TRUE(ingestor.Delete(c_documentsPerChunk));
+
+            // Expiring a group twice has no effect.
+            ingestor.ExpireGroup(1);
+            EXPECT_EQ(shard.GetSliceBuffers().size(), slicesPerGroup);
+
+            ingestor.ExpireGroup(2);
+            EXPECT_EQ(shard.GetSliceBuffers().size(), 0u);
+            EXPECT_FALSE(ingestor.Contains(c_documentsPerChunk + 1));
+        }
+
+
+        // Deletes most documents from two groups, then checks that
+        // compaction re-packs the rest without mixing the groups.
+        TEST(Ingestor, CompactSlices)
+        {
+            TestEnvironment environment(false);
+            IConfiguration const & configuration =
+                environment.GetConfiguration();
+            IIngestor& ingestor = environment.GetIngestor();
+            Shard& shard = ingestor.GetShard(0);
+
+            ingestor.OpenGroup(1);
+            ChunkIngestor(CreateChunk(0), configuration, ingestor);
+            ingestor.OpenGroup(2);
+            ChunkIngestor(CreateChunk(1), configuration, ingestor);
+            ingestor.CloseGroup();
+
+            const size_t documentCount = 2 * c_documentsPerChunk;
+            const size_t capacity = shard.GetSliceCapacity();
+            const size_t slicesPerGroup =
+                (c_documentsPerChunk + capacity - 1) / capacity;
+            ASSERT_GT(slicesPerGroup, 1u);
+
+            // Keep every tenth document.
+            for (DocId id = 0; id < documentCount; ++id)
+            {
+                if (id % 10 != 0)
+                {
+                    ASSERT_TRUE(ingestor.Delete(id));
+                }
+            }
+
+            EXPECT_EQ(ingestor.CompactSlices(0.0), 0u);
+
+            // The surviving documents of each group fit in a single Slice.
+            EXPECT_EQ(ingestor.CompactSlices(0.5), 2 * (slicesPerGroup - 1));
+            EXPECT_EQ(shard.GetSliceBuffers().size(), 2u);
+            EXPECT_EQ(ingestor.CompactSlices(0.5), 0u);
+
+            ITermTable2 const & termTable = shard.GetTermTable();
+            auto hasBits = [&](DocumentHandle const & handle, std::string const & text)
+            {
+                RowIdSequence rows(Term(text.c_str(), 0, configuration),
+                                   termTable);
+                for (auto row : rows)
+                {
+                    if (!handle.GetBit(row))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            };
+
+            for (DocId id = 0; id < documentCount; ++id)
+            {
+                ASSERT_EQ(ingestor.Contains(id), id % 10 == 0);
+                if (id % 10 == 0)
+                {
+                    DocumentHandle handle = ingestor.GetHandle(id);
+                    EXPECT_EQ(handle.GetDocId(), id);
+                    EXPECT_TRUE(hasBits(handle, "all"));
+                    EXPECT_TRUE(hasBits(handle, "unique" + std::to_string(id)));
+                    if (id % 3 == 0)
+                    {
+                        EXPECT_TRUE(hasBits(handle, "third"));
+                    }
+                }
+            }
+
+            // The groups own the new Slices.
+            ingestor.ExpireGroup(1);
+            EXPECT_EQ(shard.GetSliceBuffers().size(), 1u);
+            for (DocId id = 0; id < documentCount; id += 10)
+            {
+                EXPECT_EQ(ingestor.Contains(id), id >= c_documentsPerChunk);
+            }
+
+            EXPECT_TRUE(ingestor.Delete(c_documentsPerChunk));
+            EXPECT_FALSE(ingestor.Contains(c_documentsPerChunk));
+        }
     }
 }
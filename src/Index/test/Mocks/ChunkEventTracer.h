@@ -43,6 +43,13 @@ namespace BitFunnel
             }
 
 
+            // Parses the documents in the range [begin, end).
+            ChunkEventTracer(char const * begin, char const * end)
+            {
+                ChunkReader(begin, end, *this);
+            }
+
+
             std::string Trace()
             {
                 return m_trace.str();
@@ -0,0 +1,130 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/ResolvedTermCache.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "TermTable.h"
+
+
+namespace BitFunnel
+{
+    namespace ResolvedTermCacheTest
+    {
+        static const Term::Hash c_firstHash = 1000ull;
+        static const size_t c_termCount = 100;
+
+        // Builds a TermTable with c_termCount explicit terms of 1 to 3 rows
+        // and a 2 row adhoc recipe for every (IdfX10, GramSize).
+        static void BuildTermTable(TermTable& termTable)
+        {
+            for (size_t i = 0; i < c_termCount; ++i)
+            {
+                termTable.OpenTerm();
+                for (size_t r = 0; r <= (i % 3); ++r)
+                {
+                    termTable.AddRowId(RowId(0, 0, i + r));
+                }
+                termTable.CloseTerm(c_firstHash + i);
+            }
+
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                for (Term::GramSize gramSize = 0; gramSize <= Term::c_maxGramSize; ++gramSize)
+                {
+                    termTable.OpenTerm();
+                    termTable.AddRowId(RowId(0, 0, 0));
+                    termTable.AddRowId(RowId(0, 3, 0));
+                    termTable.CloseAdhocTerm(idf, gramSize);
+                }
+            }
+
+            termTable.SetRowCounts(0, 200, 1000);
+            termTable.SetRowCounts(3, 0, 1000);
+            termTable.SetFactCount(0);
+            termTable.Seal();
+        }
+
+
+        static void VerifyRows(ResolvedTermCache& cache,
+                               TermTable const & termTable,
+                               Term const & term)
+        {
+            std::vector<RowId> expected;
+            RowIdSequence rows(term, termTable);
+            for (auto row : rows)
+            {
+                expected.push_back(row);
+            }
+
+            auto observed = cache.GetRows(term);
+            EXPECT_EQ(expected,
+                      std::vector<RowId>(observed.begin(), observed.end()));
+        }
+
+
+        static void VerifyAllTerms(ResolvedTermCache& cache,
+                                   TermTable const & termTable)
+        {
+            for (size_t i = 0; i < c_termCount; ++i)
+            {
+                // Explicit term.
+                VerifyRows(cache, termTable, Term(c_firstHash + i, 0, 0));
+
+                // Adhoc terms that differ only in IdfX10.
+                const Term::Hash adhocHash = c_firstHash + c_termCount + i;
+                VerifyRows(cache, termTable, Term(adhocHash, 0, 40));
+                VerifyRows(cache, termTable, Term(adhocHash, 0, 50));
+            }
+        }
+
+
+        TEST(ResolvedTermCache, MatchesRowIdSequence)
+        {
+            TermTable termTable;
+            BuildTermTable(termTable);
+
+            ResolvedTermCache cache(termTable);
+
+            // Second pass is served from the cache.
+            VerifyAllTerms(cache, termTable);
+            VerifyAllTerms(cache, termTable);
+        }
+
+
+        TEST(ResolvedTermCache, Collisions)
+        {
+            TermTable termTable;
+            BuildTermTable(termTable);
+
+            // With two entries, most lookups replace another term.
+            ResolvedTermCache cache(termTable, 1);
+
+            VerifyAllTerms(cache, termTable);
+            VerifyAllTerms(cache, termTable);
+        }
+    }
+}
@@ -21,12 +21,101 @@
 // THE SOFTWARE.
 
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/Row.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "RowTableDescriptor.h"
+
 
 namespace BitFunnel
 {
     TEST(RowTableDescriptor, Placeholder)
     {
     }
+
+
+    TEST(RowTableDescriptor, Summary)
+    {
+        auto termTable = Factories::CreateTermTable();
+        termTable->Seal();
+
+        // Enough documents for a rank 0 summary of more than one quadword.
+        const DocIndex capacity = Row::DocumentsInRank0Row(40000);
+        const size_t quadwordsPerBlock =
+            RowTableDescriptor::c_quadwordsPerSummaryBit;
+
+        for (Rank rank = 0; rank <= 3; rank += 3)
+        {
+            // Two rows beyond those of the TermTable are used for testing.
+            const RowIndex systemRowCount = termTable->GetTotalRowCount(rank);
+            const RowIndex rowCount = systemRowCount + 2;
+            const RowIndex row = systemRowCount;
+            const RowIndex otherRow = systemRowCount + 1;
+
+            RowTableDescriptor rowTable(capacity, rowCount, rank, 0);
+            std::vector<uint64_t> buffer(
+                RowTableDescriptor::GetBufferSize(capacity, rowCount, rank)
+                / sizeof(uint64_t));
+            void* sliceBuffer = buffer.data();
+            rowTable.Initialize(sliceBuffer, *termTable);
+
+            const size_t quadwordsPerRow =
+                Row::BytesInRow(capacity, rank) / sizeof(uint64_t);
+            const size_t blockCount = quadwordsPerRow / quadwordsPerBlock;
+            ASSERT_EQ(rowTable.GetSummaryQuadwordCount(),
+                      (blockCount + 63) / 64);
+            if (rank == 0)
+            {
+                ASSERT_GT(rowTable.GetSummaryQuadwordCount(), 1u);
+            }
+
+            auto isSummarized = [&] (RowIndex r, size_t block) {
+                uint64_t const * summary = rowTable.GetSummary(sliceBuffer, r);
+                return ((summary[block >> 6] >> (block & 0x3F)) & 1) != 0;
+            };
+
+            // Only the match-all row starts with live blocks.
+            RowId matchAll = *RowIdSequence(termTable->GetMatchAllTerm(),
+                                            *termTable).begin();
+            for (size_t block = 0; block < blockCount; ++block)
+            {
+                EXPECT_EQ(isSummarized(matchAll.GetIndex(), block),
+                          matchAll.GetRank() == rank);
+                EXPECT_FALSE(isSummarized(row, block));
+                EXPECT_FALSE(isSummarized(otherRow, block));
+            }
+
+            // Set bits in the third block and in the last one.
+            const DocIndex documentsPerBlock = (quadwordsPerBlock * 64) << rank;
+            const DocIndex first = documentsPerBlock * 2 + 5;
+            const DocIndex last = capacity - 1;
+            rowTable.SetBit(sliceBuffer, row, first);
+            rowTable.SetBit(sliceBuffer, row, last);
+            EXPECT_EQ(rowTable.GetBit(sliceBuffer, row, first), 1u);
+            EXPECT_EQ(rowTable.GetBit(sliceBuffer, row, last), 1u);
+            for (size_t block = 0; block < blockCount; ++block)
+            {
+                EXPECT_EQ(isSummarized(row, block),
+                          block == 2 || block == blockCount - 1);
+                EXPECT_FALSE(isSummarized(otherRow, block));
+            }
+
+            // Summaries are conservative, so ClearBit() leaves them set.
+            rowTable.ClearBit(sliceBuffer, row, first);
+            EXPECT_EQ(rowTable.GetBit(sliceBuffer, row, first), 0u);
+            EXPECT_TRUE(isSummarized(row, 2));
+
+            // ClearRow() clears them.
+            rowTable.ClearRow(sliceBuffer, row);
+            for (size_t block = 0; block < blockCount; ++block)
+            {
+                EXPECT_FALSE(isSummarized(row, block));
+            }
+        }
+    }
 }
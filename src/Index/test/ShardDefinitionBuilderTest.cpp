@@ -0,0 +1,137 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <memory>
+#include <sstream>
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IShardDefinitionBuilder.h"
+#include "BitFunnel/ITermTable2.h"
+#include "DocumentLengthHistogram.h"
+#include "gtest/gtest.h"
+
+
+namespace BitFunnel
+{
+    namespace ShardDefinitionBuilderTest
+    {
+        // Returns a TermTable with 1000 rank 0 rows.
+        static std::unique_ptr<ITermTable2> CreateTermTable()
+        {
+            auto termTable = Factories::CreateTermTable();
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                termTable->SetRowCounts(rank, (rank == 0) ? 1000 : 0, 0);
+            }
+            termTable->SetFactCount(0);
+            termTable->Seal();
+            return termTable;
+        }
+
+
+        // Writes a DocumentLengthHistogram with documentCounts[i] documents
+        // of length postingCounts[i] to a stream.
+        static void WriteHistogram(std::vector<size_t> const & postingCounts,
+                                   std::vector<size_t> const & documentCounts,
+                                   std::ostream& output)
+        {
+            DocumentLengthHistogram histogram;
+            for (size_t i = 0; i < postingCounts.size(); ++i)
+            {
+                for (size_t j = 0; j < documentCounts[i]; ++j)
+                {
+                    histogram.AddDocument(postingCounts[i]);
+                }
+            }
+            histogram.Write(output);
+        }
+
+
+        //*********************************************************************
+        TEST(ShardDefinitionBuilder, RoundTripHistogram)
+        {
+            std::stringstream stream;
+            WriteHistogram({ 0, 3, 5 }, { 1, 2, 1 }, stream);
+
+            DocumentLengthHistogram histogram(stream);
+            EXPECT_EQ(histogram.GetValue(0), 1u);
+            EXPECT_EQ(histogram.GetValue(3), 2u);
+            EXPECT_EQ(histogram.GetValue(5), 1u);
+            EXPECT_EQ(histogram.GetPostingCount(), 11u);
+        }
+
+
+        //*********************************************************************
+        TEST(ShardDefinitionBuilder, Boundaries)
+        {
+            auto termTable = CreateTermTable();
+
+            // Splitting after the short documents leaves the 10 medium
+            // documents in the shard with the long documents. This is cheaper
+            // than splitting after the medium documents.
+            {
+                std::stringstream stream;
+                WriteHistogram({ 1, 100, 1000 }, { 1000, 10, 1000 }, stream);
+
+                auto shards = Factories::CreateShardDefinition();
+                Factories::CreateShardDefinitionBuilder(stream,
+                                                        *termTable,
+                                                        2,
+                                                        *shards);
+                ASSERT_EQ(shards->GetShardCount(), 2u);
+                EXPECT_EQ(shards->GetMaxPostingCount(0), 1u);
+            }
+
+            // Each distinct length gets its own shard, even when more shards
+            // are requested.
+            {
+                std::stringstream stream;
+                WriteHistogram({ 1, 100, 1000 }, { 1000, 10, 1000 }, stream);
+
+                auto shards = Factories::CreateShardDefinition();
+                Factories::CreateShardDefinitionBuilder(stream,
+                                                        *termTable,
+                                                        8,
+                                                        *shards);
+                ASSERT_EQ(shards->GetShardCount(), 3u);
+                EXPECT_EQ(shards->GetMaxPostingCount(0), 1u);
+                EXPECT_EQ(shards->GetMaxPostingCount(1), 100u);
+            }
+
+            // A single shard needs no boundaries.
+            {
+                std::stringstream stream;
+                WriteHistogram({ 1, 100, 1000 }, { 1000, 10, 1000 }, stream);
+
+                auto shards = Factories::CreateShardDefinition();
+                Factories::CreateShardDefinitionBuilder(stream,
+                                                        *termTable,
+                                                        1,
+                                                        *shards);
+                EXPECT_EQ(shards->GetShardCount(), 1u);
+            }
+        }
+    }
+}
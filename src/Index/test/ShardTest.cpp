@@ -59,7 +59,7 @@ namespace BitFunnel
             std::unique_ptr<TrackingSliceBufferAllocator>
                 trackingAllocator(new TrackingSliceBufferAllocator(blockSize));
 
-            Shard shard(*recycler, *tokenManager, *termTable, docDataSchema, *trackingAllocator, blockSize);
+            Shard shard(*recycler, *tokenManager, *termTable, docDataSchema, *trackingAllocator, blockSize, false);
 
             tokenManager->Shutdown();
             recycler->Shutdown();
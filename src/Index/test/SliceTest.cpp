@@ -22,10 +22,122 @@
 
 #include "gtest/gtest.h"
 
+#include <future>
+
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/Helpers.h"
+#include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "DocumentDataSchema.h"
+#include "DocumentHandleInternal.h"
+#include "Shard.h"
+#include "Slice.h"
+#include "TrackingSliceBufferAllocator.h"
+
 
 namespace BitFunnel
 {
     TEST(Slice, Placeholder)
     {
     }
+
+
+    TEST(Slice, Generation)
+    {
+        auto recycler = Factories::CreateRecycler();
+        auto background = std::async(std::launch::async, &IRecycler::Run, recycler.get());
+
+        auto tokenManager = Factories::CreateTokenManager();
+        auto termTable = Factories::CreateTermTable();
+        termTable->Seal();
+
+        DocumentDataSchema docDataSchema;
+
+        const size_t blockSize =
+            GetMinimumBlockSize(docDataSchema, *termTable);
+
+        std::unique_ptr<TrackingSliceBufferAllocator>
+            trackingAllocator(new TrackingSliceBufferAllocator(blockSize));
+
+        {
+            Shard shard(*recycler, *tokenManager, *termTable, docDataSchema, *trackingAllocator, blockSize, false);
+
+            DocumentHandleInternal handle = shard.AllocateDocument(0);
+            Slice* slice = handle.GetSlice();
+
+            const uint64_t allocated = slice->GetGeneration();
+            EXPECT_EQ(slice->GetGeneration(), allocated);
+
+            // Committing a document makes it visible to queries.
+            handle.Activate();
+            slice->CommitDocument();
+            const uint64_t committed = slice->GetGeneration();
+            EXPECT_NE(committed, allocated);
+
+            handle.Expire();
+            EXPECT_NE(slice->GetGeneration(), committed);
+            EXPECT_NE(slice->GetGeneration(), allocated);
+        }
+
+        tokenManager->Shutdown();
+        recycler->Shutdown();
+        background.wait();
+    }
+
+
+    TEST(Slice, MaxStaticRank)
+    {
+        auto recycler = Factories::CreateRecycler();
+        auto background = std::async(std::launch::async, &IRecycler::Run, recycler.get());
+
+        auto tokenManager = Factories::CreateTokenManager();
+        auto termTable = Factories::CreateTermTable();
+        termTable->Seal();
+
+        DocumentDataSchema docDataSchema;
+        docDataSchema.RegisterFixedSizeBlob(1);
+        docDataSchema.RegisterStaticRankBlob();
+
+        const size_t blockSize =
+            GetMinimumBlockSize(docDataSchema, *termTable);
+
+        std::unique_ptr<TrackingSliceBufferAllocator>
+            trackingAllocator(new TrackingSliceBufferAllocator(blockSize));
+
+        {
+            Shard shard(*recycler, *tokenManager, *termTable, docDataSchema, *trackingAllocator, blockSize, false);
+
+            DocumentHandleInternal first = shard.AllocateDocument(0);
+            DocumentHandleInternal second = shard.AllocateDocument(1);
+            Slice* slice = first.GetSlice();
+            ASSERT_EQ(second.GetSlice(), slice);
+            EXPECT_EQ(slice->GetMaxStaticRank(), 0u);
+
+            first.SetStaticRank(1000);
+            second.SetStaticRank(7);
+            EXPECT_EQ(first.GetStaticRank(), 1000u);
+            EXPECT_EQ(second.GetStaticRank(), 7u);
+
+            // The bound only ever rises.
+            EXPECT_EQ(slice->GetMaxStaticRank(), 1000u);
+            first.SetStaticRank(3);
+            EXPECT_EQ(first.GetStaticRank(), 3u);
+            EXPECT_EQ(slice->GetMaxStaticRank(), 1000u);
+            second.SetStaticRank(65535);
+            EXPECT_EQ(slice->GetMaxStaticRank(), 65535u);
+
+            first.Activate();
+            slice->CommitDocument();
+            second.Activate();
+            slice->CommitDocument();
+            first.Expire();
+            second.Expire();
+        }
+
+        tokenManager->Shutdown();
+        recycler->Shutdown();
+        background.wait();
+    }
 }
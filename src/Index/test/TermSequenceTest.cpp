@@ -0,0 +1,127 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "TermSequence.h"
+
+
+namespace BitFunnel
+{
+    namespace TermSequenceTest
+    {
+        static Term CreateTerm(Term::Hash hash, Term::StreamId stream)
+        {
+            return Term(hash, stream, 0);
+        }
+
+
+        static std::vector<uint16_t> GetFingerprints(std::vector<Term::Hash> const & hashes)
+        {
+            std::vector<uint16_t> fingerprints;
+            for (auto hash : hashes)
+            {
+                fingerprints.push_back(TermSequence::GetFingerprint(hash));
+            }
+            return fingerprints;
+        }
+
+
+        static bool Contains(std::vector<char> const & buffer,
+                             Term::StreamId stream,
+                             std::vector<Term::Hash> const & phrase)
+        {
+            std::vector<uint16_t> fingerprints = GetFingerprints(phrase);
+            return TermSequence::ContainsPhrase(buffer.data(),
+                                                stream,
+                                                fingerprints.data(),
+                                                fingerprints.size());
+        }
+
+
+        TEST(TermSequence, ContainsPhrase)
+        {
+            // Stream 0 has hashes 1..11 so that phrases at every position
+            // are found, both in the blocks of four fingerprints and in the
+            // remainder. Stream 1 has 5, 3, 1.
+            TermSequence sequence;
+            sequence.OpenStream(0);
+            for (Term::Hash hash = 1; hash <= 11; ++hash)
+            {
+                sequence.AddTerm(CreateTerm(hash, 0));
+            }
+            sequence.OpenStream(1);
+            sequence.AddTerm(CreateTerm(5, 1));
+            sequence.AddTerm(CreateTerm(3, 1));
+            sequence.AddTerm(CreateTerm(1, 1));
+
+            std::vector<char> buffer(sequence.GetByteCount());
+            sequence.Write(buffer.data());
+
+            for (Term::Hash start = 1; start <= 10; ++start)
+            {
+                EXPECT_TRUE(Contains(buffer, 0, { start, start + 1 }));
+                EXPECT_FALSE(Contains(buffer, 0, { start + 1, start }));
+                EXPECT_FALSE(Contains(buffer, 0, { start, start + 2 }));
+            }
+            EXPECT_TRUE(Contains(buffer, 0, { 9, 10, 11 }));
+            EXPECT_FALSE(Contains(buffer, 0, { 10, 11, 12 }));
+
+            EXPECT_TRUE(Contains(buffer, 1, { 5, 3, 1 }));
+            EXPECT_FALSE(Contains(buffer, 1, { 1, 2 }));
+            EXPECT_FALSE(Contains(buffer, 0, { 5, 3 }));
+            EXPECT_FALSE(Contains(buffer, 2, { 1 }));
+        }
+
+
+        TEST(TermSequence, StreamOpenedTwice)
+        {
+            // The phrase may not span the two sequences.
+            TermSequence sequence;
+            sequence.OpenStream(0);
+            sequence.AddTerm(CreateTerm(1, 0));
+            sequence.OpenStream(0);
+            sequence.AddTerm(CreateTerm(2, 0));
+            sequence.AddTerm(CreateTerm(3, 0));
+
+            std::vector<char> buffer(sequence.GetByteCount());
+            sequence.Write(buffer.data());
+
+            EXPECT_TRUE(Contains(buffer, 0, { 1 }));
+            EXPECT_TRUE(Contains(buffer, 0, { 2, 3 }));
+            EXPECT_FALSE(Contains(buffer, 0, { 1, 2 }));
+        }
+
+
+        TEST(TermSequence, Empty)
+        {
+            TermSequence sequence;
+            std::vector<char> buffer(sequence.GetByteCount());
+            sequence.Write(buffer.data());
+
+            EXPECT_FALSE(Contains(buffer, 0, { 1 }));
+        }
+    }
+}
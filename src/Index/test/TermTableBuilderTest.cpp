@@ -33,6 +33,7 @@
 
 #include "gtest/gtest.h"
 
+#include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/RowIdSequence.h"
 #include "DocumentFrequencyTable.h"
 #include "FactSetBase.h"
@@ -298,7 +299,8 @@ private:
                                      treatment,
                                      terms,
                                      facts,
-                                     termTable);
+                                     termTable,
+                                     1);
 
             builder.Print(std::cout);
 
@@ -342,6 +344,52 @@ private:
             // TODO: Verify facts
             // TODO: Verify row counts.
         }
+
+
+        // Builds a TermTable for a Zipf-like corpus and returns its
+        // serialized form.
+        static std::string BuildTermTable(size_t threadCount)
+        {
+            const size_t c_termCount = 20000;
+            const Term::Hash c_firstHash = 1000ull;
+            const double density = 0.1;
+            const double adhocFrequency = 0.0001;
+
+            DocumentFrequencyTable terms;
+            for (size_t i = 0; i < c_termCount; ++i)
+            {
+                double frequency = 0.5 / (i + 1);
+                Term::IdfX10 idf =
+                    Term::ComputeIdfX10(frequency, Term::c_maxIdfX10Value);
+                terms.AddEntry(
+                    DocumentFrequencyTable::Entry(Term(c_firstHash + i, 0, idf, 1),
+                                                  frequency));
+            }
+
+            auto treatment =
+                Factories::CreateTreatmentPrivateShardRank0And3(density, 10.0);
+            FactSetBase facts;
+            TermTable termTable;
+            TermTableBuilder builder(density,
+                                     adhocFrequency,
+                                     *treatment,
+                                     terms,
+                                     facts,
+                                     termTable,
+                                     threadCount);
+
+            std::stringstream output;
+            termTable.Write(output);
+            return output.str();
+        }
+
+
+        TEST(TermTableBuilder, ParallelMatchesSerial)
+        {
+            std::string serial = BuildTermTable(1);
+            EXPECT_EQ(serial, BuildTermTable(3));
+            EXPECT_EQ(serial, BuildTermTable(8));
+        }
     }
 }
 #ifdef _MSC_VER
@@ -20,6 +20,8 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <cstdio>
+#include <fstream>
 #include <sstream>
 
 #include "gtest/gtest.h"
@@ -430,9 +432,82 @@ namespace BitFunnel
         //
         //*********************************************************************
 
+        static void VerifyExplicitRows(ITermTable2 const & termTable,
+                                       Term::Hash firstHash,
+                                       size_t termCount,
+                                       size_t adhocRowCount)
+        {
+            for (size_t i = 0; i < termCount; ++i)
+            {
+                Term term(firstHash + i, 0, 0);
+                RowIdSequence rows(term, termTable);
+
+                size_t r = 0;
+                for (auto row : rows)
+                {
+                    EXPECT_EQ(RowId(0, 0, i + r + adhocRowCount), row);
+                    ++r;
+                }
+                EXPECT_EQ((i % 3) + 1, r);
+            }
+        }
+
+
         TEST(TermTable, RoundTrip)
         {
-            // TODO: Implement this test.
+            // Enough terms to cause collisions in the TermHashTable.
+            const size_t termCount = 1000;
+            const size_t explicitRowCount = 2000;
+            const size_t adhocRowCount = 200;
+            const Term::Hash c_firstHash = 1000ull;
+
+            TermTable termTable;
+            for (size_t i = 0; i < termCount; ++i)
+            {
+                termTable.OpenTerm();
+                for (size_t r = 0; r <= (i % 3); ++r)
+                {
+                    termTable.AddRowId(RowId(0, 0, i + r));
+                }
+                termTable.CloseTerm(c_firstHash + i);
+            }
+            termTable.SetRowCounts(0, explicitRowCount, adhocRowCount);
+            termTable.SetFactCount(0);
+            termTable.Seal();
+
+            VerifyExplicitRows(termTable, c_firstHash, termCount, adhocRowCount);
+
+            // Round trip through a stream.
+            std::stringstream stream;
+            termTable.Write(stream);
+            TermTable termTable2(stream);
+            EXPECT_EQ(termTable, termTable2);
+            VerifyExplicitRows(termTable2, c_firstHash, termCount, adhocRowCount);
+
+            // Round trip through a memory mapped file.
+            char const * fileName = "TermTableRoundTrip.bin";
+            {
+                std::ofstream output(fileName, std::ios::binary);
+                termTable.Write(output);
+            }
+            {
+                TermTable termTable3(fileName);
+                EXPECT_EQ(termTable, termTable3);
+                VerifyExplicitRows(termTable3, c_firstHash, termCount, adhocRowCount);
+
+                // Unknown terms fall back to the adhoc recipe.
+                Term adhoc(c_firstHash + termCount, 0, 0);
+                EXPECT_EQ(termTable.GetRows(adhoc), termTable3.GetRows(adhoc));
+            }
+            std::remove(fileName);
+        }
+
+
+        TEST(TermTable, WriteBeforeSeal)
+        {
+            TermTable termTable;
+            std::stringstream stream;
+            EXPECT_ANY_THROW(termTable.Write(stream));
         }
     }
 }
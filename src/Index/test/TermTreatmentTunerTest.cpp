@@ -0,0 +1,166 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <math.h>        // pow().
+#include <sstream>
+
+#include "BitFunnel/Exceptions.h"
+#include "gtest/gtest.h"
+#include "TermTreatments.h"
+#include "TermTreatmentTuner.h"
+
+
+namespace BitFunnel
+{
+    namespace TermTreatmentTunerTest
+    {
+        static std::string ToString(RowConfiguration configuration)
+        {
+            std::stringstream stream;
+            configuration.Write(stream);
+            return stream.str();
+        }
+
+
+        // Build a tuner with a Zipf-like vocabulary, where each bucket holds
+        // ten times as many terms as the bucket ten IdfX10 values below it,
+        // and a query log dominated by mid-frequency terms.
+        static void Populate(TermTreatmentTuner& tuner)
+        {
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                const size_t count =
+                    static_cast<size_t>(pow(10.0, idf / 10.0) / 10.0) + 1;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    tuner.AddTerm(idf);
+                }
+            }
+
+            for (Term::IdfX10 idf = 10; idf <= 40; idf += 5)
+            {
+                tuner.AddQuery({ idf, static_cast<Term::IdfX10>(idf + 3) });
+            }
+        }
+
+
+        TEST(TreatmentTable, RoundTrip)
+        {
+            std::vector<RowConfiguration> configurations;
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                RowConfiguration configuration;
+                configuration.push_front(
+                    RowConfiguration::Entry(0, 1 + idf % 3, idf < 10));
+                if (idf % 2 == 1)
+                {
+                    configuration.push_front(
+                        RowConfiguration::Entry(1 + idf % 7, 2, false));
+                }
+                configurations.push_back(configuration);
+            }
+
+            TreatmentTable table(configurations);
+
+            std::stringstream stream;
+            table.Write(stream);
+
+            TreatmentTable table2(stream);
+
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                Term term(0, 0, idf);
+                EXPECT_EQ(ToString(table.GetTreatment(term)),
+                          ToString(table2.GetTreatment(term)));
+                EXPECT_EQ(ToString(configurations[idf]),
+                          ToString(table2.GetTreatment(term)));
+            }
+
+            // Terms with IdfSum values past the end of the table use the last
+            // configuration.
+            Term term(0, 0, Term::c_maxIdfX10Value + 5);
+            EXPECT_EQ(ToString(configurations.back()),
+                      ToString(table2.GetTreatment(term)));
+        }
+
+
+        TEST(TreatmentTable, MissingIdf)
+        {
+            std::stringstream stream;
+            stream << "idf,rank,rowCount,private" << std::endl
+                   << "0,0,1,1" << std::endl;
+
+            ASSERT_THROW(TreatmentTable table(stream), RecoverableError);
+        }
+
+
+        TEST(TermTreatmentTuner, Unconstrained)
+        {
+            const double density = 0.1;
+            const double maxFalsePositiveRate = 0.1;
+            TermTreatmentTuner tuner(density, maxFalsePositiveRate);
+            Populate(tuner);
+
+            auto configurations = tuner.Tune(1e9);
+            ASSERT_EQ(configurations.size(), Term::c_maxIdfX10Value + 1ull);
+
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                EXPECT_LE(tuner.FalsePositiveRate(idf, configurations[idf]),
+                          maxFalsePositiveRate);
+            }
+
+            // Terms at least as common as the density get a private row.
+            EXPECT_EQ(ToString(configurations[0]), "{ (0, 1, private) }");
+        }
+
+
+        TEST(TermTreatmentTuner, MemoryBudget)
+        {
+            const double maxFalsePositiveRate = 0.1;
+            TermTreatmentTuner tuner(0.1, maxFalsePositiveRate);
+            Populate(tuner);
+
+            auto unconstrained = tuner.Tune(1e9);
+            const double bytes = tuner.BytesPerDocument(unconstrained);
+            const double quadwords = tuner.QuadwordsPerQuery(unconstrained);
+
+            // Most of the memory goes to the rank 0 rows that every term
+            // needs, so only a small saving is possible. It must be paid for
+            // with more quadwords.
+            const double budget = bytes * 0.999;
+            auto constrained = tuner.Tune(budget);
+            EXPECT_LE(tuner.BytesPerDocument(constrained), budget);
+            EXPECT_GT(tuner.QuadwordsPerQuery(constrained), quadwords);
+
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                EXPECT_LE(tuner.FalsePositiveRate(idf, constrained[idf]),
+                          maxFalsePositiveRate);
+            }
+
+            // No configuration fits in an empty budget.
+            ASSERT_THROW(tuner.Tune(0.0), RecoverableError);
+        }
+    }
+}
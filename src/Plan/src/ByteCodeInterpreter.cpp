@@ -0,0 +1,300 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "BitFunnel/IPlanRows.h"
+#include "ByteCodeInterpreter.h"
+#include "LoggerInterfaces/Logging.h"
+
+
+namespace BitFunnel
+{
+    ByteCodeInterpreter::ByteCodeInterpreter(IPlanRows const & planRows,
+                                             ShardId shard)
+      : m_planRows(planRows),
+        m_shard(shard)
+    {
+    }
+
+
+    size_t ByteCodeInterpreter::Run(void const * sliceBuffer,
+                                    size_t iterationCount,
+                                    std::vector<uint64_t>& matches,
+                                    uint64_t const * liveIterations) const
+    {
+        uint64_t const * const buffer = static_cast<uint64_t const *>(sliceBuffer);
+        Instruction const * const code = m_code.data();
+        const size_t codeSize = m_code.size();
+
+        std::vector<uint64_t> stack;
+        std::vector<size_t> callStack;
+        size_t quadwordsRead = 0;
+
+        for (size_t iteration = 0; iteration < iterationCount; ++iteration)
+        {
+            if (liveIterations != nullptr &&
+                ((liveIterations[iteration >> 6] >> (iteration & 0x3F)) & 1) == 0)
+            {
+                continue;
+            }
+
+            size_t offset = iteration;
+            uint64_t accumulator = ~0ull;
+            size_t pc = 0;
+
+            while (pc < codeSize)
+            {
+                Instruction const & instruction = code[pc++];
+                switch (instruction.m_opcode)
+                {
+                case Opcode::AndRow:
+                    {
+                        uint64_t value =
+                            buffer[instruction.m_row + (offset >> instruction.m_argument)];
+                        accumulator &= instruction.m_inverted ? ~value : value;
+                        ++quadwordsRead;
+                    }
+                    break;
+                case Opcode::LoadRow:
+                    {
+                        uint64_t value =
+                            buffer[instruction.m_row + (offset >> instruction.m_argument)];
+                        accumulator = instruction.m_inverted ? ~value : value;
+                        ++quadwordsRead;
+                    }
+                    break;
+                case Opcode::LeftShiftOffset:
+                    offset <<= instruction.m_argument;
+                    break;
+                case Opcode::RightShiftOffset:
+                    offset >>= instruction.m_argument;
+                    break;
+                case Opcode::IncrementOffset:
+                    ++offset;
+                    break;
+                case Opcode::Push:
+                    stack.push_back(accumulator);
+                    break;
+                case Opcode::Pop:
+                    accumulator = stack.back();
+                    stack.pop_back();
+                    break;
+                case Opcode::AndStack:
+                    accumulator &= stack.back();
+                    stack.pop_back();
+                    break;
+                case Opcode::Constant:
+                    accumulator = static_cast<uint64_t>(instruction.m_argument);
+                    break;
+                case Opcode::Not:
+                    accumulator = ~accumulator;
+                    break;
+                case Opcode::OrStack:
+                    accumulator |= stack.back();
+                    stack.pop_back();
+                    break;
+                case Opcode::Report:
+                    // Report is always evaluated at rank 0, where the offset
+                    // is the index of the quadword.
+                    matches[offset] |= accumulator;
+                    break;
+                case Opcode::Call:
+                    callStack.push_back(pc);
+                    pc = m_labels[instruction.m_argument];
+                    break;
+                case Opcode::Jmp:
+                    pc = m_labels[instruction.m_argument];
+                    break;
+                case Opcode::Jnz:
+                    if (accumulator != 0)
+                    {
+                        pc = m_labels[instruction.m_argument];
+                    }
+                    break;
+                case Opcode::Jz:
+                    if (accumulator == 0)
+                    {
+                        pc = m_labels[instruction.m_argument];
+                    }
+                    break;
+                case Opcode::Return:
+                    pc = callStack.back();
+                    callStack.pop_back();
+                    break;
+                }
+            }
+
+            LogAssertB(stack.empty() && callStack.empty(),
+                       "ByteCodeInterpreter: unbalanced program.");
+        }
+
+        return quadwordsRead;
+    }
+
+
+    void ByteCodeInterpreter::AndRow(size_t id, bool inverted, size_t rankDelta)
+    {
+        EmitRow(Opcode::AndRow, id, inverted, rankDelta);
+    }
+
+
+    void ByteCodeInterpreter::LoadRow(size_t id, bool inverted, size_t rankDelta)
+    {
+        EmitRow(Opcode::LoadRow, id, inverted, rankDelta);
+    }
+
+
+    void ByteCodeInterpreter::LeftShiftOffset(size_t shift)
+    {
+        Emit(Opcode::LeftShiftOffset, shift);
+    }
+
+
+    void ByteCodeInterpreter::RightShiftOffset(size_t shift)
+    {
+        Emit(Opcode::RightShiftOffset, shift);
+    }
+
+
+    void ByteCodeInterpreter::IncrementOffset()
+    {
+        Emit(Opcode::IncrementOffset);
+    }
+
+
+    void ByteCodeInterpreter::Push()
+    {
+        Emit(Opcode::Push);
+    }
+
+
+    void ByteCodeInterpreter::Pop()
+    {
+        Emit(Opcode::Pop);
+    }
+
+
+    void ByteCodeInterpreter::AndStack()
+    {
+        Emit(Opcode::AndStack);
+    }
+
+
+    void ByteCodeInterpreter::Constant(int value)
+    {
+        Emit(Opcode::Constant,
+             static_cast<size_t>(static_cast<int64_t>(value)));
+    }
+
+
+    void ByteCodeInterpreter::Not()
+    {
+        Emit(Opcode::Not);
+    }
+
+
+    void ByteCodeInterpreter::OrStack()
+    {
+        Emit(Opcode::OrStack);
+    }
+
+
+    void ByteCodeInterpreter::UpdateFlags()
+    {
+        // The zero flag is always computed from the accumulator.
+    }
+
+
+    void ByteCodeInterpreter::Report()
+    {
+        Emit(Opcode::Report);
+    }
+
+
+    ICodeGenerator::Label ByteCodeInterpreter::AllocateLabel()
+    {
+        m_labels.push_back(0);
+        return static_cast<Label>(m_labels.size() - 1);
+    }
+
+
+    void ByteCodeInterpreter::PlaceLabel(Label label)
+    {
+        LogAssertB(label < m_labels.size(), "ByteCodeInterpreter: bad label.");
+        m_labels[label] = m_code.size();
+    }
+
+
+    void ByteCodeInterpreter::Call(Label label)
+    {
+        Emit(Opcode::Call, label);
+    }
+
+
+    void ByteCodeInterpreter::Jmp(Label label)
+    {
+        Emit(Opcode::Jmp, label);
+    }
+
+
+    void ByteCodeInterpreter::Jnz(Label label)
+    {
+        Emit(Opcode::Jnz, label);
+    }
+
+
+    void ByteCodeInterpreter::Jz(Label label)
+    {
+        Emit(Opcode::Jz, label);
+    }
+
+
+    void ByteCodeInterpreter::Return()
+    {
+        Emit(Opcode::Return);
+    }
+
+
+    void ByteCodeInterpreter::Emit(Opcode opcode, size_t argument)
+    {
+        m_code.push_back(Instruction{opcode, false, argument, 0});
+    }
+
+
+    void ByteCodeInterpreter::EmitRow(Opcode opcode,
+                                      size_t id,
+                                      bool inverted,
+                                      size_t rankDelta)
+    {
+        const unsigned rowId = static_cast<unsigned>(id);
+        const Rank physicalRank = m_planRows.PhysicalRow(m_shard, rowId).GetRank();
+        const Rank abstractRank = m_planRows.GetRank(rowId);
+        LogAssertB(physicalRank >= abstractRank,
+                   "ByteCodeInterpreter: physical row rank below plan rank.");
+
+        const ptrdiff_t offset = m_planRows.GetRowOffset(m_shard, rowId);
+        m_code.push_back(Instruction{opcode,
+                                     inverted,
+                                     physicalRank - abstractRank + rankDelta,
+                                     offset / static_cast<ptrdiff_t>(sizeof(uint64_t))});
+    }
+}
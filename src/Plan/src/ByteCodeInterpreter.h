@@ -0,0 +1,159 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stddef.h>                     // ptrdiff_t, size_t members.
+#include <stdint.h>                     // uint8_t member.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"   // ShardId parameter.
+#include "BitFunnel/ICodeGenerator.h"   // Base class.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IPlanRows;
+
+    //*************************************************************************
+    //
+    // ByteCodeInterpreter
+    //
+    // ICodeGenerator that records the primitives of a compiled CompileNode
+    // tree as byte code for a single Shard, and then interprets the byte code
+    // against that Shard's slice buffers.
+    //
+    // AbstractRow ids are resolved to the Shard's row offsets as the code is
+    // generated. A physical row whose rank is higher than its AbstractRow's
+    // rank is read at the combined rank delta, so that one program serves
+    // Shards whose TermTables place a term's rows at different ranks.
+    //
+    // The machine has an offset register holding the index of the current
+    // quadword at the current rank, a 64-bit accumulator, a value stack and
+    // a call stack. The zero flag always reflects the accumulator.
+    //
+    // Thread safety: Run() may be called concurrently once code generation
+    // is complete.
+    //
+    //*************************************************************************
+    class ByteCodeInterpreter : public ICodeGenerator, NonCopyable
+    {
+    public:
+        ByteCodeInterpreter(IPlanRows const & planRows, ShardId shard);
+
+        // Runs the program once for each quadword at the program's initial
+        // rank, with iterationCount iterations. Report ORs the accumulator
+        // into the quadword of matches for the current rank 0 offset, so
+        // matches needs one quadword per rank 0 quadword of the Slice. A
+        // document reported by more than one branch of an or-expression is
+        // therefore recorded once.
+        //
+        // When liveIterations is not null, it holds one bit per iteration
+        // and the iterations whose bits are clear are skipped, since the
+        // caller knows that they have no matches.
+        //
+        // Returns the number of row quadwords read, which measures how much
+        // work the row ordering, the jumps on zero and the skipped
+        // iterations saved.
+        size_t Run(void const * sliceBuffer,
+                   size_t iterationCount,
+                   std::vector<uint64_t>& matches,
+                   uint64_t const * liveIterations = nullptr) const;
+
+        //
+        // ICodeGenerator methods.
+        //
+        virtual void AndRow(size_t id, bool inverted, size_t rankDelta) override;
+        virtual void LoadRow(size_t id, bool inverted, size_t rankDelta) override;
+
+        virtual void LeftShiftOffset(size_t shift) override;
+        virtual void RightShiftOffset(size_t shift) override;
+        virtual void IncrementOffset() override;
+
+        virtual void Push() override;
+        virtual void Pop() override;
+
+        virtual void AndStack() override;
+        virtual void Constant(int value) override;
+        virtual void Not() override;
+        virtual void OrStack() override;
+        virtual void UpdateFlags() override;
+
+        virtual void Report() override;
+
+        virtual Label AllocateLabel() override;
+        virtual void PlaceLabel(Label label) override;
+        virtual void Call(Label label) override;
+        virtual void Jmp(Label label) override;
+        virtual void Jnz(Label label) override;
+        virtual void Jz(Label label) override;
+        virtual void Return() override;
+
+    private:
+        enum class Opcode : uint8_t
+        {
+            AndRow,
+            LoadRow,
+            LeftShiftOffset,
+            RightShiftOffset,
+            IncrementOffset,
+            Push,
+            Pop,
+            AndStack,
+            Constant,
+            Not,
+            OrStack,
+            Report,
+            Call,
+            Jmp,
+            Jnz,
+            Jz,
+            Return
+        };
+
+        struct Instruction
+        {
+            Opcode m_opcode;
+            bool m_inverted;
+
+            // Shift for row and offset instructions, label for control flow
+            // instructions and value for Constant.
+            size_t m_argument;
+
+            // Offset of a row in quadwords from the start of the slice buffer.
+            ptrdiff_t m_row;
+        };
+
+        void Emit(Opcode opcode, size_t argument = 0);
+        void EmitRow(Opcode opcode, size_t id, bool inverted, size_t rankDelta);
+
+        IPlanRows const & m_planRows;
+        const ShardId m_shard;
+
+        std::vector<Instruction> m_code;
+
+        // Position in m_code of each label.
+        std::vector<size_t> m_labels;
+    };
+}
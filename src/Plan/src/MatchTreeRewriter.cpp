@@ -1,7 +1,9 @@
+#include <algorithm>    // For std::stable_sort.
 #include <new>          // For placement new.
 #include <stddef.h>     // For nullptr.
 
 #include "BitFunnel/Allocators/IAllocator.h"
+#include "BitFunnel/IPlanRows.h"
 #include "BitFunnel/RowMatchNode.h"
 #include "LoggerInterfaces/Logging.h"
 #include "MatchTreeRewriter.h"
@@ -17,9 +19,10 @@ namespace BitFunnel
     RowMatchNode const & MatchTreeRewriter::Rewrite(RowMatchNode const & root,
                                                     unsigned targetRowCount,
                                                     unsigned targetCrossProductTermCount,
-                                                    IAllocator& allocator)
+                                                    IAllocator& allocator,
+                                                    IPlanRows const * planRows)
     {
-        Partition partition(allocator);
+        Partition partition(allocator, planRows);
 
         unsigned currentCrossProductTermCount = 0;
         return BuildCompileTree(partition,
@@ -99,8 +102,10 @@ namespace BitFunnel
 #pragma warning(push)
 #pragma warning(disable:4351)
 #endif
-    MatchTreeRewriter::Partition::Partition(IAllocator& allocator)
+    MatchTreeRewriter::Partition::Partition(IAllocator& allocator,
+                                            IPlanRows const * planRows)
         : m_allocator(allocator),
+          m_planRows(planRows),
           m_rowCount(0),
           m_parentRank(c_maxRankValue),
           m_minRank(c_maxRankValue),
@@ -121,6 +126,7 @@ namespace BitFunnel
     MatchTreeRewriter::Partition::Partition(Partition const & parent,
                                             RowMatchNode const & node)
         : m_allocator(parent.m_allocator),
+          m_planRows(parent.m_planRows),
           m_rowCount(parent.m_rowCount),
           m_parentRank(parent.m_minRank),
           m_minRank(parent.m_minRank),
@@ -132,11 +138,11 @@ namespace BitFunnel
     {
         ProcessTree(node);
 
-        AddNode(m_rank0Tree, m_rows[0]);
+        AddNode(m_rank0Tree, CreateRowTree(m_rows[0]));
 
         for (Rank rank = 1; rank <= c_maxRankValue; ++rank)
         {
-            AddNode(m_rankNTree, m_rows[rank]);
+            AddNode(m_rankNTree, CreateRowTree(m_rows[rank]));
         }
     }
 #ifdef _MSC_VER
@@ -283,11 +289,11 @@ namespace BitFunnel
                     RowMatchNode::Row* rankUpRow =
                         new (m_allocator.Allocate(sizeof(RowMatchNode::Row)))
                             RowMatchNode::Row(AbstractRow(row, rank - m_parentRank));
-                    AddNode(m_rows[rank], rankUpRow);
+                    m_rows[rank].push_back(rankUpRow);
                 }
                 else
                 {
-                    AddNode(m_rows[rank], &node);
+                    m_rows[rank].push_back(&node);
                 }
             }
             break;
@@ -314,6 +320,36 @@ namespace BitFunnel
     }
 
 
+    RowMatchNode const *
+        MatchTreeRewriter::Partition::CreateRowTree(std::vector<RowMatchNode const *>& rows) const
+    {
+        if (m_planRows != nullptr)
+        {
+            // AddNode() prepends, so adding the densest row first leaves the
+            // sparsest row at the head of the and-expression.
+            IPlanRows const & planRows = *m_planRows;
+            std::stable_sort(rows.begin(),
+                             rows.end(),
+                             [&planRows] (RowMatchNode const * a,
+                                          RowMatchNode const * b)
+                             {
+                                 auto const & rowA = dynamic_cast<RowMatchNode::Row const &>(*a).GetRow();
+                                 auto const & rowB = dynamic_cast<RowMatchNode::Row const &>(*b).GetRow();
+                                 return planRows.GetDensity(rowA.GetId()) >
+                                        planRows.GetDensity(rowB.GetId());
+                             });
+        }
+
+        RowMatchNode const * tree = nullptr;
+        for (auto row : rows)
+        {
+            AddNode(tree, row);
+        }
+
+        return tree;
+    }
+
+
     void MatchTreeRewriter::Partition::CreateReportNode(RowMatchNode const * & reportNode,
                                                         RowMatchNode const * node) const
     {
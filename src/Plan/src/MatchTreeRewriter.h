@@ -1,11 +1,15 @@
 #pragma once
 
+#include <vector>                         // std::vector member.
+
 #include "BitFunnel/NonCopyable.h"        // Inherits from NonCopyable.
+#include "BitFunnel/RowMatchNode.h"       // RowMatchNode parameter.
 
 
 namespace BitFunnel
 {
     class IAllocator;
+    class IPlanRows;
 
 
     //*************************************************************************
@@ -25,6 +29,11 @@ namespace BitFunnel
     // while distributing rank zero rows and complex not expressions over
     // any or-expressions.
     //
+    // When row densities are available, the rows of each rank are ordered by
+    // increasing density. The sparsest row is intersected first, so the
+    // RankDown matcher's jump on zero skips the rest of the rows as early as
+    // possible.
+    //
     //*************************************************************************
     class MatchTreeRewriter
     {
@@ -56,10 +65,15 @@ namespace BitFunnel
         // with a target of 3, the expression (a + b)(c + d)(e + f) would be
         // expanded to four terms, (ac + ad + bc + bd)(e + f), an amount
         // that is one greater than the target.
+        //
+        // planRows:
+        // Provides the density of each row. If planRows is nullptr, the rows
+        // of each rank are left in the order in which they are encountered.
         static RowMatchNode const & Rewrite(RowMatchNode const & root,
                                             unsigned targetRowCount,
                                             unsigned targetCrossProductTermCount,
-                                            IAllocator& allocator);
+                                            IAllocator& allocator,
+                                            IPlanRows const * planRows = nullptr);
 
     private:
         // Partition is a helper class that divides the and-expression at the
@@ -68,7 +82,7 @@ namespace BitFunnel
         class Partition : NonCopyable
         {
         public:
-            Partition(IAllocator& allocator);
+            Partition(IAllocator& allocator, IPlanRows const * planRows);
             Partition(Partition const & parent,
                       RowMatchNode const & node);
 
@@ -93,6 +107,10 @@ namespace BitFunnel
             void AddNode(RowMatchNode const * & tree,
                          RowMatchNode const * node) const;
 
+            // Returns an and-expression of rows, with the sparsest row first
+            // when densities are available, or nullptr if rows is empty.
+            RowMatchNode const * CreateRowTree(std::vector<RowMatchNode const *>& rows) const;
+
             void CreateReportNode(RowMatchNode const * & reportNode, RowMatchNode const * node) const;
 
             // Given an existing RowMatchTree rooted at RowMatchNode node, create a
@@ -108,6 +126,7 @@ namespace BitFunnel
             RowMatchNode const & RankUpToRankZero(RowMatchNode const & node, bool& notNodeEncountered) const;
 
             IAllocator& m_allocator;
+            IPlanRows const * m_planRows;
 
             // Maintains the total number of rows on the path from the match
             // tree root through all parent partitions and all rows in the tio
@@ -135,11 +154,10 @@ namespace BitFunnel
             // as the parent rank for child partitions.
             Rank m_minRank;
 
-            // Storage for and-expressions of rows encountered, organized by
-            // row-rank. Entries are nullptr for ranks that have no rows. A non
-            // nullptr entry consists of either a single row or an and-expression
-            // of rows. The and-nodes are allocated from m_allocator.
-            RowMatchNode const * m_rows[c_maxRankValue + 1];
+            // Storage for the rows encountered, organized by row-rank. The
+            // rows of each rank are combined into an and-expression, allocated
+            // from m_allocator, once the tree has been processed.
+            std::vector<RowMatchNode const *> m_rows[c_maxRankValue + 1];
 
             // The top of the tree is partitioned into an and expression of
             // four trees:
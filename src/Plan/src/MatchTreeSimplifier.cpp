@@ -0,0 +1,462 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <new>                                  // For placement new.
+
+#include "BitFunnel/Allocators/IAllocator.h"
+#include "BitFunnel/RowMatchNode.h"
+#include "LoggerInterfaces/Logging.h"
+#include "MatchTreeSimplifier.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // MatchTreeSimplifier
+    //
+    //*************************************************************************
+    RowMatchNode const &
+        MatchTreeSimplifier::Simplify(RowMatchNode const & root,
+                                      std::vector<unsigned> const & matchAllRows,
+                                      std::vector<unsigned> const & matchNoneRows,
+                                      IAllocator& allocator)
+    {
+        MatchTreeSimplifier simplifier(matchAllRows, matchNoneRows, allocator);
+
+        bool value;
+        RowMatchNode const * node = simplifier.SimplifyNode(root, value);
+        if (node == nullptr)
+        {
+            node = simplifier.m_examples[value];
+        }
+
+        return (node == nullptr) ? root : *node;
+    }
+
+
+    MatchTreeSimplifier::MatchTreeSimplifier(std::vector<unsigned> const & matchAllRows,
+                                             std::vector<unsigned> const & matchNoneRows,
+                                             IAllocator& allocator)
+        : m_allocator(allocator),
+          m_examples()
+    {
+        for (auto id : matchAllRows)
+        {
+            m_constantRows[id] = true;
+        }
+
+        for (auto id : matchNoneRows)
+        {
+            m_constantRows[id] = false;
+        }
+    }
+
+
+    RowMatchNode const *
+        MatchTreeSimplifier::SimplifyNode(RowMatchNode const & node, bool& value)
+    {
+        switch (node.GetType())
+        {
+        case RowMatchNode::AndMatch:
+            return SimplifyList(node, RowMatchNode::AndMatch, true, value);
+        case RowMatchNode::OrMatch:
+            return SimplifyList(node, RowMatchNode::OrMatch, false, value);
+        case RowMatchNode::NotMatch:
+            return SimplifyNot(dynamic_cast<RowMatchNode::Not const &>(node), value);
+        case RowMatchNode::ReportMatch:
+            return SimplifyReport(dynamic_cast<RowMatchNode::Report const &>(node), value);
+        case RowMatchNode::RowMatch:
+            return SimplifyRow(dynamic_cast<RowMatchNode::Row const &>(node), value);
+        default:
+            LogAbortB("Invalid node type.");
+        }
+
+        return nullptr;
+    }
+
+
+    RowMatchNode const *
+        MatchTreeSimplifier::SimplifyRow(RowMatchNode::Row const & node, bool& value)
+    {
+        AbstractRow const & row = node.GetRow();
+        auto it = m_constantRows.find(row.GetId());
+        if (it == m_constantRows.end())
+        {
+            return &node;
+        }
+
+        value = (it->second != row.IsInverted());
+        SetExample(node, value);
+        return nullptr;
+    }
+
+
+    RowMatchNode const *
+        MatchTreeSimplifier::SimplifyNot(RowMatchNode::Not const & node, bool& value)
+    {
+        bool childValue;
+        RowMatchNode const * child = SimplifyNode(node.GetChild(), childValue);
+        if (child == nullptr)
+        {
+            value = !childValue;
+            SetExample(node, value);
+            return nullptr;
+        }
+        else if (child == &node.GetChild())
+        {
+            return &node;
+        }
+        else if (child->GetType() == RowMatchNode::NotMatch)
+        {
+            return &dynamic_cast<RowMatchNode::Not const &>(*child).GetChild();
+        }
+
+        return new (m_allocator.Allocate(sizeof(RowMatchNode::Not)))
+                   RowMatchNode::Not(*child);
+    }
+
+
+    RowMatchNode const *
+        MatchTreeSimplifier::SimplifyReport(RowMatchNode::Report const & node, bool& value)
+    {
+        if (node.GetChild() == nullptr)
+        {
+            return &node;
+        }
+
+        bool childValue;
+        RowMatchNode const * child = SimplifyNode(*node.GetChild(), childValue);
+        if (child == nullptr && !childValue)
+        {
+            value = false;
+            return nullptr;
+        }
+        else if (child == node.GetChild())
+        {
+            return &node;
+        }
+
+        // A null child reports every document.
+        return RowMatchNode::Builder::CreateReportNode(child, m_allocator);
+    }
+
+
+    RowMatchNode const *
+        MatchTreeSimplifier::SimplifyList(RowMatchNode const & node,
+                                          RowMatchNode::NodeType type,
+                                          bool identity,
+                                          bool& value)
+    {
+        std::vector<RowMatchNode const *> operands;
+        if (!AddOperands(node, type, identity, operands))
+        {
+            value = !identity;
+            return nullptr;
+        }
+
+        std::vector<RowMatchNode const *> unique;
+        for (auto operand : operands)
+        {
+            if (Contains(unique, *operand))
+            {
+                continue;
+            }
+
+            for (auto other : unique)
+            {
+                if (AreComplements(*operand, *other))
+                {
+                    value = !identity;
+                    return nullptr;
+                }
+            }
+
+            unique.push_back(operand);
+        }
+
+        if (unique.empty())
+        {
+            value = identity;
+            return nullptr;
+        }
+        else if (unique.size() == 1)
+        {
+            return unique[0];
+        }
+
+        if (type == RowMatchNode::OrMatch)
+        {
+            RowMatchNode const * factored = FactorOr(unique);
+            if (factored != nullptr)
+            {
+                return factored;
+            }
+        }
+
+        return &CreateList(type, unique, 0);
+    }
+
+
+    bool MatchTreeSimplifier::AddOperands(RowMatchNode const & node,
+                                          RowMatchNode::NodeType type,
+                                          bool identity,
+                                          std::vector<RowMatchNode const *>& operands)
+    {
+        if (node.GetType() == type)
+        {
+            if (type == RowMatchNode::AndMatch)
+            {
+                auto const & andNode = dynamic_cast<RowMatchNode::And const &>(node);
+                return AddOperands(andNode.GetLeft(), type, identity, operands)
+                       && AddOperands(andNode.GetRight(), type, identity, operands);
+            }
+            else
+            {
+                auto const & orNode = dynamic_cast<RowMatchNode::Or const &>(node);
+                return AddOperands(orNode.GetLeft(), type, identity, operands)
+                       && AddOperands(orNode.GetRight(), type, identity, operands);
+            }
+        }
+
+        bool value;
+        RowMatchNode const * operand = SimplifyNode(node, value);
+        if (operand == nullptr)
+        {
+            return value == identity;
+        }
+
+        // Simplification may produce a list of the same type, e.g. when
+        // factoring an or-expression under an and-expression.
+        GetOperands(*operand, type, operands);
+        return true;
+    }
+
+
+    RowMatchNode const *
+        MatchTreeSimplifier::FactorOr(std::vector<RowMatchNode const *> const & operands)
+    {
+        std::vector<std::vector<RowMatchNode const *>> factors(operands.size());
+        for (size_t i = 0; i < operands.size(); ++i)
+        {
+            GetOperands(*operands[i], RowMatchNode::AndMatch, factors[i]);
+        }
+
+        std::vector<RowMatchNode const *> common;
+        for (auto factor : factors[0])
+        {
+            bool isCommon = true;
+            for (size_t i = 1; i < factors.size() && isCommon; ++i)
+            {
+                isCommon = Contains(factors[i], *factor);
+            }
+
+            if (isCommon)
+            {
+                common.push_back(factor);
+            }
+        }
+
+        if (common.empty())
+        {
+            return nullptr;
+        }
+
+        std::vector<RowMatchNode const *> remainders;
+        for (auto const & branch : factors)
+        {
+            std::vector<RowMatchNode const *> remainder;
+            for (auto factor : branch)
+            {
+                if (!Contains(common, *factor))
+                {
+                    remainder.push_back(factor);
+                }
+            }
+
+            if (remainder.empty())
+            {
+                // Absorption: a + ab = a.
+                return &CreateList(RowMatchNode::AndMatch, common, 0);
+            }
+
+            remainders.push_back(&CreateList(RowMatchNode::AndMatch, remainder, 0));
+        }
+
+        common.push_back(&CreateList(RowMatchNode::OrMatch, remainders, 0));
+        return &CreateList(RowMatchNode::AndMatch, common, 0);
+    }
+
+
+    RowMatchNode const &
+        MatchTreeSimplifier::CreateList(RowMatchNode::NodeType type,
+                                        std::vector<RowMatchNode const *> const & operands,
+                                        size_t start) const
+    {
+        LogAssertB(start < operands.size(), "Empty operand list.");
+
+        if (start + 1 == operands.size())
+        {
+            return *operands[start];
+        }
+
+        // Build a right-leaning list so that the operands are formatted in
+        // their original order.
+        RowMatchNode const & rest = CreateList(type, operands, start + 1);
+        if (type == RowMatchNode::AndMatch)
+        {
+            return *new (m_allocator.Allocate(sizeof(RowMatchNode::And)))
+                        RowMatchNode::And(*operands[start], rest);
+        }
+        else
+        {
+            return *new (m_allocator.Allocate(sizeof(RowMatchNode::Or)))
+                        RowMatchNode::Or(*operands[start], rest);
+        }
+    }
+
+
+    void MatchTreeSimplifier::SetExample(RowMatchNode const & node, bool value)
+    {
+        if (m_examples[value] == nullptr)
+        {
+            m_examples[value] = &node;
+        }
+    }
+
+
+    void MatchTreeSimplifier::GetOperands(RowMatchNode const & node,
+                                          RowMatchNode::NodeType type,
+                                          std::vector<RowMatchNode const *>& operands)
+    {
+        if (node.GetType() != type)
+        {
+            operands.push_back(&node);
+        }
+        else if (type == RowMatchNode::AndMatch)
+        {
+            auto const & andNode = dynamic_cast<RowMatchNode::And const &>(node);
+            GetOperands(andNode.GetLeft(), type, operands);
+            GetOperands(andNode.GetRight(), type, operands);
+        }
+        else
+        {
+            auto const & orNode = dynamic_cast<RowMatchNode::Or const &>(node);
+            GetOperands(orNode.GetLeft(), type, operands);
+            GetOperands(orNode.GetRight(), type, operands);
+        }
+    }
+
+
+    bool MatchTreeSimplifier::Contains(std::vector<RowMatchNode const *> const & nodes,
+                                       RowMatchNode const & node)
+    {
+        for (auto other : nodes)
+        {
+            if (AreEqual(*other, node))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    bool MatchTreeSimplifier::AreEqual(RowMatchNode const & a, RowMatchNode const & b)
+    {
+        if (&a == &b)
+        {
+            return true;
+        }
+        else if (a.GetType() != b.GetType())
+        {
+            return false;
+        }
+
+        switch (a.GetType())
+        {
+        case RowMatchNode::AndMatch:
+            {
+                auto const & left = dynamic_cast<RowMatchNode::And const &>(a);
+                auto const & right = dynamic_cast<RowMatchNode::And const &>(b);
+                return AreEqual(left.GetLeft(), right.GetLeft())
+                       && AreEqual(left.GetRight(), right.GetRight());
+            }
+        case RowMatchNode::OrMatch:
+            {
+                auto const & left = dynamic_cast<RowMatchNode::Or const &>(a);
+                auto const & right = dynamic_cast<RowMatchNode::Or const &>(b);
+                return AreEqual(left.GetLeft(), right.GetLeft())
+                       && AreEqual(left.GetRight(), right.GetRight());
+            }
+        case RowMatchNode::NotMatch:
+            return AreEqual(dynamic_cast<RowMatchNode::Not const &>(a).GetChild(),
+                            dynamic_cast<RowMatchNode::Not const &>(b).GetChild());
+        case RowMatchNode::ReportMatch:
+            {
+                RowMatchNode const * left =
+                    dynamic_cast<RowMatchNode::Report const &>(a).GetChild();
+                RowMatchNode const * right =
+                    dynamic_cast<RowMatchNode::Report const &>(b).GetChild();
+                return (left == nullptr || right == nullptr) ?
+                    left == right : AreEqual(*left, *right);
+            }
+        case RowMatchNode::RowMatch:
+            {
+                AbstractRow const & left = dynamic_cast<RowMatchNode::Row const &>(a).GetRow();
+                AbstractRow const & right = dynamic_cast<RowMatchNode::Row const &>(b).GetRow();
+                return left.GetId() == right.GetId()
+                       && left.GetRank() == right.GetRank()
+                       && left.GetRankDelta() == right.GetRankDelta()
+                       && left.IsInverted() == right.IsInverted();
+            }
+        default:
+            return false;
+        }
+    }
+
+
+    bool MatchTreeSimplifier::AreComplements(RowMatchNode const & a, RowMatchNode const & b)
+    {
+        if (a.GetType() == RowMatchNode::NotMatch)
+        {
+            return AreEqual(dynamic_cast<RowMatchNode::Not const &>(a).GetChild(), b);
+        }
+        else if (b.GetType() == RowMatchNode::NotMatch)
+        {
+            return AreEqual(a, dynamic_cast<RowMatchNode::Not const &>(b).GetChild());
+        }
+        else if (a.GetType() == RowMatchNode::RowMatch
+                 && b.GetType() == RowMatchNode::RowMatch)
+        {
+            AbstractRow const & left = dynamic_cast<RowMatchNode::Row const &>(a).GetRow();
+            AbstractRow const & right = dynamic_cast<RowMatchNode::Row const &>(b).GetRow();
+            return left.GetId() == right.GetId()
+                   && left.GetRank() == right.GetRank()
+                   && left.GetRankDelta() == right.GetRankDelta()
+                   && left.IsInverted() != right.IsInverted();
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,138 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <map>                            // std::map member.
+#include <vector>                         // std::vector parameter.
+
+#include "BitFunnel/NonCopyable.h"        // Inherits from NonCopyable.
+#include "BitFunnel/RowMatchNode.h"       // RowMatchNode parameter.
+
+
+namespace BitFunnel
+{
+    class IAllocator;
+
+
+    //*************************************************************************
+    //
+    // MatchTreeSimplifier removes redundant rows from a RowMatchNode tree
+    // before it is partitioned by rank in the MatchTreeRewriter. Each row
+    // removed saves a quadword load per block of documents scanned.
+    //
+    // The simplifier
+    //   1. folds rows known to match every document or no document, such as
+    //      the rows of the match-all and match-none terms.
+    //   2. flattens nested and-expressions and or-expressions and removes
+    //      duplicate operands, e.g. adhoc rows shared by several terms.
+    //   3. replaces an and-expression containing both x and Not(x) with
+    //      false and an or-expression containing both with true.
+    //   4. factors operands common to every branch of an or-expression out
+    //      of the or-expression, e.g. replacing ab + ac with a(b + c), and
+    //      applies absorption, e.g. replacing a + ab with a.
+    //
+    // Equivalent subtrees are recognized by structure, so the input should
+    // use the same AbstractRow id for rows with the same physical rows.
+    //
+    //*************************************************************************
+    class MatchTreeSimplifier : NonCopyable
+    {
+    public:
+        // Returns a tree equivalent to root. Nodes in the returned tree are
+        // shared with the input tree or allocated from the allocator.
+        //
+        // matchAllRows and matchNoneRows are the ids of AbstractRows whose
+        // bits are set for every document and for no document respectively.
+        //
+        // If the whole tree folds to a constant, the returned tree is a row
+        // or Not node from the input tree with that value. If the input has
+        // no such node, the input tree is returned unchanged.
+        static RowMatchNode const & Simplify(RowMatchNode const & root,
+                                             std::vector<unsigned> const & matchAllRows,
+                                             std::vector<unsigned> const & matchNoneRows,
+                                             IAllocator& allocator);
+
+        // Returns true if the two trees have the same structure and rows.
+        static bool AreEqual(RowMatchNode const & a, RowMatchNode const & b);
+
+    private:
+        MatchTreeSimplifier(std::vector<unsigned> const & matchAllRows,
+                            std::vector<unsigned> const & matchNoneRows,
+                            IAllocator& allocator);
+
+        // Returns the simplified node, or nullptr if the node has a constant
+        // value, which is then returned in value.
+        RowMatchNode const * SimplifyNode(RowMatchNode const & node, bool& value);
+
+        RowMatchNode const * SimplifyRow(RowMatchNode::Row const & node, bool& value);
+        RowMatchNode const * SimplifyNot(RowMatchNode::Not const & node, bool& value);
+        RowMatchNode const * SimplifyReport(RowMatchNode::Report const & node, bool& value);
+
+        // Simplifies an and-expression or an or-expression. The identity
+        // is true for an and-expression and false for an or-expression.
+        RowMatchNode const * SimplifyList(RowMatchNode const & node,
+                                          RowMatchNode::NodeType type,
+                                          bool identity,
+                                          bool& value);
+
+        // Simplifies each operand of the list rooted at node and appends the
+        // non-constant results to operands. Returns false if an operand has
+        // the list's absorbing value, i.e. the value opposite to identity.
+        bool AddOperands(RowMatchNode const & node,
+                         RowMatchNode::NodeType type,
+                         bool identity,
+                         std::vector<RowMatchNode const *>& operands);
+
+        // Rewrites ab + ac as a(b + c). Returns nullptr if the operands of
+        // the or-expression have no common factor.
+        RowMatchNode const * FactorOr(std::vector<RowMatchNode const *> const & operands);
+
+        RowMatchNode const & CreateList(RowMatchNode::NodeType type,
+                                        std::vector<RowMatchNode const *> const & operands,
+                                        size_t start) const;
+
+        // Records a node from the input tree that has a constant value, for
+        // use as the result when the whole tree is constant.
+        void SetExample(RowMatchNode const & node, bool value);
+
+        // Appends the operands of the list of the given type rooted at node.
+        // A node of another type is its own single operand.
+        static void GetOperands(RowMatchNode const & node,
+                                RowMatchNode::NodeType type,
+                                std::vector<RowMatchNode const *>& operands);
+
+        static bool Contains(std::vector<RowMatchNode const *> const & nodes,
+                             RowMatchNode const & node);
+
+        static bool AreComplements(RowMatchNode const & a, RowMatchNode const & b);
+
+        IAllocator& m_allocator;
+
+        // Maps AbstractRow id to the row's value for every document.
+        std::map<unsigned, bool> m_constantRows;
+
+        // Nodes from the input tree that are always false and always true.
+        RowMatchNode const * m_examples[2];
+    };
+}
@@ -0,0 +1,175 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <memory>                           // std::unique_ptr.
+
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Term.h"
+#include "LoggerInterfaces/Logging.h"
+#include "PhraseVerifier.h"
+#include "StringVector.h"
+#include "TermSequence.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<PhraseVerifier const>
+        PhraseVerifier::Create(TermMatchNode const & query,
+                               IConfiguration const & configuration)
+    {
+        std::unique_ptr<PhraseVerifier> verifier(new PhraseVerifier());
+        verifier->AddNode(query, configuration);
+
+        if (!verifier->m_hasPhrase)
+        {
+            return nullptr;
+        }
+
+        return std::unique_ptr<PhraseVerifier const>(verifier.release());
+    }
+
+
+    PhraseVerifier::PhraseVerifier()
+        : m_hasPhrase(false)
+    {
+    }
+
+
+    bool PhraseVerifier::Verify(void const * termSequences) const
+    {
+        return termSequences == nullptr ||
+               Evaluate(m_nodes.size() - 1, termSequences) != False;
+    }
+
+
+    size_t PhraseVerifier::AddNode(TermMatchNode const & node,
+                                   IConfiguration const & configuration)
+    {
+        Node result = { node.GetType(), 0, 0, 0, 0, 0 };
+
+        switch (node.GetType())
+        {
+        case TermMatchNode::AndMatch:
+            {
+                auto const & andNode = dynamic_cast<TermMatchNode::And const &>(node);
+                result.m_left = AddNode(andNode.GetLeft(), configuration);
+                result.m_right = AddNode(andNode.GetRight(), configuration);
+            }
+            break;
+        case TermMatchNode::OrMatch:
+            {
+                auto const & orNode = dynamic_cast<TermMatchNode::Or const &>(node);
+                result.m_left = AddNode(orNode.GetLeft(), configuration);
+                result.m_right = AddNode(orNode.GetRight(), configuration);
+            }
+            break;
+        case TermMatchNode::NotMatch:
+            {
+                auto const & notNode = dynamic_cast<TermMatchNode::Not const &>(node);
+                result.m_left = AddNode(notNode.GetChild(), configuration);
+            }
+            break;
+        case TermMatchNode::PhraseMatch:
+            {
+                auto const & phrase = dynamic_cast<TermMatchNode::Phrase const &>(node);
+                StringVector const & grams = phrase.GetGrams();
+
+                result.m_stream = phrase.GetStreamId();
+                result.m_start = m_fingerprints.size();
+                result.m_length = grams.GetSize();
+                for (unsigned i = 0; i < grams.GetSize(); ++i)
+                {
+                    Term term(grams[i], phrase.GetStreamId(), configuration);
+                    m_fingerprints.push_back(
+                        TermSequence::GetFingerprint(term.GetRawHash()));
+                }
+                m_hasPhrase = true;
+            }
+            break;
+        case TermMatchNode::UnigramMatch:
+            {
+                auto const & unigram = dynamic_cast<TermMatchNode::Unigram const &>(node);
+                Term term(unigram.GetText(), unigram.GetStreamId(), configuration);
+
+                result.m_stream = unigram.GetStreamId();
+                result.m_start = m_fingerprints.size();
+                result.m_length = 1;
+                m_fingerprints.push_back(
+                    TermSequence::GetFingerprint(term.GetRawHash()));
+            }
+            break;
+        default:
+            // Facts are left to the rows.
+            break;
+        }
+
+        m_nodes.push_back(result);
+        return m_nodes.size() - 1;
+    }
+
+
+    PhraseVerifier::Value
+        PhraseVerifier::Evaluate(size_t index, void const * termSequences) const
+    {
+        Node const & node = m_nodes[index];
+
+        switch (node.m_type)
+        {
+        case TermMatchNode::AndMatch:
+            {
+                const Value left = Evaluate(node.m_left, termSequences);
+                if (left == False)
+                {
+                    return False;
+                }
+                const Value right = Evaluate(node.m_right, termSequences);
+                return (right == True) ? left : right;
+            }
+        case TermMatchNode::OrMatch:
+            {
+                const Value left = Evaluate(node.m_left, termSequences);
+                if (left == True)
+                {
+                    return True;
+                }
+                const Value right = Evaluate(node.m_right, termSequences);
+                return (right == False) ? left : right;
+            }
+        case TermMatchNode::NotMatch:
+            {
+                const Value child = Evaluate(node.m_left, termSequences);
+                return (child == Unknown) ? Unknown : ((child == True) ? False : True);
+            }
+        case TermMatchNode::PhraseMatch:
+        case TermMatchNode::UnigramMatch:
+            // Distinct terms may share a fingerprint, so finding the
+            // sequence does not prove the phrase is in the document.
+            return TermSequence::ContainsPhrase(termSequences,
+                                                node.m_stream,
+                                                m_fingerprints.data() + node.m_start,
+                                                node.m_length) ? Unknown : False;
+        default:
+            return Unknown;
+        }
+    }
+}
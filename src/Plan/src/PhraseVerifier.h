@@ -0,0 +1,107 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <memory>                       // std::unique_ptr return value.
+#include <stddef.h>                     // size_t member.
+#include <stdint.h>                     // uint16_t member.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"      // Base class.
+#include "BitFunnel/TermMatchNode.h"    // TermMatchNode::NodeType member.
+
+
+namespace BitFunnel
+{
+    class IConfiguration;
+
+    //*************************************************************************
+    //
+    // PhraseVerifier
+    //
+    // Removes phrase false positives from the matches of a query's row plan.
+    // The n-gram rows of a phrase only show that its terms occur somewhere in
+    // the document, so the verifier checks the phrase against the document's
+    // term sequences, recorded at ingestion by TermSequence.
+    //
+    // The query is evaluated with three-valued logic. Phrases and unigrams
+    // are false when the document does not have the sequence of term
+    // fingerprints. Otherwise they are unknown, since fingerprints can
+    // collide, as are facts. A match is only rejected when the query is
+    // false.
+    //
+    // Thread safety: Verify() may be called concurrently.
+    //
+    //*************************************************************************
+    class PhraseVerifier : NonCopyable
+    {
+    public:
+        // Returns nullptr if the query has no phrases, since then the
+        // verifier could not reject any match.
+        static std::unique_ptr<PhraseVerifier const>
+            Create(TermMatchNode const & query,
+                   IConfiguration const & configuration);
+
+        // Returns false if the document's term sequences show that it does
+        // not match the query. Returns true if termSequences is nullptr.
+        bool Verify(void const * termSequences) const;
+
+    private:
+        PhraseVerifier();
+
+        enum Value
+        {
+            False,
+            True,
+            Unknown
+        };
+
+        class Node
+        {
+        public:
+            TermMatchNode::NodeType m_type;
+
+            // Children of And, Or and Not nodes.
+            size_t m_left;
+            size_t m_right;
+
+            // Fingerprints of a phrase's or unigram's terms in
+            // m_fingerprints.
+            Term::StreamId m_stream;
+            size_t m_start;
+            size_t m_length;
+        };
+
+        // Appends node and its children to m_nodes and returns its index.
+        size_t AddNode(TermMatchNode const & node,
+                       IConfiguration const & configuration);
+
+        Value Evaluate(size_t node, void const * termSequences) const;
+
+        // Nodes of the query, with each node after its children.
+        std::vector<Node> m_nodes;
+        std::vector<uint16_t> m_fingerprints;
+        bool m_hasPhrase;
+    };
+}
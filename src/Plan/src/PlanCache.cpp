@@ -0,0 +1,248 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>                    // std::sort(), std::unique().
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/TermMatchNode.h"
+#include "LoggerInterfaces/Logging.h"
+#include "PlanCache.h"
+#include "StringVector.h"
+
+
+namespace BitFunnel
+{
+    // Appends the canonical forms of the operands of a chain of nodes of the
+    // same type as node.
+    static void AppendOperands(TermMatchNode const & node,
+                               TermMatchNode::NodeType type,
+                               std::vector<std::string>& operands)
+    {
+        if (node.GetType() == type && type == TermMatchNode::AndMatch)
+        {
+            auto const & andNode = dynamic_cast<TermMatchNode::And const &>(node);
+            AppendOperands(andNode.GetLeft(), type, operands);
+            AppendOperands(andNode.GetRight(), type, operands);
+        }
+        else if (node.GetType() == type && type == TermMatchNode::OrMatch)
+        {
+            auto const & orNode = dynamic_cast<TermMatchNode::Or const &>(node);
+            AppendOperands(orNode.GetLeft(), type, operands);
+            AppendOperands(orNode.GetRight(), type, operands);
+        }
+        else
+        {
+            operands.push_back(PlanCache::GetCanonicalForm(node));
+        }
+    }
+
+
+    // Text is prefixed with its length so that it may contain any character.
+    static void AppendText(std::string& form, char const * text)
+    {
+        const std::string value(text);
+        form.append(std::to_string(value.size()));
+        form.push_back(':');
+        form.append(value);
+    }
+
+
+    //*************************************************************************
+    //
+    // PlanCache
+    //
+    //*************************************************************************
+    PlanCache::PlanCache(size_t capacity)
+      : m_capacity(capacity),
+        m_hitCount(0),
+        m_missCount(0)
+    {
+        LogAssertB(capacity > 0, "PlanCache: capacity must be positive.");
+    }
+
+
+    std::string PlanCache::GetCanonicalForm(TermMatchNode const & query)
+    {
+        std::string form;
+
+        switch (query.GetType())
+        {
+        case TermMatchNode::AndMatch:
+        case TermMatchNode::OrMatch:
+            {
+                std::vector<std::string> operands;
+                AppendOperands(query, query.GetType(), operands);
+                std::sort(operands.begin(), operands.end());
+                operands.erase(std::unique(operands.begin(), operands.end()),
+                               operands.end());
+
+                form.append(query.GetType() == TermMatchNode::AndMatch ? "And(" : "Or(");
+                for (auto const & operand : operands)
+                {
+                    form.append(operand);
+                    form.push_back(',');
+                }
+                form.push_back(')');
+            }
+            break;
+        case TermMatchNode::NotMatch:
+            {
+                auto const & notNode = dynamic_cast<TermMatchNode::Not const &>(query);
+                form.append("Not(");
+                form.append(GetCanonicalForm(notNode.GetChild()));
+                form.push_back(')');
+            }
+            break;
+        case TermMatchNode::UnigramMatch:
+            {
+                auto const & unigram = dynamic_cast<TermMatchNode::Unigram const &>(query);
+                form.append("Unigram(");
+                form.append(std::to_string(unigram.GetStreamId()));
+                form.push_back(',');
+                AppendText(form, unigram.GetText());
+                form.push_back(')');
+            }
+            break;
+        case TermMatchNode::PhraseMatch:
+            {
+                auto const & phrase = dynamic_cast<TermMatchNode::Phrase const &>(query);
+                StringVector const & grams = phrase.GetGrams();
+                form.append("Phrase(");
+                form.append(std::to_string(phrase.GetStreamId()));
+                for (unsigned i = 0; i < grams.GetSize(); ++i)
+                {
+                    form.push_back(',');
+                    AppendText(form, grams[i]);
+                }
+                form.push_back(')');
+            }
+            break;
+        case TermMatchNode::FactMatch:
+            {
+                auto const & fact = dynamic_cast<TermMatchNode::Fact const &>(query);
+                form.append("Fact(");
+                form.append(std::to_string(fact.GetFact()));
+                form.push_back(')');
+            }
+            break;
+        default:
+            RecoverableError error("PlanCache: unsupported TermMatchNode.");
+            throw error;
+        }
+
+        return form;
+    }
+
+
+    std::shared_ptr<PlanCache::ShardPlans const>
+        PlanCache::Find(std::string const & query, uint64_t version)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto it = m_index.find(Key { query, version });
+        if (it == m_index.end())
+        {
+            ++m_missCount;
+            return nullptr;
+        }
+
+        ++m_hitCount;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->m_plans;
+    }
+
+
+    void PlanCache::Add(std::string const & query,
+                        uint64_t version,
+                        std::shared_ptr<ShardPlans const> plans)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        Key key { query, version };
+        auto it = m_index.find(key);
+        if (it != m_index.end())
+        {
+            it->second->m_plans = plans;
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return;
+        }
+
+        if (m_entries.size() == m_capacity)
+        {
+            m_index.erase(m_entries.back().m_key);
+            m_entries.pop_back();
+        }
+
+        m_entries.push_front(Entry { key, plans });
+        m_index.insert(std::make_pair(key, m_entries.begin()));
+    }
+
+
+    void PlanCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_index.clear();
+        m_entries.clear();
+    }
+
+
+    size_t PlanCache::GetSize() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_entries.size();
+    }
+
+
+    uint64_t PlanCache::GetHitCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_hitCount;
+    }
+
+
+    uint64_t PlanCache::GetMissCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_missCount;
+    }
+
+
+    //*************************************************************************
+    //
+    // PlanCache::Key
+    //
+    //*************************************************************************
+    bool PlanCache::Key::operator==(Key const & other) const
+    {
+        return m_version == other.m_version && m_query == other.m_query;
+    }
+
+
+    size_t PlanCache::KeyHash::operator()(Key const & key) const
+    {
+        const size_t hash = std::hash<std::string>()(key.m_query);
+        return hash ^ (std::hash<uint64_t>()(key.m_version) + 0x9e3779b97f4a7c15ull
+                       + (hash << 6) + (hash >> 2));
+    }
+}
@@ -0,0 +1,123 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <list>                         // std::list member.
+#include <memory>                       // std::shared_ptr member.
+#include <mutex>                        // std::mutex member.
+#include <stddef.h>                     // size_t parameter.
+#include <stdint.h>                     // uint64_t parameter.
+#include <string>                       // std::string parameter.
+#include <unordered_map>                // std::unordered_map member.
+#include <vector>                       // std::vector template parameter.
+
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class ShardPlan;
+    class TermMatchNode;
+
+    //*************************************************************************
+    //
+    // PlanCache
+    //
+    // A size bounded, least recently used cache of the ShardPlans compiled
+    // for a query. Entries are keyed by the canonical form of the query and
+    // by a version that the owner increments whenever plans must be
+    // discarded, e.g. when a TermTable is replaced or the row densities used
+    // for planning change.
+    //
+    // Plans are shared, so a query that is running when its entry is evicted
+    // or invalidated keeps its plans until it completes.
+    //
+    // Thread safety: all methods are thread safe.
+    //
+    //*************************************************************************
+    class PlanCache : public NonCopyable
+    {
+    public:
+        // One ShardPlan per Shard, indexed by ShardId.
+        typedef std::vector<std::shared_ptr<ShardPlan const>> ShardPlans;
+
+        PlanCache(size_t capacity);
+
+        // Returns a string that is the same for queries that differ only in
+        // the order or repetition of the operands of an and-expression or
+        // or-expression, and for nested and-expressions or or-expressions
+        // that are flattened.
+        static std::string GetCanonicalForm(TermMatchNode const & query);
+
+        // Returns the plans for the query, or nullptr if they are not cached.
+        // A successful lookup makes the entry the most recently used.
+        std::shared_ptr<ShardPlans const> Find(std::string const & query,
+                                               uint64_t version);
+
+        // Adds the plans for the query, evicting the least recently used
+        // entry if the cache is full. Replaces any existing entry.
+        void Add(std::string const & query,
+                 uint64_t version,
+                 std::shared_ptr<ShardPlans const> plans);
+
+        // Removes every entry.
+        void Clear();
+
+        size_t GetSize() const;
+        uint64_t GetHitCount() const;
+        uint64_t GetMissCount() const;
+
+    private:
+        struct Key
+        {
+            std::string m_query;
+            uint64_t m_version;
+
+            bool operator==(Key const & other) const;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(Key const & key) const;
+        };
+
+        struct Entry
+        {
+            Key m_key;
+            std::shared_ptr<ShardPlans const> m_plans;
+        };
+
+        const size_t m_capacity;
+
+        mutable std::mutex m_lock;
+
+        // Most recently used entries are at the front.
+        std::list<Entry> m_entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+
+        uint64_t m_hitCount;
+        uint64_t m_missCount;
+    };
+}
@@ -0,0 +1,120 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "LoggerInterfaces/Logging.h"
+#include "PlanRows.h"
+#include "RowDensityTable.h"
+#include "Shard.h"
+
+
+namespace BitFunnel
+{
+    PlanRows::PlanRows(IIngestor const & ingestor,
+                       RowDensityTable const * densities)
+      : m_ingestor(ingestor),
+        m_densities(densities),
+        m_shardCount(ingestor.GetShardCount())
+    {
+    }
+
+
+    bool PlanRows::IsFull() const
+    {
+        return m_ranks.size() >= c_maxRowsPerQuery;
+    }
+
+
+    ShardId PlanRows::GetShardCount() const
+    {
+        return m_shardCount;
+    }
+
+
+    unsigned PlanRows::GetRowCount() const
+    {
+        return static_cast<unsigned>(m_ranks.size());
+    }
+
+
+    AbstractRow PlanRows::AddRow(Rank rank)
+    {
+        if (IsFull())
+        {
+            RecoverableError error("PlanRows: query has too many rows.");
+            throw error;
+        }
+
+        const unsigned id = GetRowCount();
+        m_ranks.push_back(rank);
+        m_rows.resize(m_rows.size() + m_shardCount);
+
+        return AbstractRow(id, rank, false);
+    }
+
+
+    Rank PlanRows::GetRank(unsigned id) const
+    {
+        LogAssertB(id < m_ranks.size(), "PlanRows: id out of range.");
+        return m_ranks[id];
+    }
+
+
+    RowId const & PlanRows::PhysicalRow(ShardId shard, unsigned id) const
+    {
+        LogAssertB(shard < m_shardCount && id < m_ranks.size(),
+                   "PlanRows: shard or id out of range.");
+        return m_rows[id * m_shardCount + shard];
+    }
+
+
+    RowId & PlanRows::PhysicalRow(ShardId shard, unsigned id)
+    {
+        LogAssertB(shard < m_shardCount && id < m_ranks.size(),
+                   "PlanRows: shard or id out of range.");
+        return m_rows[id * m_shardCount + shard];
+    }
+
+
+    ptrdiff_t PlanRows::GetRowOffset(ShardId shard, unsigned id) const
+    {
+        return m_ingestor.GetShard(shard).GetRowOffset(PhysicalRow(shard, id));
+    }
+
+
+    double PlanRows::GetDensity(unsigned id) const
+    {
+        if (m_densities == nullptr || m_shardCount == 0)
+        {
+            return 1.0;
+        }
+
+        double sum = 0.0;
+        for (ShardId shard = 0; shard < m_shardCount; ++shard)
+        {
+            sum += m_densities->GetDensity(shard, PhysicalRow(shard, id));
+        }
+        return sum / m_shardCount;
+    }
+}
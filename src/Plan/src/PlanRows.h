@@ -0,0 +1,81 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/IPlanRows.h"        // Base class.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IIngestor;
+    class RowDensityTable;
+
+    //*************************************************************************
+    //
+    // PlanRows
+    //
+    // IPlanRows for the Shards of an IIngestor. Row offsets are looked up in
+    // the Shard that owns the physical row, and densities, when available,
+    // in a RowDensityTable.
+    //
+    //*************************************************************************
+    class PlanRows : public IPlanRows, NonCopyable
+    {
+    public:
+        // The densities parameter may be nullptr.
+        PlanRows(IIngestor const & ingestor,
+                 RowDensityTable const * densities);
+
+        //
+        // IPlanRows methods.
+        //
+        virtual bool IsFull() const override;
+        virtual ShardId GetShardCount() const override;
+        virtual unsigned GetRowCount() const override;
+        virtual AbstractRow AddRow(Rank rank) override;
+        virtual Rank GetRank(unsigned id) const override;
+        virtual RowId const & PhysicalRow(ShardId shard, unsigned id) const override;
+        virtual RowId & PhysicalRow(ShardId shard, unsigned id) override;
+        virtual ptrdiff_t GetRowOffset(ShardId shard, unsigned id) const override;
+        virtual double GetDensity(unsigned id) const override;
+
+        // AbstractRow ids are 16 bits, but a query with this many rows is
+        // already too expensive to match.
+        static const unsigned c_maxRowsPerQuery = 500;
+
+    private:
+        IIngestor const & m_ingestor;
+        RowDensityTable const * m_densities;
+        const ShardId m_shardCount;
+
+        // Rank of each AbstractRow, indexed by id.
+        std::vector<Rank> m_ranks;
+
+        // Physical rows, m_shardCount for each AbstractRow id.
+        std::vector<RowId> m_rows;
+    };
+}
@@ -0,0 +1,630 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <functional>
+
+#include "Allocator.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Plan/Factories.h"
+#include "BitFunnel/RowMatchNode.h"
+#include "BitFunnel/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "CompileNode.h"
+#include "LoggerInterfaces/Logging.h"
+#include "MatchTreeRewriter.h"
+#include "MatchTreeSimplifier.h"
+#include "PhraseVerifier.h"
+#include "PlanRows.h"
+#include "QueryExecutor.h"
+#include "RankDownCompiler.h"
+#include "RowDensityTable.h"
+#include "Shard.h"
+#include "ShardPlan.h"
+#include "Slice.h"
+#include "TermMatchTreeConverter.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IQueryExecutor>
+        Factories::CreateQueryExecutor(IIngestor& ingestor,
+                                       IConfiguration const & configuration,
+                                       size_t threadCount)
+    {
+        return std::unique_ptr<IQueryExecutor>(
+            new QueryExecutor(ingestor, configuration, threadCount));
+    }
+
+
+    //*************************************************************************
+    //
+    // QueryExecutor::Worker
+    //
+    //*************************************************************************
+    class QueryExecutor::Worker : public IThreadBase
+    {
+    public:
+        Worker(QueryExecutor& executor)
+          : m_executor(executor)
+        {
+        }
+
+        virtual void EntryPoint() override
+        {
+            std::unique_ptr<ShardTask> task;
+            while (m_executor.m_queue.TryDequeue(task))
+            {
+                m_executor.ProcessTask(*task);
+                task.reset();
+            }
+        }
+
+    private:
+        QueryExecutor& m_executor;
+    };
+
+
+    //*************************************************************************
+    //
+    // QueryExecutor::ResultStream
+    //
+    //*************************************************************************
+    class QueryExecutor::ResultStream : public IEnumerator<DocId>
+    {
+    public:
+        ResultStream(std::shared_ptr<Results> const & results)
+          : m_results(results),
+            m_position(0)
+        {
+        }
+
+        ~ResultStream()
+        {
+            // Stops the workers if the stream was abandoned early.
+            m_results->Cancel();
+        }
+
+        virtual bool MoveNext() override
+        {
+            ++m_position;
+            while (m_position >= m_batch.size())
+            {
+                m_position = 0;
+                if (!m_results->TryTake(m_batch))
+                {
+                    m_batch.clear();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        virtual void Reset() override
+        {
+            // The matches are not retained once they have been consumed.
+            throw NotImplemented();
+        }
+
+        virtual DocId Current() const override
+        {
+            return m_batch[m_position];
+        }
+
+    private:
+        std::shared_ptr<Results> m_results;
+        std::vector<DocId> m_batch;
+
+        // Position in m_batch. MoveNext() advances the position before
+        // reading it, so the initially empty batch forces a fetch.
+        size_t m_position;
+    };
+
+
+    //*************************************************************************
+    //
+    // QueryExecutor::Results
+    //
+    //*************************************************************************
+    QueryExecutor::Results::Results(size_t shardCount)
+      : m_pendingShards(shardCount),
+        m_cancelled(false)
+    {
+    }
+
+
+    void QueryExecutor::Results::Add(std::vector<DocId>& matches)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_batches.push_back(std::vector<DocId>());
+            m_batches.back().swap(matches);
+        }
+        m_condition.notify_one();
+    }
+
+
+    void QueryExecutor::Results::CompleteShard()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            --m_pendingShards;
+        }
+        m_condition.notify_one();
+    }
+
+
+    void QueryExecutor::Results::Fail(std::exception_ptr error)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_error)
+        {
+            m_error = error;
+        }
+    }
+
+
+    bool QueryExecutor::Results::IsCancelled() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_cancelled;
+    }
+
+
+    bool QueryExecutor::Results::TryTake(std::vector<DocId>& matches)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_condition.wait(lock, [this] () {
+            return !m_batches.empty() || m_pendingShards == 0;
+        });
+
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+
+        if (m_batches.empty())
+        {
+            return false;
+        }
+
+        matches.swap(m_batches.front());
+        m_batches.pop_front();
+        return true;
+    }
+
+
+    void QueryExecutor::Results::Cancel()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_cancelled = true;
+        m_batches.clear();
+    }
+
+
+    //*************************************************************************
+    //
+    // QueryExecutor::TopMatches
+    //
+    //*************************************************************************
+    QueryExecutor::TopMatches::TopMatches(size_t k, size_t shardCount)
+      : m_k(k),
+        m_pendingShards(shardCount)
+    {
+        m_heap.reserve(k);
+    }
+
+
+    bool QueryExecutor::TopMatches::IsCandidate(StaticRank bound) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_heap.size() < m_k || m_heap.front().first < bound;
+    }
+
+
+    void QueryExecutor::TopMatches::Add(
+        std::vector<ShardPlan::RankedMatch> const & matches)
+    {
+        typedef std::greater<ShardPlan::RankedMatch> Greater;
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (auto const & match : matches)
+        {
+            if (m_heap.size() < m_k)
+            {
+                m_heap.push_back(match);
+                std::push_heap(m_heap.begin(), m_heap.end(), Greater());
+            }
+            else if (m_k > 0 && m_heap.front() < match)
+            {
+                std::pop_heap(m_heap.begin(), m_heap.end(), Greater());
+                m_heap.back() = match;
+                std::push_heap(m_heap.begin(), m_heap.end(), Greater());
+            }
+        }
+    }
+
+
+    void QueryExecutor::TopMatches::CompleteShard()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            --m_pendingShards;
+        }
+        m_condition.notify_one();
+    }
+
+
+    void QueryExecutor::TopMatches::Fail(std::exception_ptr error)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_error)
+        {
+            m_error = error;
+        }
+    }
+
+
+    std::vector<DocId> QueryExecutor::TopMatches::Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_condition.wait(lock, [this] () {
+            return m_pendingShards == 0;
+        });
+
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+
+        std::sort(m_heap.begin(),
+                  m_heap.end(),
+                  std::greater<ShardPlan::RankedMatch>());
+
+        std::vector<DocId> matches;
+        for (auto const & match : m_heap)
+        {
+            matches.push_back(match.second);
+        }
+        return matches;
+    }
+
+
+    //*************************************************************************
+    //
+    // QueryExecutor
+    //
+    //*************************************************************************
+    QueryExecutor::QueryExecutor(IIngestor& ingestor,
+                                 IConfiguration const & configuration,
+                                 size_t threadCount)
+      : m_ingestor(ingestor),
+        m_configuration(configuration),
+        m_threadCount(threadCount),
+        m_planVersion(0),
+        m_planCache(c_planCacheCapacity),
+        m_resultCache(c_resultCacheCapacity),
+        m_slicesMatched(0),
+        m_quadwordsRead(0),
+        m_queue(256)
+    {
+        LogAssertB(threadCount > 0, "QueryExecutor: threadCount must be positive.");
+
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            m_threads.push_back(new Worker(*this));
+        }
+        m_threadManager = Factories::CreateThreadManager(m_threads);
+    }
+
+
+    QueryExecutor::~QueryExecutor()
+    {
+        m_queue.Shutdown();
+        m_threadManager->WaitForThreads();
+
+        for (auto thread : m_threads)
+        {
+            delete thread;
+        }
+    }
+
+
+    std::unique_ptr<IEnumerator<DocId>>
+        QueryExecutor::Execute(TermMatchNode const & query)
+    {
+        std::shared_ptr<PlanCache::ShardPlans const> plans = GetPlans(query);
+
+        std::shared_ptr<Results> results(new Results(plans->size()));
+        for (auto const & plan : *plans)
+        {
+            std::unique_ptr<ShardTask> task(new ShardTask());
+            task->m_results = results;
+            task->m_plan = plan;
+            if (!m_queue.TryEnqueue(std::move(task)))
+            {
+                RecoverableError error("QueryExecutor: executor is shutting down.");
+                throw error;
+            }
+        }
+
+        return std::unique_ptr<IEnumerator<DocId>>(new ResultStream(results));
+    }
+
+
+    std::vector<DocId>
+        QueryExecutor::FindTopMatches(TermMatchNode const & query, size_t k)
+    {
+        std::shared_ptr<PlanCache::ShardPlans const> plans = GetPlans(query);
+        if (k == 0)
+        {
+            return std::vector<DocId>();
+        }
+
+        std::shared_ptr<TopMatches> topMatches(new TopMatches(k, plans->size()));
+        for (auto const & plan : *plans)
+        {
+            std::unique_ptr<ShardTask> task(new ShardTask());
+            task->m_topMatches = topMatches;
+            task->m_plan = plan;
+            if (!m_queue.TryEnqueue(std::move(task)))
+            {
+                RecoverableError error("QueryExecutor: executor is shutting down.");
+                throw error;
+            }
+        }
+
+        return topMatches->Wait();
+    }
+
+
+    std::shared_ptr<PlanCache::ShardPlans const>
+        QueryExecutor::GetPlans(TermMatchNode const & query)
+    {
+        std::shared_ptr<RowDensityTable const> densities;
+        uint64_t version;
+        {
+            std::lock_guard<std::mutex> lock(m_planLock);
+            densities = m_densities;
+            version = m_planVersion;
+        }
+
+        const std::string key = PlanCache::GetCanonicalForm(query);
+        std::shared_ptr<PlanCache::ShardPlans const> plans =
+            m_planCache.Find(key, version);
+        if (!plans)
+        {
+            plans = CreatePlans(query, densities.get());
+            m_planCache.Add(key, version, plans);
+        }
+
+        return plans;
+    }
+
+
+    void QueryExecutor::UpdateRowDensities()
+    {
+        // Measure outside of the lock so that queries can still be planned
+        // with the previous snapshot.
+        std::shared_ptr<RowDensityTable const>
+            densities(new RowDensityTable(m_ingestor, m_threadCount));
+
+        {
+            std::lock_guard<std::mutex> lock(m_planLock);
+            m_densities = densities;
+            ++m_planVersion;
+        }
+        m_planCache.Clear();
+    }
+
+
+    void QueryExecutor::InvalidatePlans()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_planLock);
+            ++m_planVersion;
+        }
+        m_planCache.Clear();
+    }
+
+
+    uint64_t QueryExecutor::GetSlicesMatched() const
+    {
+        return m_slicesMatched;
+    }
+
+
+    uint64_t QueryExecutor::GetQuadwordsRead() const
+    {
+        return m_quadwordsRead;
+    }
+
+
+    std::shared_ptr<PlanCache::ShardPlans const>
+        QueryExecutor::CreatePlans(TermMatchNode const & query,
+                                   RowDensityTable const * densities) const
+    {
+        // The plan's trees are only needed until the program has been bound
+        // to each Shard.
+        Allocator allocator(c_planAllocatorSize);
+        PlanRows planRows(m_ingestor, densities);
+
+        TermMatchTreeConverter converter(m_ingestor,
+                                         m_configuration,
+                                         planRows,
+                                         allocator);
+        RowMatchNode const & rowTree = converter.BuildRowPlan(query);
+        RowMatchNode const & simplified =
+            MatchTreeSimplifier::Simplify(rowTree,
+                                          converter.GetMatchAllRows(),
+                                          converter.GetMatchNoneRows(),
+                                          allocator);
+        RowMatchNode const & rewritten =
+            MatchTreeRewriter::Rewrite(simplified,
+                                       c_targetRowCount,
+                                       c_targetCrossProductTermCount,
+                                       allocator,
+                                       &planRows);
+
+        RankDownCompiler compiler(allocator);
+        CompileNode const & program = compiler.Compile(rewritten);
+
+        std::vector<unsigned> requiredRows;
+        ShardPlan::GetRequiredRows(simplified, requiredRows);
+
+        std::shared_ptr<PhraseVerifier const>
+            verifier(PhraseVerifier::Create(query, m_configuration));
+
+        // Every Shard is planned before any work is queued so that a query
+        // that fails to plan leaves no tasks behind.
+        std::shared_ptr<PlanCache::ShardPlans> plans(new PlanCache::ShardPlans());
+        for (size_t shard = 0; shard < m_ingestor.GetShardCount(); ++shard)
+        {
+            plans->push_back(std::make_shared<ShardPlan>(
+                program,
+                compiler.GetInitialRank(),
+                planRows,
+                static_cast<ShardId>(shard),
+                m_ingestor.GetShard(shard),
+                requiredRows,
+                verifier));
+        }
+
+        return plans;
+    }
+
+
+    void QueryExecutor::ProcessTask(ShardTask const & task)
+    {
+        if (task.m_topMatches)
+        {
+            ProcessTopMatchesTask(task);
+            return;
+        }
+
+        Results& results = *task.m_results;
+
+        try
+        {
+            // The token keeps the slice buffers alive while they are scanned.
+            const Token token = m_ingestor.GetTokenManager().RequestToken();
+
+            ShardPlan const & plan = *task.m_plan;
+            Shard const & shard = plan.GetShard();
+            const ptrdiff_t slicePtrOffset = shard.GetSlicePtrOffset();
+
+            std::vector<DocId> matches;
+            for (auto sliceBuffer : shard.GetSliceBuffers())
+            {
+                if (results.IsCancelled())
+                {
+                    break;
+                }
+
+                // Only Slices that are no longer ingesting are cached. The
+                // generation is read before matching, so a change during the
+                // scan leaves the matches under a generation that is gone.
+                Slice const & slice =
+                    *Slice::GetSliceFromBuffer(sliceBuffer, slicePtrOffset);
+                DocIndex liveCount;
+                const bool isCacheable = slice.TryGetLiveCount(liveCount);
+                const uint64_t generation = slice.GetGeneration();
+
+                if (!isCacheable ||
+                    !m_resultCache.TryGet(plan.GetId(), generation, matches))
+                {
+                    m_quadwordsRead += plan.Match(sliceBuffer, matches);
+                    ++m_slicesMatched;
+                    if (isCacheable && slice.GetGeneration() == generation)
+                    {
+                        m_resultCache.Add(plan.GetId(), generation, matches);
+                    }
+                }
+                if (!matches.empty())
+                {
+                    results.Add(matches);
+                    matches.clear();
+                }
+            }
+        }
+        catch (...)
+        {
+            results.Fail(std::current_exception());
+        }
+
+        results.CompleteShard();
+    }
+
+
+    void QueryExecutor::ProcessTopMatchesTask(ShardTask const & task)
+    {
+        TopMatches& topMatches = *task.m_topMatches;
+
+        try
+        {
+            const Token token = m_ingestor.GetTokenManager().RequestToken();
+
+            ShardPlan const & plan = *task.m_plan;
+            Shard const & shard = plan.GetShard();
+            const ptrdiff_t slicePtrOffset = shard.GetSlicePtrOffset();
+
+            // Visit the Slices with the best documents first.
+            typedef std::pair<StaticRank, void*> BoundedSlice;
+            std::vector<BoundedSlice> slices;
+            for (auto sliceBuffer : shard.GetSliceBuffers())
+            {
+                Slice const & slice =
+                    *Slice::GetSliceFromBuffer(sliceBuffer, slicePtrOffset);
+                slices.push_back(BoundedSlice(slice.GetMaxStaticRank(),
+                                              sliceBuffer));
+            }
+            std::stable_sort(slices.begin(),
+                             slices.end(),
+                             [] (BoundedSlice const & a, BoundedSlice const & b) {
+                return a.first > b.first;
+            });
+
+            std::vector<ShardPlan::RankedMatch> matches;
+            for (auto const & slice : slices)
+            {
+                // The remaining Slices have no better documents.
+                if (!topMatches.IsCandidate(slice.first))
+                {
+                    break;
+                }
+
+                m_quadwordsRead += plan.Match(slice.second, matches);
+                ++m_slicesMatched;
+                topMatches.Add(matches);
+                matches.clear();
+            }
+        }
+        catch (...)
+        {
+            topMatches.Fail(std::current_exception());
+        }
+
+        topMatches.CompleteShard();
+    }
+}
@@ -0,0 +1,238 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>                               // std::atomic member.
+#include <condition_variable>                   // std::condition_variable member.
+#include <deque>                                // std::deque member.
+#include <exception>                            // std::exception_ptr member.
+#include <memory>                               // std::unique_ptr member.
+#include <mutex>                                // std::mutex member.
+#include <vector>                               // std::vector member.
+
+#include "BitFunnel/Plan/IQueryExecutor.h"      // Base class.
+#include "BitFunnel/Utilities/IThreadManager.h" // IThreadBase base class.
+#include "BitFunnel/Utilities/MpmcQueue.h"      // MpmcQueue member.
+#include "PlanCache.h"                          // PlanCache member.
+#include "ResultCache.h"                        // ResultCache member.
+#include "ShardPlan.h"                          // ShardPlan::RankedMatch member.
+
+
+namespace BitFunnel
+{
+    class IConfiguration;
+    class IIngestor;
+    class RowDensityTable;
+
+    //*************************************************************************
+    //
+    // QueryExecutor
+    //
+    // Implements IQueryExecutor with a pool of worker threads. Execute()
+    // plans the query on the calling thread: the query is converted to a
+    // RowMatchNode tree, rewritten for RankDown and compiled, and the program
+    // is then bound to each Shard. One task is queued per Shard. A worker
+    // scans every Slice of its Shard under a Token and hands the matches for
+    // each Slice to the query's ResultStream.
+    //
+    // The ShardPlans of recent queries are kept in a PlanCache, keyed by the
+    // canonical form of the query and by a plan version. The version changes
+    // whenever the inputs to planning change, which makes the cached plans
+    // unreachable.
+    //
+    // The matches of each ShardPlan in each Slice that is no longer ingesting
+    // are kept in a ResultCache keyed by the plan's id and the Slice's
+    // generation. A repeated query only rescans the Slices that are still
+    // ingesting or whose documents changed since it last ran.
+    //
+    // FindTopMatches() queues the same tasks, but the worker visits the
+    // Slices of its Shard in decreasing order of Slice::GetMaxStaticRank()
+    // and gathers the matches into a TopMatches shared by every Shard. A
+    // worker stops as soon as the TopMatches are full of matches that rank
+    // at least as high as the bound of its next Slice. These scans bypass
+    // the ResultCache, which does not hold StaticRanks.
+    //
+    // UpdateRowDensities() replaces the RowDensityTable snapshot used to
+    // order rows. Each query holds a reference to the snapshot it was planned
+    // with.
+    //
+    //*************************************************************************
+    class QueryExecutor : public IQueryExecutor
+    {
+    public:
+        QueryExecutor(IIngestor& ingestor,
+                      IConfiguration const & configuration,
+                      size_t threadCount);
+
+        ~QueryExecutor();
+
+        virtual std::unique_ptr<IEnumerator<DocId>>
+            Execute(TermMatchNode const & query) override;
+
+        virtual std::vector<DocId>
+            FindTopMatches(TermMatchNode const & query, size_t k) override;
+
+        virtual void UpdateRowDensities() override;
+        virtual void InvalidatePlans() override;
+
+        virtual uint64_t GetSlicesMatched() const override;
+        virtual uint64_t GetQuadwordsRead() const override;
+
+    private:
+        class Results;
+        class ResultStream;
+        class TopMatches;
+        class Worker;
+
+        // Exactly one of m_results and m_topMatches is set.
+        struct ShardTask
+        {
+            std::shared_ptr<Results> m_results;
+            std::shared_ptr<TopMatches> m_topMatches;
+            std::shared_ptr<ShardPlan const> m_plan;
+        };
+
+        // Returns the cached plans for query, planning it on a miss.
+        std::shared_ptr<PlanCache::ShardPlans const>
+            GetPlans(TermMatchNode const & query);
+
+        // Plans query for every Shard.
+        std::shared_ptr<PlanCache::ShardPlans const>
+            CreatePlans(TermMatchNode const & query,
+                        RowDensityTable const * densities) const;
+
+        void ProcessTask(ShardTask const & task);
+        void ProcessTopMatchesTask(ShardTask const & task);
+
+        // MatchTreeRewriter parameters. Rewriting stops once every path from
+        // the root intersects at least c_targetRowCount rows, or once the
+        // cross products of or-expressions have produced about
+        // c_targetCrossProductTermCount terms.
+        static const unsigned c_targetRowCount = 4;
+        static const unsigned c_targetCrossProductTermCount = 16;
+
+        // Size of the arena for the trees built while planning a query.
+        static const size_t c_planAllocatorSize = 1 << 20;
+
+        // Number of queries whose plans are cached.
+        static const size_t c_planCacheCapacity = 1024;
+
+        // Number of DocIds in the cached matches of Slices.
+        static const size_t c_resultCacheCapacity = 1 << 20;
+
+        IIngestor& m_ingestor;
+        IConfiguration const & m_configuration;
+        const size_t m_threadCount;
+
+        // Densities used to order rows, or nullptr until
+        // UpdateRowDensities() has been called, and the version of the plans
+        // made with them. Guarded by m_planLock.
+        std::mutex m_planLock;
+        std::shared_ptr<RowDensityTable const> m_densities;
+        uint64_t m_planVersion;
+
+        PlanCache m_planCache;
+        ResultCache m_resultCache;
+
+        std::atomic<uint64_t> m_slicesMatched;
+        std::atomic<uint64_t> m_quadwordsRead;
+
+        // TODO: Convert ThreadManager to use std::vector<std::unique_ptr<IThreadBase>>
+        std::vector<IThreadBase*> m_threads;
+        std::unique_ptr<IThreadManager> m_threadManager;
+
+        MpmcQueue<std::unique_ptr<ShardTask>> m_queue;
+    };
+
+
+    //*************************************************************************
+    //
+    // QueryExecutor::Results
+    //
+    // Matches shared between the workers matching a query and the
+    // ResultStream that consumes them. Matches are handed over one Slice at
+    // a time to keep locking off the per-document path.
+    //
+    //*************************************************************************
+    class QueryExecutor::Results : public NonCopyable
+    {
+    public:
+        Results(size_t shardCount);
+
+        // Called by workers.
+        void Add(std::vector<DocId>& matches);
+        void CompleteShard();
+        void Fail(std::exception_ptr error);
+        bool IsCancelled() const;
+
+        // Called by the ResultStream. Waits for the next batch of matches.
+        // Returns false when every Shard has completed and all batches have
+        // been taken.
+        bool TryTake(std::vector<DocId>& matches);
+        void Cancel();
+
+    private:
+        mutable std::mutex m_lock;
+        std::condition_variable m_condition;
+        std::deque<std::vector<DocId>> m_batches;
+        size_t m_pendingShards;
+        bool m_cancelled;
+        std::exception_ptr m_error;
+    };
+
+
+    //*************************************************************************
+    //
+    // QueryExecutor::TopMatches
+    //
+    // The k best matches by StaticRank found so far by the workers of a
+    // FindTopMatches() query, kept in a min-heap so that the worst of them
+    // is at the front.
+    //
+    //*************************************************************************
+    class QueryExecutor::TopMatches : public NonCopyable
+    {
+    public:
+        TopMatches(size_t k, size_t shardCount);
+
+        // Called by workers. Returns false once a document with StaticRank
+        // bound can no longer improve the matches.
+        bool IsCandidate(StaticRank bound) const;
+        void Add(std::vector<ShardPlan::RankedMatch> const & matches);
+        void CompleteShard();
+        void Fail(std::exception_ptr error);
+
+        // Waits for every Shard to complete and returns the DocIds of the
+        // matches, best first.
+        std::vector<DocId> Wait();
+
+    private:
+        mutable std::mutex m_lock;
+        std::condition_variable m_condition;
+        const size_t m_k;
+        std::vector<ShardPlan::RankedMatch> m_heap;
+        size_t m_pendingShards;
+        std::exception_ptr m_error;
+    };
+}
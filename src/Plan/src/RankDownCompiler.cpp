@@ -0,0 +1,212 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <new>                      // For placement new.
+
+#include "BitFunnel/AbstractRow.h"
+#include "BitFunnel/Allocators/IAllocator.h"
+#include "BitFunnel/RowMatchNode.h"
+#include "CompileNode.h"
+#include "LoggerInterfaces/Logging.h"
+#include "RankDownCompiler.h"
+
+
+namespace BitFunnel
+{
+    RankDownCompiler::RankDownCompiler(IAllocator& allocator)
+      : m_allocator(allocator),
+        m_initialRank(0)
+    {
+    }
+
+
+    CompileNode const & RankDownCompiler::Compile(RowMatchNode const & root)
+    {
+        return CompileChain(root, nullptr, 0, false, m_initialRank);
+    }
+
+
+    Rank RankDownCompiler::GetInitialRank() const
+    {
+        return m_initialRank;
+    }
+
+
+    CompileNode const &
+        RankDownCompiler::CompileChain(RowMatchNode const & node,
+                                       CompileNode const * continuation,
+                                       Rank continuationRank,
+                                       bool loaded,
+                                       Rank& rank)
+    {
+        switch (node.GetType())
+        {
+        case RowMatchNode::AndMatch:
+            {
+                // The left side always intersects at least one row into the
+                // accumulator before the right side is evaluated.
+                RowMatchNode::And const & andNode =
+                    dynamic_cast<RowMatchNode::And const &>(node);
+                LogAssertB(andNode.GetLeft().GetType() != RowMatchNode::ReportMatch,
+                           "RankDownCompiler: Report must end the chain.");
+
+                Rank rightRank;
+                CompileNode const & right = CompileChain(andNode.GetRight(),
+                                                         continuation,
+                                                         continuationRank,
+                                                         true,
+                                                         rightRank);
+                return CompileChain(andNode.GetLeft(),
+                                    &right,
+                                    rightRank,
+                                    loaded,
+                                    rank);
+            }
+        case RowMatchNode::OrMatch:
+            {
+                RowMatchNode::Or const & orNode =
+                    dynamic_cast<RowMatchNode::Or const &>(node);
+
+                Rank leftRank;
+                CompileNode const & left = CompileChain(orNode.GetLeft(),
+                                                        continuation,
+                                                        continuationRank,
+                                                        loaded,
+                                                        leftRank);
+                Rank rightRank;
+                CompileNode const & right = CompileChain(orNode.GetRight(),
+                                                         continuation,
+                                                         continuationRank,
+                                                         loaded,
+                                                         rightRank);
+
+                rank = (leftRank > rightRank) ? leftRank : rightRank;
+                return *new (m_allocator.Allocate(sizeof(CompileNode::Or)))
+                            CompileNode::Or(RankDown(left, leftRank, rank),
+                                            RankDown(right, rightRank, rank));
+            }
+        case RowMatchNode::ReportMatch:
+            {
+                LogAssertB(continuation == nullptr,
+                           "RankDownCompiler: Report must end the chain.");
+
+                RowMatchNode const * child =
+                    dynamic_cast<RowMatchNode::Report const &>(node).GetChild();
+                CompileNode const * loweredChild =
+                    (child == nullptr) ? nullptr : &CompileRankZero(*child);
+
+                rank = 0;
+                return *new (m_allocator.Allocate(sizeof(CompileNode::Report)))
+                            CompileNode::Report(loweredChild);
+            }
+        case RowMatchNode::RowMatch:
+            {
+                LogAssertB(continuation != nullptr,
+                           "RankDownCompiler: chain must end with a Report.");
+
+                AbstractRow const & row =
+                    dynamic_cast<RowMatchNode::Row const &>(node).GetRow();
+                rank = row.GetRank();
+                LogAssertB(rank >= continuationRank,
+                           "RankDownCompiler: rows must be in descending rank order.");
+
+                CompileNode const & child =
+                    RankDown(*continuation, continuationRank, rank);
+                if (loaded)
+                {
+                    return *new (m_allocator.Allocate(sizeof(CompileNode::AndRowJz)))
+                                CompileNode::AndRowJz(row, child);
+                }
+                else
+                {
+                    return *new (m_allocator.Allocate(sizeof(CompileNode::LoadRowJz)))
+                                CompileNode::LoadRowJz(row, child);
+                }
+            }
+        default:
+            LogAbortB("RankDownCompiler: unsupported node type.");
+            return *static_cast<CompileNode const *>(nullptr);
+        }
+    }
+
+
+    CompileNode const &
+        RankDownCompiler::CompileRankZero(RowMatchNode const & node)
+    {
+        switch (node.GetType())
+        {
+        case RowMatchNode::AndMatch:
+            {
+                RowMatchNode::And const & andNode =
+                    dynamic_cast<RowMatchNode::And const &>(node);
+                CompileNode const & left = CompileRankZero(andNode.GetLeft());
+                CompileNode const & right = CompileRankZero(andNode.GetRight());
+                return *new (m_allocator.Allocate(sizeof(CompileNode::AndTree)))
+                            CompileNode::AndTree(left, right);
+            }
+        case RowMatchNode::OrMatch:
+            {
+                RowMatchNode::Or const & orNode =
+                    dynamic_cast<RowMatchNode::Or const &>(node);
+                CompileNode const & left = CompileRankZero(orNode.GetLeft());
+                CompileNode const & right = CompileRankZero(orNode.GetRight());
+                return *new (m_allocator.Allocate(sizeof(CompileNode::OrTree)))
+                            CompileNode::OrTree(left, right);
+            }
+        case RowMatchNode::NotMatch:
+            {
+                RowMatchNode::Not const & notNode =
+                    dynamic_cast<RowMatchNode::Not const &>(node);
+                CompileNode const & child = CompileRankZero(notNode.GetChild());
+                return *new (m_allocator.Allocate(sizeof(CompileNode::Not)))
+                            CompileNode::Not(child);
+            }
+        case RowMatchNode::RowMatch:
+            {
+                // RankZero nodes are evaluated one rank 0 quadword at a time.
+                AbstractRow const & row =
+                    dynamic_cast<RowMatchNode::Row const &>(node).GetRow();
+                AbstractRow rankZeroRow(row, row.GetRank() + row.GetRankDelta());
+                return *new (m_allocator.Allocate(sizeof(CompileNode::LoadRow)))
+                            CompileNode::LoadRow(rankZeroRow);
+            }
+        default:
+            LogAbortB("RankDownCompiler: unsupported node type in Report.");
+            return *static_cast<CompileNode const *>(nullptr);
+        }
+    }
+
+
+    CompileNode const & RankDownCompiler::RankDown(CompileNode const & node,
+                                                   Rank rank,
+                                                   Rank targetRank)
+    {
+        if (rank == targetRank)
+        {
+            return node;
+        }
+
+        return *new (m_allocator.Allocate(sizeof(CompileNode::RankDown)))
+                    CompileNode::RankDown(targetRank - rank, node);
+    }
+}
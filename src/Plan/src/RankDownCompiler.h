@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "BitFunnel/BitFunnelTypes.h"   // Rank member.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class CompileNode;
+    class IAllocator;
+    class RowMatchNode;
+
+    //*************************************************************************
+    //
+    // RankDownCompiler lowers a RowMatchNode tree, rewritten by the
+    // MatchTreeRewriter, into a tree of CompileNodes for the RankDown matching
+    // algorithm.
+    //
+    // The rewritten tree is a chain of and-expressions whose rows appear in
+    // descending rank order and which ends in a Report node. Or-expressions
+    // in the chain fork it, and each branch continues with the rest of the
+    // chain. The chain is lowered from right to left:
+    //
+    //   1. The Report node is evaluated at rank 0. Its child, if any, is
+    //      lowered to the RankZero nodes (AndTree, OrTree, Not, LoadRow).
+    //   2. Each row becomes an AndRowJz, or a LoadRowJz if it is the first
+    //      row on its path from the root, whose child is the lowered
+    //      remainder of the chain.
+    //   3. When a row's rank is higher than the rank of the remainder, the
+    //      remainder is wrapped in a RankDown node. Each higher rank row is
+    //      therefore evaluated once per block of lower rank quadwords, and a
+    //      zero quadword skips the whole block.
+    //   4. The branch of an Or node with the lower rank is wrapped in a
+    //      RankDown node so that both branches start at the same rank.
+    //
+    // The resulting tree is evaluated once for each quadword at the initial
+    // rank, which is the rank of the first row.
+    //
+    //*************************************************************************
+    class RankDownCompiler : NonCopyable
+    {
+    public:
+        RankDownCompiler(IAllocator& allocator);
+
+        // Lowers the rewritten tree. The returned tree and its nodes are
+        // allocated from the allocator.
+        CompileNode const & Compile(RowMatchNode const & root);
+
+        // Returns the rank at which the tree from the last call to Compile()
+        // starts.
+        Rank GetInitialRank() const;
+
+    private:
+        // Lowers node followed by continuation, which starts at
+        // continuationRank. The loaded parameter is true if the accumulator
+        // already holds the intersection of the rows on the path to node.
+        // Returns the lowered tree and sets rank to the rank at which it
+        // starts.
+        CompileNode const & CompileChain(RowMatchNode const & node,
+                                         CompileNode const * continuation,
+                                         Rank continuationRank,
+                                         bool loaded,
+                                         Rank& rank);
+
+        // Lowers the child of a Report node.
+        CompileNode const & CompileRankZero(RowMatchNode const & node);
+
+        // Wraps node, which starts at rank, so that it starts at targetRank.
+        CompileNode const & RankDown(CompileNode const & node,
+                                     Rank rank,
+                                     Rank targetRank);
+
+        IAllocator& m_allocator;
+        Rank m_initialRank;
+    };
+}
@@ -0,0 +1,147 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include "LoggerInterfaces/Logging.h"
+#include "ResultCache.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ResultCache
+    //
+    //*************************************************************************
+    ResultCache::ResultCache(size_t capacity)
+      : m_capacity(capacity),
+        m_size(0),
+        m_hitCount(0),
+        m_missCount(0)
+    {
+        LogAssertB(capacity > 0, "ResultCache: capacity must be positive.");
+    }
+
+
+    bool ResultCache::TryGet(uint64_t planId,
+                             uint64_t generation,
+                             std::vector<DocId>& matches)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto it = m_index.find(Key { planId, generation });
+        if (it == m_index.end())
+        {
+            ++m_missCount;
+            return false;
+        }
+
+        ++m_hitCount;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+        auto const & cached = it->second->m_matches;
+        matches.insert(matches.end(), cached.begin(), cached.end());
+        return true;
+    }
+
+
+    void ResultCache::Add(uint64_t planId,
+                          uint64_t generation,
+                          std::vector<DocId> const & matches)
+    {
+        const size_t cost = GetCost(matches);
+        if (cost > m_capacity)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        // Another thread running the same plan may have added the entry.
+        Key key { planId, generation };
+        if (m_index.find(key) != m_index.end())
+        {
+            return;
+        }
+
+        while (m_size + cost > m_capacity)
+        {
+            Entry const & victim = m_entries.back();
+            m_size -= GetCost(victim.m_matches);
+            m_index.erase(victim.m_key);
+            m_entries.pop_back();
+        }
+
+        m_entries.push_front(Entry { key, matches });
+        m_index.insert(std::make_pair(key, m_entries.begin()));
+        m_size += cost;
+    }
+
+
+    size_t ResultCache::GetSize() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_entries.size();
+    }
+
+
+    uint64_t ResultCache::GetHitCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_hitCount;
+    }
+
+
+    uint64_t ResultCache::GetMissCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_missCount;
+    }
+
+
+    size_t ResultCache::GetCost(std::vector<DocId> const & matches)
+    {
+        return matches.size() + 1;
+    }
+
+
+    //*************************************************************************
+    //
+    // ResultCache::Key
+    //
+    //*************************************************************************
+    bool ResultCache::Key::operator==(Key const & other) const
+    {
+        return m_planId == other.m_planId &&
+               m_generation == other.m_generation;
+    }
+
+
+    size_t ResultCache::KeyHash::operator()(Key const & key) const
+    {
+        // Generations are unique across Slices, so they alone spread the
+        // entries of a plan.
+        const uint64_t hash = key.m_generation * 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(hash ^ (key.m_planId + (hash << 6) + (hash >> 2)));
+    }
+}
@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <list>                         // std::list member.
+#include <mutex>                        // std::mutex member.
+#include <stddef.h>                     // size_t parameter.
+#include <stdint.h>                     // uint64_t parameter.
+#include <unordered_map>                // std::unordered_map member.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/BitFunnelTypes.h"   // DocId template parameter.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ResultCache
+    //
+    // A least recently used cache of the matches of a ShardPlan in a single
+    // Slice, keyed by the plan's id and the Slice's generation. A Slice's
+    // generation changes whenever its documents may match differently, so
+    // cached matches are never stale; entries for old generations are
+    // simply never found again and age out of the cache.
+    //
+    // The capacity bounds the total number of cached DocIds, with each
+    // entry counting as one more than its number of matches so that empty
+    // results are bounded too.
+    //
+    // Thread safety: all methods are thread safe.
+    //
+    //*************************************************************************
+    class ResultCache : public NonCopyable
+    {
+    public:
+        ResultCache(size_t capacity);
+
+        // Appends the cached matches to matches and returns true, or returns
+        // false if no matches are cached for the plan and generation.
+        bool TryGet(uint64_t planId,
+                    uint64_t generation,
+                    std::vector<DocId>& matches);
+
+        // Caches the matches for the plan and generation, evicting least
+        // recently used entries to make room. Matches that would not fit in
+        // an empty cache are not cached.
+        void Add(uint64_t planId,
+                 uint64_t generation,
+                 std::vector<DocId> const & matches);
+
+        size_t GetSize() const;
+        uint64_t GetHitCount() const;
+        uint64_t GetMissCount() const;
+
+    private:
+        struct Key
+        {
+            uint64_t m_planId;
+            uint64_t m_generation;
+
+            bool operator==(Key const & other) const;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(Key const & key) const;
+        };
+
+        struct Entry
+        {
+            Key m_key;
+            std::vector<DocId> m_matches;
+        };
+
+        static size_t GetCost(std::vector<DocId> const & matches);
+
+        const size_t m_capacity;
+
+        mutable std::mutex m_lock;
+
+        // Most recently used entries are at the front.
+        std::list<Entry> m_entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+
+        // Sum of the costs of the entries.
+        size_t m_size;
+
+        uint64_t m_hitCount;
+        uint64_t m_missCount;
+    };
+}
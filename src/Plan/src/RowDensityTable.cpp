@@ -0,0 +1,62 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/RowId.h"
+#include "RowDensityAnalyzer.h"
+#include "RowDensityTable.h"
+
+
+namespace BitFunnel
+{
+    RowDensityTable::RowDensityTable(IIngestor const & ingestor,
+                                     size_t threadCount)
+    {
+        for (size_t shard = 0; shard < ingestor.GetShardCount(); ++shard)
+        {
+            RowDensityAnalyzer analyzer(ingestor.GetShard(shard),
+                                        ingestor.GetTokenManager(),
+                                        threadCount);
+
+            std::vector<std::vector<double>> densities;
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                densities.push_back(analyzer.GetDensities(rank));
+            }
+            m_densities.push_back(std::move(densities));
+        }
+    }
+
+
+    double RowDensityTable::GetDensity(ShardId shard, RowId row) const
+    {
+        if (shard >= m_densities.size())
+        {
+            return 1.0;
+        }
+
+        auto const & densities = m_densities[shard][row.GetRank()];
+        return (row.GetIndex() < densities.size()) ?
+            densities[row.GetIndex()] : 1.0;
+    }
+}
@@ -0,0 +1,65 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"   // ShardId parameter.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IIngestor;
+    class RowId;
+
+    //*************************************************************************
+    //
+    // RowDensityTable
+    //
+    // A snapshot of the fraction of bits set in every row of every Shard,
+    // measured with the RowDensityAnalyzer. The planner uses the densities to
+    // order the rows of each rank so that the sparsest rows are intersected
+    // first, which lets the RankDown program skip blocks as early as
+    // possible.
+    //
+    // Thread safety: all const methods are thread safe.
+    //
+    //*************************************************************************
+    class RowDensityTable : public NonCopyable
+    {
+    public:
+        // Scans every Slice of every Shard, dividing each Shard's Slices
+        // between threadCount threads.
+        RowDensityTable(IIngestor const & ingestor, size_t threadCount);
+
+        // Returns the density of a row in a Shard. Rows that were not
+        // measured are assumed to have every bit set.
+        double GetDensity(ShardId shard, RowId row) const;
+
+    private:
+        // Indexed by ShardId, Rank and then RowIndex.
+        std::vector<std::vector<std::vector<double>>> m_densities;
+    };
+}
@@ -0,0 +1,236 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <bitset>
+
+#include "BitFunnel/IPlanRows.h"
+#include "BitFunnel/RowMatchNode.h"
+#include "CompileNode.h"
+#include "DocTableDescriptor.h"
+#include "LoggerInterfaces/Logging.h"
+#include "PhraseVerifier.h"
+#include "RowTableDescriptor.h"
+#include "Shard.h"
+#include "ShardPlan.h"
+
+
+namespace BitFunnel
+{
+    std::atomic<uint64_t> ShardPlan::s_nextId(0);
+
+
+    ShardPlan::ShardPlan(CompileNode const & program,
+                         Rank initialRank,
+                         IPlanRows const & planRows,
+                         ShardId shardId,
+                         Shard const & shard,
+                         std::vector<unsigned> const & requiredRows,
+                         std::shared_ptr<PhraseVerifier const> verifier)
+      : m_id(++s_nextId),
+        m_shard(shard),
+        m_initialRank(initialRank),
+        m_iterationCount((shard.GetSliceCapacity() / 64) >> initialRank),
+        m_code(planRows, shardId)
+    {
+        for (auto id : requiredRows)
+        {
+            RowId const & row = planRows.PhysicalRow(shardId, id);
+            if (row.GetRank() == 0)
+            {
+                m_summaryRows.push_back(row.GetIndex());
+            }
+        }
+
+        VariableSizeBlobId blob;
+        if (shard.GetDocTable().TryGetTermSequenceBlob(blob))
+        {
+            m_verifier = verifier;
+        }
+
+        // Slice capacity is a multiple of the documents in a quadword of the
+        // TermTable's highest rank, and the plan never exceeds that rank.
+        LogAssertB((m_iterationCount << initialRank) * 64 == shard.GetSliceCapacity(),
+                   "ShardPlan: initial rank exceeds the Slice capacity.");
+
+        program.Compile(m_code);
+    }
+
+
+    template <typename ACTION>
+    size_t ShardPlan::ForEachMatch(void* sliceBuffer, ACTION const & action) const
+    {
+        DocTableDescriptor const & docTable = m_shard.GetDocTable();
+        VariableSizeBlobId termSequenceBlob = 0;
+        docTable.TryGetTermSequenceBlob(termSequenceBlob);
+
+        std::vector<uint64_t> liveIterations;
+        if (!m_summaryRows.empty() &&
+            !GetLiveIterations(sliceBuffer, liveIterations))
+        {
+            return 0;
+        }
+
+        std::vector<uint64_t> quadwords(m_shard.GetSliceCapacity() / 64);
+        const size_t quadwordsRead =
+            m_code.Run(sliceBuffer,
+                       m_iterationCount,
+                       quadwords,
+                       liveIterations.empty() ? nullptr : liveIterations.data());
+
+        for (size_t q = 0; q < quadwords.size(); ++q)
+        {
+            uint64_t bits = quadwords[q];
+            while (bits != 0)
+            {
+                // The number of trailing zeros is the bit position of the
+                // lowest set bit.
+                const uint64_t lowest = bits & (~bits + 1);
+                const size_t position = std::bitset<64>(lowest - 1).count();
+                bits ^= lowest;
+
+                const DocIndex index = static_cast<DocIndex>(q * 64 + position);
+                if (m_verifier == nullptr ||
+                    m_verifier->Verify(docTable.GetVariableSizeBlob(sliceBuffer,
+                                                                    index,
+                                                                    termSequenceBlob)))
+                {
+                    action(index);
+                }
+            }
+        }
+
+        return quadwordsRead;
+    }
+
+
+    size_t ShardPlan::Match(void* sliceBuffer, std::vector<DocId>& matches) const
+    {
+        DocTableDescriptor const & docTable = m_shard.GetDocTable();
+        return ForEachMatch(sliceBuffer, [&] (DocIndex index) {
+            matches.push_back(docTable.GetDocId(sliceBuffer, index));
+        });
+    }
+
+
+    size_t ShardPlan::Match(void* sliceBuffer,
+                            std::vector<RankedMatch>& matches) const
+    {
+        DocTableDescriptor const & docTable = m_shard.GetDocTable();
+        return ForEachMatch(sliceBuffer, [&] (DocIndex index) {
+            matches.push_back(
+                RankedMatch(docTable.GetStaticRank(sliceBuffer, index),
+                            docTable.GetDocId(sliceBuffer, index)));
+        });
+    }
+
+
+    bool ShardPlan::GetLiveIterations(void* sliceBuffer,
+                                      std::vector<uint64_t>& liveIterations) const
+    {
+        RowTableDescriptor const & rowTable = m_shard.GetRowTable(0);
+
+        std::vector<uint64_t> blocks(rowTable.GetSummaryQuadwordCount(), ~0ull);
+        for (auto row : m_summaryRows)
+        {
+            uint64_t const * summary = rowTable.GetSummary(sliceBuffer, row);
+            for (size_t i = 0; i < blocks.size(); ++i)
+            {
+                blocks[i] &= summary[i];
+            }
+        }
+
+        // Iteration i runs at the initial rank and covers rank 0 quadwords
+        // [i << m_initialRank, (i + 1) << m_initialRank).
+        const size_t blockSize = RowTableDescriptor::c_quadwordsPerSummaryBit;
+        liveIterations.assign((m_iterationCount + 63) / 64, 0);
+        bool isLive = false;
+        for (size_t i = 0; i < m_iterationCount; ++i)
+        {
+            const size_t first = (i << m_initialRank) / blockSize;
+            const size_t last = (((i + 1) << m_initialRank) - 1) / blockSize;
+            for (size_t block = first; block <= last; ++block)
+            {
+                if (((blocks[block >> 6] >> (block & 0x3F)) & 1) != 0)
+                {
+                    liveIterations[i >> 6] |= 1ull << (i & 0x3F);
+                    isLive = true;
+                    break;
+                }
+            }
+        }
+
+        return isLive;
+    }
+
+
+    Shard const & ShardPlan::GetShard() const
+    {
+        return m_shard;
+    }
+
+
+    uint64_t ShardPlan::GetId() const
+    {
+        return m_id;
+    }
+
+
+    void ShardPlan::GetRequiredRows(RowMatchNode const & node,
+                                    std::vector<unsigned>& rows)
+    {
+        switch (node.GetType())
+        {
+        case RowMatchNode::AndMatch:
+            {
+                RowMatchNode::And const & andNode =
+                    dynamic_cast<RowMatchNode::And const &>(node);
+                GetRequiredRows(andNode.GetLeft(), rows);
+                GetRequiredRows(andNode.GetRight(), rows);
+            }
+            break;
+        case RowMatchNode::RowMatch:
+            {
+                AbstractRow const & row =
+                    dynamic_cast<RowMatchNode::Row const &>(node).GetRow();
+                if (!row.IsInverted())
+                {
+                    rows.push_back(row.GetId());
+                }
+            }
+            break;
+        case RowMatchNode::ReportMatch:
+            {
+                RowMatchNode const * child =
+                    dynamic_cast<RowMatchNode::Report const &>(node).GetChild();
+                if (child != nullptr)
+                {
+                    GetRequiredRows(*child, rows);
+                }
+            }
+            break;
+        default:
+            // Or and Not nodes don't require any single row.
+            break;
+        }
+    }
+}
@@ -0,0 +1,134 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>                       // std::atomic static member.
+#include <memory>                       // std::shared_ptr member.
+#include <stdint.h>                     // uint64_t return value.
+#include <utility>                      // std::pair typedef.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/BitFunnelTypes.h"   // DocId, Rank, ShardId, StaticRank parameters.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+#include "ByteCodeInterpreter.h"        // ByteCodeInterpreter member.
+
+
+namespace BitFunnel
+{
+    class CompileNode;
+    class IPlanRows;
+    class PhraseVerifier;
+    class RowMatchNode;
+    class Shard;
+
+    //*************************************************************************
+    //
+    // ShardPlan
+    //
+    // A query's compiled RankDown program, bound to the row layout of a
+    // single Shard. Every Slice in the Shard shares the same row layout, so
+    // the same byte code matches any of the Shard's Slices.
+    //
+    // The program is evaluated once for each quadword at its initial rank,
+    // and ranks down to rank 0 only for the blocks whose higher rank rows
+    // have bits in common.
+    //
+    // Before running the program, the plan ANDs the summary bitmaps of the
+    // rank 0 rows that every match requires, and skips the iterations whose
+    // rank 0 blocks are all dead. Rare terms then touch only the few blocks
+    // where they occur. See RowTableDescriptor for the summaries.
+    //
+    // When the query has phrases and the Shard stores term sequences, each
+    // match is checked by a PhraseVerifier before it is reported.
+    //
+    // Thread safety: Match() may be called concurrently.
+    //
+    //*************************************************************************
+    class ShardPlan : public NonCopyable
+    {
+    public:
+        // A match and its document's StaticRank. Ordered by StaticRank.
+        typedef std::pair<StaticRank, DocId> RankedMatch;
+
+        // The program and the planRows are only used during construction.
+        // requiredRows holds the ids of rows that every match has a bit in.
+        // The verifier, which may be shared by the plans for other Shards,
+        // is optional.
+        ShardPlan(CompileNode const & program,
+                  Rank initialRank,
+                  IPlanRows const & planRows,
+                  ShardId shardId,
+                  Shard const & shard,
+                  std::vector<unsigned> const & requiredRows,
+                  std::shared_ptr<PhraseVerifier const> verifier = nullptr);
+
+        // Appends the DocIds of the matching documents in sliceBuffer to
+        // matches. The caller must hold a Token that keeps sliceBuffer alive.
+        // Returns the number of row quadwords read.
+        size_t Match(void* sliceBuffer, std::vector<DocId>& matches) const;
+
+        // Like the method above, but appends each match along with its
+        // document's StaticRank.
+        size_t Match(void* sliceBuffer, std::vector<RankedMatch>& matches) const;
+
+        Shard const & GetShard() const;
+
+        // Returns an identifier that no other ShardPlan in the process has.
+        // Results of Match() may be cached under the id, since a plan's
+        // matches depend only on the Slice.
+        uint64_t GetId() const;
+
+        // Appends to rows the ids of the rows that every match of the
+        // RowMatchNode tree has a bit in, i.e. the rows reached from the root
+        // through And nodes alone. These are the requiredRows passed to the
+        // constructor.
+        static void GetRequiredRows(RowMatchNode const & node,
+                                    std::vector<unsigned>& rows);
+
+    private:
+        // Runs the program over sliceBuffer and calls action(index) with
+        // the DocIndex of each verified match. Returns the number of row
+        // quadwords read.
+        template <typename ACTION>
+        size_t ForEachMatch(void* sliceBuffer, ACTION const & action) const;
+
+        // Sets one bit in liveIterations for each iteration that covers a
+        // block where every summary row may have bits. Returns false if
+        // there are no such iterations.
+        bool GetLiveIterations(void* sliceBuffer,
+                               std::vector<uint64_t>& liveIterations) const;
+
+        const uint64_t m_id;
+        Shard const & m_shard;
+        const Rank m_initialRank;
+        size_t m_iterationCount;
+
+        // Physical rank 0 rows whose summaries bound the matches.
+        std::vector<RowIndex> m_summaryRows;
+        ByteCodeInterpreter m_code;
+        std::shared_ptr<PhraseVerifier const> m_verifier;
+
+        static std::atomic<uint64_t> s_nextId;
+    };
+}
@@ -25,6 +25,7 @@
 #include "BitFunnel/Allocators/IAllocator.h"
 //#include "BitFunnel/Factories.h"
 #include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/BitSlicedField.h"
 #include "BitFunnel/IObjectFormatter.h"
 #include "BitFunnel/IObjectParser.h"
 #include "BitFunnel/TermMatchNode.h"
@@ -671,4 +672,117 @@ namespace BitFunnel
     {
         return new (allocator.Allocate(sizeof(Fact))) Fact(fact);
     }
+
+
+    static TermMatchNode const * CreateBinaryNode(TermMatchNode::NodeType type,
+                                                  TermMatchNode const * left,
+                                                  TermMatchNode const * right,
+                                                  IAllocator& allocator)
+    {
+        TermMatchNode::Builder builder(type, allocator);
+        builder.AddChild(left);
+        builder.AddChild(right);
+        return builder.Complete();
+    }
+
+
+    static TermMatchNode const * CreateNotNode(TermMatchNode const * child,
+                                               IAllocator& allocator)
+    {
+        TermMatchNode::Builder builder(TermMatchNode::NotMatch, allocator);
+        builder.AddChild(child);
+        return builder.Complete();
+    }
+
+
+    TermMatchNode const *
+    TermMatchNode::Builder::CreateRangeNode(BitSlicedField const & field,
+                                            uint64_t low,
+                                            uint64_t high,
+                                            IAllocator& allocator)
+    {
+        const unsigned bitCount = field.GetBitCount();
+        const uint64_t mask = (bitCount == 64) ?
+            ~static_cast<uint64_t>(0) :
+            ((static_cast<uint64_t>(1) << bitCount) - 1);
+
+        // Documents never hold values above the field's maximum, so an upper
+        // bound at or beyond it may be widened to all ones, which needs no
+        // rows at all.
+        if (high >= field.GetMaxValue())
+        {
+            high = mask;
+        }
+
+        if (low > high || low > field.GetMaxValue())
+        {
+            TermMatchNode const * bit = CreateFactNode(field.GetFact(0),
+                                                       allocator);
+            return CreateBinaryNode(TermMatchNode::AndMatch,
+                                    bit,
+                                    CreateNotNode(bit, allocator),
+                                    allocator);
+        }
+
+        // Build value <= high and value >= low from the least significant bit
+        // up, where nullptr stands for true. At bit i,
+        //   value[i..0] <= high[i..0] is
+        //     !b[i] || (value[i-1..0] <= high[i-1..0])  when high[i] is 1,
+        //     !b[i] && (value[i-1..0] <= high[i-1..0])  when high[i] is 0,
+        // and symmetrically for value >= low with b[i] in place of !b[i] and
+        // the roles of 0 and 1 exchanged. Trailing ones in high and trailing
+        // zeros in low therefore cost nothing.
+        TermMatchNode const * lessEqual = nullptr;
+        TermMatchNode const * greaterEqual = nullptr;
+        for (unsigned bit = 0; bit < bitCount; ++bit)
+        {
+            TermMatchNode const * fact =
+                CreateFactNode(field.GetFact(bit), allocator);
+
+            if (((high >> bit) & 1) == 0)
+            {
+                lessEqual = CreateBinaryNode(TermMatchNode::AndMatch,
+                                             CreateNotNode(fact, allocator),
+                                             lessEqual,
+                                             allocator);
+            }
+            else if (lessEqual != nullptr)
+            {
+                lessEqual = CreateBinaryNode(TermMatchNode::OrMatch,
+                                             CreateNotNode(fact, allocator),
+                                             lessEqual,
+                                             allocator);
+            }
+
+            if (((low >> bit) & 1) == 1)
+            {
+                greaterEqual = CreateBinaryNode(TermMatchNode::AndMatch,
+                                                fact,
+                                                greaterEqual,
+                                                allocator);
+            }
+            else if (greaterEqual != nullptr)
+            {
+                greaterEqual = CreateBinaryNode(TermMatchNode::OrMatch,
+                                                fact,
+                                                greaterEqual,
+                                                allocator);
+            }
+        }
+
+        if (lessEqual == nullptr && greaterEqual == nullptr)
+        {
+            TermMatchNode const * bit = CreateFactNode(field.GetFact(0),
+                                                       allocator);
+            return CreateBinaryNode(TermMatchNode::OrMatch,
+                                    bit,
+                                    CreateNotNode(bit, allocator),
+                                    allocator);
+        }
+
+        return CreateBinaryNode(TermMatchNode::AndMatch,
+                                lessEqual,
+                                greaterEqual,
+                                allocator);
+    }
 }
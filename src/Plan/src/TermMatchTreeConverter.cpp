@@ -0,0 +1,311 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <new>                      // For placement new.
+#include <vector>
+
+#include "BitFunnel/Allocators/IAllocator.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/IPlanRows.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/ResolvedTermCache.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "BitFunnel/RowMatchNode.h"
+#include "BitFunnel/Term.h"
+#include "BitFunnel/TermMatchNode.h"
+#include "LoggerInterfaces/Logging.h"
+#include "Shard.h"
+#include "StringVector.h"
+#include "TermMatchTreeConverter.h"
+
+
+namespace BitFunnel
+{
+    TermMatchTreeConverter::TermMatchTreeConverter(IIngestor const & ingestor,
+                                                   IConfiguration const & configuration,
+                                                   IPlanRows& planRows,
+                                                   IAllocator& allocator)
+      : m_ingestor(ingestor),
+        m_configuration(configuration),
+        m_planRows(planRows),
+        m_allocator(allocator)
+    {
+        LogAssertB(planRows.GetShardCount() == ingestor.GetShardCount(),
+                   "TermMatchTreeConverter: shard count mismatch.");
+
+        for (ShardId shard = 0; shard < planRows.GetShardCount(); ++shard)
+        {
+            ITermTable2 const & termTable =
+                m_ingestor.GetShard(shard).GetTermTable();
+
+            m_matchAllRowIds.emplace_back();
+            for (auto row : RowIdSequence(termTable.GetMatchAllTerm(),
+                                          termTable))
+            {
+                m_matchAllRowIds.back().push_back(row);
+            }
+
+            m_matchNoneRowIds.emplace_back();
+            for (auto row : RowIdSequence(termTable.GetMatchNoneTerm(),
+                                          termTable))
+            {
+                m_matchNoneRowIds.back().push_back(row);
+            }
+        }
+    }
+
+
+    RowMatchNode const &
+        TermMatchTreeConverter::BuildRowPlan(TermMatchNode const & query)
+    {
+        RowMatchNode const & tree = BuildNode(query);
+        Term documentActive =
+            m_ingestor.GetShard(0).GetTermTable().GetDocumentActiveTerm();
+        return CreateAnd(tree, BuildTerm(documentActive));
+    }
+
+
+    std::vector<unsigned> const & TermMatchTreeConverter::GetMatchAllRows() const
+    {
+        return m_matchAllRows;
+    }
+
+
+    std::vector<unsigned> const & TermMatchTreeConverter::GetMatchNoneRows() const
+    {
+        return m_matchNoneRows;
+    }
+
+
+    RowMatchNode const &
+        TermMatchTreeConverter::BuildNode(TermMatchNode const & node)
+    {
+        switch (node.GetType())
+        {
+        case TermMatchNode::AndMatch:
+            {
+                auto const & andNode =
+                    dynamic_cast<TermMatchNode::And const &>(node);
+                return CreateAnd(BuildNode(andNode.GetLeft()),
+                                 BuildNode(andNode.GetRight()));
+            }
+        case TermMatchNode::OrMatch:
+            {
+                auto const & orNode =
+                    dynamic_cast<TermMatchNode::Or const &>(node);
+                RowMatchNode const & left = BuildNode(orNode.GetLeft());
+                RowMatchNode const & right = BuildNode(orNode.GetRight());
+                return *new (m_allocator.Allocate(sizeof(RowMatchNode::Or)))
+                            RowMatchNode::Or(left, right);
+            }
+        case TermMatchNode::NotMatch:
+            {
+                auto const & notNode =
+                    dynamic_cast<TermMatchNode::Not const &>(node);
+                RowMatchNode const & child = BuildNode(notNode.GetChild());
+                return *new (m_allocator.Allocate(sizeof(RowMatchNode::Not)))
+                            RowMatchNode::Not(child);
+            }
+        case TermMatchNode::UnigramMatch:
+            {
+                auto const & unigram =
+                    dynamic_cast<TermMatchNode::Unigram const &>(node);
+                return BuildTerm(Term(unigram.GetText(),
+                                      unigram.GetStreamId(),
+                                      m_configuration));
+            }
+        case TermMatchNode::PhraseMatch:
+            return BuildPhrase(node);
+        case TermMatchNode::FactMatch:
+            {
+                auto const & fact =
+                    dynamic_cast<TermMatchNode::Fact const &>(node);
+                return BuildTerm(Term(fact.GetFact(), 0u, 0u, 1u));
+            }
+        default:
+            RecoverableError error("TermMatchTreeConverter: unsupported TermMatchNode.");
+            throw error;
+        }
+    }
+
+
+    RowMatchNode const &
+        TermMatchTreeConverter::BuildPhrase(TermMatchNode const & node)
+    {
+        // Ingestion adds every n-gram up to the maximum gram size, so a
+        // phrase is matched by the conjunction of its longest n-grams.
+        auto const & phrase = dynamic_cast<TermMatchNode::Phrase const &>(node);
+        StringVector const & grams = phrase.GetGrams();
+        const unsigned gramCount = grams.GetSize();
+        if (gramCount == 0)
+        {
+            RecoverableError error("TermMatchTreeConverter: empty phrase.");
+            throw error;
+        }
+
+        const size_t maxGramSize = m_configuration.GetMaxGramSize();
+        const unsigned length = (gramCount < maxGramSize) ?
+            gramCount : static_cast<unsigned>(maxGramSize);
+
+        RowMatchNode const * tree = nullptr;
+        for (unsigned start = 0; start + length <= gramCount; ++start)
+        {
+            Term term(grams[start], phrase.GetStreamId(), m_configuration);
+            for (unsigned i = 1; i < length; ++i)
+            {
+                term.AddTerm(Term(grams[start + i],
+                                  phrase.GetStreamId(),
+                                  m_configuration),
+                             m_configuration);
+            }
+
+            RowMatchNode const & rows = BuildTerm(term);
+            tree = (tree == nullptr) ? &rows : &CreateAnd(*tree, rows);
+        }
+
+        return *tree;
+    }
+
+
+    RowMatchNode const & TermMatchTreeConverter::BuildTerm(Term const & term)
+    {
+        const ShardId shardCount = m_planRows.GetShardCount();
+
+        std::vector<std::vector<RowId>> rows(shardCount);
+        size_t rowCount = 0;
+        for (ShardId shard = 0; shard < shardCount; ++shard)
+        {
+            Shard& owner = m_ingestor.GetShard(shard);
+            ITermTable2 const & termTable = owner.GetTermTable();
+
+            // Queries repeat terms, e.g. in phrases and across plans, so the
+            // thread's cache saves re-resolving adhoc terms.
+            for (auto row : owner.GetResolvedTermCache().GetRows(term))
+            {
+                rows[shard].push_back(row);
+            }
+
+            if (rows[shard].empty())
+            {
+                // Ingestion sets no bits for a term without rows, e.g. with
+                // a TermTable that has no adhoc recipes, so every document is
+                // a candidate.
+                for (auto row : RowIdSequence(termTable.GetMatchAllTerm(),
+                                              termTable))
+                {
+                    rows[shard].push_back(row);
+                }
+            }
+
+            LogAssertB(!rows[shard].empty(),
+                       "TermMatchTreeConverter: match-all term has no rows.");
+
+            std::stable_sort(rows[shard].begin(),
+                             rows[shard].end(),
+                             [] (RowId a, RowId b)
+                             {
+                                 return a.GetRank() > b.GetRank();
+                             });
+
+            rowCount = (std::max)(rowCount, rows[shard].size());
+        }
+
+        RowMatchNode::Builder builder(RowMatchNode::AndMatch, m_allocator);
+        std::vector<RowId> physicalRows(shardCount);
+        for (size_t i = 0; i < rowCount; ++i)
+        {
+            for (ShardId shard = 0; shard < shardCount; ++shard)
+            {
+                const size_t index = (std::min)(i, rows[shard].size() - 1);
+                physicalRows[shard] = rows[shard][index];
+            }
+
+            builder.AddChild(RowMatchNode::Builder::CreateRowNode(GetRow(physicalRows),
+                                                                  m_allocator));
+        }
+
+        return *builder.Complete();
+    }
+
+
+    AbstractRow TermMatchTreeConverter::GetRow(std::vector<RowId> const & rows)
+    {
+        auto it = m_rows.find(rows);
+        if (it != m_rows.end())
+        {
+            return it->second;
+        }
+
+        Rank rank = c_maxRankValue;
+        for (auto row : rows)
+        {
+            rank = (std::min)(rank, row.GetRank());
+        }
+
+        AbstractRow row = m_planRows.AddRow(rank);
+        for (ShardId shard = 0; shard < rows.size(); ++shard)
+        {
+            m_planRows.PhysicalRow(shard, row.GetId()) = rows[shard];
+        }
+
+        if (IsSystemRow(rows, m_matchAllRowIds))
+        {
+            m_matchAllRows.push_back(row.GetId());
+        }
+        else if (IsSystemRow(rows, m_matchNoneRowIds))
+        {
+            m_matchNoneRows.push_back(row.GetId());
+        }
+
+        m_rows.insert(std::make_pair(rows, row));
+        return row;
+    }
+
+
+    bool TermMatchTreeConverter::IsSystemRow(std::vector<RowId> const & rows,
+                                             std::vector<std::vector<RowId>> const & systemRows)
+    {
+        for (ShardId shard = 0; shard < rows.size(); ++shard)
+        {
+            if (std::find(systemRows[shard].begin(),
+                          systemRows[shard].end(),
+                          rows[shard]) == systemRows[shard].end())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    RowMatchNode const &
+        TermMatchTreeConverter::CreateAnd(RowMatchNode const & left,
+                                          RowMatchNode const & right)
+    {
+        return *new (m_allocator.Allocate(sizeof(RowMatchNode::And)))
+                    RowMatchNode::And(left, right);
+    }
+}
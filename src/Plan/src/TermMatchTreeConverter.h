@@ -0,0 +1,113 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <map>                          // std::map member.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/AbstractRow.h"      // AbstractRow member.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+#include "BitFunnel/RowId.h"            // RowId member.
+
+
+namespace BitFunnel
+{
+    class IAllocator;
+    class IConfiguration;
+    class IIngestor;
+    class IPlanRows;
+    class RowMatchNode;
+    class Term;
+    class TermMatchNode;
+
+    //*************************************************************************
+    //
+    // TermMatchTreeConverter
+    //
+    // Converts a TermMatchNode tree into an equivalent RowMatchNode tree over
+    // the AbstractRows of an IPlanRows. The tree is shared by every Shard, so
+    // each term is given the same sequence of AbstractRows in every Shard:
+    //
+    //   1. The term's rows in each Shard are sorted by descending rank. A
+    //      term without rows in a Shard is treated as the match-all term.
+    //   2. The term gets as many AbstractRows as the Shard where it has the
+    //      most rows. Shards with fewer rows repeat their last row, which
+    //      has no effect on an intersection.
+    //   3. Each AbstractRow takes the lowest rank of its physical rows, so
+    //      that every physical row can be evaluated at the AbstractRow's rank.
+    //   4. Terms that share physical rows in every Shard, e.g. when adhoc
+    //      rows collide, share the AbstractRow so that the duplicate can be
+    //      recognized by the MatchTreeSimplifier.
+    //
+    // The resulting tree is intersected with the document active rows so
+    // that only committed and unexpired documents match.
+    //
+    //*************************************************************************
+    class TermMatchTreeConverter : NonCopyable
+    {
+    public:
+        TermMatchTreeConverter(IIngestor const & ingestor,
+                               IConfiguration const & configuration,
+                               IPlanRows& planRows,
+                               IAllocator& allocator);
+
+        RowMatchNode const & BuildRowPlan(TermMatchNode const & query);
+
+        // Return the ids of the AbstractRows that are bound to the match-all
+        // and match-none rows in every Shard.
+        std::vector<unsigned> const & GetMatchAllRows() const;
+        std::vector<unsigned> const & GetMatchNoneRows() const;
+
+    private:
+        RowMatchNode const & BuildNode(TermMatchNode const & node);
+        RowMatchNode const & BuildPhrase(TermMatchNode const & node);
+        RowMatchNode const & BuildTerm(Term const & term);
+
+        RowMatchNode const & CreateAnd(RowMatchNode const & left,
+                                       RowMatchNode const & right);
+
+        // Returns the AbstractRow for the physical rows, one per Shard,
+        // adding a row to m_planRows the first time they are seen.
+        AbstractRow GetRow(std::vector<RowId> const & rows);
+
+        // Returns true if rows[shard] is one of the rows of the match-all
+        // (or match-none) term in every Shard.
+        static bool IsSystemRow(std::vector<RowId> const & rows,
+                                std::vector<std::vector<RowId>> const & systemRows);
+
+        IIngestor const & m_ingestor;
+        IConfiguration const & m_configuration;
+        IPlanRows& m_planRows;
+        IAllocator& m_allocator;
+
+        std::map<std::vector<RowId>, AbstractRow> m_rows;
+
+        // Physical rows of the match-all and match-none terms in each Shard.
+        std::vector<std::vector<RowId>> m_matchAllRowIds;
+        std::vector<std::vector<RowId>> m_matchNoneRowIds;
+
+        std::vector<unsigned> m_matchAllRows;
+        std::vector<unsigned> m_matchNoneRows;
+    };
+}
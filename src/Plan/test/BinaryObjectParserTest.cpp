@@ -0,0 +1,255 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "Allocator.h"
+#include "BinaryObjectFormatter.h"
+#include "BinaryObjectParser.h"
+#include "BitFunnel/RowMatchNode.h"
+#include "BitFunnel/RowPlan.h"
+#include "BitFunnel/TermMatchNode.h"
+#include "CompileNode.h"
+#include "TextObjectFormatter.h"
+#include "TextObjectParser.h"
+
+
+namespace BitFunnel
+{
+    namespace BinaryObjectParserTest
+    {
+        const char* c_termMatchNodeCases[] = {
+            "Unigram(\"123\", 0)",
+            "Unigram(\"12\\\"3\", 2)",
+            "Fact(1)",
+
+            "Not {\n"
+            "  Child: Unigram(\"123\", 0)\n"
+            "}",
+
+            "And {\n"
+            "  Children: [\n"
+            "    Or {\n"
+            "      Children: [\n"
+            "        Phrase {\n"
+            "          StreamId: 1,\n"
+            "          Grams: [\n"
+            "            \"123\",\n"
+            "            \"456\",\n"
+            "            \"789\"\n"
+            "          ]\n"
+            "        },\n"
+            "        Unigram(\"123\", 0)\n"
+            "      ]\n"
+            "    },\n"
+            "    Not {\n"
+            "      Child: And {\n"
+            "        Children: [\n"
+            "          Unigram(\"123\", 0),\n"
+            "          Unigram(\"foobar\", 1)\n"
+            "        ]\n"
+            "      }\n"
+            "    }\n"
+            "  ]\n"
+            "}",
+        };
+
+
+        const char* c_rowMatchNodeCases[] = {
+            "Row(0, 0, 0, false)",
+
+            "And {\n"
+            "  Children: [\n"
+            "    Or {\n"
+            "      Children: [\n"
+            "        Row(1, 3, 0, true),\n"
+            "        Row(200, 6, 0, false)\n"
+            "      ]\n"
+            "    },\n"
+            "    Not {\n"
+            "      Child: Row(2, 0, 6, false)\n"
+            "    },\n"
+            "    Report {\n"
+            "      Child: \n"
+            "    }\n"
+            "  ]\n"
+            "}",
+        };
+
+
+        const char* c_rowPlanCases[] = {
+            "RowPlan {\n"
+            "  Match: Row(0, 0, 0, false)\n"
+            "}",
+
+            "RowPlan {\n"
+            "  Match: Or {\n"
+            "    Children: [\n"
+            "      And {\n"
+            "        Children: [\n"
+            "          Row(1, 3, 0, true),\n"
+            "          Not {\n"
+            "            Child: Row(2, 0, 6, false)\n"
+            "          }\n"
+            "        ]\n"
+            "      },\n"
+            "      Report {\n"
+            "        Child: Row(200, 6, 0, false)\n"
+            "      }\n"
+            "    ]\n"
+            "  }\n"
+            "}",
+        };
+
+
+        const char* c_compileNodeCases[] = {
+            "AndRowJz {\n"
+            "  Row: Row(1, 2, 0, false),\n"
+            "  Child: Report {\n"
+            "    Child: \n"
+            "  }\n"
+            "}",
+
+            "Or {\n"
+            "  Children: [\n"
+            "    LoadRowJz {\n"
+            "      Row: Row(1, 2, 0, false),\n"
+            "      Child: Report {\n"
+            "        Child: \n"
+            "      }\n"
+            "    },\n"
+            "    RankDown {\n"
+            "      Delta: 3,\n"
+            "      Child: Report {\n"
+            "        Child: \n"
+            "      }\n"
+            "    }\n"
+            "  ]\n"
+            "}",
+        };
+
+
+        // Parses text, converts it to the binary format and back, and checks
+        // that the result formats to the same text as the original parse.
+        template <class T>
+        void VerifyRoundtripCase(char const * text,
+                                 int (*typenameConverter)(char const * name))
+        {
+            Allocator allocator(4096);
+
+            std::stringstream input(text);
+            TextObjectParser textParser(input, allocator, typenameConverter);
+            T const & node = T::Parse(textParser);
+
+            std::stringstream expected;
+            TextObjectFormatter textFormatter(expected);
+            node.Format(textFormatter);
+
+            std::stringstream binary;
+            BinaryObjectFormatter binaryFormatter(binary, typenameConverter);
+            node.Format(binaryFormatter);
+            std::string const buffer = binary.str();
+
+            EXPECT_LT(buffer.size(), expected.str().size());
+
+            BinaryObjectParser binaryParser(buffer.data(),
+                                            buffer.size(),
+                                            allocator,
+                                            typenameConverter);
+            T const & copy = T::Parse(binaryParser);
+            EXPECT_EQ(buffer.size(), binaryParser.GetPosition());
+
+            std::stringstream output;
+            TextObjectFormatter outputFormatter(output);
+            copy.Format(outputFormatter);
+
+            EXPECT_EQ(expected.str(), output.str());
+        }
+
+
+        TEST(BinaryObjectParser, TermMatchNode)
+        {
+            for (auto text : c_termMatchNodeCases)
+            {
+                VerifyRoundtripCase<TermMatchNode>(text, &TermMatchNode::GetType);
+            }
+        }
+
+
+        TEST(BinaryObjectParser, RowMatchNode)
+        {
+            for (auto text : c_rowMatchNodeCases)
+            {
+                VerifyRoundtripCase<RowMatchNode>(text, &RowPlanBase::GetType);
+            }
+        }
+
+
+        TEST(BinaryObjectParser, RowPlan)
+        {
+            for (auto text : c_rowPlanCases)
+            {
+                VerifyRoundtripCase<RowPlan>(text, &RowPlanBase::GetType);
+            }
+        }
+
+
+        TEST(BinaryObjectParser, CompileNode)
+        {
+            for (auto text : c_compileNodeCases)
+            {
+                VerifyRoundtripCase<CompileNode>(text, &CompileNode::GetType);
+            }
+        }
+
+
+        TEST(BinaryObjectParser, ZeroCopyStrings)
+        {
+            std::stringstream binary;
+            BinaryObjectFormatter formatter(binary, &TermMatchNode::GetType);
+            formatter.FormatStringLiteral("hello");
+            formatter.Format(-3);
+            formatter.Format(300u);
+            formatter.Format(2.5);
+            std::string const buffer = binary.str();
+
+            Allocator allocator(256);
+            BinaryObjectParser parser(buffer.data(),
+                                      buffer.size(),
+                                      allocator,
+                                      &TermMatchNode::GetType);
+
+            char const * text = parser.ParseStringLiteral();
+            EXPECT_STREQ("hello", text);
+            EXPECT_GE(text, buffer.data());
+            EXPECT_LT(text, buffer.data() + buffer.size());
+
+            EXPECT_EQ(-3, static_cast<int>(parser.ParseInt()));
+            EXPECT_EQ(300u, parser.ParseUInt());
+            EXPECT_EQ(2.5, parser.ParseDouble());
+            EXPECT_EQ(buffer.size(), parser.GetPosition());
+        }
+    }
+}
@@ -1,6 +1,10 @@
 #include "gtest/gtest.h"
 
+#include <vector>
+
 #include "Allocator.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IPlanRows.h"
 #include "BitFunnel/RowMatchNode.h"
 #include "MatchTreeRewriter.h"
 #include "SameExceptForWhitespace.h"
@@ -991,5 +995,75 @@ namespace BitFunnel
                 VerifyCase(c_rewriteCases[i]);
             }
         }
+
+
+        // IPlanRows that only knows the density of each row.
+        class DensityPlanRows : public IPlanRows
+        {
+        public:
+            DensityPlanRows(std::vector<double> const & densities)
+              : m_densities(densities)
+            {
+            }
+
+            virtual bool IsFull() const override { throw NotImplemented(); }
+            virtual ShardId GetShardCount() const override { throw NotImplemented(); }
+            virtual unsigned GetRowCount() const override { throw NotImplemented(); }
+            virtual AbstractRow AddRow(Rank) override { throw NotImplemented(); }
+            virtual Rank GetRank(unsigned) const override { throw NotImplemented(); }
+            virtual RowId const & PhysicalRow(ShardId, unsigned) const override { throw NotImplemented(); }
+            virtual RowId & PhysicalRow(ShardId, unsigned) override { throw NotImplemented(); }
+            virtual ptrdiff_t GetRowOffset(ShardId, unsigned) const override { throw NotImplemented(); }
+
+            virtual double GetDensity(unsigned id) const override
+            {
+                return m_densities.at(id);
+            }
+
+        private:
+            std::vector<double> m_densities;
+        };
+
+
+        // Rows of the same rank are ordered from sparsest to densest, and
+        // higher ranks still come first.
+        TEST(MatchTreeRewriter, SparsestRowsFirst)
+        {
+            std::stringstream input(
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Row(1, 0, 0, false),"
+                "    Row(2, 3, 0, false),"
+                "    Row(3, 3, 0, false)"
+                "  ]"
+                "}");
+
+            Allocator allocator(1024*4);
+            TextObjectParser parser(input, allocator, &RowPlanBase::GetType);
+            RowMatchNode const & root = RowMatchNode::Parse(parser);
+
+            DensityPlanRows planRows({ 0.01, 0.5, 0.02, 0.3 });
+            RowMatchNode const & converted =
+                MatchTreeRewriter::Rewrite(root, 4, 0, allocator, &planRows);
+
+            std::stringstream output;
+            TextObjectFormatter formatter(output);
+            converted.Format(formatter);
+
+            char const * expected =
+                "And {"
+                "  Children: ["
+                "    Row(2, 3, 0, false),"
+                "    Row(3, 3, 0, false),"
+                "    Row(0, 0, 0, false),"
+                "    Row(1, 0, 0, false),"
+                "    Report {"
+                "      Child:"
+                "    }"
+                "  ]"
+                "}";
+            EXPECT_TRUE(SameExceptForWhitespace(output.str().c_str(), expected));
+        }
     }
 }
@@ -0,0 +1,361 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <vector>
+
+#include "Allocator.h"
+#include "BitFunnel/RowMatchNode.h"
+#include "MatchTreeSimplifier.h"
+#include "SameExceptForWhitespace.h"
+#include "TextObjectFormatter.h"
+#include "TextObjectParser.h"
+
+
+namespace BitFunnel
+{
+    namespace MatchTreeSimplifierUnitTest
+    {
+        struct InputOutput
+        {
+        public:
+            char const * m_input;
+            char const * m_output;
+        };
+
+
+        // Rows 8 and 9 are bound to the match-all and match-none rows.
+        const std::vector<unsigned> c_matchAllRows = { 8 };
+        const std::vector<unsigned> c_matchNoneRows = { 9 };
+
+
+        const InputOutput c_simplifyCases[] =
+        {
+            // Nothing to simplify.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Row(1, 3, 0, false)"
+                "  ]"
+                "}",
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Row(1, 3, 0, false)"
+                "  ]"
+                "}"
+            },
+
+
+            // Match-all row removed from and-expression.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Row(8, 0, 0, false),"
+                "    Row(1, 3, 0, false)"
+                "  ]"
+                "}",
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Row(1, 3, 0, false)"
+                "  ]"
+                "}"
+            },
+
+
+            // Match-none row removed from or-expression.
+            {
+                "Or {"
+                "  Children: ["
+                "    Row(9, 0, 0, false),"
+                "    Row(1, 3, 0, false)"
+                "  ]"
+                "}",
+                "Row(1, 3, 0, false)"
+            },
+
+
+            // And-expression with a match-none row folds to that row.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Row(9, 0, 0, false)"
+                "  ]"
+                "}",
+                "Row(9, 0, 0, false)"
+            },
+
+
+            // Not of the match-all row is false.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Not {"
+                "      Child: Row(8, 0, 0, false)"
+                "    }"
+                "  ]"
+                "}",
+                "Not {"
+                "  Child: Row(8, 0, 0, false)"
+                "}"
+            },
+
+
+            // Or-expression with a true operand removed from and-expression.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Or {"
+                "      Children: ["
+                "        Row(1, 3, 0, false),"
+                "        Not {"
+                "          Child: Row(9, 0, 0, false)"
+                "        }"
+                "      ]"
+                "    }"
+                "  ]"
+                "}",
+                "Row(0, 0, 0, false)"
+            },
+
+
+            // Duplicate rows in nested and-expressions.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    And {"
+                "      Children: ["
+                "        Row(1, 3, 0, false),"
+                "        Row(0, 0, 0, false)"
+                "      ]"
+                "    }"
+                "  ]"
+                "}",
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Row(1, 3, 0, false)"
+                "  ]"
+                "}"
+            },
+
+
+            // Duplicate subtrees.
+            {
+                "Or {"
+                "  Children: ["
+                "    Not {"
+                "      Child: Row(0, 0, 0, false)"
+                "    },"
+                "    Row(1, 3, 0, false),"
+                "    Not {"
+                "      Child: Row(0, 0, 0, false)"
+                "    }"
+                "  ]"
+                "}",
+                "Or {"
+                "  Children: ["
+                "    Not {"
+                "      Child: Row(0, 0, 0, false)"
+                "    },"
+                "    Row(1, 3, 0, false)"
+                "  ]"
+                "}"
+            },
+
+
+            // Complementary operands make the or-expression true.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(2, 6, 0, false),"
+                "    Or {"
+                "      Children: ["
+                "        Row(0, 0, 0, false),"
+                "        Not {"
+                "          Child: Row(0, 0, 0, false)"
+                "        }"
+                "      ]"
+                "    }"
+                "  ]"
+                "}",
+                "Row(2, 6, 0, false)"
+            },
+
+
+            // Common row factored out of or-expression: ab + ca = a(b + c).
+            {
+                "Or {"
+                "  Children: ["
+                "    And {"
+                "      Children: ["
+                "        Row(0, 0, 0, false),"
+                "        Row(1, 3, 0, false)"
+                "      ]"
+                "    },"
+                "    And {"
+                "      Children: ["
+                "        Row(2, 6, 0, false),"
+                "        Row(0, 0, 0, false)"
+                "      ]"
+                "    }"
+                "  ]"
+                "}",
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Or {"
+                "      Children: ["
+                "        Row(1, 3, 0, false),"
+                "        Row(2, 6, 0, false)"
+                "      ]"
+                "    }"
+                "  ]"
+                "}"
+            },
+
+
+            // Absorption: a + ab = a.
+            {
+                "Or {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    And {"
+                "      Children: ["
+                "        Row(0, 0, 0, false),"
+                "        Row(1, 3, 0, false)"
+                "      ]"
+                "    }"
+                "  ]"
+                "}",
+                "Row(0, 0, 0, false)"
+            },
+
+
+            // Factored row is merged into the enclosing and-expression.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(3, 6, 0, false),"
+                "    Or {"
+                "      Children: ["
+                "        And {"
+                "          Children: ["
+                "            Row(0, 0, 0, false),"
+                "            Row(1, 3, 0, false)"
+                "          ]"
+                "        },"
+                "        And {"
+                "          Children: ["
+                "            Row(0, 0, 0, false),"
+                "            Row(2, 6, 0, false)"
+                "          ]"
+                "        }"
+                "      ]"
+                "    }"
+                "  ]"
+                "}",
+                "And {"
+                "  Children: ["
+                "    Row(3, 6, 0, false),"
+                "    Row(0, 0, 0, false),"
+                "    Or {"
+                "      Children: ["
+                "        Row(1, 3, 0, false),"
+                "        Row(2, 6, 0, false)"
+                "      ]"
+                "    }"
+                "  ]"
+                "}"
+            },
+        };
+
+
+        void VerifyCase(InputOutput const & testCase)
+        {
+            std::stringstream input(testCase.m_input);
+
+            Allocator allocator(1024 * 4);
+            TextObjectParser parser(input, allocator, &RowPlanBase::GetType);
+            RowMatchNode const & root = RowMatchNode::Parse(parser);
+
+            RowMatchNode const & simplified =
+                MatchTreeSimplifier::Simplify(root,
+                                              c_matchAllRows,
+                                              c_matchNoneRows,
+                                              allocator);
+
+            std::stringstream output;
+            TextObjectFormatter formatter(output);
+            simplified.Format(formatter);
+
+            EXPECT_TRUE(SameExceptForWhitespace(output.str().c_str(),
+                                                testCase.m_output))
+                << output.str();
+        }
+
+
+        TEST(MatchTreeSimplifier, Basic)
+        {
+            for (auto const & testCase : c_simplifyCases)
+            {
+                VerifyCase(testCase);
+            }
+        }
+
+
+        TEST(MatchTreeSimplifier, ConstantTreeWithoutExample)
+        {
+            // x + Not(x) is true, but no node in the input is always true.
+            char const * text =
+                "Or {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Not {"
+                "      Child: Row(0, 0, 0, false)"
+                "    }"
+                "  ]"
+                "}";
+
+            std::stringstream input(text);
+            Allocator allocator(1024);
+            TextObjectParser parser(input, allocator, &RowPlanBase::GetType);
+            RowMatchNode const & root = RowMatchNode::Parse(parser);
+
+            EXPECT_EQ(&root,
+                      &MatchTreeSimplifier::Simplify(root,
+                                                     c_matchAllRows,
+                                                     c_matchNoneRows,
+                                                     allocator));
+        }
+    }
+}
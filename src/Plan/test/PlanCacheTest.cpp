@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "Allocator.h"
+#include "BitFunnel/TermMatchNode.h"
+#include "PlanCache.h"
+#include "TextObjectParser.h"
+
+
+namespace BitFunnel
+{
+    namespace PlanCacheUnitTest
+    {
+        static std::string GetCanonicalForm(char const * text,
+                                            IAllocator& allocator)
+        {
+            std::stringstream input(text);
+            TextObjectParser parser(input, allocator, &TermMatchNode::GetType);
+            return PlanCache::GetCanonicalForm(TermMatchNode::Parse(parser));
+        }
+
+
+        TEST(PlanCache, CanonicalForm)
+        {
+            Allocator allocator(4096);
+
+            std::string a = GetCanonicalForm(
+                "And {"
+                "  Children: ["
+                "    Unigram(\"dog\", 0),"
+                "    Unigram(\"cat\", 0),"
+                "    Unigram(\"bird\", 0)"
+                "  ]"
+                "}",
+                allocator);
+
+            // Operand order, repeated operands and nesting don't matter.
+            std::string b = GetCanonicalForm(
+                "And {"
+                "  Children: ["
+                "    Unigram(\"bird\", 0),"
+                "    And {"
+                "      Children: ["
+                "        Unigram(\"cat\", 0),"
+                "        Unigram(\"dog\", 0)"
+                "      ]"
+                "    },"
+                "    Unigram(\"cat\", 0)"
+                "  ]"
+                "}",
+                allocator);
+            EXPECT_EQ(a, b);
+
+            // Streams, operators and phrase order do matter.
+            EXPECT_NE(GetCanonicalForm("Unigram(\"dog\", 0)", allocator),
+                      GetCanonicalForm("Unigram(\"dog\", 1)", allocator));
+            EXPECT_NE(a,
+                      GetCanonicalForm(
+                          "Or {"
+                          "  Children: ["
+                          "    Unigram(\"dog\", 0),"
+                          "    Unigram(\"cat\", 0),"
+                          "    Unigram(\"bird\", 0)"
+                          "  ]"
+                          "}",
+                          allocator));
+            EXPECT_NE(GetCanonicalForm("Phrase {"
+                                       "  StreamId: 0,"
+                                       "  Grams: [\"a\", \"b\"]"
+                                       "}",
+                                       allocator),
+                      GetCanonicalForm("Phrase {"
+                                       "  StreamId: 0,"
+                                       "  Grams: [\"b\", \"a\"]"
+                                       "}",
+                                       allocator));
+        }
+
+
+        TEST(PlanCache, EvictsLeastRecentlyUsed)
+        {
+            PlanCache cache(2);
+            auto plans = std::make_shared<PlanCache::ShardPlans const>();
+
+            cache.Add("a", 0, plans);
+            cache.Add("b", 0, plans);
+            EXPECT_EQ(cache.Find("a", 0), plans);
+
+            // "b" is now the least recently used entry.
+            cache.Add("c", 0, plans);
+            EXPECT_EQ(cache.GetSize(), 2u);
+            EXPECT_EQ(cache.Find("b", 0), nullptr);
+            EXPECT_EQ(cache.Find("a", 0), plans);
+            EXPECT_EQ(cache.Find("c", 0), plans);
+
+            EXPECT_EQ(cache.GetHitCount(), 3u);
+            EXPECT_EQ(cache.GetMissCount(), 1u);
+        }
+
+
+        TEST(PlanCache, Version)
+        {
+            PlanCache cache(4);
+            auto plans = std::make_shared<PlanCache::ShardPlans const>();
+
+            cache.Add("a", 0, plans);
+            EXPECT_EQ(cache.Find("a", 1), nullptr);
+            EXPECT_EQ(cache.Find("a", 0), plans);
+
+            cache.Clear();
+            EXPECT_EQ(cache.GetSize(), 0u);
+            EXPECT_EQ(cache.Find("a", 0), nullptr);
+        }
+    }
+}
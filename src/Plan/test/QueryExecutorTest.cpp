@@ -0,0 +1,662 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Allocator.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Index/BitSlicedField.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IDocumentDataSchema.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/ITermTreatment.h"
+#include "BitFunnel/Plan/Factories.h"
+#include "BitFunnel/Plan/IQueryExecutor.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "BitFunnel/Term.h"
+#include "BitFunnel/TermMatchNode.h"
+#include "FactSetBase.h"
+#include "gtest/gtest.h"
+#include "Shard.h"
+#include "SyntheticCorpus.h"
+#include "TermSequence.h"
+#include "TestIngestor.h"
+#include "TextObjectParser.h"
+
+
+namespace BitFunnel
+{
+    namespace QueryExecutorTest
+    {
+        static const size_t c_documentCount = 1000;
+        static const ShardId c_shardCount = 2;
+
+        // Document i holds i % (c_maxValue + 1) in the bit-sliced "value"
+        // field.
+        static const uint64_t c_maxValue = 99;
+
+
+        // Every document has a distinct StaticRank in [0, c_documentCount).
+        static StaticRank GetStaticRank(DocId id)
+        {
+            return static_cast<StaticRank>((id * 37) % c_documentCount);
+        }
+
+        // Ranks the documents in the order they are ingested, so the first
+        // Slices of each shard hold its best documents.
+        static StaticRank GetDescendingStaticRank(DocId id)
+        {
+            return static_cast<StaticRank>(c_documentCount - 1 - id);
+        }
+
+        static std::unique_ptr<IDocumentDataSchema>
+            CreateSchema(bool storeTermSequences)
+        {
+            auto schema = Factories::CreateDocumentDataSchema();
+            schema->RegisterStaticRankBlob();
+            if (storeTermSequences)
+            {
+                schema->RegisterTermSequenceBlob();
+            }
+            return schema;
+        }
+
+
+        // Split at 3 postings, so documents with both "even" and "third" go
+        // to the second shard.
+        static std::unique_ptr<IShardDefinition> CreateShardDefinition()
+        {
+            auto shardDefinition = Factories::CreateShardDefinition();
+            shardDefinition->AddShard(3);
+            return shardDefinition;
+        }
+
+
+        // Ingests the documents from CreateSyntheticChunk(), with unique
+        // terms, into two shards. The "all", "even" and "third" rows are
+        // chosen by the treatment. Each document's StaticRank is given by
+        // staticRank.
+        class TestEnvironment
+        {
+        public:
+            TestEnvironment(ITermTreatment const & treatment,
+                            bool storeTermSequences = false,
+                            StaticRank (*staticRank)(DocId) = GetStaticRank)
+              : m_value(m_facts, "value", c_maxValue),
+                m_index(CreateSyntheticTermTables(treatment,
+                                                  m_facts,
+                                                  c_shardCount),
+                        CreateSchema(storeTermSequences),
+                        CreateShardDefinition(),
+                        64)
+            {
+                m_index.Ingest(CreateSyntheticChunk(0, c_documentCount, true));
+
+                for (DocId id = 0; id < c_documentCount; ++id)
+                {
+                    DocumentHandle handle = GetIngestor().GetHandle(id);
+                    m_value.Assert(handle, id % (c_maxValue + 1));
+                    handle.SetStaticRank(staticRank(id));
+                }
+            }
+
+            IConfiguration const & GetConfiguration() const
+            {
+                return m_index.GetConfiguration();
+            }
+
+            IIngestor& GetIngestor() const
+            {
+                return m_index.GetIngestor();
+            }
+
+            BitSlicedField const & GetValueField() const
+            {
+                return m_value;
+            }
+
+            // Returns true if every row of the term has the document's bit
+            // set.
+            bool HasBits(DocId id, char const * text) const
+            {
+                DocumentHandle handle = GetIngestor().GetHandle(id);
+                Shard const & shard = GetIngestor().GetShard((id % 6 == 0) ? 1 : 0);
+                Term term(text, 0, GetConfiguration());
+                RowIdSequence rows(term, shard.GetTermTable());
+                bool hasRows = false;
+                for (auto row : rows)
+                {
+                    hasRows = true;
+                    if (!handle.GetBit(row))
+                    {
+                        return false;
+                    }
+                }
+                EXPECT_TRUE(hasRows);
+                return true;
+            }
+
+        private:
+            FactSetBase m_facts;
+            BitSlicedField m_value;
+            TestIngestor m_index;
+        };
+
+
+        static std::set<DocId> Execute(IQueryExecutor& executor,
+                                       TermMatchNode const & query)
+        {
+            auto stream = executor.Execute(query);
+
+            std::set<DocId> matches;
+            while (stream->MoveNext())
+            {
+                EXPECT_TRUE(matches.insert(stream->Current()).second);
+            }
+            return matches;
+        }
+
+
+        static std::set<DocId> Execute(IQueryExecutor& executor,
+                                       char const * text)
+        {
+            std::stringstream input(text);
+            Allocator allocator(4096);
+            TextObjectParser parser(input, allocator, &TermMatchNode::GetType);
+            return Execute(executor, TermMatchNode::Parse(parser));
+        }
+
+
+        // Runs queries covering each kind of node against every shard and
+        // checks the matches against the bits of each document.
+        static void VerifyQueries(TestEnvironment& environment)
+        {
+            IIngestor& ingestor = environment.GetIngestor();
+            ASSERT_EQ(ingestor.GetShardCount(), 2u);
+            ASSERT_GT(ingestor.GetShard(0).GetSliceBuffers().size(), 0u);
+            ASSERT_GT(ingestor.GetShard(1).GetSliceBuffers().size(), 0u);
+
+            auto executor = Factories::CreateQueryExecutor(
+                ingestor,
+                environment.GetConfiguration(),
+                4);
+
+            // Every document matches "all", whichever shard it is in.
+            std::set<DocId> matches = Execute(*executor, "Unigram(\"all\", 0)");
+            EXPECT_EQ(matches.size(), c_documentCount);
+
+            // The other queries may have false positives, so they are
+            // compared with the bits of each document.
+            matches = Execute(*executor,
+                              "And {\n"
+                              "  Children: [\n"
+                              "    Unigram(\"even\", 0),\n"
+                              "    Unigram(\"third\", 0)\n"
+                              "  ]\n"
+                              "}");
+            for (DocId id = 0; id < c_documentCount; ++id)
+            {
+                const bool expected = environment.HasBits(id, "even") &&
+                                      environment.HasBits(id, "third");
+                EXPECT_EQ(matches.count(id) == 1, expected);
+                if (id % 6 == 0)
+                {
+                    EXPECT_TRUE(expected);
+                }
+            }
+
+            matches = Execute(*executor,
+                              "Or {\n"
+                              "  Children: [\n"
+                              "    Unigram(\"unique17\", 0),\n"
+                              "    Not {\n"
+                              "      Child: Unigram(\"even\", 0)\n"
+                              "    }\n"
+                              "  ]\n"
+                              "}");
+            for (DocId id = 0; id < c_documentCount; ++id)
+            {
+                const bool expected = environment.HasBits(id, "unique17") ||
+                                      !environment.HasBits(id, "even");
+                EXPECT_EQ(matches.count(id) == 1, expected);
+            }
+            EXPECT_EQ(matches.count(17), 1u);
+
+            // Deleted documents no longer match.
+            ASSERT_TRUE(ingestor.Delete(6));
+            matches = Execute(*executor, "Unigram(\"all\", 0)");
+            EXPECT_EQ(matches.size(), c_documentCount - 1);
+            EXPECT_EQ(matches.count(6), 0u);
+
+            // Ordering the rows by their measured densities doesn't change
+            // the matches.
+            executor->UpdateRowDensities();
+            matches = Execute(*executor,
+                              "And {\n"
+                              "  Children: [\n"
+                              "    Unigram(\"all\", 0),\n"
+                              "    Unigram(\"even\", 0),\n"
+                              "    Unigram(\"third\", 0)\n"
+                              "  ]\n"
+                              "}");
+            for (DocId id = 0; id < c_documentCount; ++id)
+            {
+                const bool expected = (id != 6) &&
+                                      environment.HasBits(id, "even") &&
+                                      environment.HasBits(id, "third");
+                EXPECT_EQ(matches.count(id) == 1, expected);
+            }
+        }
+
+
+        TEST(QueryExecutor, MatchesEveryShard)
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            TestEnvironment environment(*treatment);
+            VerifyQueries(environment);
+        }
+
+
+        // With rank 3 rows, the compiled plans rank down from rank 3 to rank
+        // 0 and skip the blocks where the rank 3 rows have no bits in common.
+        TEST(QueryExecutor, RankDown)
+        {
+            auto treatment =
+                Factories::CreateTreatmentPrivateShardRank0And3(0.1, 10.0);
+            TestEnvironment environment(*treatment);
+
+            Term even("even", 0, environment.GetConfiguration());
+            bool hasRank3 = false;
+            for (auto row : RowIdSequence(even,
+                                          environment.GetIngestor().GetShard(0).GetTermTable()))
+            {
+                hasRank3 |= (row.GetRank() == 3);
+            }
+            ASSERT_TRUE(hasRank3);
+
+            VerifyQueries(environment);
+        }
+
+
+        // The rows of a phrase only show that its terms are in the document.
+        // With term sequences, the matches are exactly the documents where
+        // the terms are adjacent and in order.
+        TEST(QueryExecutor, PhraseVerification)
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            TestEnvironment environment(*treatment, true);
+            auto executor = Factories::CreateQueryExecutor(
+                environment.GetIngestor(),
+                environment.GetConfiguration(),
+                2);
+
+            // Documents list "all", then "even", then "third".
+            std::set<DocId> matches = Execute(*executor,
+                                              "Phrase {\n"
+                                              "  StreamId: 0,\n"
+                                              "  Grams: [\n"
+                                              "    \"all\",\n"
+                                              "    \"third\"\n"
+                                              "  ]\n"
+                                              "}");
+            for (DocId id = 0; id < c_documentCount; ++id)
+            {
+                EXPECT_EQ(matches.count(id) == 1, id % 3 == 0 && id % 2 == 1);
+            }
+
+            matches = Execute(*executor,
+                              "Phrase {\n"
+                              "  StreamId: 0,\n"
+                              "  Grams: [\n"
+                              "    \"even\",\n"
+                              "    \"all\"\n"
+                              "  ]\n"
+                              "}");
+            EXPECT_TRUE(matches.empty());
+
+            // Unigrams are checked too, so the false positives of
+            // "unique17" are also removed.
+            matches = Execute(*executor,
+                              "Or {\n"
+                              "  Children: [\n"
+                              "    Phrase {\n"
+                              "      StreamId: 0,\n"
+                              "      Grams: [\n"
+                              "        \"even\",\n"
+                              "        \"all\"\n"
+                              "      ]\n"
+                              "    },\n"
+                              "    Unigram(\"unique17\", 0)\n"
+                              "  ]\n"
+                              "}");
+            EXPECT_EQ(matches, std::set<DocId>({ 17 }));
+        }
+
+
+        // A term whose fingerprint collides with "all" looks present in
+        // every document's term sequences. Under a Not, that must not
+        // remove the documents that match the phrase.
+        TEST(QueryExecutor, PhraseVerificationCollision)
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            TestEnvironment environment(*treatment, true);
+            auto executor = Factories::CreateQueryExecutor(
+                environment.GetIngestor(),
+                environment.GetConfiguration(),
+                2);
+
+            Term all("all", 0, environment.GetConfiguration());
+            const uint16_t fingerprint =
+                TermSequence::GetFingerprint(all.GetRawHash());
+            std::string collision;
+            for (unsigned i = 0; collision.empty(); ++i)
+            {
+                std::string text = "collision" + std::to_string(i);
+                Term term(text.c_str(), 0, environment.GetConfiguration());
+                if (TermSequence::GetFingerprint(term.GetRawHash()) == fingerprint)
+                {
+                    collision = text;
+                }
+            }
+
+            std::string query =
+                "And {\n"
+                "  Children: [\n"
+                "    Phrase {\n"
+                "      StreamId: 0,\n"
+                "      Grams: [\n"
+                "        \"all\",\n"
+                "        \"even\"\n"
+                "      ]\n"
+                "    },\n"
+                "    Not {\n"
+                "      Child: Unigram(\"" + collision + "\", 0)\n"
+                "    }\n"
+                "  ]\n"
+                "}";
+            std::set<DocId> matches = Execute(*executor, query.c_str());
+            EXPECT_FALSE(matches.empty());
+            for (DocId id = 0; id < c_documentCount; ++id)
+            {
+                EXPECT_EQ(matches.count(id) == 1,
+                          id % 2 == 0 &&
+                          !environment.HasBits(id, collision.c_str()));
+            }
+        }
+
+
+        // Range predicates over a bit-sliced field compile to private rank 0
+        // fact rows, so their matches are exact.
+        TEST(QueryExecutor, BitSlicedRange)
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            TestEnvironment environment(*treatment);
+            auto executor = Factories::CreateQueryExecutor(
+                environment.GetIngestor(),
+                environment.GetConfiguration(),
+                2);
+            BitSlicedField const & field = environment.GetValueField();
+            ASSERT_EQ(field.GetBitCount(), 7u);
+
+            struct Range
+            {
+                uint64_t m_low;
+                uint64_t m_high;
+            };
+            const Range ranges[] = {
+                { 20, 45 },     // Interior.
+                { 0, 9 },       // No lower bound.
+                { 64, 99 },     // No upper bound.
+                { 37, 37 },     // Single value.
+                { 90, 500 },    // Upper bound beyond the field.
+                { 0, 99 },      // Every value.
+                { 50, 40 },     // Empty.
+                { 100, 127 }    // Above every stored value.
+            };
+
+            for (auto const & range : ranges)
+            {
+                Allocator allocator(4096);
+                TermMatchNode const * node =
+                    TermMatchNode::Builder::CreateRangeNode(field,
+                                                            range.m_low,
+                                                            range.m_high,
+                                                            allocator);
+                std::set<DocId> matches = Execute(*executor, *node);
+
+                for (DocId id = 0; id < c_documentCount; ++id)
+                {
+                    const uint64_t value = id % (c_maxValue + 1);
+                    EXPECT_EQ(matches.count(id) == 1,
+                              value >= range.m_low && value <= range.m_high)
+                        << "id " << id << " in [" << range.m_low << ", "
+                        << range.m_high << "]";
+                }
+            }
+
+            // Ranges combine with terms like any other fact.
+            Allocator allocator(4096);
+            TermMatchNode::Builder builder(TermMatchNode::AndMatch, allocator);
+            builder.AddChild(
+                TermMatchNode::Builder::CreateUnigramNode("even", 0, allocator));
+            builder.AddChild(
+                TermMatchNode::Builder::CreateRangeNode(field, 10, 19, allocator));
+            std::set<DocId> matches = Execute(*executor, *builder.Complete());
+            for (DocId id = 0; id < c_documentCount; ++id)
+            {
+                const uint64_t value = id % (c_maxValue + 1);
+                const bool expected = environment.HasBits(id, "even") &&
+                                      value >= 10 && value <= 19;
+                EXPECT_EQ(matches.count(id) == 1, expected);
+            }
+        }
+
+
+        // Returns the k matches with the highest StaticRank, best first.
+        static std::vector<DocId> GetTopMatches(std::set<DocId> const & matches,
+                                                size_t k)
+        {
+            std::vector<DocId> top(matches.begin(), matches.end());
+            std::sort(top.begin(), top.end(), [] (DocId a, DocId b) {
+                return GetStaticRank(a) > GetStaticRank(b);
+            });
+            if (top.size() > k)
+            {
+                top.resize(k);
+            }
+            return top;
+        }
+
+
+        TEST(QueryExecutor, TopMatches)
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            TestEnvironment environment(*treatment);
+            auto executor = Factories::CreateQueryExecutor(
+                environment.GetIngestor(),
+                environment.GetConfiguration(),
+                2);
+
+            std::stringstream input("And {\n"
+                                    "  Children: [\n"
+                                    "    Unigram(\"even\", 0),\n"
+                                    "    Unigram(\"third\", 0)\n"
+                                    "  ]\n"
+                                    "}");
+            Allocator allocator(4096);
+            TextObjectParser parser(input, allocator, &TermMatchNode::GetType);
+            TermMatchNode const & query = TermMatchNode::Parse(parser);
+            std::set<DocId> matches = Execute(*executor, query);
+            ASSERT_GT(matches.size(), 20u);
+
+            EXPECT_EQ(executor->FindTopMatches(query, 1),
+                      GetTopMatches(matches, 1));
+            EXPECT_EQ(executor->FindTopMatches(query, 20),
+                      GetTopMatches(matches, 20));
+
+            // Asking for more than there are returns every match.
+            EXPECT_EQ(executor->FindTopMatches(query, c_documentCount),
+                      GetTopMatches(matches, c_documentCount));
+
+            EXPECT_TRUE(executor->FindTopMatches(query, 0).empty());
+
+            // Every document matches "all", so the top matches are simply
+            // the best documents.
+            std::vector<DocId> top =
+                executor->FindTopMatches(
+                    *TermMatchNode::Builder::CreateUnigramNode("all", 0, allocator),
+                    5);
+            ASSERT_EQ(top.size(), 5u);
+            for (size_t i = 0; i < top.size(); ++i)
+            {
+                EXPECT_EQ(GetStaticRank(top[i]), c_documentCount - 1 - i);
+            }
+        }
+
+
+        // When the documents are ingested from the best to the worst, the
+        // first Slice of each shard holds enough good documents that the
+        // remaining Slices are never matched.
+        TEST(QueryExecutor, TopMatchesSkipSlices)
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            TestEnvironment environment(*treatment,
+                                        false,
+                                        GetDescendingStaticRank);
+            auto executor = Factories::CreateQueryExecutor(
+                environment.GetIngestor(),
+                environment.GetConfiguration(),
+                2);
+
+            size_t sliceCount = 0;
+            for (ShardId shard = 0; shard < c_shardCount; ++shard)
+            {
+                sliceCount +=
+                    environment.GetIngestor().GetShard(shard).GetSliceBuffers().size();
+            }
+            ASSERT_GT(sliceCount, 2u * c_shardCount);
+
+            Allocator allocator(4096);
+            std::vector<DocId> top =
+                executor->FindTopMatches(
+                    *TermMatchNode::Builder::CreateUnigramNode("all", 0, allocator),
+                    10);
+            ASSERT_EQ(top.size(), 10u);
+            for (size_t i = 0; i < top.size(); ++i)
+            {
+                EXPECT_EQ(top[i], i);
+            }
+
+            EXPECT_GE(executor->GetSlicesMatched(), c_shardCount);
+            EXPECT_LE(executor->GetSlicesMatched(), 2u * c_shardCount);
+        }
+
+
+        // Rare terms only have bits in a few blocks of each Slice, so most
+        // of the program's iterations are skipped using the row summaries.
+        TEST(QueryExecutor, RareTerms)
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            TestEnvironment environment(*treatment);
+            auto executor = Factories::CreateQueryExecutor(
+                environment.GetIngestor(),
+                environment.GetConfiguration(),
+                2);
+
+            // Half of the documents match, and "even" has bits in every
+            // block, so no iterations are skipped.
+            Execute(*executor,
+                    "And {\n"
+                    "  Children: [\n"
+                    "    Unigram(\"all\", 0),\n"
+                    "    Unigram(\"even\", 0)\n"
+                    "  ]\n"
+                    "}");
+            const uint64_t denseQuadwords = executor->GetQuadwordsRead();
+            ASSERT_GT(denseQuadwords, 0u);
+
+            const DocId ids[] = { 0, 17, 511, 512, 999 };
+            for (auto rare : ids)
+            {
+                const uint64_t quadwordsBefore = executor->GetQuadwordsRead();
+
+                std::stringstream text;
+                text << "And {\n"
+                     << "  Children: [\n"
+                     << "    Unigram(\"all\", 0),\n"
+                     << "    Unigram(\"unique" << rare << "\", 0)\n"
+                     << "  ]\n"
+                     << "}";
+                std::set<DocId> matches = Execute(*executor, text.str().c_str());
+                EXPECT_EQ(matches.count(rare), 1u);
+
+                std::stringstream term;
+                term << "unique" << rare;
+                for (DocId id = 0; id < c_documentCount; ++id)
+                {
+                    EXPECT_EQ(matches.count(id) == 1,
+                              environment.HasBits(id, term.str().c_str()));
+                }
+
+                // The same two rows are read as for the dense query, but only
+                // in the few blocks where the rare term has bits.
+                const uint64_t rareQuadwords =
+                    executor->GetQuadwordsRead() - quadwordsBefore;
+                EXPECT_GT(rareQuadwords, 0u);
+                EXPECT_LT(rareQuadwords * 4, denseQuadwords);
+            }
+        }
+
+
+        TEST(QueryExecutor, AbandonedStream)
+        {
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            TestEnvironment environment(*treatment);
+            auto executor = Factories::CreateQueryExecutor(
+                environment.GetIngestor(),
+                environment.GetConfiguration(),
+                2);
+
+            std::stringstream input("Unigram(\"all\", 0)");
+            Allocator allocator(4096);
+            TextObjectParser parser(input, allocator, &TermMatchNode::GetType);
+            TermMatchNode const & query = TermMatchNode::Parse(parser);
+
+            // Streams destroyed before they are exhausted cancel their work.
+            for (size_t i = 0; i < 10; ++i)
+            {
+                auto stream = executor->Execute(query);
+                EXPECT_TRUE(stream->MoveNext());
+            }
+        }
+    }
+}
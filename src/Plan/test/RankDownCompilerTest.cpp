@@ -0,0 +1,273 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "gtest/gtest.h"
+
+#include "Allocator.h"
+#include "BitFunnel/RowMatchNode.h"
+#include "CompileNode.h"
+#include "RankDownCompiler.h"
+#include "SameExceptForWhitespace.h"
+#include "TextObjectFormatter.h"
+#include "TextObjectParser.h"
+
+
+namespace BitFunnel
+{
+    namespace RankDownCompilerUnitTest
+    {
+        struct InputOutput
+        {
+        public:
+            char const * m_input;
+            char const * m_output;
+            Rank m_initialRank;
+        };
+
+
+        // Inputs are in the form produced by the MatchTreeRewriter.
+        const InputOutput c_compileCases[] =
+        {
+            // Single row. Expect the row to be loaded.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(0, 0, 0, false),"
+                "    Report {"
+                "      Child:"
+                "    }"
+                "  ]"
+                "}",
+                "LoadRowJz {"
+                "  Row: Row(0, 0, 0, false),"
+                "  Child: Report {"
+                "    Child:"
+                "  }"
+                "}",
+                0
+            },
+
+
+            // Rows in descending rank order. Expect a RankDown where the rank
+            // changes.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(3, 6, 0, false),"
+                "    Row(2, 6, 0, false),"
+                "    Row(1, 3, 0, false),"
+                "    Row(0, 0, 0, false),"
+                "    Report {"
+                "      Child:"
+                "    }"
+                "  ]"
+                "}",
+                "LoadRowJz {"
+                "  Row: Row(3, 6, 0, false),"
+                "  Child: AndRowJz {"
+                "    Row: Row(2, 6, 0, false),"
+                "    Child: RankDown {"
+                "      Delta: 3,"
+                "      Child: AndRowJz {"
+                "        Row: Row(1, 3, 0, false),"
+                "        Child: RankDown {"
+                "          Delta: 3,"
+                "          Child: AndRowJz {"
+                "            Row: Row(0, 0, 0, false),"
+                "            Child: Report {"
+                "              Child:"
+                "            }"
+                "          }"
+                "        }"
+                "      }"
+                "    }"
+                "  }"
+                "}",
+                6
+            },
+
+
+            // Report with a not. Expect the not to be compiled with RankZero
+            // nodes.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(0, 3, 0, false),"
+                "    Report {"
+                "      Child: Not {"
+                "        Child: Row(2, 0, 6, false)"
+                "      }"
+                "    }"
+                "  ]"
+                "}",
+                "LoadRowJz {"
+                "  Row: Row(0, 3, 0, false),"
+                "  Child: RankDown {"
+                "    Delta: 3,"
+                "    Child: Report {"
+                "      Child: Not {"
+                "        Child: LoadRow(2, 0, 6, false)"
+                "      }"
+                "    }"
+                "  }"
+                "}",
+                3
+            },
+
+
+            // Or with branches that start at different ranks. Expect the
+            // lower rank branch to be ranked down to the higher rank.
+            {
+                "And {"
+                "  Children: ["
+                "    Row(2, 6, 0, false),"
+                "    Or {"
+                "      Children: ["
+                "        And {"
+                "          Children: ["
+                "            Row(5, 3, 3, false),"
+                "            Row(0, 0, 0, false),"
+                "            Report {"
+                "              Child:"
+                "            }"
+                "          ]"
+                "        },"
+                "        And {"
+                "          Children: ["
+                "            Row(4, 0, 0, false),"
+                "            Report {"
+                "              Child:"
+                "            }"
+                "          ]"
+                "        }"
+                "      ]"
+                "    }"
+                "  ]"
+                "}",
+                "LoadRowJz {"
+                "  Row: Row(2, 6, 0, false),"
+                "  Child: RankDown {"
+                "    Delta: 3,"
+                "    Child: Or {"
+                "      Children: ["
+                "        AndRowJz {"
+                "          Row: Row(5, 3, 3, false),"
+                "          Child: RankDown {"
+                "            Delta: 3,"
+                "            Child: AndRowJz {"
+                "              Row: Row(0, 0, 0, false),"
+                "              Child: Report {"
+                "                Child:"
+                "              }"
+                "            }"
+                "          }"
+                "        },"
+                "        RankDown {"
+                "          Delta: 3,"
+                "          Child: AndRowJz {"
+                "            Row: Row(4, 0, 0, false),"
+                "            Child: Report {"
+                "              Child:"
+                "            }"
+                "          }"
+                "        }"
+                "      ]"
+                "    }"
+                "  }"
+                "}",
+                6
+            },
+
+
+            // Or at the root. Expect both branches to load the accumulator.
+            {
+                "Or {"
+                "  Children: ["
+                "    And {"
+                "      Children: ["
+                "        Row(0, 0, 0, false),"
+                "        Report {"
+                "          Child:"
+                "        }"
+                "      ]"
+                "    },"
+                "    And {"
+                "      Children: ["
+                "        Row(1, 0, 0, false),"
+                "        Report {"
+                "          Child:"
+                "        }"
+                "      ]"
+                "    }"
+                "  ]"
+                "}",
+                "Or {"
+                "  Children: ["
+                "    LoadRowJz {"
+                "      Row: Row(0, 0, 0, false),"
+                "      Child: Report {"
+                "        Child:"
+                "      }"
+                "    },"
+                "    LoadRowJz {"
+                "      Row: Row(1, 0, 0, false),"
+                "      Child: Report {"
+                "        Child:"
+                "      }"
+                "    }"
+                "  ]"
+                "}",
+                0
+            },
+        };
+
+
+        void VerifyCase(InputOutput const & testCase)
+        {
+            std::stringstream input(testCase.m_input);
+
+            Allocator allocator(1024 * 4);
+            TextObjectParser parser(input, allocator, &RowPlanBase::GetType);
+            RowMatchNode const & root = RowMatchNode::Parse(parser);
+
+            RankDownCompiler compiler(allocator);
+            CompileNode const & compiled = compiler.Compile(root);
+
+            std::stringstream output;
+            TextObjectFormatter formatter(output);
+            compiled.Format(formatter);
+
+            EXPECT_TRUE(SameExceptForWhitespace(output.str().c_str(), testCase.m_output));
+            EXPECT_EQ(compiler.GetInitialRank(), testCase.m_initialRank);
+        }
+
+
+        TEST(RankDownCompiler, Basic)
+        {
+            for (unsigned i = 0; i < sizeof(c_compileCases) / sizeof(InputOutput); ++i)
+            {
+                VerifyCase(c_compileCases[i]);
+            }
+        }
+    }
+}
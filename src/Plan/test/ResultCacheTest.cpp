@@ -0,0 +1,88 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "ResultCache.h"
+
+
+namespace BitFunnel
+{
+    namespace ResultCacheUnitTest
+    {
+        TEST(ResultCache, Basic)
+        {
+            ResultCache cache(100);
+            std::vector<DocId> matches;
+
+            EXPECT_FALSE(cache.TryGet(1, 10, matches));
+
+            cache.Add(1, 10, { 5, 6, 7 });
+            cache.Add(1, 11, {});
+
+            // Cached matches are appended.
+            matches.push_back(4);
+            EXPECT_TRUE(cache.TryGet(1, 10, matches));
+            EXPECT_EQ(matches, std::vector<DocId>({ 4, 5, 6, 7 }));
+
+            // Empty results are cached too.
+            matches.clear();
+            EXPECT_TRUE(cache.TryGet(1, 11, matches));
+            EXPECT_TRUE(matches.empty());
+
+            // A new generation or another plan misses.
+            EXPECT_FALSE(cache.TryGet(1, 12, matches));
+            EXPECT_FALSE(cache.TryGet(2, 10, matches));
+
+            EXPECT_EQ(cache.GetHitCount(), 2u);
+            EXPECT_EQ(cache.GetMissCount(), 3u);
+        }
+
+
+        TEST(ResultCache, EvictsLeastRecentlyUsed)
+        {
+            // Each entry costs one more than its number of matches.
+            ResultCache cache(10);
+            std::vector<DocId> matches;
+
+            cache.Add(1, 1, { 1, 2, 3 });
+            cache.Add(1, 2, { 1, 2, 3 });
+            EXPECT_TRUE(cache.TryGet(1, 1, matches));
+
+            // Generation 2 is the least recently used.
+            cache.Add(1, 3, { 1, 2, 3 });
+            EXPECT_EQ(cache.GetSize(), 2u);
+            EXPECT_FALSE(cache.TryGet(1, 2, matches));
+            EXPECT_TRUE(cache.TryGet(1, 1, matches));
+            EXPECT_TRUE(cache.TryGet(1, 3, matches));
+
+            // Matches larger than the cache are not cached.
+            cache.Add(1, 4, std::vector<DocId>(10));
+            EXPECT_FALSE(cache.TryGet(1, 4, matches));
+            EXPECT_EQ(cache.GetSize(), 2u);
+        }
+    }
+}
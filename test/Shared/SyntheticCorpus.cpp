@@ -0,0 +1,125 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdio>                       // sprintf(), std::remove().
+#include <sstream>
+#include <string>
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IIndexedIdfTable.h"
+#include "BitFunnel/Index/ITermTableBuilder.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/Term.h"
+#include "DocumentFrequencyTable.h"
+#include "SyntheticCorpus.h"
+
+
+namespace BitFunnel
+{
+    // The TermTable files are written to and loaded from here.
+    static char const * c_termTableDirectory = ".";
+
+
+    std::vector<char> CreateSyntheticChunk(size_t firstId,
+                                           size_t documentCount,
+                                           bool uniqueTerms)
+    {
+        std::stringstream data;
+        for (size_t i = firstId; i < firstId + documentCount; ++i)
+        {
+            char id[17];
+            sprintf(id, "%016zx", i);
+            data << id << '\0';
+            data << "00" << '\0';
+            data << "all" << '\0';
+            if (i % 2 == 0)
+            {
+                data << "even" << '\0';
+            }
+            if (i % 3 == 0)
+            {
+                data << "third" << '\0';
+            }
+            if (uniqueTerms)
+            {
+                data << "unique" << i << '\0';
+            }
+            data << '\0' << '\0';
+        }
+        data << '\0';
+
+        std::string text = data.str();
+        return std::vector<char>(text.begin(), text.end());
+    }
+
+
+    std::unique_ptr<ITermTableCollection>
+        CreateSyntheticTermTables(ITermTreatment const & treatment,
+                                  IFactSet const & facts,
+                                  ShardId shardCount)
+    {
+        auto idfTable = Factories::CreateIndexedIdfTable();
+        auto config = Factories::CreateConfiguration(1, false, *idfTable);
+
+        DocumentFrequencyTable terms;
+        terms.AddEntry(
+            IDocumentFrequencyTable::Entry(Term("all", 0, *config), 1.0));
+        terms.AddEntry(
+            IDocumentFrequencyTable::Entry(Term("even", 0, *config), 0.5));
+        terms.AddEntry(
+            IDocumentFrequencyTable::Entry(Term("third", 0, *config), 0.334));
+
+        auto termTable = Factories::CreateTermTable();
+        Factories::CreateTermTableBuilder(0.1,
+                                          0.0001,
+                                          treatment,
+                                          terms,
+                                          facts,
+                                          *termTable,
+                                          1);
+
+        auto fileManager =
+            Factories::CreateFileManager(c_termTableDirectory,
+                                         c_termTableDirectory,
+                                         c_termTableDirectory);
+        for (ShardId shard = 0; shard < shardCount; ++shard)
+        {
+            termTable->Write(*fileManager->TermTable(shard).OpenForWrite());
+        }
+
+        auto termTables =
+            Factories::CreateTermTableCollection(*fileManager, shardCount);
+
+        // The TermTables map the files, which may be removed while mapped
+        // on POSIX. Windows will refuse and leave the files behind.
+        for (ShardId shard = 0; shard < shardCount; ++shard)
+        {
+            std::remove(fileManager->TermTable(shard).GetName().c_str());
+        }
+
+        return termTables;
+    }
+}
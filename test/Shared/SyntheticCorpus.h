@@ -0,0 +1,54 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>                      // size_t parameter.
+#include <memory>                       // std::unique_ptr return value.
+#include <vector>                       // std::vector return value.
+
+#include "BitFunnel/BitFunnelTypes.h"   // ShardId parameter.
+
+
+namespace BitFunnel
+{
+    class IFactSet;
+    class ITermTableCollection;
+    class ITermTreatment;
+
+    // Returns a chunk holding the documents with ids in
+    // [firstId, firstId + documentCount). Document i contains "all", "even"
+    // when i is even, "third" when i is a multiple of 3 and, if uniqueTerms
+    // is set, a term "unique<i>" that no other document contains.
+    std::vector<char> CreateSyntheticChunk(size_t firstId,
+                                           size_t documentCount,
+                                           bool uniqueTerms);
+
+    // Builds a TermTable where "all", "even" and "third" get explicit rows
+    // and other terms get adhoc rows, as chosen by the treatment, along
+    // with a row for each fact. Every one of the shardCount shards loads the
+    // same TermTable.
+    std::unique_ptr<ITermTableCollection>
+        CreateSyntheticTermTables(ITermTreatment const & treatment,
+                                  IFactSet const & facts,
+                                  ShardId shardCount);
+}
@@ -0,0 +1,103 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/Helpers.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IDocumentDataSchema.h"
+#include "BitFunnel/Index/IIndexedIdfTable.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/ISliceBufferAllocator.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "ChunkIngestor.h"
+#include "TestIngestor.h"
+
+
+namespace BitFunnel
+{
+    TestIngestor::TestIngestor(std::unique_ptr<ITermTableCollection> termTables,
+                               std::unique_ptr<IDocumentDataSchema> schema,
+                               std::unique_ptr<IShardDefinition> shardDefinition,
+                               size_t blockCount,
+                               bool generateStatistics,
+                               double statisticsErrorBound,
+                               size_t heavyHitterCount)
+      : m_termTables(std::move(termTables)),
+        m_schema(std::move(schema)),
+        m_recycler(Factories::CreateRecycler()),
+        m_recyclerThread([this] () { m_recycler->Run(); }),
+        m_shardDefinition(std::move(shardDefinition)),
+        m_idfTable(Factories::CreateIndexedIdfTable()),
+        m_configuration(Factories::CreateConfiguration(1, false, *m_idfTable)),
+        m_allocator(
+            Factories::CreateSliceBufferAllocator(
+                GetMinimumBlockSize(*m_schema, m_termTables->GetTermTable(0)),
+                blockCount)),
+        m_ingestor(
+            (heavyHitterCount == 0) ?
+                Factories::CreateIngestor(*m_schema,
+                                          *m_recycler,
+                                          *m_termTables,
+                                          *m_shardDefinition,
+                                          *m_allocator,
+                                          generateStatistics) :
+                Factories::CreateIngestor(*m_schema,
+                                          *m_recycler,
+                                          *m_termTables,
+                                          *m_shardDefinition,
+                                          *m_allocator,
+                                          statisticsErrorBound,
+                                          heavyHitterCount))
+    {
+    }
+
+
+    TestIngestor::~TestIngestor()
+    {
+        m_ingestor->Shutdown();
+        m_recycler->Shutdown();
+        m_recyclerThread.join();
+    }
+
+
+    void TestIngestor::Ingest(std::vector<char> const & chunk)
+    {
+        // NOTE: The act of constructing a ChunkIngestor causes the bytes in
+        // chunk to be parsed into documents and ingested.
+        ChunkIngestor(chunk, *m_configuration, *m_ingestor);
+    }
+
+
+    IConfiguration const & TestIngestor::GetConfiguration() const
+    {
+        return *m_configuration;
+    }
+
+
+    IIngestor& TestIngestor::GetIngestor() const
+    {
+        return *m_ingestor;
+    }
+}
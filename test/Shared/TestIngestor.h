@@ -0,0 +1,88 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>                      // size_t parameter.
+#include <memory>                       // std::unique_ptr member.
+#include <thread>                       // std::thread member.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IConfiguration;
+    class IDocumentDataSchema;
+    class IIndexedIdfTable;
+    class IIngestor;
+    class IRecycler;
+    class IShardDefinition;
+    class ISliceBufferAllocator;
+    class ITermTableCollection;
+
+    //*************************************************************************
+    //
+    // TestIngestor
+    //
+    // Wires up an Ingestor for tests, along with the TermTables, schema,
+    // IRecycler, shard definition, configuration and slice buffers it uses.
+    // The IRecycler runs on its own thread, since Slice list replacements
+    // are recycled. The destructor shuts the Ingestor and IRecycler down.
+    //
+    //*************************************************************************
+    class TestIngestor : private NonCopyable
+    {
+    public:
+        // The shardDefinition must already hold its shards. blockCount is
+        // the number of minimum size slice buffers. When heavyHitterCount is
+        // not 0, approximate statistics are gathered with the given error
+        // bound. Otherwise statistics are exact, if generateStatistics is set.
+        TestIngestor(std::unique_ptr<ITermTableCollection> termTables,
+                     std::unique_ptr<IDocumentDataSchema> schema,
+                     std::unique_ptr<IShardDefinition> shardDefinition,
+                     size_t blockCount,
+                     bool generateStatistics = false,
+                     double statisticsErrorBound = 0.0,
+                     size_t heavyHitterCount = 0);
+
+        ~TestIngestor();
+
+        // Ingests the documents in chunk on the calling thread.
+        void Ingest(std::vector<char> const & chunk);
+
+        IConfiguration const & GetConfiguration() const;
+        IIngestor& GetIngestor() const;
+
+    private:
+        std::unique_ptr<ITermTableCollection> m_termTables;
+        std::unique_ptr<IDocumentDataSchema> m_schema;
+        std::unique_ptr<IRecycler> m_recycler;
+        std::thread m_recyclerThread;
+        std::unique_ptr<IShardDefinition> m_shardDefinition;
+        std::unique_ptr<IIndexedIdfTable> m_idfTable;
+        std::unique_ptr<IConfiguration> m_configuration;
+        std::unique_ptr<ISliceBufferAllocator> m_allocator;
+        std::unique_ptr<IIngestor> m_ingestor;
+    };
+}
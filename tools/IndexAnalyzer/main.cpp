@@ -0,0 +1,267 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IngestChunks.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Term.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "FalsePositiveAnalyzer.h"
+#include "RowDensityAnalyzer.h"
+
+
+namespace BitFunnel
+{
+    // Returns a vector with one entry for each line in the file.
+    static std::vector<std::string> ReadLines(char const * fileName)
+    {
+        std::ifstream file(fileName);
+        if (!file.is_open())
+        {
+            std::stringstream message;
+            message << "Failed to open '" << fileName << "'";
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line)) {
+            lines.push_back(std::move(line));
+        }
+
+        return lines;
+    }
+
+
+    // Converts each line of the query log into a conjunction of terms in
+    // stream 0. Characters other than letters and digits, such as query
+    // operators, separate words.
+    static std::vector<std::vector<Term>>
+        ParseQueries(std::vector<std::string> const & lines,
+                     size_t maxQueryCount,
+                     IConfiguration const & configuration)
+    {
+        std::vector<std::vector<Term>> queries;
+        for (auto const & line : lines)
+        {
+            if (queries.size() == maxQueryCount)
+            {
+                break;
+            }
+
+            std::vector<Term> query;
+            size_t i = 0;
+            while (i < line.size())
+            {
+                while (i < line.size() &&
+                       !std::isalnum(static_cast<unsigned char>(line[i])))
+                {
+                    ++i;
+                }
+
+                size_t start = i;
+                while (i < line.size() &&
+                       std::isalnum(static_cast<unsigned char>(line[i])))
+                {
+                    ++i;
+                }
+
+                if (i > start)
+                {
+                    std::string word(line, start, i - start);
+                    query.push_back(Term(word.c_str(), 0, configuration));
+                }
+            }
+
+            if (!query.empty())
+            {
+                queries.push_back(query);
+            }
+        }
+
+        return queries;
+    }
+
+
+    static void Analyze(char const * intermediateDirectory,
+                        char const * chunkListFileName,
+                        char const * queryLogFileName,
+                        size_t maxQueryCount,
+                        int gramSize,
+                        size_t threadCount)
+    {
+        auto index = Factories::CreateSimpleIndex(intermediateDirectory,
+                                                  gramSize,
+                                                  false);
+        index->StartIndex(false);
+
+        IConfiguration const & configuration = index->GetConfiguration();
+        IIngestor & ingestor = index->GetIngestor();
+
+        std::vector<std::string> filePaths = ReadLines(chunkListFileName);
+
+        std::cout << "Ingesting " << filePaths.size() << " files." << std::endl;
+
+        Stopwatch stopwatch;
+        IngestChunks(filePaths, configuration, ingestor, threadCount);
+        std::cout << "  Ingestion time = " << stopwatch.ElapsedTime() << std::endl;
+
+        for (size_t shard = 0; shard < ingestor.GetShardCount(); ++shard)
+        {
+            std::cout << "Shard " << shard << std::endl;
+
+            Stopwatch densityStopwatch;
+            RowDensityAnalyzer densities(ingestor.GetShard(shard),
+                                         ingestor.GetTokenManager(),
+                                         threadCount);
+            densities.Print(std::cout);
+            std::cout << "  Analysis time = "
+                      << densityStopwatch.ElapsedTime() << std::endl;
+
+            std::stringstream fileName;
+            fileName << intermediateDirectory
+                     << "/RowDensities-" << shard << ".csv";
+            std::ofstream densityFile(fileName.str());
+            densities.Write(densityFile);
+        }
+
+        auto queries = ParseQueries(ReadLines(queryLogFileName),
+                                    maxQueryCount,
+                                    configuration);
+        std::cout << "Matching " << queries.size() << " queries." << std::endl;
+
+        Stopwatch matchStopwatch;
+        FalsePositiveAnalyzer falsePositives(queries);
+        falsePositives.AddChunkFiles(filePaths, configuration, threadCount);
+        falsePositives.Analyze(ingestor, threadCount);
+        falsePositives.Print(std::cout);
+        std::cout << "  Analysis time = "
+                  << matchStopwatch.ElapsedTime() << std::endl;
+
+        std::string fileName(intermediateDirectory);
+        fileName.append("/FalsePositives.csv");
+        std::ofstream falsePositiveFile(fileName);
+        falsePositives.Write(falsePositiveFile);
+
+        index->StopIndex();
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    CmdLine::CmdLineParser parser(
+        "IndexAnalyzer",
+        "Ingest documents, then measure row densities and the false positive "
+        "rate for a sample of queries.");
+
+    CmdLine::RequiredParameter<char const *> chunkListFileName(
+        "chunkListFileName",
+        "Path to a file containing the paths to the chunk files to be ingested. "
+        "One chunk file per line. Paths are relative to working directory.");
+
+    CmdLine::RequiredParameter<char const *> tempPath(
+        "tempPath",
+        "Path to a tmp directory with the TermTable and IndexedIdfTable. "
+        "Results are written here as RowDensities-<shard>.csv and "
+        "FalsePositives.csv.");
+
+    CmdLine::RequiredParameter<char const *> queryLog(
+        "queryLog",
+        "Path to a query log with one query per line. Each query is treated "
+        "as the conjunction of its words.");
+
+    CmdLine::OptionalParameter<int> queryCount(
+        "queries",
+        "Number of queries to sample from the start of the query log.",
+        1000,
+        CmdLine::GreaterThan(0));
+
+    // TODO: This parameter should be unsigned, but it doesn't seem to work
+    // with CmdLineParser.
+    CmdLine::OptionalParameter<int> gramSize(
+        "gramsize",
+        "Set the maximum ngram size for phrases.",
+        1u);
+
+    CmdLine::OptionalParameter<int> threadCount(
+        "threads",
+        "Number of threads for ingestion and analysis.",
+        1,
+        CmdLine::GreaterThan(0));
+
+    parser.AddParameter(chunkListFileName);
+    parser.AddParameter(tempPath);
+    parser.AddParameter(queryLog);
+    parser.AddParameter(queryCount);
+    parser.AddParameter(gramSize);
+    parser.AddParameter(threadCount);
+
+    int returnCode = 0;
+
+    if (parser.TryParse(std::cout, argc, argv))
+    {
+        try
+        {
+            BitFunnel::Analyze(tempPath,
+                               chunkListFileName,
+                               queryLog,
+                               static_cast<size_t>(static_cast<int>(queryCount)),
+                               gramSize,
+                               static_cast<size_t>(static_cast<int>(threadCount)));
+            returnCode = 0;
+        }
+        catch (BitFunnel::RecoverableError const & e)
+        {
+            std::cout << "Error: " << e.what() << std::endl;
+            returnCode = 1;
+        }
+        catch (...)
+        {
+            std::cout << "Unexpected error.";
+            returnCode = 1;
+        }
+    }
+    else
+    {
+        parser.Usage(std::cout, argv[0]);
+        returnCode = 1;
+    }
+
+    return returnCode;
+}
@@ -25,8 +25,8 @@
 #include <memory>                               // std::unique_ptr embedded.
 #include <vector>                               // std::vector embedded.
 
-#include "BitFunnel/Utilities/BlockingQueue.h"  // BlockingQueue embedded.
 #include "BitFunnel/Utilities/IThreadManager.h" // IThreadBase base class.
+#include "BitFunnel/Utilities/MpmcQueue.h"      // MpmcQueue embedded.
 
 
 namespace BitFunnel
@@ -59,6 +59,8 @@ namespace BitFunnel
         std::vector<IThreadBase*> m_threads;
         std::unique_ptr<IThreadManager> m_threadManager;
 
-        BlockingQueue<std::unique_ptr<ITask>> m_queue;
+        // DESIGN NOTE: MpmcQueue rather than BlockingQueue so that dispatching
+        // a query does not take a lock when threads are busy.
+        MpmcQueue<std::unique_ptr<ITask>> m_queue;
     };
 }
@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+
+
+namespace BitFunnel
+{
+    namespace Microbenchmarks
+    {
+        double TimeOnThreads(size_t threadCount,
+                             std::function<void(size_t)> const & body)
+        {
+            std::atomic<size_t> ready(0);
+            std::atomic<bool> go(false);
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < threadCount; ++t)
+            {
+                threads.emplace_back([&ready, &go, &body, t]()
+                {
+                    ++ready;
+                    while (!go)
+                    {
+                        std::this_thread::yield();
+                    }
+                    body(t);
+                });
+            }
+
+            while (ready != threadCount)
+            {
+                std::this_thread::yield();
+            }
+
+            Stopwatch stopwatch;
+            go = true;
+
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            return stopwatch.ElapsedTime();
+        }
+    }
+}
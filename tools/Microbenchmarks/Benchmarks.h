@@ -0,0 +1,82 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>      // size_t parameter.
+#include <functional>   // std::function parameter.
+#include <iosfwd>       // std::ostream parameter.
+
+
+namespace BitFunnel
+{
+    namespace Microbenchmarks
+    {
+        // Starts threadCount threads, each running body(threadId), and
+        // returns the number of seconds between the moment all threads have
+        // been released and the moment the last one finishes. Thread startup
+        // cost is excluded from the measurement.
+        double TimeOnThreads(size_t threadCount,
+                             std::function<void(size_t)> const & body);
+
+        // Measures AllocateBlock()/ReleaseBlock() throughput of the
+        // IBlockAllocator for thread counts 1..maxThreadCount, comparing
+        // against a reference allocator that guards its free list with a
+        // std::mutex.
+        void RunBlockAllocatorBenchmark(std::ostream& output,
+                                        size_t maxThreadCount,
+                                        size_t iterations);
+
+        // Measures the cost of requesting and releasing a Token from the
+        // mutex-based TokenManager and from the EpochManager for thread
+        // counts 1..maxThreadCount.
+        void RunTokenBenchmark(std::ostream& output,
+                               size_t maxThreadCount,
+                               size_t iterations);
+
+        // Measures the rate at which postings are resolved to RowIds and
+        // written to a row buffer when each posting enumerates a
+        // RowIdSequence. Then measures the rate at which documents are
+        // ingested through DocumentHandle::AddPosting(), which resolves
+        // through the thread's ResolvedTermCache, when the cache is looked
+        // up for each posting and when it is looked up once per document.
+        void RunPostingBenchmark(std::ostream& output,
+                                 size_t maxThreadCount,
+                                 size_t iterations);
+
+        // Measures item throughput of BlockingQueue and MpmcQueue with
+        // 1..maxThreadCount producers and as many consumers.
+        void RunQueueBenchmark(std::ostream& output,
+                               size_t maxThreadCount,
+                               size_t iterations);
+
+        // Ingests min(iterations, 100000) synthetic documents and counts the
+        // row quadwords read by two and three term conjunctions, first with
+        // the rows in query order, then with the sparsest rows first as
+        // measured with maxThreadCount threads, and finally with the sparsest
+        // rows first and the row summaries used to skip dead blocks.
+        void RunRowOrderingBenchmark(std::ostream& output,
+                                     size_t maxThreadCount,
+                                     size_t iterations);
+    }
+}
@@ -0,0 +1,151 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/IBlockAllocator.h"
+
+
+namespace BitFunnel
+{
+    namespace Microbenchmarks
+    {
+        //*********************************************************************
+        //
+        // MutexBlockAllocator is the reference point for the benchmark. It
+        // keeps its free list in the first quadword of each block and guards
+        // it with a single std::mutex, which is how BlockAllocator used to
+        // work before its free list became lock-free.
+        //
+        //*********************************************************************
+        class MutexBlockAllocator : public IBlockAllocator
+        {
+        public:
+            MutexBlockAllocator(size_t blockSize, size_t totalBlockCount)
+                : m_blockSize(blockSize),
+                  m_pool(blockSize / sizeof(uint64_t) * totalBlockCount),
+                  m_freeListHead(nullptr)
+            {
+                for (size_t block = 0; block < totalBlockCount; ++block)
+                {
+                    ReleaseBlock(m_pool.data() + block * blockSize / sizeof(uint64_t));
+                }
+            }
+
+            virtual uint64_t* AllocateBlock() override
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_freeListHead == nullptr)
+                {
+                    throw FatalError("Out of memory");
+                }
+                uint64_t * block = m_freeListHead;
+                m_freeListHead = reinterpret_cast<uint64_t*>(*block);
+                return block;
+            }
+
+            virtual void ReleaseBlock(uint64_t* block) override
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                *reinterpret_cast<uint64_t**>(block) = m_freeListHead;
+                m_freeListHead = block;
+            }
+
+            virtual size_t GetBlockSize() const override
+            {
+                return m_blockSize;
+            }
+
+        private:
+            const size_t m_blockSize;
+            std::vector<uint64_t> m_pool;
+            std::mutex m_lock;
+            uint64_t * m_freeListHead;
+        };
+
+
+        // Each thread holds a small working set of blocks, the way a shard
+        // holds a few slice buffers, and repeatedly releases and reallocates
+        // one of them.
+        static const size_t c_blocksPerThread = 4;
+        static const size_t c_blockSize = 64;
+
+
+        static double MeasureThroughput(IBlockAllocator& allocator,
+                                        size_t threadCount,
+                                        size_t iterations)
+        {
+            const double seconds = TimeOnThreads(threadCount, [&](size_t)
+            {
+                uint64_t* blocks[c_blocksPerThread];
+                for (size_t b = 0; b < c_blocksPerThread; ++b)
+                {
+                    blocks[b] = allocator.AllocateBlock();
+                }
+
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    const size_t b = i % c_blocksPerThread;
+                    allocator.ReleaseBlock(blocks[b]);
+                    blocks[b] = allocator.AllocateBlock();
+                    *blocks[b] = i;
+                }
+
+                for (size_t b = 0; b < c_blocksPerThread; ++b)
+                {
+                    allocator.ReleaseBlock(blocks[b]);
+                }
+            });
+
+            // Each iteration performs one allocation and one release.
+            return 2.0 * iterations * threadCount / seconds;
+        }
+
+
+        void RunBlockAllocatorBenchmark(std::ostream& output,
+                                        size_t maxThreadCount,
+                                        size_t iterations)
+        {
+            const size_t blockCount = c_blocksPerThread * maxThreadCount;
+
+            output << "threads,lockFreeOpsPerSecond,mutexOpsPerSecond" << std::endl;
+
+            for (size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount)
+            {
+                auto lockFree(Factories::CreateBlockAllocator(c_blockSize, blockCount));
+                MutexBlockAllocator mutex(c_blockSize, blockCount);
+
+                output << threadCount
+                       << "," << MeasureThroughput(*lockFree, threadCount, iterations)
+                       << "," << MeasureThroughput(mutex, threadCount, iterations)
+                       << std::endl;
+            }
+        }
+    }
+}
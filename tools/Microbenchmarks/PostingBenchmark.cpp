@@ -0,0 +1,357 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Index/DocumentHandle.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/Helpers.h"
+#include "BitFunnel/Index/IDocument.h"
+#include "BitFunnel/Index/IDocumentDataSchema.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/ISliceBufferAllocator.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/ResolvedTermCache.h"
+#include "BitFunnel/Row.h"
+#include "BitFunnel/RowIdSequence.h"
+#include "BitFunnel/Term.h"
+
+
+namespace BitFunnel
+{
+    namespace Microbenchmarks
+    {
+        static const Term::Hash c_firstHash = 1000ull;
+        static const size_t c_explicitTermCount = 50000;
+        static const size_t c_vocabularySize = 2 * c_explicitTermCount;
+        static const size_t c_maxDistinctPostings = 1 << 20;
+        static const size_t c_postingsPerDocument = 256;
+        static const RowIndex c_rowCount = 4096;
+
+
+        // Explicit terms get one to three rank 0 rows. Adhoc terms get two
+        // rank 0 rows and one rank 3 row.
+        static std::unique_ptr<ITermTable2> CreateTermTable()
+        {
+            auto termTable = Factories::CreateTermTable();
+
+            for (size_t i = 0; i < c_explicitTermCount; ++i)
+            {
+                termTable->OpenTerm();
+                for (size_t r = 0; r <= (i % 3); ++r)
+                {
+                    termTable->AddRowId(RowId(0, 0, (i + r) % c_rowCount));
+                }
+                termTable->CloseTerm(c_firstHash + i);
+            }
+
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                for (Term::GramSize gramSize = 0; gramSize <= Term::c_maxGramSize; ++gramSize)
+                {
+                    termTable->OpenTerm();
+                    termTable->AddRowId(RowId(0, 0, 0));
+                    termTable->AddRowId(RowId(0, 0, 0));
+                    termTable->AddRowId(RowId(0, 3, 0));
+                    termTable->CloseAdhocTerm(idf, gramSize);
+                }
+            }
+
+            termTable->SetRowCounts(0, c_rowCount, c_rowCount);
+            termTable->SetRowCounts(3, 0, c_rowCount);
+            termTable->SetFactCount(0);
+            termTable->Seal();
+
+            return termTable;
+        }
+
+
+        // Draws postingCount terms from a vocabulary with a Zipfian
+        // distribution, like the words of natural language text. Even ranks
+        // are explicit terms and odd ranks are adhoc terms.
+        static std::vector<Term> CreatePostings(size_t postingCount)
+        {
+            std::vector<double> cumulative(c_vocabularySize);
+            double total = 0;
+            for (size_t rank = 0; rank < c_vocabularySize; ++rank)
+            {
+                total += 1.0 / (rank + 1);
+                cumulative[rank] = total;
+            }
+
+            std::mt19937 generator(12345);
+            std::uniform_real_distribution<double> distribution(0, total);
+
+            std::vector<Term> postings;
+            postings.reserve(postingCount);
+            for (size_t i = 0; i < postingCount; ++i)
+            {
+                const size_t rank = static_cast<size_t>(
+                    std::upper_bound(cumulative.begin(),
+                                     cumulative.end(),
+                                     distribution(generator))
+                    - cumulative.begin());
+
+                if (rank % 2 == 0)
+                {
+                    postings.push_back(Term(c_firstHash + rank / 2, 0, 0));
+                }
+                else
+                {
+                    postings.push_back(
+                        Term(c_firstHash + c_explicitTermCount + rank, 0, 40));
+                }
+            }
+
+            return postings;
+        }
+
+
+        // Every shard uses the benchmark's TermTable.
+        class PostingTermTables : public ITermTableCollection
+        {
+        public:
+            PostingTermTables(std::unique_ptr<ITermTable2> termTable)
+              : m_termTable(std::move(termTable))
+            {
+            }
+
+            virtual ITermTable2 & GetTermTable(ShardId) const override
+            {
+                return *m_termTable;
+            }
+
+            virtual size_t size() const override
+            {
+                return 1;
+            }
+
+        private:
+            std::unique_ptr<ITermTable2> m_termTable;
+        };
+
+
+        // A document made of a run of postings. Ingest() either passes the
+        // thread's ResolvedTermCache to each AddPosting() call, as Document
+        // does, or lets each call look it up.
+        class PostingDocument : public IDocument
+        {
+        public:
+            PostingDocument(Term const * begin,
+                            Term const * end,
+                            bool resolveCachePerDocument)
+              : m_begin(begin),
+                m_end(end),
+                m_resolveCachePerDocument(resolveCachePerDocument)
+            {
+            }
+
+            virtual size_t GetPostingCount() const override
+            {
+                return static_cast<size_t>(m_end - m_begin);
+            }
+
+            virtual size_t GetSourceByteSize() const override
+            {
+                return 0;
+            }
+
+            virtual void Ingest(DocumentHandle handle) const override
+            {
+                if (m_resolveCachePerDocument)
+                {
+                    ResolvedTermCache& cache = handle.GetResolvedTermCache();
+                    for (Term const * term = m_begin; term != m_end; ++term)
+                    {
+                        handle.AddPosting(*term, cache);
+                    }
+                }
+                else
+                {
+                    for (Term const * term = m_begin; term != m_end; ++term)
+                    {
+                        handle.AddPosting(*term);
+                    }
+                }
+            }
+
+            // The postings are supplied to the constructor.
+            virtual void OpenStream(Term::StreamId) override {}
+            virtual void AddTerm(char const *) override {}
+            virtual void CloseStream() override {}
+            virtual void CloseDocument(size_t) override {}
+
+        private:
+            Term const * m_begin;
+            Term const * m_end;
+            bool m_resolveCachePerDocument;
+        };
+
+
+        // Ingests documents of c_postingsPerDocument postings on threadCount
+        // threads, through DocumentHandle::AddPosting() and Slice, into a
+        // new Ingestor. Returns postings per second.
+        static double MeasureIngestion(ITermTableCollection const & termTables,
+                                       std::vector<Term> const & postings,
+                                       size_t threadCount,
+                                       size_t iterations,
+                                       bool resolveCachePerDocument)
+        {
+            const size_t documentsPerThread =
+                (std::max)(iterations / c_postingsPerDocument, size_t(1));
+            ITermTable2 const & termTable = termTables.GetTermTable(0);
+
+            auto schema = Factories::CreateDocumentDataSchema();
+            auto recycler = Factories::CreateRecycler();
+            std::thread recyclerThread([&recycler] () { recycler->Run(); });
+            auto shardDefinition = Factories::CreateShardDefinition();
+
+            const size_t documentsPerBlock =
+                Row::DocumentsInRank0Row(1, termTable.GetMaxRankUsed());
+            auto allocator = Factories::CreateSliceBufferAllocator(
+                GetMinimumBlockSize(*schema, termTable),
+                documentsPerThread * threadCount / documentsPerBlock + 16);
+
+            auto ingestor = Factories::CreateIngestor(*schema,
+                                                      *recycler,
+                                                      termTables,
+                                                      *shardDefinition,
+                                                      *allocator,
+                                                      false);
+
+            const size_t runCount = postings.size() - c_postingsPerDocument;
+            const double seconds = TimeOnThreads(threadCount, [&](size_t thread)
+            {
+                for (size_t i = 0; i < documentsPerThread; ++i)
+                {
+                    const DocId id = thread * documentsPerThread + i;
+                    Term const * begin =
+                        postings.data() + (id * c_postingsPerDocument) % runCount;
+                    PostingDocument document(begin,
+                                             begin + c_postingsPerDocument,
+                                             resolveCachePerDocument);
+                    ingestor->Add(id, document);
+                }
+            });
+
+            ingestor->Shutdown();
+            recycler->Shutdown();
+            recyclerThread.join();
+
+            return static_cast<double>(documentsPerThread) *
+                   c_postingsPerDocument * threadCount / seconds;
+        }
+
+
+        // Runs AddPosting-like work on threadCount threads. Each thread calls
+        // createResolver() once to get a resolver(term, sink) that passes
+        // each of term's RowIds to sink. Returns postings per second.
+        template <typename CREATE_RESOLVER>
+        static double MeasureThroughput(std::vector<Term> const & postings,
+                                        size_t threadCount,
+                                        size_t iterations,
+                                        CREATE_RESOLVER createResolver)
+        {
+            std::atomic<uint64_t> checksum(0);
+
+            const double seconds = TimeOnThreads(threadCount, [&](size_t)
+            {
+                auto resolver = createResolver();
+
+                // Stand in for the slice's row tables.
+                std::vector<uint64_t> bits(c_rowCount);
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    resolver(postings[i % postings.size()], [&](RowId row)
+                    {
+                        bits[row.GetIndex() % c_rowCount] |= 1ull << (i & 63);
+                    });
+                }
+
+                uint64_t sum = 0;
+                for (auto word : bits)
+                {
+                    sum += word;
+                }
+                checksum += sum;
+            });
+
+            // Keep the compiler from discarding the work.
+            if (checksum.load() == 1)
+            {
+                std::cout << std::endl;
+            }
+
+            return static_cast<double>(iterations) * threadCount / seconds;
+        }
+
+
+        void RunPostingBenchmark(std::ostream& output,
+                                 size_t maxThreadCount,
+                                 size_t iterations)
+        {
+            PostingTermTables termTables(CreateTermTable());
+            ITermTable2 const & termTable = termTables.GetTermTable(0);
+            const auto postings =
+                CreatePostings((std::max)((std::min)(iterations, c_maxDistinctPostings),
+                                          2 * c_postingsPerDocument));
+
+            output << "threads,rowIdSequencePostingsPerSecond,"
+                      "cachePerPostingPostingsPerSecond,"
+                      "cachePerDocumentPostingsPerSecond" << std::endl;
+
+            for (size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount)
+            {
+                auto sequence = [&]()
+                {
+                    return [&](Term const & term, auto const & sink)
+                    {
+                        RowIdSequence rows(term, termTable);
+                        for (auto row : rows)
+                        {
+                            sink(row);
+                        }
+                    };
+                };
+
+                output << threadCount
+                       << "," << MeasureThroughput(postings, threadCount, iterations, sequence)
+                       << "," << MeasureIngestion(termTables, postings, threadCount, iterations, false)
+                       << "," << MeasureIngestion(termTables, postings, threadCount, iterations, true)
+                       << std::endl;
+            }
+        }
+    }
+}
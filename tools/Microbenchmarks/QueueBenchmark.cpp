@@ -0,0 +1,92 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "BitFunnel/Utilities/BlockingQueue.h"
+#include "BitFunnel/Utilities/MpmcQueue.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+
+
+namespace BitFunnel
+{
+    namespace Microbenchmarks
+    {
+        // Runs threadCount producers against threadCount consumers, each
+        // producer enqueueing iterations items, and returns items per second.
+        template <typename QUEUE>
+        static double MeasureThroughput(size_t threadCount, size_t iterations)
+        {
+            QUEUE queue(1024);
+
+            Stopwatch stopwatch;
+
+            std::vector<std::thread> consumers;
+            for (size_t t = 0; t < threadCount; ++t)
+            {
+                consumers.emplace_back([&queue]()
+                {
+                    size_t value;
+                    while (queue.TryDequeue(value))
+                    {
+                    }
+                });
+            }
+
+            TimeOnThreads(threadCount, [&queue, iterations](size_t)
+            {
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    queue.TryEnqueue(i);
+                }
+            });
+
+            queue.Shutdown();
+            for (auto & consumer : consumers)
+            {
+                consumer.join();
+            }
+
+            return static_cast<double>(iterations) * threadCount / stopwatch.ElapsedTime();
+        }
+
+
+        void RunQueueBenchmark(std::ostream& output,
+                               size_t maxThreadCount,
+                               size_t iterations)
+        {
+            output << "threads,blockingQueueItemsPerSecond,mpmcQueueItemsPerSecond" << std::endl;
+
+            for (size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount)
+            {
+                output << threadCount
+                       << "," << MeasureThroughput<BlockingQueue<size_t>>(threadCount, iterations)
+                       << "," << MeasureThroughput<MpmcQueue<size_t>>(threadCount, iterations)
+                       << std::endl;
+            }
+        }
+    }
+}
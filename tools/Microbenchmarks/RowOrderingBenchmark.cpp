@@ -0,0 +1,355 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Allocator.h"
+#include "Benchmarks.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/Helpers.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IDocumentDataSchema.h"
+#include "BitFunnel/Index/IIndexedIdfTable.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/ISliceBufferAllocator.h"
+#include "BitFunnel/Index/ITermTableBuilder.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/ITermTable2.h"
+#include "BitFunnel/ITermTreatment.h"
+#include "BitFunnel/Term.h"
+#include "BitFunnel/TermMatchNode.h"
+#include "BitFunnel/Token.h"
+#include "ChunkIngestor.h"
+#include "CompileNode.h"
+#include "DocumentFrequencyTable.h"
+#include "FactSetBase.h"
+#include "MatchTreeRewriter.h"
+#include "PlanRows.h"
+#include "RankDownCompiler.h"
+#include "RowDensityTable.h"
+#include "Shard.h"
+#include "ShardPlan.h"
+#include "TermMatchTreeConverter.h"
+#include "TextObjectParser.h"
+
+
+namespace BitFunnel
+{
+    namespace Microbenchmarks
+    {
+        static const size_t c_maxDocumentCount = 100000;
+
+        // Same values as the QueryExecutor.
+        static const unsigned c_targetRowCount = 4;
+        static const unsigned c_targetCrossProductTermCount = 16;
+
+        // Document frequencies of the terms "t0", "t1", ... Each term is
+        // sparser than the one before it.
+        static const double c_frequencies[] =
+        {
+            0.5, 0.3, 0.1, 0.03, 0.01, 0.003
+        };
+        static const size_t c_termCount =
+            sizeof(c_frequencies) / sizeof(c_frequencies[0]);
+
+
+        static std::string GetTermText(size_t term)
+        {
+            return "t" + std::to_string(term);
+        }
+
+
+        class TermTableCollection : public ITermTableCollection
+        {
+        public:
+            TermTableCollection(std::unique_ptr<ITermTable2> termTable)
+              : m_termTable(std::move(termTable))
+            {
+            }
+
+            virtual ITermTable2 & GetTermTable(ShardId) const override
+            {
+                return *m_termTable;
+            }
+
+            virtual size_t size() const override
+            {
+                return 1;
+            }
+
+        private:
+            std::unique_ptr<ITermTable2> m_termTable;
+        };
+
+
+        // Every term gets a private rank 0 row.
+        static std::unique_ptr<ITermTableCollection>
+            CreateTermTables(IConfiguration const & configuration)
+        {
+            DocumentFrequencyTable terms;
+            for (size_t term = 0; term < c_termCount; ++term)
+            {
+                Term t(GetTermText(term).c_str(), 0, configuration);
+                terms.AddEntry(
+                    IDocumentFrequencyTable::Entry(t, c_frequencies[term]));
+            }
+
+            auto treatment = Factories::CreateTreatmentPrivateRank0();
+            FactSetBase facts;
+            auto termTable = Factories::CreateTermTable();
+            Factories::CreateTermTableBuilder(0.1,
+                                              0.0001,
+                                              *treatment,
+                                              terms,
+                                              facts,
+                                              *termTable,
+                                              1);
+
+            return std::unique_ptr<ITermTableCollection>(
+                new TermTableCollection(std::move(termTable)));
+        }
+
+
+        // Document i contains term k with probability c_frequencies[k].
+        static std::vector<char> CreateChunk(size_t documentCount)
+        {
+            std::mt19937 generator(12345);
+            std::uniform_real_distribution<double> distribution(0, 1);
+
+            std::stringstream data;
+            for (size_t i = 0; i < documentCount; ++i)
+            {
+                char id[17];
+                sprintf(id, "%016zx", i);
+                data << id << '\0';
+                data << "00" << '\0';
+                for (size_t term = 0; term < c_termCount; ++term)
+                {
+                    if (distribution(generator) < c_frequencies[term])
+                    {
+                        data << GetTermText(term) << '\0';
+                    }
+                }
+                data << '\0' << '\0';
+            }
+            data << '\0';
+
+            std::string text = data.str();
+            return std::vector<char>(text.begin(), text.end());
+        }
+
+
+        // Conjunctions of two and three terms, each listed from the densest
+        // term to the sparsest, which is the worst order for RankDown.
+        static std::vector<std::vector<size_t>> CreateQueries()
+        {
+            std::vector<std::vector<size_t>> queries;
+            for (size_t a = 0; a < c_termCount; ++a)
+            {
+                for (size_t b = a + 1; b < c_termCount; ++b)
+                {
+                    queries.push_back({ a, b });
+                    for (size_t c = b + 1; c < c_termCount; ++c)
+                    {
+                        queries.push_back({ a, b, c });
+                    }
+                }
+            }
+            return queries;
+        }
+
+
+        static std::string GetQueryText(std::vector<size_t> const & query)
+        {
+            std::stringstream text;
+            text << "And {\n  Children: [\n";
+            for (size_t i = 0; i < query.size(); ++i)
+            {
+                text << "    Unigram(\"" << GetTermText(query[i]) << "\", 0)"
+                     << ((i + 1 < query.size()) ? ",\n" : "\n");
+            }
+            text << "  ]\n}";
+            return text.str();
+        }
+
+
+        // Plans and matches query against every Slice of the index's only
+        // Shard. Returns the number of row quadwords read and sets
+        // matchCount to the number of matches. Unless useSummaries is set,
+        // no required rows are passed to the plan, so that summary skipping
+        // doesn't hide the effect of the row ordering on the quadwords read.
+        static size_t MatchQuery(IIngestor const & ingestor,
+                                 IConfiguration const & configuration,
+                                 RowDensityTable const * densities,
+                                 bool useSummaries,
+                                 std::string const & queryText,
+                                 size_t& matchCount)
+        {
+            Allocator allocator(1 << 20);
+
+            std::stringstream input(queryText);
+            TextObjectParser parser(input, allocator, &TermMatchNode::GetType);
+            TermMatchNode const & query = TermMatchNode::Parse(parser);
+
+            PlanRows planRows(ingestor, densities);
+            TermMatchTreeConverter converter(ingestor,
+                                             configuration,
+                                             planRows,
+                                             allocator);
+            RowMatchNode const & rowPlan = converter.BuildRowPlan(query);
+            RowMatchNode const & rewritten =
+                MatchTreeRewriter::Rewrite(rowPlan,
+                                           c_targetRowCount,
+                                           c_targetCrossProductTermCount,
+                                           allocator,
+                                           &planRows);
+
+            std::vector<unsigned> requiredRows;
+            if (useSummaries)
+            {
+                ShardPlan::GetRequiredRows(rowPlan, requiredRows);
+            }
+
+            RankDownCompiler compiler(allocator);
+            CompileNode const & program = compiler.Compile(rewritten);
+            ShardPlan plan(program,
+                           compiler.GetInitialRank(),
+                           planRows,
+                           0,
+                           ingestor.GetShard(0),
+                           requiredRows);
+
+            const Token token = ingestor.GetTokenManager().RequestToken();
+
+            size_t quadwordsRead = 0;
+            std::vector<DocId> matches;
+            for (auto sliceBuffer : ingestor.GetShard(0).GetSliceBuffers())
+            {
+                quadwordsRead += plan.Match(sliceBuffer, matches);
+            }
+
+            matchCount = matches.size();
+            return quadwordsRead;
+        }
+
+
+        void RunRowOrderingBenchmark(std::ostream& output,
+                                     size_t maxThreadCount,
+                                     size_t iterations)
+        {
+            const size_t documentCount =
+                (std::min)(iterations, c_maxDocumentCount);
+
+            auto idfTable = Factories::CreateIndexedIdfTable();
+            auto configuration =
+                Factories::CreateConfiguration(1, false, *idfTable);
+            auto termTables = CreateTermTables(*configuration);
+            auto schema = Factories::CreateDocumentDataSchema();
+            auto recycler = Factories::CreateRecycler();
+            std::thread recyclerThread([&recycler] () { recycler->Run(); });
+            auto shardDefinition = Factories::CreateShardDefinition();
+
+            // Minimum size blocks hold 64 documents each.
+            auto allocator = Factories::CreateSliceBufferAllocator(
+                GetMinimumBlockSize(*schema, termTables->GetTermTable(0)),
+                documentCount / 64 + 16);
+
+            auto ingestor = Factories::CreateIngestor(*schema,
+                                                      *recycler,
+                                                      *termTables,
+                                                      *shardDefinition,
+                                                      *allocator,
+                                                      false);
+
+            ChunkIngestor(CreateChunk(documentCount), *configuration, *ingestor);
+
+            RowDensityTable densities(*ingestor, maxThreadCount);
+
+            output << "query,matches,quadwordsInQueryOrder,quadwordsSparsestFirst,"
+                   << "quadwordsWithSummaries"
+                   << std::endl;
+
+            size_t totalBefore = 0;
+            size_t totalAfter = 0;
+            size_t totalSummaries = 0;
+            for (auto const & query : CreateQueries())
+            {
+                const std::string text = GetQueryText(query);
+
+                size_t matchesBefore = 0;
+                size_t matchesAfter = 0;
+                size_t matchesSummaries = 0;
+                const size_t before =
+                    MatchQuery(*ingestor, *configuration, nullptr, false, text, matchesBefore);
+                const size_t after =
+                    MatchQuery(*ingestor, *configuration, &densities, false, text, matchesAfter);
+                const size_t summaries =
+                    MatchQuery(*ingestor, *configuration, &densities, true, text, matchesSummaries);
+
+                if (matchesBefore != matchesAfter)
+                {
+                    output << "Row ordering changed the matches." << std::endl;
+                }
+                if (matchesSummaries != matchesAfter)
+                {
+                    output << "Summaries changed the matches." << std::endl;
+                }
+
+                for (size_t i = 0; i < query.size(); ++i)
+                {
+                    output << (i == 0 ? "" : " ") << GetTermText(query[i]);
+                }
+                output << "," << matchesAfter
+                       << "," << before
+                       << "," << after
+                       << "," << summaries
+                       << std::endl;
+
+                totalBefore += before;
+                totalAfter += after;
+                totalSummaries += summaries;
+            }
+
+            output << "total,,"
+                   << totalBefore << ","
+                   << totalAfter << ","
+                   << totalSummaries << std::endl;
+
+            ingestor->Shutdown();
+            recycler->Shutdown();
+            recyclerThread.join();
+        }
+    }
+}
@@ -0,0 +1,73 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+#include <memory>
+
+#include "Benchmarks.h"
+#include "BitFunnel/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+
+
+namespace BitFunnel
+{
+    namespace Microbenchmarks
+    {
+        static double MeasureThroughput(ITokenManager& tokenManager,
+                                        size_t threadCount,
+                                        size_t iterations)
+        {
+            const double seconds = TimeOnThreads(threadCount, [&](size_t)
+            {
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    const Token token = tokenManager.RequestToken();
+                }
+            });
+
+            return static_cast<double>(iterations) * threadCount / seconds;
+        }
+
+
+        void RunTokenBenchmark(std::ostream& output,
+                               size_t maxThreadCount,
+                               size_t iterations)
+        {
+            output << "threads,tokenManagerTokensPerSecond,epochManagerTokensPerSecond" << std::endl;
+
+            for (size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount)
+            {
+                auto tokenManager(Factories::CreateTokenManager());
+                auto epochManager(Factories::CreateEpochManager(maxThreadCount));
+
+                output << threadCount
+                       << "," << MeasureThroughput(*tokenManager, threadCount, iterations)
+                       << "," << MeasureThroughput(*epochManager, threadCount, iterations)
+                       << std::endl;
+
+                tokenManager->Shutdown();
+                epochManager->Shutdown();
+            }
+        }
+    }
+}
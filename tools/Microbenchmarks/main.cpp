@@ -0,0 +1,148 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "Benchmarks.h"
+#include "CmdLineParser/CmdLineParser.h"
+
+
+namespace BitFunnel
+{
+    namespace Microbenchmarks
+    {
+        typedef void (*Benchmark)(std::ostream& output,
+                                  size_t maxThreadCount,
+                                  size_t iterations);
+
+        struct BenchmarkEntry
+        {
+            char const * m_name;
+            Benchmark m_benchmark;
+        };
+
+        static const BenchmarkEntry c_benchmarks[] =
+        {
+            { "blockallocator", RunBlockAllocatorBenchmark },
+            { "postings", RunPostingBenchmark },
+            { "queue", RunQueueBenchmark },
+            { "roworder", RunRowOrderingBenchmark },
+            { "tokens", RunTokenBenchmark },
+        };
+
+
+        static void ListBenchmarks(std::ostream& output)
+        {
+            output << "Available benchmarks:" << std::endl;
+            for (auto const & entry : c_benchmarks)
+            {
+                output << "  " << entry.m_name << std::endl;
+            }
+        }
+
+
+        static bool TryRunBenchmark(std::ostream& output,
+                                    char const * name,
+                                    size_t maxThreadCount,
+                                    size_t iterations)
+        {
+            for (auto const & entry : c_benchmarks)
+            {
+                if (strcmp(entry.m_name, name) == 0)
+                {
+                    output << "Running " << name
+                           << " (" << maxThreadCount << " threads max, "
+                           << iterations << " iterations)" << std::endl;
+                    entry.m_benchmark(output, maxThreadCount, iterations);
+                    return true;
+                }
+            }
+
+            output << "Unknown benchmark '" << name << "'." << std::endl;
+            ListBenchmarks(output);
+            return false;
+        }
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    CmdLine::CmdLineParser parser(
+        "Microbenchmarks",
+        "Run a microbenchmark and print its results as CSV.");
+
+    CmdLine::RequiredParameter<char const *> benchmark(
+        "benchmark",
+        "Name of the benchmark to run (e.g. blockallocator).");
+
+    const int defaultThreadCount =
+        static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    CmdLine::OptionalParameter<int> threads(
+        "threads",
+        "Maximum number of threads. Benchmarks sweep from 1 up to this value.",
+        defaultThreadCount,
+        CmdLine::GreaterThan(0));
+
+    CmdLine::OptionalParameter<int> iterations(
+        "iterations",
+        "Number of operations performed by each thread.",
+        1000000,
+        CmdLine::GreaterThan(0));
+
+    parser.AddParameter(benchmark);
+    parser.AddParameter(threads);
+    parser.AddParameter(iterations);
+
+    int returnCode = 0;
+
+    if (parser.TryParse(std::cout, argc, argv))
+    {
+        try
+        {
+            const bool success =
+                BitFunnel::Microbenchmarks::TryRunBenchmark(
+                    std::cout,
+                    benchmark,
+                    static_cast<size_t>(static_cast<int>(threads)),
+                    static_cast<size_t>(static_cast<int>(iterations)));
+            returnCode = success ? 0 : 1;
+        }
+        catch (...)
+        {
+            std::cout << "Unexpected error.";
+            returnCode = 1;
+        }
+    }
+    else
+    {
+        parser.Usage(std::cout, argv[0]);
+        returnCode = 1;
+    }
+
+    return returnCode;
+}
@@ -0,0 +1,122 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+
+#include "BitFunnel/BitFunnelTypes.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IShardDefinitionBuilder.h"
+#include "BitFunnel/ITermTable2.h"
+#include "CmdLineParser/CmdLineParser.h"
+
+
+namespace BitFunnel
+{
+    void BuildShardDefinition(char const * intermediateDirectory,
+                              ShardId shardCount)
+    {
+        std::cout << "Loading files for ShardDefinition build." << std::endl;
+
+        auto fileManager = Factories::CreateFileManager(intermediateDirectory,
+                                                        intermediateDirectory,
+                                                        intermediateDirectory);
+
+        // The TermTable built by TermTableBuilder for the unsharded corpus
+        // calibrates the cost of each shard.
+        auto termTable(Factories::CreateTermTable(*fileManager->TermTable(0).OpenForRead()));
+
+        auto shardDefinition(Factories::CreateShardDefinition());
+
+        std::cout << "Starting ShardDefinition build." << std::endl;
+
+        auto builder(Factories::CreateShardDefinitionBuilder(
+            *fileManager->DocumentLengthHistogram().OpenForRead(),
+            *termTable,
+            shardCount,
+            *shardDefinition));
+
+        builder->Print(std::cout);
+
+        std::cout << "Writing ShardDefinition file." << std::endl;
+
+        shardDefinition->Write(*fileManager->ShardDefinition().OpenForWrite());
+
+        std::cout << "Done." << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    CmdLine::CmdLineParser parser(
+        "ShardDefinitionBuilder",
+        "Generate a ShardDefinition from the DocumentLengthHistogram written "
+        "by StatisticsBuilder and the TermTable written by TermTableBuilder.");
+
+    CmdLine::RequiredParameter<char const *> tempPath(
+        "tempPath",
+        "Path to a tmp directory. "
+        "Something like /tmp/ or c:\\temp\\, depending on platform..");
+
+    CmdLine::OptionalParameter<int> shardCount(
+        "shards",
+        "Number of shards in the ShardDefinition.",
+        4,
+        CmdLine::GreaterThan(0));
+
+    parser.AddParameter(tempPath);
+    parser.AddParameter(shardCount);
+
+    int returnCode = 0;
+
+    if (parser.TryParse(std::cout, argc, argv))
+    {
+        try
+        {
+            BitFunnel::BuildShardDefinition(
+                tempPath,
+                static_cast<BitFunnel::ShardId>(static_cast<int>(shardCount)));
+            returnCode = 0;
+        }
+        catch (BitFunnel::RecoverableError const & e)
+        {
+            std::cout << "Error: " << e.what() << std::endl;
+            returnCode = 1;
+        }
+        catch (...)
+        {
+            std::cout << "Unexpected error.";
+            returnCode = 1;
+        }
+    }
+    else
+    {
+        parser.Usage(std::cout, argv[0]);
+        returnCode = 1;
+    }
+
+    return returnCode;
+}
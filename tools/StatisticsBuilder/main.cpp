@@ -57,11 +57,18 @@ namespace BitFunnel
                                        // TODO: gramSize should be unsigned once CmdLineParser supports unsigned.
                                        int gramSize,
                                        bool generateStatistics,
-                                       bool generateTermToText)
+                                       bool generateTermToText,
+                                       size_t threadCount,
+                                       double errorBound,
+                                       size_t heavyHitterCount)
     {
         auto index = Factories::CreateSimpleIndex(intermediateDirectory,
                                                   gramSize,
                                                   generateTermToText);
+        if (heavyHitterCount > 0)
+        {
+            index->SetApproximateStatistics(errorBound, heavyHitterCount);
+        }
         index->StartIndex(true);
 
 
@@ -82,8 +89,6 @@ namespace BitFunnel
 
         Stopwatch stopwatch;
 
-        // TODO: Use correct thread count.
-        const size_t threadCount = 1;
         IngestChunks(filePaths, configuration, ingestor, threadCount);
 
         const double elapsedTime = stopwatch.ElapsedTime();
@@ -129,6 +134,23 @@ int main(int argc, char** argv)
         "Generate index statistics such as document frequency table, "
         "document length histogram, and cumulative term counts.");
 
+    CmdLine::OptionalParameterList approximate(
+        "approximate",
+        "Compute the document frequency table approximately, in fixed memory. "
+        "Keeps the heavyHitters most frequent terms, with counts overestimated "
+        "by at most errorBound times the number of postings.");
+    CmdLine::RequiredParameter<double> errorBound(
+        "errorBound",
+        "Bound on the overestimate of each count, as a fraction of the number "
+        "of postings.",
+        CmdLine::GreaterThan(0.0));
+    CmdLine::RequiredParameter<int> heavyHitters(
+        "heavyHitters",
+        "Number of terms kept in the document frequency table.",
+        CmdLine::GreaterThan(0));
+    approximate.AddParameter(errorBound);
+    approximate.AddParameter(heavyHitters);
+
     CmdLine::OptionalParameterList termToText(
         "text",
         "Create mapping from Term::Hash to term text.");
@@ -140,11 +162,19 @@ int main(int argc, char** argv)
         "Set the maximum ngram size for phrases.",
         1u);
 
+    CmdLine::OptionalParameter<int> threadCount(
+        "threads",
+        "Number of threads for ingestion.",
+        1,
+        CmdLine::GreaterThan(0));
+
     parser.AddParameter(chunkListFileName);
     parser.AddParameter(tempPath);
     parser.AddParameter(statistics);
+    parser.AddParameter(approximate);
     parser.AddParameter(termToText);
     parser.AddParameter(gramSize);
+    parser.AddParameter(threadCount);
 
     int returnCode = 0;
 
@@ -156,7 +186,12 @@ int main(int argc, char** argv)
                                               chunkListFileName,
                                               gramSize,
                                               statistics.IsActivated(),
-                                              termToText.IsActivated());
+                                              termToText.IsActivated(),
+                                              static_cast<size_t>(static_cast<int>(threadCount)),
+                                              approximate.IsActivated() ?
+                                                  static_cast<double>(errorBound) : 0.0,
+                                              approximate.IsActivated() ?
+                                                  static_cast<size_t>(static_cast<int>(heavyHitters)) : 0);
             returnCode = 0;
         }
         catch (...)
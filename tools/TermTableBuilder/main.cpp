@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 
 
+#include <fstream>
 #include <iostream>
 
 #include "BitFunnel/BitFunnelTypes.h"
@@ -42,7 +43,9 @@ namespace BitFunnel
                         ShardId shard,
                         double density,
                         double snr,
-                        double adhocFrequency)
+                        double adhocFrequency,
+                        char const * treatmentFileName,
+                        size_t threadCount)
     {
         std::cout << "Loading files for TermTable build." << std::endl;
 
@@ -52,7 +55,16 @@ namespace BitFunnel
 
         auto terms(Factories::CreateDocumentFrequencyTable(*fileManager->DocFreqTable(shard).OpenForRead()));
 
-        auto treatment(Factories::CreateTreatmentPrivateShardRank0And3(density, snr));
+        std::unique_ptr<ITermTreatment> treatment;
+        if (*treatmentFileName != 0)
+        {
+            std::ifstream input(treatmentFileName);
+            treatment = Factories::CreateTreatmentTable(input);
+        }
+        else
+        {
+            treatment = Factories::CreateTreatmentPrivateShardRank0And3(density, snr);
+        }
 
         auto facts(Factories::CreateFactSet());
 
@@ -65,7 +77,8 @@ namespace BitFunnel
                                                                 *treatment,
                                                                 *terms,
                                                                 *facts,
-                                                                *termTable));
+                                                                *termTable,
+                                                                threadCount));
 
         termTableBuilder->Print(std::cout);
 
@@ -89,7 +102,21 @@ int main(int argc, char** argv)
         "Something like /tmp/ or c:\\temp\\, depending on platform..");
 
 
+    CmdLine::OptionalParameter<char const *> treatment(
+        "treatment",
+        "Path to a TermTreatment table generated by TermTreatmentTuner. "
+        "Uses TreatmentPrivateSharedRank0And3 if not specified.",
+        "");
+
+    CmdLine::OptionalParameter<int> threadCount(
+        "threads",
+        "Number of threads used to build the TermTable.",
+        1,
+        CmdLine::GreaterThan(0));
+
     parser.AddParameter(tempPath);
+    parser.AddParameter(treatment);
+    parser.AddParameter(threadCount);
 
     int returnCode = 0;
 
@@ -106,7 +133,9 @@ int main(int argc, char** argv)
                                       shard,
                                       density,
                                       snr,
-                                      adhocFrequency);
+                                      adhocFrequency,
+                                      treatment,
+                                      static_cast<size_t>(static_cast<int>(threadCount)));
             returnCode = 0;
         }
         catch (...)
@@ -0,0 +1,235 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BitFunnel/BitFunnelTypes.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IDocumentFrequencyTable.h"
+#include "BitFunnel/Term.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "TermTreatments.h"
+#include "TermTreatmentTuner.h"
+
+
+namespace BitFunnel
+{
+    // Reads one query per line and maps each word to the IdfX10 value of the
+    // matching term in the DocumentFrequencyTable. Words that are not in the
+    // table are adhoc terms and are treated as maximally rare. Characters
+    // other than letters and digits, such as query operators, separate
+    // words.
+    void AddQueries(TermTreatmentTuner& tuner,
+                    IDocumentFrequencyTable const & terms,
+                    std::istream& queries)
+    {
+        std::unordered_map<Term::Hash, Term::IdfX10> idfs;
+        for (auto const & entry : terms)
+        {
+            Term term = entry.GetTerm();
+            auto it = idfs.find(term.GetRawHash());
+            if (it == idfs.end())
+            {
+                idfs.insert(std::make_pair(term.GetRawHash(),
+                                           term.GetIdfSum()));
+            }
+            else
+            {
+                // The same word may appear in more than one stream. Use its
+                // most common occurrence.
+                it->second = std::min(it->second, term.GetIdfSum());
+            }
+        }
+
+        // DESIGN NOTE: copy c_maxIdfX10Value to a local so that the
+        // conditional expression below does not need its address.
+        const Term::IdfX10 adhocIdf = Term::c_maxIdfX10Value;
+
+        std::string line;
+        std::vector<Term::IdfX10> query;
+        while (std::getline(queries, line))
+        {
+            query.clear();
+
+            size_t i = 0;
+            while (i < line.size())
+            {
+                while (i < line.size() &&
+                       !std::isalnum(static_cast<unsigned char>(line[i])))
+                {
+                    ++i;
+                }
+
+                size_t start = i;
+                while (i < line.size() &&
+                       std::isalnum(static_cast<unsigned char>(line[i])))
+                {
+                    ++i;
+                }
+
+                if (i > start)
+                {
+                    std::string word(line, start, i - start);
+                    auto it = idfs.find(Term::ComputeRawHash(word.c_str()));
+                    query.push_back(it == idfs.end() ? adhocIdf : it->second);
+                }
+            }
+
+            if (!query.empty())
+            {
+                tuner.AddQuery(query);
+            }
+        }
+    }
+
+
+    void TuneTermTreatment(char const * intermediateDirectory,
+                           char const * queryLogFileName,
+                           char const * outputFileName,
+                           double bytesPerDocument,
+                           ShardId shard,
+                           double density,
+                           double maxFalsePositiveRate)
+    {
+        std::cout << "Loading files for TermTreatment tuning." << std::endl;
+
+        auto fileManager = Factories::CreateFileManager(intermediateDirectory,
+                                                        intermediateDirectory,
+                                                        intermediateDirectory);
+
+        auto terms(Factories::CreateDocumentFrequencyTable(*fileManager->DocFreqTable(shard).OpenForRead()));
+
+        TermTreatmentTuner tuner(density, maxFalsePositiveRate);
+        tuner.AddTerms(*terms);
+
+        std::ifstream queries(queryLogFileName);
+        if (!queries.is_open())
+        {
+            RecoverableError error("TermTreatmentTuner: unable to open query log.");
+            throw error;
+        }
+        AddQueries(tuner, *terms, queries);
+
+        std::cout << "Starting TermTreatment tuning." << std::endl;
+
+        auto configurations = tuner.Tune(bytesPerDocument);
+        tuner.Print(std::cout, configurations);
+
+        std::cout << "Writing TermTreatment file." << std::endl;
+
+        TreatmentTable table(configurations);
+        std::ofstream output(outputFileName);
+        table.Write(output);
+
+        std::cout << "Done." << std::endl;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    CmdLine::CmdLineParser parser(
+        "TermTreatmentTuner",
+        "Choose the row configuration for each IdfX10 value that minimizes "
+        "quadwords scanned per query within a memory budget.");
+
+    CmdLine::RequiredParameter<char const *> tempPath(
+        "tempPath",
+        "Path to a tmp directory containing the DocumentFrequencyTable. "
+        "Something like /tmp/ or c:\\temp\\, depending on platform..");
+
+    CmdLine::RequiredParameter<char const *> queryLog(
+        "queryLog",
+        "Path to a sample query log with one query per line.");
+
+    CmdLine::RequiredParameter<char const *> output(
+        "output",
+        "Path to the TermTreatment table to be written.");
+
+    CmdLine::RequiredParameter<double> bytesPerDocument(
+        "bytesPerDocument",
+        "Memory budget for rows, in bytes per document.");
+
+    CmdLine::OptionalParameter<double> density(
+        "density",
+        "Target bit density for shared rows.",
+        0.1);
+
+    CmdLine::OptionalParameter<double> maxFalsePositiveRate(
+        "falsepositives",
+        "Largest acceptable ratio of false positives to matches for a term.",
+        0.1);
+
+    parser.AddParameter(tempPath);
+    parser.AddParameter(queryLog);
+    parser.AddParameter(output);
+    parser.AddParameter(bytesPerDocument);
+    parser.AddParameter(density);
+    parser.AddParameter(maxFalsePositiveRate);
+
+    int returnCode = 0;
+
+    if (parser.TryParse(std::cout, argc, argv))
+    {
+        try
+        {
+            BitFunnel::ShardId shard = 0;
+
+            BitFunnel::TuneTermTreatment(tempPath,
+                                         queryLog,
+                                         output,
+                                         bytesPerDocument,
+                                         shard,
+                                         density,
+                                         maxFalsePositiveRate);
+            returnCode = 0;
+        }
+        catch (BitFunnel::RecoverableError const & e)
+        {
+            std::cout << "Error: " << e.what() << std::endl;
+            returnCode = 1;
+        }
+        catch (...)
+        {
+            std::cout << "Unexpected error.";
+            returnCode = 1;
+        }
+    }
+    else
+    {
+        parser.Usage(std::cout, argv[0]);
+        returnCode = 1;
+    }
+
+    return returnCode;
+}